@@ -1,12 +1,28 @@
 #include <nw/formats/StaticTwoDA.hpp>
 #include <nw/formats/TwoDA.hpp>
 #include <nw/i18n/Tlk.hpp>
+#include <nw/kernel/EventSystem.hpp>
+#include <nw/kernel/FactionSystem.hpp>
+#include <nw/kernel/JobSystem.hpp>
+#include <nw/kernel/Memory.hpp>
 #include <nw/kernel/Rules.hpp>
 #include <nw/kernel/Strings.hpp>
 #include <nw/model/Mdl.hpp>
+#include <nw/objects/Area.hpp>
+#include <nw/objects/AreaSpatialIndex.hpp>
 #include <nw/objects/Creature.hpp>
+#include <nw/objects/Door.hpp>
+#include <nw/objects/Encounter.hpp>
+#include <nw/objects/LocalData.hpp>
 #include <nw/objects/ObjectManager.hpp>
+#include <nw/objects/ObjectSnapshot.hpp>
+#include <nw/objects/Placeable.hpp>
+#include <nw/objects/Sound.hpp>
+#include <nw/objects/Store.hpp>
+#include <nw/objects/Trigger.hpp>
+#include <nw/objects/Waypoint.hpp>
 #include <nw/resources/ResourceManager.hpp>
+#include <nw/resources/StaticErf.hpp>
 #include <nw/script/Nss.hpp>
 #include <nw/serialization/Gff.hpp>
 #include <nw/serialization/GffBuilder.hpp>
@@ -17,7 +33,11 @@
 #include <nw/profiles/nwn1/constants.hpp>
 #include <nw/profiles/nwn1/rules.hpp>
 #include <nw/profiles/nwn1/scriptbridge.hpp>
+#include <nw/rules/combat_scheduler.hpp>
 #include <nw/rules/effects.hpp>
+#include <nw/smalls/AstCompiler.hpp>
+#include <nw/smalls/BytecodeCache.hpp>
+#include <nw/smalls/ScriptFunction.hpp>
 #include <nw/smalls/Smalls.hpp>
 #include <nw/smalls/runtime.hpp>
 
@@ -27,6 +47,14 @@
 #include "../tests/item_gff_builders.hpp"
 #include "test_nwn_root.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <new>
+#include <optional>
+#include <queue>
 #include <random>
 
 // Note the resources loaded here should be default NWN resources distributed in the game install
@@ -37,6 +65,26 @@ namespace nwk = nw::kernel;
 
 using namespace std::literals;
 
+// Counts global allocations so benchmarks can report allocations per iteration.
+static std::atomic<uint64_t> g_allocation_count{0};
+
+void* operator new(std::size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 static fs::path resolve_stdlib_module_path(const char* argv0, std::string_view module)
 {
     std::error_code ec;
@@ -87,17 +135,54 @@ static void set_benchmark_working_directory(const char* argv0)
     }
 }
 
+// Arg 0 tokenizes, arg 1 tokenizes and compiles column caches, arg 2 maps a compiled sidecar.
 static void BM_parse_feat_2da_static(benchmark::State& state)
 {
     nw::ResourceData data = nw::ResourceData::from_file("test_data/user/development/feat.2da");
     const auto bytes = static_cast<int64_t>(data.bytes.size());
-    for (auto _ : state) {
+    const auto hash = nw::StaticTwoDA::source_hash(data);
+    if (state.range(0) == 2) {
+        std::filesystem::create_directories("tmp");
         nw::StaticTwoDA tda{data.copy()};
-        benchmark::DoNotOptimize(tda);
+        tda.compile();
+        tda.write_sidecar("tmp/bm_feat.2dac", hash);
+    }
+
+    for (auto _ : state) {
+        if (state.range(0) == 2) {
+            auto tda = nw::StaticTwoDA::from_sidecar("tmp/bm_feat.2dac", data.name, hash);
+            benchmark::DoNotOptimize(tda);
+        } else {
+            nw::StaticTwoDA tda{data.copy()};
+            if (state.range(0) == 1) { tda.compile(); }
+            benchmark::DoNotOptimize(tda);
+        }
     }
     state.SetBytesProcessed(state.iterations() * bytes);
 }
-BENCHMARK(BM_parse_feat_2da_static);
+BENCHMARK(BM_parse_feat_2da_static)->Arg(0)->Arg(1)->Arg(2);
+
+// Reads an int and a float column of every row, arg 0 parses cell text, arg 1 reads column caches.
+static void BM_lookup_feat_2da_static(benchmark::State& state)
+{
+    nw::StaticTwoDA tda{std::filesystem::path("test_data/user/development/feat.2da")};
+    if (state.range(0) == 1) { tda.compile(); }
+    const size_t feat = tda.column_index("FEAT");
+    const size_t max_cr = tda.column_index("MAXCR");
+
+    for (auto _ : state) {
+        int32_t ints = 0;
+        float floats = 0.0f;
+        for (size_t row = 0; row < tda.rows(); ++row) {
+            ints += tda.get<int32_t>(row, feat).value_or(0);
+            floats += tda.get<float>(row, max_cr).value_or(0.0f);
+        }
+        benchmark::DoNotOptimize(ints);
+        benchmark::DoNotOptimize(floats);
+    }
+    state.SetItemsProcessed(state.iterations() * tda.rows() * 2);
+}
+BENCHMARK(BM_lookup_feat_2da_static)->Arg(0)->Arg(1);
 
 static void BM_parse_feat_2da(benchmark::State& state)
 {
@@ -111,27 +196,50 @@ static void BM_parse_feat_2da(benchmark::State& state)
 }
 BENCHMARK(BM_parse_feat_2da);
 
+// Parses a creature already in memory, arg 0 copies the gff tables, arg 1 reads them in place.
 static void BM_load_creature_gff(benchmark::State& state)
 {
-    nw::ResourceData data = nw::ResourceData::from_file("test_data/user/development/drorry.utc");
-    const auto bytes = static_cast<int64_t>(data.bytes.size());
+    auto data = std::make_shared<nw::ResourceData>(
+        nw::ResourceData::from_file("test_data/user/development/drorry.utc"));
+    const auto bytes = static_cast<int64_t>(data->bytes.size());
     for (auto _ : state) {
-        nw::Gff gff{nw::ResourceData::from_file("test_data/user/development/drorry.utc")};
+        nw::ResourceData view;
+        view.name = data->name;
+        view.bytes = nw::ByteArray::borrow(data, data->bytes.data(), data->bytes.size());
+        nw::Gff gff{std::move(view), nw::LanguageID::english, !!state.range(0)};
         benchmark::DoNotOptimize(gff);
     }
     state.SetBytesProcessed(state.iterations() * bytes);
 }
-BENCHMARK(BM_load_creature_gff);
+BENCHMARK(BM_load_creature_gff)->Arg(0)->Arg(1);
 
+// Parses and deserializes a creature already in memory, reporting how many label lookups were
+// answered by the Gff slot cache in builds with ROLLNW_ENABLE_GFF_STATS.
 static void BM_creature_from_gff(benchmark::State& state)
 {
-    nw::ResourceData data = nw::ResourceData::from_file("test_data/user/development/drorry.utc");
-    const auto bytes = static_cast<int64_t>(data.bytes.size());
+    auto data = std::make_shared<nw::ResourceData>(
+        nw::ResourceData::from_file("test_data/user/development/drorry.utc"));
+    const auto bytes = static_cast<int64_t>(data->bytes.size());
+    uint64_t lookups = 0;
+    uint64_t slot_hits = 0;
     for (auto _ : state) {
-        auto ent = nwk::objects().load_file<nw::Creature>("test_data/user/development/drorry.utc");
+        nw::ResourceData view;
+        view.name = data->name;
+        view.bytes = nw::ByteArray::borrow(data, data->bytes.data(), data->bytes.size());
+        nw::Gff gff{std::move(view)};
+        auto ent = nwk::objects().make<nw::Creature>();
+        nw::deserialize(ent, gff.toplevel(), nw::SerializationProfile::blueprint);
         benchmark::DoNotOptimize(ent);
+        nwk::objects().destroy(ent->handle());
+
+        auto stats = gff.lookup_stats();
+        lookups += stats.lookups;
+        slot_hits += stats.slot_hits;
     }
     state.SetBytesProcessed(state.iterations() * bytes);
+    if (!lookups) { return; }
+    state.counters["label_lookups"] = benchmark::Counter(static_cast<double>(lookups), benchmark::Counter::kAvgIterations);
+    state.counters["slot_hit_rate"] = static_cast<double>(slot_hits) / static_cast<double>(lookups);
 }
 BENCHMARK(BM_creature_from_gff);
 
@@ -171,20 +279,28 @@ BENCHMARK(BM_creature_to_json_blueprint);
 static void BM_creature_to_gff_blueprint(benchmark::State& state)
 {
     auto ent = nwk::objects().load_file<nw::Creature>("test_data/user/development/drorry.utc");
+    const uint64_t allocations = g_allocation_count.load(std::memory_order_relaxed);
     for (auto _ : state) {
         auto out = serialize(ent, nw::SerializationProfile::blueprint);
         benchmark::DoNotOptimize(out);
     }
+    state.counters["allocations"] = benchmark::Counter(
+        static_cast<double>(g_allocation_count.load(std::memory_order_relaxed) - allocations),
+        benchmark::Counter::kAvgIterations);
 }
 BENCHMARK(BM_creature_to_gff_blueprint);
 
 static void BM_creature_to_gff_instance(benchmark::State& state)
 {
     auto ent = nwk::objects().load_file<nw::Creature>("test_data/user/development/drorry.utc");
+    const uint64_t allocations = g_allocation_count.load(std::memory_order_relaxed);
     for (auto _ : state) {
         auto out = serialize(ent, nw::SerializationProfile::instance);
         benchmark::DoNotOptimize(out);
     }
+    state.counters["allocations"] = benchmark::Counter(
+        static_cast<double>(g_allocation_count.load(std::memory_order_relaxed) - allocations),
+        benchmark::Counter::kAvgIterations);
 }
 BENCHMARK(BM_creature_to_gff_instance);
 
@@ -265,15 +381,86 @@ static void BM_resources_resman_contains(benchmark::State& state)
 }
 BENCHMARK(BM_resources_resman_contains);
 
+// Demands a random batch of resources, arg 0 one at a time, arg 1 through demand_many.
+static void BM_resources_resman_demand_many(benchmark::State& state)
+{
+    std::vector<nw::Resource> resources;
+    nw::kernel::resman().visit([&resources](nw::Resource res) {
+        resources.push_back(res);
+    });
+    if (resources.empty()) {
+        state.SkipWithError("no resources");
+        return;
+    }
+
+    std::mt19937 gen(42);
+    std::shuffle(resources.begin(), resources.end(), gen);
+    resources.resize(std::min<size_t>(resources.size(), 256));
+
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        if (state.range(0)) {
+            auto data = nw::kernel::resman().demand_many(resources);
+            for (const auto& it : data) {
+                bytes += static_cast<int64_t>(it.bytes.size());
+            }
+            benchmark::DoNotOptimize(data);
+        } else {
+            for (auto res : resources) {
+                auto data = nw::kernel::resman().demand(res);
+                bytes += static_cast<int64_t>(data.bytes.size());
+                benchmark::DoNotOptimize(data);
+            }
+        }
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_resources_resman_demand_many)->Arg(0)->Arg(1);
+
+// Demands every resource in a module, arg 0 reads through a stream, arg 1 borrows from a memory mapping.
+static void BM_resources_erf_demand(benchmark::State& state)
+{
+    nw::StaticErf erf{"test_data/user/modules/DockerDemo.mod"};
+    if (!erf.valid()) {
+        state.SkipWithError("failed to load module");
+        return;
+    }
+    if (state.range(0) && !erf.memory_map()) {
+        state.SkipWithError("failed to memory map module");
+        return;
+    }
+
+    std::vector<const nw::ContainerKey*> keys;
+    keys.reserve(erf.size());
+    erf.visit([&keys](nw::Resource, const nw::ContainerKey* key) {
+        keys.push_back(key);
+    });
+
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        for (auto key : keys) {
+            auto data = erf.demand(key);
+            bytes += static_cast<int64_t>(data.bytes.size());
+            benchmark::DoNotOptimize(data);
+        }
+    }
+    state.SetBytesProcessed(bytes);
+    state.SetLabel(state.range(0) ? "mmap" : "stream");
+}
+BENCHMARK(BM_resources_erf_demand)->Arg(0)->Arg(1);
+
+// Arg 0 is the ``nw::AreaLoadMode``: serial, parallel or lazy.
 static void BM_load_module(benchmark::State& state)
 {
+    nwk::config().set_area_load_mode(static_cast<nw::AreaLoadMode>(state.range(0)));
     for (auto _ : state) {
         auto m = nwk::load_module("test_data/user/modules/DockerDemo.mod");
         nwk::unload_module();
         benchmark::DoNotOptimize(m);
     }
+    nwk::config().set_area_load_mode(nw::AreaLoadMode::serial);
 }
-BENCHMARK(BM_load_module);
+BENCHMARK(BM_load_module)->Arg(0)->Arg(1)->Arg(2);
 
 [[maybe_unused]] static void BM_start_service(benchmark::State& state)
 {
@@ -422,6 +609,8 @@ static void BM_nwn1_equip_unequip_high_level(benchmark::State& state)
 }
 BENCHMARK(BM_nwn1_equip_unequip_high_level);
 
+// Arg 0 calls by name through Runtime::execute_script, 1 through the nwn1 bridge, 2 through a typed
+// ScriptFunction handle.
 static void BM_smalls_bridge_noop(benchmark::State& state)
 {
     auto module = nwk::load_module("test_data/user/modules/DockerDemo.mod");
@@ -443,7 +632,22 @@ fn noop(): int {
     }
 
     nw::Vector<nw::smalls::Value> args;
-    auto warmup = nwn1::bridge::call_nwn1_module_int("bench.noop", "noop", args);
+    nw::smalls::ScriptFunction<int32_t()> noop{"bench.noop", "noop"};
+    auto call = [&]() -> std::optional<int32_t> {
+        switch (state.range(0)) {
+        case 0: {
+            auto result = rt.execute_script("bench.noop", "noop", args);
+            if (!result.ok()) { return std::nullopt; }
+            return result.value.data.ival;
+        }
+        case 1:
+            return nwn1::bridge::call_nwn1_module_int("bench.noop", "noop", args);
+        default:
+            return noop.call(rt);
+        }
+    };
+
+    auto warmup = call();
     if (!warmup || *warmup != 1) {
         nwk::unload_module();
         state.SkipWithError("failed to warm up smalls bridge noop benchmark");
@@ -451,7 +655,7 @@ fn noop(): int {
     }
 
     for (auto _ : state) {
-        auto out = nwn1::bridge::call_nwn1_module_int("bench.noop", "noop", args);
+        auto out = call();
         benchmark::DoNotOptimize(out);
         if (!out) {
             state.SkipWithError("smalls bridge noop call failed");
@@ -461,7 +665,115 @@ fn noop(): int {
 
     nwk::unload_module();
 }
-BENCHMARK(BM_smalls_bridge_noop);
+BENCHMARK(BM_smalls_bridge_noop)->Arg(0)->Arg(1)->Arg(2);
+
+// Arg 0 runs a loop compiled as is, 1 with every bytecode optimizer pass.
+static void BM_smalls_bytecode_optimizer(benchmark::State& state)
+{
+    auto& rt = nwk::runtime();
+    const auto previous = rt.bytecode_optimizer();
+    rt.set_bytecode_optimizer(state.range(0) ? nw::smalls::BytecodeOptimizerOptions{}
+                                             : nw::smalls::BytecodeOptimizerOptions::none());
+
+    const auto module_name = fmt::format("bench.optimizer{}", state.range(0));
+    auto* script = rt.load_module_from_source(module_name, R"(
+fn weight(x: int, y: int): int {
+    return x * 3 + y;
+}
+
+fn run(n: int): int {
+    var total = 0;
+    for (var i = 0; i < n; i = i + 1) {
+        var v = i;
+        if (v % 3 == 0) {
+            total = weight(total, v) % 1000;
+        } else {
+            total += v;
+        }
+    }
+    return total;
+}
+)");
+    nw::smalls::ScriptFunction<int32_t(int32_t)> run{module_name, "run"};
+    if (!script || !run.resolve(rt)) {
+        rt.set_bytecode_optimizer(previous);
+        state.SkipWithError("failed to compile bytecode optimizer benchmark module");
+        return;
+    }
+
+    for (auto _ : state) {
+        auto out = run.call(rt, 1000);
+        benchmark::DoNotOptimize(out);
+        if (!out) {
+            state.SkipWithError("bytecode optimizer benchmark call failed");
+            break;
+        }
+    }
+
+    rt.evict_module(module_name);
+    rt.set_bytecode_optimizer(previous);
+}
+BENCHMARK(BM_smalls_bytecode_optimizer)->Arg(0)->Arg(1);
+
+// Arg 0 compiles a resolved script, 1 reads the same module from its serialized bytecode.
+static void BM_smalls_bytecode_cache(benchmark::State& state)
+{
+    auto& rt = nwk::runtime();
+    nw::smalls::Script script{"bench.bytecode_cache", R"(
+type Pair { x: int; y: float; };
+
+fn weight(x: int, y: int): int {
+    return x * 3 + y;
+}
+
+fn label(n: int): string {
+    if (n > 10) { return "many"; }
+    if (n > 2) { return "some"; }
+    return "few";
+}
+
+fn run(n: int): int {
+    var p: Pair = { n, 1.5 };
+    var total = p.x;
+    for (var i = 0; i < n; i = i + 1) {
+        if (label(i) == "many") {
+            total = weight(total, i) % 1000;
+        } else {
+            total += i;
+        }
+    }
+    return total;
+}
+)", rt.diagnostic_context()};
+    script.parse();
+    script.resolve();
+
+    nw::smalls::BytecodeModule compiled{"bench.bytecode_cache"};
+    nw::smalls::AstCompiler compiler{&script, &compiled, &rt, rt.diagnostic_context()};
+    nw::ByteArray bytes;
+    if (script.errors() > 0 || !compiler.compile()
+        || !nw::smalls::write_bytecode_module(compiled, rt, script.text(), 1, bytes)) {
+        state.SkipWithError("failed to compile bytecode cache benchmark module");
+        return;
+    }
+
+    for (auto _ : state) {
+        nw::smalls::BytecodeModule module{"bench.bytecode_cache"};
+        bool ok;
+        if (state.range(0) == 0) {
+            nw::smalls::AstCompiler c{&script, &module, &rt, rt.diagnostic_context()};
+            ok = c.compile();
+        } else {
+            ok = nw::smalls::read_bytecode_module(bytes.span(), rt, script.text(), 1, module);
+        }
+        benchmark::DoNotOptimize(module.functions.data());
+        if (!ok) {
+            state.SkipWithError("bytecode cache benchmark iteration failed");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_smalls_bytecode_cache)->Arg(0)->Arg(1);
 
 static void BM_kernel_object_lookup(benchmark::State& state)
 {
@@ -489,6 +801,429 @@ static void BM_kernel_object_lookup(benchmark::State& state)
 }
 BENCHMARK(BM_kernel_object_lookup);
 
+// Arg 0 finds the object service by scanning type indices as lookups used to, arg 1 reads its slot.
+static void BM_kernel_service_lookup(benchmark::State& state)
+{
+    auto obj = nwk::objects().load<nw::Creature>("nw_chicken"sv);
+    if (!obj) {
+        state.SkipWithError("Failed to create test object");
+        return;
+    }
+    const auto handle = obj->handle();
+
+    for (auto _ : state) {
+        nw::Creature* cre = nullptr;
+        if (state.range(0) == 0) {
+            auto* objects = static_cast<nw::ObjectManager*>(nwk::services().find(nw::ObjectManager::type_index));
+            cre = objects->get<nw::Creature>(handle);
+        } else {
+            cre = nwk::objects().get<nw::Creature>(handle);
+        }
+        benchmark::DoNotOptimize(cre);
+    }
+    nwk::objects().destroy(handle);
+}
+BENCHMARK(BM_kernel_service_lookup)->Arg(0)->Arg(1);
+
+// Arg 0 reads locals by name, arg 1 by a LocalKey created once.
+static void BM_local_data_get(benchmark::State& state)
+{
+    nw::LocalData locals;
+    std::vector<std::string> names;
+    for (int i = 0; i < 64; ++i) {
+        names.push_back(fmt::format("bm_local_var_{}", i));
+        locals.set_int(names.back(), i);
+        locals.set_string(names.back(), names.back());
+    }
+    std::vector<nw::LocalKey> keys;
+    for (const auto& name : names) {
+        keys.emplace_back(name);
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        const size_t index = i++ & 63;
+        int32_t value = state.range(0) == 0 ? locals.get_int(names[index]) : locals.get_int(keys[index]);
+        benchmark::DoNotOptimize(value);
+    }
+    state.counters["bytes_per_var"] = double(locals.memory_usage()) / double(locals.size());
+}
+BENCHMARK(BM_local_data_get)->Arg(0)->Arg(1);
+
+// Arg 0 asks for each target's reputation one at a time, arg 1 classifies all targets in one call.
+static void BM_faction_classify_hostility(benchmark::State& state)
+{
+    auto& factions = nwk::factions();
+    if (factions.count() == 0) {
+        state.SkipWithError("No factions loaded");
+        return;
+    }
+
+    std::vector<nw::ObjectHandle> targets;
+    for (int i = 0; i < 256; ++i) {
+        auto* obj = nwk::objects().load<nw::Creature>("nw_chicken"sv);
+        if (!obj) { continue; }
+        nwk::objects().components().set_faction(obj->handle(), static_cast<uint32_t>(i) % uint32_t(factions.count()));
+        targets.push_back(obj->handle());
+    }
+    if (targets.empty()) {
+        state.SkipWithError("Failed to create test objects");
+        return;
+    }
+    const auto observer = targets.front();
+    factions.adjust_personal_reputation(observer, targets.back(), -50);
+
+    for (auto _ : state) {
+        size_t hostile = 0;
+        if (state.range(0) == 0) {
+            for (auto target : targets) {
+                hostile += factions.reputation(observer, target) <= nwk::FactionSystem::hostile_threshold;
+            }
+        } else {
+            hostile = factions.classify_hostility(observer, targets).count();
+        }
+        benchmark::DoNotOptimize(hostile);
+    }
+
+    factions.clear_personal_reputation(observer);
+    for (auto target : targets) {
+        nwk::objects().destroy(target);
+    }
+}
+BENCHMARK(BM_faction_classify_hostility)->Arg(0)->Arg(1);
+
+static std::mt19937 s_event_rng{42};
+static bool s_event_reschedule = true;
+
+static void BM_event_reschedule(const nwk::EventHandle&)
+{
+    if (!s_event_reschedule) { return; }
+    std::uniform_int_distribution<uint64_t> delay(1, 6000);
+    nwk::events().add_custom(nw::ObjectHandle{}, &BM_event_reschedule, delay(s_event_rng));
+}
+
+// Keeps 100k events pending, each rescheduling itself 1 to 6000 ticks out when it fires.  Arg 0 runs the
+// same workload on a binary heap for comparison, arg 1 on the event system's timing wheel.
+static void BM_events_process(benchmark::State& state)
+{
+    constexpr size_t pending = 100000;
+    std::uniform_int_distribution<uint64_t> delay(1, 6000);
+    int64_t processed = 0;
+
+    if (state.range(0) == 0) {
+        using Entry = std::pair<uint64_t, uint64_t>; // tick, sequence
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+        uint64_t tick = 0;
+        uint64_t sequence = 0;
+        for (size_t i = 0; i < pending; ++i) {
+            heap.emplace(delay(s_event_rng), sequence++);
+        }
+        for (auto _ : state) {
+            ++tick;
+            while (!heap.empty() && heap.top().first <= tick) {
+                heap.pop();
+                heap.emplace(tick + delay(s_event_rng), sequence++);
+                ++processed;
+            }
+        }
+    } else {
+        auto& events = nwk::events();
+        events.process_until(std::numeric_limits<uint64_t>::max());
+        events.set_current_tick(0);
+        for (size_t i = 0; i < pending; ++i) {
+            events.add_custom(nw::ObjectHandle{}, &BM_event_reschedule, delay(s_event_rng));
+        }
+        for (auto _ : state) {
+            events.advance(1);
+            processed += events.process();
+        }
+
+        state.PauseTiming();
+        s_event_reschedule = false;
+        events.process_until(events.current_tick() + 6000);
+        s_event_reschedule = true;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(processed);
+}
+BENCHMARK(BM_events_process)->Arg(0)->Arg(1);
+
+// Objects scattered over a 32 x 32 tile area.
+static std::vector<std::pair<nw::ObjectHandle, glm::vec3>> make_area_objects(int64_t count)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(0.0f, 320.0f);
+    std::vector<std::pair<nw::ObjectHandle, glm::vec3>> result;
+    for (int64_t i = 0; i < count; ++i) {
+        result.emplace_back(nw::ObjectHandle{static_cast<nw::ObjectID>(i), nw::ObjectType::creature},
+            glm::vec3{coord(rng), coord(rng), 0.0f});
+    }
+    return result;
+}
+
+// Arg 0 is the object count, arg 1 selects a linear scan (0) or the area spatial index (1).
+static void BM_area_spatial_radius(benchmark::State& state)
+{
+    const auto objects = make_area_objects(state.range(0));
+    nw::AreaSpatialIndex index;
+    for (const auto& [obj, position] : objects) {
+        index.update(obj, position, 0);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(0.0f, 320.0f);
+    nw::Vector<nw::ObjectHandle> out;
+    for (auto _ : state) {
+        const glm::vec3 center{coord(rng), coord(rng), 0.0f};
+        out.clear();
+        if (state.range(1) == 0) {
+            for (const auto& [obj, position] : objects) {
+                const glm::vec3 d = position - center;
+                if (glm::dot(d, d) <= 20.0f * 20.0f) { out.push_back(obj); }
+            }
+        } else {
+            index.query_radius(center, 20.0f, {}, out);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_area_spatial_radius)->ArgsProduct({{1000, 10000}, {0, 1}});
+
+// Arg 0 is the object count, arg 1 selects a partial sort of every object (0) or the area spatial index (1).
+static void BM_area_spatial_nearest(benchmark::State& state)
+{
+    const auto objects = make_area_objects(state.range(0));
+    nw::AreaSpatialIndex index;
+    for (const auto& [obj, position] : objects) {
+        index.update(obj, position, 0);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(0.0f, 320.0f);
+    std::vector<std::pair<float, nw::ObjectHandle>> scratch;
+    nw::Vector<nw::ObjectHandle> out;
+    for (auto _ : state) {
+        const glm::vec3 center{coord(rng), coord(rng), 0.0f};
+        out.clear();
+        if (state.range(1) == 0) {
+            scratch.clear();
+            for (const auto& [obj, position] : objects) {
+                const glm::vec3 d = position - center;
+                scratch.emplace_back(glm::dot(d, d), obj);
+            }
+            std::partial_sort(scratch.begin(), scratch.begin() + 8, scratch.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+            for (size_t i = 0; i < 8; ++i) {
+                out.push_back(scratch[i].second);
+            }
+        } else {
+            index.query_nearest(center, 8, {}, out);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_area_spatial_nearest)->ArgsProduct({{1000, 10000}, {0, 1}});
+
+static nw::Area* load_snapshot_area()
+{
+    auto area = nwk::objects().make<nw::Area>();
+    nw::Gff are{"test_data/user/development/test_area.are"};
+    nw::Gff git{"test_data/user/development/test_area.git"};
+    nw::Gff gic{"test_data/user/development/test_area.gic"};
+    nw::deserialize(area, are.toplevel(), git.toplevel(), gic.toplevel());
+    return area;
+}
+
+// Calls ``f`` with each pair of matching object lists of two areas.
+template <typename F>
+static void visit_area_lists(nw::Area* lhs, nw::Area* rhs, F&& f)
+{
+    f(lhs->creatures, rhs->creatures);
+    f(lhs->doors, rhs->doors);
+    f(lhs->encounters, rhs->encounters);
+    f(lhs->items, rhs->items);
+    f(lhs->placeables, rhs->placeables);
+    f(lhs->sounds, rhs->sounds);
+    f(lhs->stores, rhs->stores);
+    f(lhs->triggers, rhs->triggers);
+    f(lhs->waypoints, rhs->waypoints);
+}
+
+// Arg 0 writes one instance GFF per object of the test area as snapshots used to, arg 1 an AreaSnapshot.
+static void BM_area_snapshot_write(benchmark::State& state)
+{
+    auto area = load_snapshot_area();
+    size_t bytes = 0;
+    for (auto _ : state) {
+        bytes = 0;
+        if (state.range(0) == 0) {
+            visit_area_lists(area, area, [&](const auto& list, const auto&) {
+                for (const auto* obj : list) {
+                    auto out = serialize(obj, nw::SerializationProfile::instance).to_byte_array();
+                    bytes += out.size();
+                    benchmark::DoNotOptimize(out.data());
+                }
+            });
+        } else {
+            auto out = nw::AreaSnapshot::write(area);
+            bytes = out.size();
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+    nwk::objects().destroy(area->handle());
+}
+BENCHMARK(BM_area_snapshot_write)->Arg(0)->Arg(1);
+
+// Arg 0 restores the objects of the test area from one in memory instance GFF each, arg 1 from an AreaSnapshot.
+static void BM_area_snapshot_restore(benchmark::State& state)
+{
+    auto area = load_snapshot_area();
+    auto restored = nwk::objects().make<nw::Area>();
+
+    std::vector<std::vector<std::shared_ptr<nw::ResourceData>>> instances;
+    auto snapshot = nw::AreaSnapshot::write(area);
+    size_t bytes = snapshot.size();
+    if (state.range(0) == 0) {
+        bytes = 0;
+        visit_area_lists(area, area, [&](const auto& list, const auto&) {
+            auto& out = instances.emplace_back();
+            for (const auto* obj : list) {
+                auto data = std::make_shared<nw::ResourceData>();
+                data->bytes = serialize(obj, nw::SerializationProfile::instance).to_byte_array();
+                bytes += data->bytes.size();
+                out.push_back(std::move(data));
+            }
+        });
+    }
+
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            restored->clear();
+            size_t i = 0;
+            visit_area_lists(area, restored, [&](const auto&, auto& holder) {
+                using T = std::remove_pointer_t<typename std::decay_t<decltype(holder)>::value_type>;
+                for (const auto& data : instances[i]) {
+                    nw::ResourceData view;
+                    view.bytes = nw::ByteArray::borrow(data, data->bytes.data(), data->bytes.size());
+                    nw::Gff gff{std::move(view)};
+                    if (auto* obj = nwk::objects().load_instance<T>(gff.toplevel())) { holder.push_back(obj); }
+                }
+                ++i;
+            });
+        } else {
+            nw::AreaSnapshot::restore(restored, std::span<const uint8_t>{snapshot.data(), snapshot.size()});
+        }
+        benchmark::DoNotOptimize(restored->creatures.data());
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+    restored->clear();
+    nwk::objects().destroy(restored->handle());
+    nwk::objects().destroy(area->handle());
+}
+BENCHMARK(BM_area_snapshot_restore)->Arg(0)->Arg(1);
+
+// Arg 0 is the number of creatures attacking on one tick, arg 1 selects one resolve_attack call per
+// creature (0) or one resolve_round call for all of them (1).
+static void BM_combat_resolve_round(benchmark::State& state)
+{
+    auto module = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    if (!module) {
+        state.SkipWithError("failed to load benchmark module");
+        return;
+    }
+
+    auto* target = nwk::objects().load_file<nw::Creature>("test_data/user/development/nw_chicken.utc");
+    std::vector<nw::Creature*> attackers;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        attackers.push_back(nwk::objects().load_file<nw::Creature>("test_data/user/development/pl_agent_001.utc"));
+    }
+    if (!target || std::find(attackers.begin(), attackers.end(), nullptr) != attackers.end()) {
+        nwk::unload_module();
+        state.SkipWithError("failed to load benchmark creatures");
+        return;
+    }
+    std::vector<nw::ObjectBase*> targets(attackers.size(), target);
+
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            for (auto* attacker : attackers) {
+                benchmark::DoNotOptimize(nw::combat::resolve_attack(attacker, target));
+            }
+        } else {
+            benchmark::DoNotOptimize(nw::combat::resolve_round(attackers, targets));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    nwk::unload_module();
+}
+BENCHMARK(BM_combat_resolve_round)->ArgsProduct({{8, 64}, {0, 1}});
+
+// 50k timed effects spread over 500 creatures, none due.  Arg 0 finds expired effects by scanning every
+// creature's EffectArray (0) or by asking the effect system's expiry index (1).
+static void BM_effects_expire(benchmark::State& state)
+{
+    auto module = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    if (!module) {
+        state.SkipWithError("failed to load benchmark module");
+        return;
+    }
+
+    constexpr size_t creature_count = 500;
+    constexpr size_t effects_per_creature = 100;
+    constexpr uint64_t first_expiry = uint64_t(1) << 40;
+
+    std::vector<nw::Creature*> creatures;
+    for (size_t i = 0; i < creature_count; ++i) {
+        auto* cre = nwk::objects().load_file<nw::Creature>("test_data/user/development/nw_chicken.utc");
+        if (!cre) {
+            nwk::unload_module();
+            state.SkipWithError("failed to load benchmark creatures");
+            return;
+        }
+        nw::Vector<nw::Effect*> effects;
+        for (size_t j = 0; j < effects_per_creature; ++j) {
+            auto* eff = nwk::effects().create(nwn1::effect_type_haste);
+            eff->expire_tick = first_expiry + i * effects_per_creature + j;
+            effects.push_back(eff);
+        }
+        nwk::effects().apply_to(cre, effects);
+        creatures.push_back(cre);
+    }
+
+    uint64_t tick = 0;
+    for (auto _ : state) {
+        tick = (tick + 1) % 1024;
+        if (state.range(0) == 0) {
+            size_t due = 0;
+            for (auto* cre : creatures) {
+                for (const auto& handle : cre->effects()) {
+                    if (handle.effect->expire_tick != 0 && handle.effect->expire_tick <= tick) { ++due; }
+                }
+            }
+            benchmark::DoNotOptimize(due);
+        } else {
+            benchmark::DoNotOptimize(nwk::effects().expire(tick));
+        }
+    }
+    state.counters["active_effects"] = double(nwk::effects().expiring());
+    nwk::unload_module();
+}
+BENCHMARK(BM_effects_expire)->Arg(0)->Arg(1);
+
+// Arg 0 is the number of job system workers, 0 runs the loop inline on the calling thread.
+static void BM_kernel_jobs_parallel_for(benchmark::State& state)
+{
+    nwk::JobSystem jobs{nwk::global_allocator(), size_t(state.range(0))};
+    nw::Vector<float> values(1 << 20, 1.0f);
+    for (auto _ : state) {
+        jobs.parallel_for(std::span<float>{values}, [](float& value) { value = value * 1.0001f + 0.5f; }, 4096);
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_kernel_jobs_parallel_for)->Arg(0)->Arg(2)->Arg(4)->UseRealTime();
+
 int main(int argc, char** argv)
 {
     set_benchmark_working_directory(argc > 0 ? argv[0] : nullptr);
@@ -1,3 +1,4 @@
+#include <nw/kernel/EventSystem.hpp>
 #include <nw/kernel/Kernel.hpp>
 #include <nw/kernel/Memory.hpp>
 #include <nw/objects/Creature.hpp>
@@ -8,6 +9,7 @@
 #include <nw/smalls/AstCompiler.hpp>
 #include <nw/smalls/Bytecode.hpp>
 #include <nw/smalls/Context.hpp>
+#include <nw/smalls/CoroutineScheduler.hpp>
 #include <nw/smalls/Smalls.hpp>
 #include <nw/smalls/VirtualMachine.hpp>
 #include <nw/smalls/runtime.hpp>
@@ -481,6 +483,117 @@ fn main(): int {
 }
 BENCHMARK(BM_vm_map_put_get_loop);
 
+// Key-specialized map storage through MAPGET/MAPSET. Module globals keep the maps and keys rooted.
+constexpr const char* k_smalls_map_bench_source = R"(
+import core.array as arr;
+
+var int_map: map!(int, int) = {};
+var string_map: map!(string, int) = {};
+var keys: array!(string) = {};
+
+fn setup(n: int) {
+    for (var i = 0; i < n; i = i + 1) {
+        var key = f"key{i}";
+        arr.push(keys, key);
+        int_map[i] = i;
+        string_map[key] = i;
+    }
+}
+
+fn lookup_int(n: int): int {
+    var sum = 0;
+    for (var i = 0; i < n; i = i + 1) {
+        sum = sum + int_map[i];
+    }
+    return sum;
+}
+
+fn lookup_string(): int {
+    var sum = 0;
+    for (var key in keys) {
+        sum = sum + string_map[key];
+    }
+    return sum;
+}
+
+fn insert_int(n: int): int {
+    var m: map!(int, int) = {};
+    for (var i = 0; i < n; i = i + 1) {
+        m[i] = i;
+    }
+    return n;
+}
+
+fn insert_string(): int {
+    var m: map!(string, int) = {};
+    var i = 0;
+    for (var key in keys) {
+        m[key] = i;
+        i = i + 1;
+    }
+    return i;
+}
+)";
+
+// Arg 0 is the number of entries, each iteration looks up or inserts every entry once
+static void run_smalls_map_bench(benchmark::State& state, const char* module_name, const char* function, bool pass_count)
+{
+    auto& rt = nw::kernel::runtime();
+    auto* script = rt.load_module_from_source(module_name, k_smalls_map_bench_source);
+    if (!script || script->errors() != 0) {
+        state.SkipWithError("failed to compile map bench script");
+        return;
+    }
+
+    const auto count = static_cast<int32_t>(state.range(0));
+    nw::Vector<nw::smalls::Value> args{nw::smalls::Value::make_int(count)};
+    if (!rt.execute_script(script, "setup", args, 0).ok()) {
+        state.SkipWithError("failed to fill map bench script");
+        rt.evict_module(module_name);
+        return;
+    }
+    if (!pass_count) { args.clear(); }
+
+    auto* gc = rt.gc();
+    for (auto _ : state) {
+        auto res = rt.execute_script(script, function, args, 0);
+        benchmark::DoNotOptimize(res);
+        if (gc) {
+            state.PauseTiming();
+            gc->collect_minor();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(count) * state.iterations());
+
+    rt.evict_module(module_name);
+    if (gc) { gc->collect_major(); }
+}
+
+static void BM_smalls_map_int_lookup(benchmark::State& state)
+{
+    run_smalls_map_bench(state, "bench.map_int_lookup", "lookup_int", true);
+}
+BENCHMARK(BM_smalls_map_int_lookup)->Arg(1000)->Arg(100000);
+
+static void BM_smalls_map_int_insert(benchmark::State& state)
+{
+    run_smalls_map_bench(state, "bench.map_int_insert", "insert_int", true);
+}
+BENCHMARK(BM_smalls_map_int_insert)->Arg(1000)->Arg(100000);
+
+static void BM_smalls_map_string_lookup(benchmark::State& state)
+{
+    run_smalls_map_bench(state, "bench.map_string_lookup", "lookup_string", false);
+}
+BENCHMARK(BM_smalls_map_string_lookup)->Arg(1000)->Arg(100000);
+
+static void BM_smalls_map_string_insert(benchmark::State& state)
+{
+    run_smalls_map_bench(state, "bench.map_string_insert", "insert_string", false);
+}
+BENCHMARK(BM_smalls_map_string_insert)->Arg(1000)->Arg(100000);
+
 // Minimum C++→smalls boundary cost: module lookup, function name lookup, frame setup.
 // Uses execute_script (not execute_compiled) to exercise the full dispatch path.
 static void BM_smalls_script_entry(benchmark::State& state)
@@ -505,6 +618,51 @@ static void BM_smalls_script_entry(benchmark::State& state)
 }
 BENCHMARK(BM_smalls_script_entry);
 
+// Parked coroutine wakeups: every coroutine yields once per tick, so one tick is a single wake event
+// resuming all of them.
+// Arg 0 is the number of parked coroutines, each iteration advances one tick and resumes them all.
+static void BM_smalls_coroutine_tick(benchmark::State& state)
+{
+    auto& rt = nw::kernel::runtime();
+    auto* script = rt.load_module_from_source("bench.coroutine_tick", R"(
+import core.coroutine as co;
+
+fn run() {
+    var i = 0;
+    for (i >= 0) {
+        i = i + 1;
+        co.yield();
+    }
+}
+)");
+    if (!script || script->errors() != 0) {
+        state.SkipWithError("failed to compile coroutine bench script");
+        return;
+    }
+
+    auto& scheduler = rt.coroutines();
+    const auto count = static_cast<size_t>(state.range(0));
+    for (size_t i = 0; i < count; ++i) {
+        if (scheduler.spawn(script, "run") == 0) {
+            state.SkipWithError("failed to spawn coroutine");
+            scheduler.clear();
+            rt.evict_module("bench.coroutine_tick");
+            return;
+        }
+    }
+
+    auto& events = nw::kernel::events();
+    for (auto _ : state) {
+        events.advance(1);
+        events.process();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(count) * state.iterations());
+
+    scheduler.clear();
+    rt.evict_module("bench.coroutine_tick");
+}
+BENCHMARK(BM_smalls_coroutine_tick)->Arg(1000)->Arg(10000);
+
 // == Modifier system benchmarks ==============================================
 // Both benchmarks require nwn1.init to have been called (init_modifiers).
 // The main() in main.cpp starts kernel services and loads stdlib module paths,
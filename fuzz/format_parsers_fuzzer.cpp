@@ -201,7 +201,7 @@ void fuzz_mdl_binary(const uint8_t* data, size_t size)
 {
     nw::ResourceData resource = make_resource(data, size, nw::ResourceType::mdl);
     if (resource.bytes.size() != 0) {
-        resource.bytes[0] = 0;
+        resource.bytes.mutable_data()[0] = 0;
     }
     nw::model::Mdl mdl{std::move(resource)};
     (void)mdl.valid();
@@ -20,7 +20,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
     try {
         nw::ResourceData resource;
         resource.bytes.append(data, size);
-        resource.bytes[0] = 0;
+        resource.bytes.mutable_data()[0] = 0;
         nw::model::Mdl mdl{std::move(resource)};
         (void)mdl.valid();
     } catch (...) {
@@ -55,7 +55,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
         resource.name.type = nw::ResourceType::mdl;
         resource.bytes.append(data, size);
         if (resource.bytes[0] == 0) {
-            resource.bytes[0] = '#';
+            resource.bytes.mutable_data()[0] = '#';
         }
 
         nw::model::Mdl mdl{std::move(resource)};
@@ -2,10 +2,68 @@
 
 #include "TwoDATokenizer.hpp"
 
+#include "../util/MappedFile.hpp"
+#include "../util/templates.hpp"
+
+#include "xxhash/xxh3.h"
+
+#include <absl/container/flat_hash_map.h>
+
+#include <fstream>
+#include <system_error>
+
 using namespace std::literals;
+namespace fs = std::filesystem;
 
 namespace nw {
 
+namespace {
+
+/// @cond NEVER
+struct SidecarHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t source_hash;
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t has_default;
+    uint32_t strings_size;
+    uint64_t cells_offset;
+    uint64_t ints_offset;
+    uint64_t floats_offset;
+    uint64_t bits_offset;
+    uint64_t strings_offset;
+};
+
+struct SidecarCell {
+    uint32_t offset;
+    uint32_t size;
+};
+/// @endcond
+
+static_assert(sizeof(SidecarHeader) == 72);
+
+constexpr char sidecar_magic[4] = {'N', 'W', '2', 'C'};
+constexpr uint32_t sidecar_version = 1;
+
+bool range_contains(size_t file_size, uint64_t offset, uint64_t size) noexcept
+{
+    if (offset > file_size) { return false; }
+    return size <= file_size - offset;
+}
+
+size_t align8(size_t value) noexcept
+{
+    return (value + 7) & ~size_t(7);
+}
+
+size_t bit_words(size_t bits) noexcept
+{
+    return (bits + 63) / 64;
+}
+
+} // namespace
+
 StaticTwoDA::StaticTwoDA(const std::filesystem::path& filename)
     : StaticTwoDA(ResourceData::from_file(filename))
 {
@@ -38,6 +96,220 @@ size_t StaticTwoDA::columns() const noexcept
     return columns_.size();
 }
 
+size_t StaticTwoDA::cache_index(size_t row, size_t col) const
+{
+    CHECK_F(row < row_count_ && col < columns_.size(), "[2da] {}: out of bounds row {}, col {}",
+        data_.name.resref.view(), row, col);
+    return col * row_count_ + row;
+}
+
+void StaticTwoDA::compile()
+{
+    if (!is_loaded_ || compiled_) { return; }
+
+    row_count_ = rows();
+    const size_t cells = row_count_ * columns_.size();
+    const size_t words = bit_words(cells);
+
+    int_storage_.assign(cells, 0);
+    float_storage_.assign(cells, 0.0f);
+    bit_storage_.assign(words * 3, 0);
+    uint64_t* null_bits = bit_storage_.data();
+    uint64_t* int_bits = null_bits + words;
+    uint64_t* float_bits = int_bits + words;
+
+    for (size_t col = 0; col < columns_.size(); ++col) {
+        for (size_t row = 0; row < row_count_; ++row) {
+            const StringView cell = rows_[row * columns_.size() + col];
+            const size_t idx = col * row_count_ + row;
+            const uint64_t bit = uint64_t(1) << (idx & 63);
+            if (cell == "****") {
+                null_bits[idx >> 6] |= bit;
+                continue;
+            }
+            if (auto value = string::from<int32_t>(cell)) {
+                int_storage_[idx] = *value;
+                int_bits[idx >> 6] |= bit;
+            }
+            if (auto value = string::from<float>(cell)) {
+                float_storage_[idx] = *value;
+                float_bits[idx >> 6] |= bit;
+            }
+        }
+    }
+
+    ints_ = int_storage_;
+    floats_ = float_storage_;
+    null_bits_ = {null_bits, words};
+    int_bits_ = {int_bits, words};
+    float_bits_ = {float_bits, words};
+    compiled_ = true;
+}
+
+bool StaticTwoDA::write_sidecar(const fs::path& path, uint64_t source_hash) const
+{
+    if (!compiled_) { return false; }
+
+    const size_t cells = row_count_ * columns_.size();
+    const size_t words = bit_words(cells);
+
+    // Cell text is deduplicated, most tables are dominated by a handful of values.
+    String strings;
+    absl::flat_hash_map<StringView, uint32_t> string_offsets;
+    Vector<SidecarCell> table;
+    table.reserve(columns_.size() + 1 + cells);
+    const auto add_string = [&](StringView str) {
+        auto [it, inserted] = string_offsets.try_emplace(str, static_cast<uint32_t>(strings.size()));
+        if (inserted) { strings.append(str); }
+        table.push_back({it->second, static_cast<uint32_t>(str.size())});
+    };
+    for (const auto& col : columns_) {
+        add_string(col);
+    }
+    add_string(default_);
+    for (const auto cell : rows_) {
+        add_string(cell);
+    }
+
+    if (strings.size() > std::numeric_limits<uint32_t>::max()) { return false; }
+
+    SidecarHeader header{};
+    std::memcpy(header.magic, sidecar_magic, 4);
+    header.version = sidecar_version;
+    header.source_hash = source_hash;
+    header.rows = static_cast<uint32_t>(row_count_);
+    header.columns = static_cast<uint32_t>(columns_.size());
+    header.has_default = !default_.empty();
+    header.strings_size = static_cast<uint32_t>(strings.size());
+    header.cells_offset = sizeof(SidecarHeader);
+    header.ints_offset = align8(header.cells_offset + table.size() * sizeof(SidecarCell));
+    header.floats_offset = align8(header.ints_offset + cells * sizeof(int32_t));
+    header.bits_offset = align8(header.floats_offset + cells * sizeof(float));
+    header.strings_offset = header.bits_offset + words * 3 * sizeof(uint64_t);
+
+    std::error_code ec;
+    if (path.has_parent_path()) { fs::create_directories(path.parent_path(), ec); }
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+        if (!out) {
+            LOG_F(ERROR, "[2da] unable to write sidecar '{}'", tmp);
+            return false;
+        }
+        const char padding[8] = {};
+        const auto pad_to = [&](uint64_t offset) {
+            ostream_write(out, padding, offset - static_cast<uint64_t>(out.tellp()));
+        };
+        ostream_write(out, &header, sizeof(header));
+        ostream_write(out, table.data(), table.size() * sizeof(SidecarCell));
+        pad_to(header.ints_offset);
+        ostream_write(out, ints_.data(), cells * sizeof(int32_t));
+        pad_to(header.floats_offset);
+        ostream_write(out, floats_.data(), cells * sizeof(float));
+        pad_to(header.bits_offset);
+        ostream_write(out, null_bits_.data(), words * sizeof(uint64_t));
+        ostream_write(out, int_bits_.data(), words * sizeof(uint64_t));
+        ostream_write(out, float_bits_.data(), words * sizeof(uint64_t));
+        ostream_write(out, strings.data(), strings.size());
+        if (!out) {
+            LOG_F(ERROR, "[2da] unable to write sidecar '{}'", tmp);
+            return false;
+        }
+    }
+
+    // Renamed into place so a concurrent reader never maps a partial file.
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        LOG_F(ERROR, "[2da] unable to replace sidecar '{}': {}", path, ec.message());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+StaticTwoDA StaticTwoDA::from_sidecar(const fs::path& path, Resource name, uint64_t source_hash)
+{
+    StaticTwoDA result;
+    result.data_.name = name;
+
+    std::error_code ec;
+    if (!fs::exists(path, ec)) { return result; }
+
+    auto file = MappedFile::open(path);
+    if (!file) { return result; }
+
+    SidecarHeader header;
+    if (!range_contains(file->size(), 0, sizeof(header))) { return result; }
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, sidecar_magic, 4) != 0 || header.version != sidecar_version
+        || header.source_hash != source_hash) {
+        return result;
+    }
+
+    const uint64_t cells = uint64_t(header.rows) * header.columns;
+    const uint64_t words = bit_words(cells);
+    const uint64_t table_size = header.columns + 1 + cells;
+    const bool valid = range_contains(file->size(), header.cells_offset, table_size * sizeof(SidecarCell))
+        && range_contains(file->size(), header.ints_offset, cells * sizeof(int32_t))
+        && range_contains(file->size(), header.floats_offset, cells * sizeof(float))
+        && range_contains(file->size(), header.bits_offset, words * 3 * sizeof(uint64_t))
+        && range_contains(file->size(), header.strings_offset, header.strings_size)
+        && header.ints_offset % alignof(int32_t) == 0
+        && header.floats_offset % alignof(float) == 0
+        && header.bits_offset % alignof(uint64_t) == 0;
+    if (!valid) {
+        LOG_F(WARNING, "[2da] sidecar '{}' is corrupt", path);
+        return result;
+    }
+
+    const char* strings = reinterpret_cast<const char*>(file->data() + header.strings_offset);
+    const auto cell = [&](size_t index, StringView& out) {
+        SidecarCell c;
+        std::memcpy(&c, file->data() + header.cells_offset + index * sizeof(SidecarCell), sizeof(c));
+        if (!range_contains(header.strings_size, c.offset, c.size)) { return false; }
+        out = StringView{strings + c.offset, c.size};
+        return true;
+    };
+
+    StringView str;
+    result.columns_.reserve(header.columns);
+    for (size_t i = 0; i < header.columns; ++i) {
+        if (!cell(i, str)) { return result; }
+        result.columns_.emplace_back(str);
+    }
+    if (!cell(header.columns, str)) { return result; }
+    if (header.has_default) { result.default_ = String(str); }
+    result.rows_.resize(cells);
+    for (size_t i = 0; i < cells; ++i) {
+        if (!cell(header.columns + 1 + i, result.rows_[i])) {
+            LOG_F(WARNING, "[2da] sidecar '{}' is corrupt", path);
+            return StaticTwoDA{};
+        }
+    }
+
+    const uint8_t* base = file->data();
+    result.ints_ = {reinterpret_cast<const int32_t*>(base + header.ints_offset), cells};
+    result.floats_ = {reinterpret_cast<const float*>(base + header.floats_offset), cells};
+    const auto* bits = reinterpret_cast<const uint64_t*>(base + header.bits_offset);
+    result.null_bits_ = {bits, words};
+    result.int_bits_ = {bits + words, words};
+    result.float_bits_ = {bits + words * 2, words};
+    result.row_count_ = header.rows;
+
+    // Cells view the mapping, the borrowed bytes keep it alive for the life of the table.
+    const size_t size = file->size();
+    result.data_.bytes = ByteArray::borrow(std::move(file), base, size);
+    result.compiled_ = true;
+    result.is_loaded_ = true;
+    return result;
+}
+
+uint64_t StaticTwoDA::source_hash(const ResourceData& data) noexcept
+{
+    return XXH3_64bits(data.bytes.data(), data.bytes.size());
+}
+
 StringView StaticTwoDA::get_internal(size_t row, size_t col) const
 {
     size_t idx = row * columns_.size() + col;
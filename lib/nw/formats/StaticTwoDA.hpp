@@ -7,7 +7,9 @@
 #include <filesystem>
 #include <limits>
 #include <optional>
+#include <span>
 #include <string_view>
+#include <utility>
 
 namespace nw {
 
@@ -65,6 +67,23 @@ struct StaticTwoDA final {
     /// Is the 2da parsed without error
     bool is_valid() const noexcept;
 
+    /// Builds typed column caches, afterwards integer and float lookups no longer parse cell text
+    void compile();
+
+    /// Determines if typed column caches have been built
+    bool compiled() const noexcept { return compiled_; }
+
+    /// Writes the table and its column caches to a binary sidecar
+    /// @param source_hash Hash of the source 2da, see ``source_hash``
+    bool write_sidecar(const std::filesystem::path& path, uint64_t source_hash) const;
+
+    /// Maps a sidecar written by ``write_sidecar``, the result is compiled.
+    /// @note The result is invalid if the sidecar is missing, corrupt, or was built from a different source.
+    static StaticTwoDA from_sidecar(const std::filesystem::path& path, Resource name, uint64_t source_hash);
+
+    /// Hashes the bytes of a source 2da
+    static uint64_t source_hash(const ResourceData& data) noexcept;
+
 private:
     ResourceData data_;
     bool is_loaded_ = false;
@@ -72,8 +91,26 @@ private:
     String default_;
     Vector<String> columns_;
 
+    // Column caches, column major.  The spans view either the storage vectors or a mapped sidecar.
+    bool compiled_ = false;
+    size_t row_count_ = 0;
+    std::span<const int32_t> ints_;
+    std::span<const float> floats_;
+    std::span<const uint64_t> null_bits_;  ///< Cell is "****"
+    std::span<const uint64_t> int_bits_;   ///< Cell parses as int32_t
+    std::span<const uint64_t> float_bits_; ///< Cell parses as float
+    Vector<int32_t> int_storage_;
+    Vector<float> float_storage_;
+    Vector<uint64_t> bit_storage_;
+
+    size_t cache_index(size_t row, size_t col) const;
     StringView get_internal(size_t row, size_t col) const;
     bool parse();
+
+    static bool test_bit(std::span<const uint64_t> bits, size_t index) noexcept
+    {
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
 };
 
 template <typename T>
@@ -104,6 +141,30 @@ bool StaticTwoDA::get_to(size_t row, size_t col, T& out) const
         std::is_same_v<T, String> || std::is_same_v<T, float> || std::is_convertible_v<T, int32_t> || std::is_same_v<T, StringView>,
         "TwoDA only supports float, String, StringView, or anything convertible to int32_t");
 
+    if constexpr (std::is_same_v<T, float>) {
+        if (compiled_) {
+            const size_t idx = cache_index(row, col);
+            if (!test_bit(float_bits_, idx)) { return false; }
+            out = floats_[idx];
+            return true;
+        }
+    } else if constexpr (std::is_same_v<T, int16_t> || std::is_same_v<T, int32_t>
+        || std::is_same_v<T, uint32_t> || std::is_same_v<T, int64_t>) {
+        if (compiled_) {
+            const size_t idx = cache_index(row, col);
+            if (test_bit(int_bits_, idx)) {
+                const int32_t value = ints_[idx];
+                if (!std::in_range<T>(value)) { return false; }
+                out = static_cast<T>(value);
+                return true;
+            }
+            // Anything that isn't an int32_t may still be a valid uint32_t or int64_t
+            if (test_bit(null_bits_, idx) || std::is_same_v<T, int16_t> || std::is_same_v<T, int32_t>) {
+                return false;
+            }
+        }
+    }
+
     StringView res = get_internal(row, col);
     if (res == "****") return false;
 
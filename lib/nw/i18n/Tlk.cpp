@@ -146,7 +146,7 @@ void Tlk::refresh_elements() noexcept
 
     const size_t table_size = sizeof(TlkHeader) + sizeof(TlkElement) * static_cast<size_t>(header_.str_count);
     elements_ = bytes_.size() >= table_size
-        ? reinterpret_cast<TlkElement*>(bytes_.data() + sizeof(TlkHeader))
+        ? reinterpret_cast<const TlkElement*>(bytes_.data() + sizeof(TlkHeader))
         : nullptr;
 }
 
@@ -254,7 +254,7 @@ void Tlk::load()
         "strings corrupted");
     elements_ = header_.str_count == 0
         ? nullptr
-        : reinterpret_cast<TlkElement*>(bytes_.data() + sizeof(TlkHeader));
+        : reinterpret_cast<const TlkElement*>(bytes_.data() + sizeof(TlkHeader));
 
     loaded_ = true;
 
@@ -92,7 +92,7 @@ private:
     std::filesystem::path path_;
     ByteArray bytes_;
     TlkHeader header_;
-    TlkElement* elements_ = nullptr;
+    const TlkElement* elements_ = nullptr;
     std::map<uint32_t, String> modified_strings_;
 
     void load();
@@ -102,6 +102,11 @@ void Config::set_combat_policy_module(std::string module)
     options_.combat_policy_module = std::move(module);
 }
 
+void Config::set_area_load_mode(AreaLoadMode mode)
+{
+    options_.area_load_mode = mode;
+}
+
 void Config::set_init_module(std::string module)
 {
     options_.init_module = std::move(module);
@@ -6,10 +6,26 @@
 
 namespace nw {
 
+/// How ``Module::instantiate`` loads areas
+enum class AreaLoadMode : uint8_t {
+    serial,   ///< Load and instantiate areas one at a time
+    parallel, ///< Demand and parse areas on worker threads, deserialize and instantiate in order
+    lazy,     ///< Register areas, each is loaded on first ``Module::get_area``
+};
+
 /// Configuration options, maybe there will be an actual config file.. someday.
 struct ConfigOptions {
-    bool include_install = true; ///< Load Game install files
-    bool include_user = true;    ///< Load User files, note: if false, value overrides ``include_nwsync``
+    bool include_install = true;        ///< Load Game install files
+    bool include_user = true;           ///< Load User files, note: if false, value overrides ``include_nwsync``
+    bool memory_map_containers = false; ///< Map container files into memory, demanded resources borrow from the mapping
+    uint32_t zip_pooled_archives = 2;   ///< Idle archive handles kept open per zip container, at least 1
+    std::string registry_snapshot; ///< Path of the persisted resource registry snapshot, empty to disable
+    std::string twoda_sidecars;    ///< Directory of compiled 2da sidecars, empty to disable
+    std::string smalls_bytecode_cache; ///< Directory of compiled smalls modules, empty to disable
+    uint64_t smalls_coroutine_tick_budget = 0; ///< Gas of all smalls coroutines resumed on one tick, 0 for unlimited
+    AreaLoadMode area_load_mode = AreaLoadMode::serial;
+    uint32_t job_workers = 0; ///< Worker threads of the job system, 0 runs jobs inline on the calling thread
+    uint32_t ticks_per_second = 10; ///< Event ticks per game second, converts ``Effect::duration`` to ticks
     std::string profile = "nwn1";
     std::string combat_policy_module;
     std::string effects_policy_module;
@@ -48,6 +64,9 @@ struct Config {
     /// Sets combat policy module path
     void set_combat_policy_module(std::string module);
 
+    /// Sets how module areas are loaded
+    void set_area_load_mode(AreaLoadMode mode);
+
     /// Sets init module path
     void set_init_module(std::string module);
 
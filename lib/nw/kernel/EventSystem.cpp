@@ -5,52 +5,65 @@
 
 #include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <bit>
+
 namespace nw::kernel {
 
+namespace {
+
+uint64_t next_event_system_generation() noexcept
+{
+    static std::atomic<uint64_t> generation{0};
+    return ++generation;
+}
+
+} // namespace
+
 const std::type_index EventSystem::type_index{typeid(EventSystem)};
+size_t EventSystem::service_slot = Services::no_slot;
 
 EventSystem::EventSystem(MemoryResource* scope)
     : Service(scope)
+    , generation_(next_event_system_generation())
 {
 }
 
 EventSystem::~EventSystem()
 {
-    while (!queue_.empty()) {
-        const auto& ev = queue_.top();
-        if (ev.data && ev.data_deleter) {
-            ev.data_deleter(ev.data);
+    for (auto& node : nodes_) {
+        if (node.state != NodeState::free && !node.cancelled) {
+            release(node.event);
         }
-        queue_.pop();
     }
 }
 
-void EventSystem::add(EventType type, ObjectBase* object, void* data)
+EventId EventSystem::add(EventType type, ObjectBase* object, void* data)
 {
-    add(type, object ? object->handle() : ObjectHandle{}, data);
+    return add(type, object ? object->handle() : ObjectHandle{}, data);
 }
 
-void EventSystem::add(EventType type, ObjectHandle object, void* data)
+EventId EventSystem::add(EventType type, ObjectHandle object, void* data)
 {
-    add_at(type, object, current_tick_, data);
+    return add_at(type, object, current_tick_, data);
 }
 
-void EventSystem::add_in(EventType type, ObjectBase* object, uint64_t delay_ticks, void* data)
+EventId EventSystem::add_in(EventType type, ObjectBase* object, uint64_t delay_ticks, void* data)
 {
-    add_in(type, object ? object->handle() : ObjectHandle{}, delay_ticks, data);
+    return add_in(type, object ? object->handle() : ObjectHandle{}, delay_ticks, data);
 }
 
-void EventSystem::add_in(EventType type, ObjectHandle object, uint64_t delay_ticks, void* data)
+EventId EventSystem::add_in(EventType type, ObjectHandle object, uint64_t delay_ticks, void* data)
 {
-    add_at(type, object, current_tick_ + delay_ticks, data);
+    return add_at(type, object, current_tick_ + delay_ticks, data);
 }
 
-void EventSystem::add_at(EventType type, ObjectBase* object, uint64_t at_tick, void* data)
+EventId EventSystem::add_at(EventType type, ObjectBase* object, uint64_t at_tick, void* data)
 {
-    add_at(type, object ? object->handle() : ObjectHandle{}, at_tick, data);
+    return add_at(type, object ? object->handle() : ObjectHandle{}, at_tick, data);
 }
 
-void EventSystem::add_at(EventType type, ObjectHandle object, uint64_t at_tick, void* data)
+EventId EventSystem::add_at(EventType type, ObjectHandle object, uint64_t at_tick, void* data)
 {
     EventHandle ev;
     ev.tick = at_tick;
@@ -63,16 +76,16 @@ void EventSystem::add_at(EventType type, ObjectHandle object, uint64_t at_tick,
         ev.data_handle = eff->handle().runtime_handle;
     }
 
-    enqueue(std::move(ev));
+    return enqueue(std::move(ev));
 }
 
-void EventSystem::add_custom(ObjectBase* object, EventCallback callback, uint64_t delay_ticks, void* data,
+EventId EventSystem::add_custom(ObjectBase* object, EventCallback callback, uint64_t delay_ticks, void* data,
     EventDataDeleter data_deleter)
 {
-    add_custom(object ? object->handle() : ObjectHandle{}, callback, delay_ticks, data, data_deleter);
+    return add_custom(object ? object->handle() : ObjectHandle{}, callback, delay_ticks, data, data_deleter);
 }
 
-void EventSystem::add_custom(ObjectHandle object, EventCallback callback, uint64_t delay_ticks, void* data,
+EventId EventSystem::add_custom(ObjectHandle object, EventCallback callback, uint64_t delay_ticks, void* data,
     EventDataDeleter data_deleter)
 {
     EventHandle ev;
@@ -82,7 +95,7 @@ void EventSystem::add_custom(ObjectHandle object, EventCallback callback, uint64
     ev.data = data;
     ev.callback = callback;
     ev.data_deleter = data_deleter;
-    enqueue(std::move(ev));
+    return enqueue(std::move(ev));
 }
 
 uint64_t EventSystem::current_tick() const noexcept
@@ -93,6 +106,15 @@ uint64_t EventSystem::current_tick() const noexcept
 void EventSystem::set_current_tick(uint64_t tick) noexcept
 {
     current_tick_ = tick;
+
+    // With nothing scheduled the wheel can follow the clock anywhere, even backwards.
+    if (pending_ == 0) {
+        while (!overdue_.empty()) {
+            free_node(std::get<2>(overdue_.top()));
+            overdue_.pop();
+        }
+        wheel_tick_ = tick;
+    }
 }
 
 uint64_t EventSystem::advance(uint64_t ticks) noexcept
@@ -101,60 +123,260 @@ uint64_t EventSystem::advance(uint64_t ticks) noexcept
     return current_tick_;
 }
 
-void EventSystem::enqueue(EventHandle&& ev)
+bool EventSystem::cancel(EventId id)
 {
+    if (!is_pending(id)) { return false; }
+
+    Node& node = nodes_[id.index];
+    release(node.event);
+    if (node.state == NodeState::wheel) {
+        unlink(id.index);
+        free_node(id.index);
+    } else {
+        // Overdue and draining nodes are held by index elsewhere, they are freed when reached.
+        node.cancelled = true;
+    }
+    --pending_;
+    return true;
+}
+
+bool EventSystem::is_pending(EventId id) const noexcept
+{
+    if (id.index >= nodes_.size()) { return false; }
+    const Node& node = nodes_[id.index];
+    return node.generation == id.generation && node.state != NodeState::free && !node.cancelled;
+}
+
+EventId EventSystem::enqueue(EventHandle&& ev)
+{
+    const uint32_t index = allocate_node();
+    Node& node = nodes_[index];
     ev.sequence = next_sequence_++;
-    queue_.push(std::move(ev));
+    ev.id = EventId{index, node.generation};
+    node.event = std::move(ev);
+    link(index);
+    ++pending_;
+    return node.event.id;
 }
 
-int EventSystem::process()
+uint32_t EventSystem::allocate_node()
 {
-    int processed = 0;
-    while (!queue_.empty() && queue_.top().tick <= current_tick_) {
-        auto ev = queue_.top();
-        queue_.pop();
-
-        auto* object = ev.object == ObjectHandle{}
-            ? nullptr
-            : kernel::objects().get_object_base(ev.object);
-
-        switch (ev.type) {
-        case EventType::apply_effect: {
-            auto* eff = ev.data_handle.is_valid()
-                ? effects().get(ev.data_handle)
-                : reinterpret_cast<Effect*>(ev.data);
-            if (!eff) {
-                break;
-            }
+    if (free_head_ != no_node) {
+        const uint32_t index = free_head_;
+        free_head_ = nodes_[index].next;
+        nodes_[index].next = no_node;
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
 
-            if (!object || !effects().apply_to(object, eff)) {
-                effects().destroy(eff);
-            }
-        } break;
-        case EventType::remove_effect: {
-            auto* eff = ev.data_handle.is_valid()
-                ? effects().get(ev.data_handle)
-                : reinterpret_cast<Effect*>(ev.data);
-            if (!eff) {
-                break;
-            }
+void EventSystem::free_node(uint32_t index) noexcept
+{
+    Node& node = nodes_[index];
+    node.event = EventHandle{};
+    node.state = NodeState::free;
+    node.cancelled = false;
+    node.prev = no_node;
+    node.next = free_head_;
+    if (++node.generation == 0) { node.generation = 1; }
+    free_head_ = index;
+}
+
+void EventSystem::link(uint32_t index)
+{
+    Node& node = nodes_[index];
+    const uint64_t tick = node.event.tick;
+    if (tick < wheel_tick_) {
+        node.state = NodeState::overdue;
+        overdue_.emplace(tick, node.event.sequence, index);
+        return;
+    }
 
-            if (!object || effects().remove_from(object, eff)) {
-                effects().destroy(eff);
+    const uint64_t diff = tick ^ wheel_tick_;
+    const size_t level = diff == 0 ? 0 : (std::bit_width(diff) - 1) / 8;
+    const size_t slot = (tick >> (8 * level)) & (wheel_slots - 1);
+
+    Slot& bucket = slots_[level][slot];
+    node.state = NodeState::wheel;
+    node.level = static_cast<uint8_t>(level);
+    node.slot = static_cast<uint8_t>(slot);
+    node.prev = bucket.tail;
+    node.next = no_node;
+    if (bucket.tail != no_node) {
+        nodes_[bucket.tail].next = index;
+    } else {
+        bucket.head = index;
+        occupied_[level][slot / 64] |= uint64_t(1) << (slot % 64);
+    }
+    bucket.tail = index;
+    ++level_counts_[level];
+}
+
+void EventSystem::unlink(uint32_t index) noexcept
+{
+    Node& node = nodes_[index];
+    Slot& bucket = slots_[node.level][node.slot];
+    if (node.prev != no_node) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        bucket.head = node.next;
+    }
+    if (node.next != no_node) {
+        nodes_[node.next].prev = node.prev;
+    } else {
+        bucket.tail = node.prev;
+    }
+    if (bucket.head == no_node) {
+        occupied_[node.level][node.slot / 64] &= ~(uint64_t(1) << (node.slot % 64));
+    }
+    --level_counts_[node.level];
+    node.prev = node.next = no_node;
+}
+
+void EventSystem::detach(size_t level, size_t slot, Vector<uint32_t>& out) noexcept
+{
+    Slot& bucket = slots_[level][slot];
+    for (uint32_t index = bucket.head; index != no_node; index = nodes_[index].next) {
+        out.push_back(index);
+        --level_counts_[level];
+    }
+    bucket = Slot{};
+    occupied_[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+}
+
+int EventSystem::next_occupied(size_t level, size_t from) const noexcept
+{
+    for (size_t word = from / 64; word < occupied_[level].size(); ++word) {
+        uint64_t bits = occupied_[level][word];
+        if (word == from / 64) { bits &= ~uint64_t(0) << (from % 64); }
+        if (bits) { return static_cast<int>(word * 64 + std::countr_zero(bits)); }
+    }
+    return -1;
+}
+
+// Moves the wheel to the next slot holding events, cascading it down if needed.  Returns false, with the
+// wheel at the current tick, if nothing is due by then.
+bool EventSystem::advance_wheel()
+{
+    for (size_t level = 0; level < wheel_levels; ++level) {
+        const size_t digit = (wheel_tick_ >> (8 * level)) & (wheel_slots - 1);
+        if (digit + 1 >= wheel_slots) { continue; }
+        const int slot = next_occupied(level, digit + 1);
+        if (slot < 0) { continue; }
+
+        const uint64_t keep = level + 1 < wheel_levels ? ~uint64_t(0) << (8 * (level + 1)) : 0;
+        const uint64_t next = (wheel_tick_ & keep) | (uint64_t(slot) << (8 * level));
+        if (next > current_tick_) { break; }
+
+        wheel_tick_ = next;
+        if (level > 0) {
+            cascade_.clear();
+            detach(level, static_cast<size_t>(slot), cascade_);
+            for (uint32_t index : cascade_) {
+                link(index);
             }
-        } break;
-        case EventType::custom: {
-            if (ev.callback) {
-                ev.callback(ev);
+        }
+        return true;
+    }
+
+    wheel_tick_ = current_tick_;
+    return false;
+}
+
+bool EventSystem::collect_due(Vector<uint32_t>& batch)
+{
+    // Overdue events are older than anything on the wheel.
+    if (!overdue_.empty() && std::get<0>(overdue_.top()) <= current_tick_) {
+        const uint32_t index = std::get<2>(overdue_.top());
+        overdue_.pop();
+        nodes_[index].state = NodeState::draining;
+        batch.push_back(index);
+        return true;
+    }
+
+    if (current_tick_ < wheel_tick_) { return false; }
+
+    while (true) {
+        const size_t slot = wheel_tick_ & (wheel_slots - 1);
+        if (slots_[0][slot].head != no_node) {
+            detach(0, slot, batch);
+            for (uint32_t index : batch) {
+                nodes_[index].state = NodeState::draining;
             }
-        } break;
+            return true;
         }
+        if (!advance_wheel()) { return false; }
+    }
+}
 
-        if (ev.data && ev.data_deleter) {
-            ev.data_deleter(ev.data);
+void EventSystem::release(EventHandle& ev) noexcept
+{
+    if (ev.data && ev.data_deleter) {
+        ev.data_deleter(ev.data);
+    }
+    ev.data = nullptr;
+}
+
+void EventSystem::dispatch(const EventHandle& ev)
+{
+    auto* object = ev.object == ObjectHandle{}
+        ? nullptr
+        : kernel::objects().get_object_base(ev.object);
+
+    switch (ev.type) {
+    case EventType::apply_effect: {
+        auto* eff = ev.data_handle.is_valid()
+            ? effects().get(ev.data_handle)
+            : reinterpret_cast<Effect*>(ev.data);
+        if (!eff) {
+            break;
         }
 
-        ++processed;
+        if (!object || !effects().apply_to(object, eff)) {
+            effects().destroy(eff);
+        }
+    } break;
+    case EventType::remove_effect: {
+        auto* eff = ev.data_handle.is_valid()
+            ? effects().get(ev.data_handle)
+            : reinterpret_cast<Effect*>(ev.data);
+        if (!eff) {
+            break;
+        }
+
+        if (!object || effects().remove_from(object, eff)) {
+            effects().destroy(eff);
+        }
+    } break;
+    case EventType::custom: {
+        if (ev.callback) {
+            ev.callback(ev);
+        }
+    } break;
+    }
+}
+
+int EventSystem::process()
+{
+    int processed = 0;
+    Vector<uint32_t> batch;
+    while (collect_due(batch)) {
+        for (uint32_t index : batch) {
+            if (nodes_[index].cancelled) {
+                free_node(index);
+                continue;
+            }
+
+            // Copied out, callbacks may add events and grow the node table.
+            auto ev = std::move(nodes_[index].event);
+            free_node(index);
+            --pending_;
+            dispatch(ev);
+            release(ev);
+            ++processed;
+        }
+        batch.clear();
     }
     return processed;
 }
@@ -167,7 +389,23 @@ int EventSystem::process_until(uint64_t tick)
 
 size_t EventSystem::pending() const noexcept
 {
-    return queue_.size();
+    return pending_;
+}
+
+size_t EventSystem::pending(size_t level) const noexcept
+{
+    return level < wheel_levels ? level_counts_[level] : 0;
+}
+
+size_t EventSystem::occupied_slots() const noexcept
+{
+    size_t result = 0;
+    for (const auto& level : occupied_) {
+        for (uint64_t bits : level) {
+            result += static_cast<size_t>(std::popcount(bits));
+        }
+    }
+    return result;
 }
 
 nlohmann::json EventSystem::stats() const
@@ -175,10 +413,20 @@ nlohmann::json EventSystem::stats() const
     nlohmann::json j;
     j["events service"] = {
         {"current_tick", current_tick_},
-        {"pending", queue_.size()},
+        {"wheel_tick", wheel_tick_},
+        {"pending", pending_},
+        {"overdue", overdue_.size()},
+        {"occupied_slots", occupied_slots()},
+        {"nodes", nodes_.size()},
     };
-    if (!queue_.empty()) {
-        j["events service"]["next_due_tick"] = queue_.top().tick;
+
+    auto& levels = j["events service"]["levels"] = nlohmann::json::array();
+    for (size_t level = 0; level < wheel_levels; ++level) {
+        size_t slots = 0;
+        for (uint64_t bits : occupied_[level]) {
+            slots += static_cast<size_t>(std::popcount(bits));
+        }
+        levels.push_back({{"events", level_counts_[level]}, {"occupied_slots", slots}});
     }
     return j;
 }
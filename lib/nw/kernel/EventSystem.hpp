@@ -4,6 +4,8 @@
 #include "../util/HandlePool.hpp"
 #include "Kernel.hpp"
 
+#include <array>
+#include <limits>
 #include <queue>
 #include <tuple>
 
@@ -15,6 +17,15 @@ enum struct EventType {
     custom,
 };
 
+/// Stable handle of a scheduled event, see ``EventSystem::cancel``
+struct EventId {
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+
+    bool is_valid() const noexcept { return index != std::numeric_limits<uint32_t>::max(); }
+    bool operator==(const EventId&) const = default;
+};
+
 struct EventHandle;
 using EventCallback = void (*)(const EventHandle&);
 using EventDataDeleter = void (*)(void*);
@@ -28,6 +39,7 @@ struct EventHandle {
     void* data = nullptr;
     EventCallback callback = nullptr;
     EventDataDeleter data_deleter = nullptr;
+    EventId id;
 
     bool operator<(const EventHandle& rhs) const
     {
@@ -45,26 +57,41 @@ struct EventHandle {
     }
 };
 
+/// Schedules events by tick on a hierarchical timing wheel
+///
+/// Eight levels of 256 slots cover the whole tick range.  Level ``n`` buckets events by bits ``[8n, 8n + 8)``
+/// of their tick, an event sits on the lowest level at which its tick differs from the wheel's.  Adding and
+/// cancelling are O(1), processing skips empty slots by occupancy bitmaps, drains a due slot as one batch,
+/// and cascades a higher level slot down once the wheel reaches it.  Events due on the same tick run in the
+/// order they were added.  Events added for a tick the wheel already passed, e.g. after moving the current
+/// tick backwards, wait in a small ordered queue and run first.
 struct EventSystem : public Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
     EventSystem(MemoryResource* scope);
     ~EventSystem();
 
-    template <typename T>
-    using storage = std::priority_queue<T, Vector<T>, std::greater<T>>;
+    static constexpr size_t wheel_levels = 8;
+    static constexpr size_t wheel_slots = 256;
 
-    void add(EventType type, ObjectBase* object, void* data = nullptr);
-    void add(EventType type, ObjectHandle object, void* data = nullptr);
-    void add_in(EventType type, ObjectBase* object, uint64_t delay_ticks, void* data = nullptr);
-    void add_in(EventType type, ObjectHandle object, uint64_t delay_ticks, void* data = nullptr);
-    void add_at(EventType type, ObjectBase* object, uint64_t at_tick, void* data = nullptr);
-    void add_at(EventType type, ObjectHandle object, uint64_t at_tick, void* data = nullptr);
+    EventId add(EventType type, ObjectBase* object, void* data = nullptr);
+    EventId add(EventType type, ObjectHandle object, void* data = nullptr);
+    EventId add_in(EventType type, ObjectBase* object, uint64_t delay_ticks, void* data = nullptr);
+    EventId add_in(EventType type, ObjectHandle object, uint64_t delay_ticks, void* data = nullptr);
+    EventId add_at(EventType type, ObjectBase* object, uint64_t at_tick, void* data = nullptr);
+    EventId add_at(EventType type, ObjectHandle object, uint64_t at_tick, void* data = nullptr);
 
-    void add_custom(ObjectBase* object, EventCallback callback, uint64_t delay_ticks = 0, void* data = nullptr,
+    EventId add_custom(ObjectBase* object, EventCallback callback, uint64_t delay_ticks = 0, void* data = nullptr,
         EventDataDeleter data_deleter = nullptr);
-    void add_custom(ObjectHandle object, EventCallback callback, uint64_t delay_ticks = 0, void* data = nullptr,
+    EventId add_custom(ObjectHandle object, EventCallback callback, uint64_t delay_ticks = 0, void* data = nullptr,
         EventDataDeleter data_deleter = nullptr);
 
+    /// Cancels a pending event, its data is released by its deleter
+    bool cancel(EventId id);
+
+    /// Determines if an event is still waiting to be processed
+    bool is_pending(EventId id) const noexcept;
+
     uint64_t current_tick() const noexcept;
     void set_current_tick(uint64_t tick) noexcept;
     uint64_t advance(uint64_t ticks = 1) noexcept;
@@ -73,16 +100,73 @@ struct EventSystem : public Service {
     int process_until(uint64_t tick);
     size_t pending() const noexcept;
 
+    /// Gets the number of events pending on a wheel level
+    size_t pending(size_t level) const noexcept;
+
+    /// Gets the number of wheel slots holding at least one event
+    size_t occupied_slots() const noexcept;
+
+    /// Gets the generation of this event system
+    /// @note Generations are unique across event system instances, state tied to the events of one
+    /// instance can compare it rather than the instance's address.
+    uint64_t generation() const noexcept { return generation_; }
+
     /// Log service stats, if the service wants.
     virtual nlohmann::json stats() const override;
 
-    storage<EventHandle> queue_;
-
 private:
-    void enqueue(EventHandle&& ev);
+    static constexpr uint32_t no_node = std::numeric_limits<uint32_t>::max();
+
+    enum struct NodeState : uint8_t {
+        free,
+        wheel,
+        overdue,
+        draining,
+    };
+
+    struct Node {
+        EventHandle event;
+        uint32_t prev = no_node;
+        uint32_t next = no_node;
+        uint32_t generation = 1;
+        NodeState state = NodeState::free;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool cancelled = false;
+    };
+
+    struct Slot {
+        uint32_t head = no_node;
+        uint32_t tail = no_node;
+    };
+
+    using OverdueEntry = std::tuple<uint64_t, uint64_t, uint32_t>; // tick, sequence, node
+
+    EventId enqueue(EventHandle&& ev);
+    uint32_t allocate_node();
+    void free_node(uint32_t index) noexcept;
+    void link(uint32_t index);
+    void unlink(uint32_t index) noexcept;
+    void detach(size_t level, size_t slot, Vector<uint32_t>& out) noexcept;
+    int next_occupied(size_t level, size_t from) const noexcept;
+    bool collect_due(Vector<uint32_t>& batch);
+    bool advance_wheel();
+    void dispatch(const EventHandle& ev);
+    static void release(EventHandle& ev) noexcept;
+
+    Vector<Node> nodes_;
+    uint32_t free_head_ = no_node;
+    std::array<std::array<Slot, wheel_slots>, wheel_levels> slots_;
+    std::array<std::array<uint64_t, wheel_slots / 64>, wheel_levels> occupied_{};
+    std::array<size_t, wheel_levels> level_counts_{};
+    std::priority_queue<OverdueEntry, Vector<OverdueEntry>, std::greater<OverdueEntry>> overdue_;
+    Vector<uint32_t> cascade_;
+    size_t pending_ = 0;
 
     uint64_t current_tick_ = 0;
+    uint64_t wheel_tick_ = 0; ///< Tick the wheel has drained up to
     uint64_t next_sequence_ = 0;
+    uint64_t generation_ = 0;
 };
 
 inline EventSystem& events()
@@ -1,9 +1,15 @@
 #include "FactionSystem.hpp"
 
+#include "../objects/ObjectComponentSystem.hpp"
+#include "../objects/ObjectManager.hpp"
 #include "../resources/ResourceManager.hpp"
+#include "EventSystem.hpp"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <limits>
 
 using namespace std::literals;
@@ -11,6 +17,7 @@ using namespace std::literals;
 namespace nw::kernel {
 
 const std::type_index FactionSystem::type_index{typeid(FactionSystem)};
+size_t FactionSystem::service_slot = Services::no_slot;
 
 FactionSystem::FactionSystem(MemoryResource* scope)
     : Service(scope)
@@ -30,6 +37,18 @@ void FactionSystem::initialize(ServiceInitTime time)
     for (uint32_t i = 0; i < factions_->factions.size(); ++i) {
         name_id_map_.emplace(factions_->factions[i].name, i);
     }
+
+    const size_t n = factions_->factions.size();
+    feelings_.assign(n * n, no_reputation);
+    for (const auto& rep : factions_->reputations) {
+        if (rep.faction_1 >= n || rep.faction_2 >= n) {
+            LOG_F(WARNING, "[factions] reputation between unknown factions {} and {}", rep.faction_1, rep.faction_2);
+            continue;
+        }
+        feelings_[rep.faction_2 * n + rep.faction_1] = static_cast<uint8_t>(std::min(rep.reputation, 100u));
+    }
+    personal_.clear();
+    personal_count_ = 0;
 }
 
 Vector<String> FactionSystem::all() const
@@ -62,15 +81,12 @@ uint32_t FactionSystem::faction_id(StringView name) const
 Reputation FactionSystem::locate(uint32_t faction1, uint32_t faction2) const
 {
     Reputation result;
-    if (!factions_) { return result; }
+    const size_t n = count();
+    if (faction1 >= n || faction2 >= n) { return result; }
 
-    Reputation needle{faction1, faction2, 0};
-    auto it = std::lower_bound(std::begin(factions_->reputations), std::end(factions_->reputations), needle);
-    if (it == std::end(factions_->reputations)) {
-        return result;
-    }
-    if (it->faction_1 == faction1 && it->faction_2 == faction2) {
-        return *it;
+    const uint8_t value = feelings_[faction2 * n + faction1];
+    if (value != no_reputation) {
+        result = Reputation{faction1, faction2, value};
     }
     return result;
 }
@@ -88,10 +104,185 @@ uint32_t FactionSystem::reputation(uint32_t faction1, uint32_t faction2) const
     return rep.reputation;
 }
 
+int32_t FactionSystem::faction_reputation(uint32_t observer, uint32_t target) const noexcept
+{
+    const size_t n = feelings_.empty() ? 0 : count();
+    if (observer >= n || target >= n) { return neutral_reputation; }
+    const uint8_t value = feelings_[observer * n + target];
+    return value != no_reputation ? value : neutral_reputation;
+}
+
+// == Object Reputation =======================================================
+// ============================================================================
+
+size_t HostilityMask::count() const noexcept
+{
+    size_t result = 0;
+    for (uint64_t word : words) {
+        result += static_cast<size_t>(std::popcount(word));
+    }
+    return result;
+}
+
+uint32_t FactionSystem::faction_of(ObjectHandle obj) const
+{
+    const auto* spatial = objects().components().find_spatial(obj);
+    return spatial ? spatial->faction : std::numeric_limits<uint32_t>::max();
+}
+
+int32_t FactionSystem::personal_adjustment(const PersonalReputation& entry, uint64_t now) noexcept
+{
+    return entry.permanent + (now < entry.expires_at ? entry.temporary : 0);
+}
+
+int32_t FactionSystem::reputation(ObjectHandle observer, ObjectHandle target) const
+{
+    int32_t result = faction_reputation(faction_of(observer), faction_of(target));
+    if (auto it = personal_.find(observer.to_ull()); it != personal_.end()) {
+        if (auto entry = it->second.find(target.to_ull()); entry != it->second.end()) {
+            result += personal_adjustment(entry->second, events().current_tick());
+        }
+    }
+    return std::clamp(result, 0, 100);
+}
+
+HostilityMask FactionSystem::classify_hostility(ObjectHandle observer, std::span<const ObjectHandle> targets) const
+{
+    HostilityMask result;
+    result.size = targets.size();
+    result.words.assign((targets.size() + 63) / 64, 0);
+
+    const size_t n = feelings_.empty() ? 0 : count();
+    const uint32_t observer_faction = faction_of(observer);
+    const uint8_t* row = observer_faction < n ? &feelings_[observer_faction * n] : nullptr;
+
+    const PersonalTable* personal = nullptr;
+    if (auto it = personal_.find(observer.to_ull()); it != personal_.end() && !it->second.empty()) {
+        personal = &it->second;
+    }
+    const uint64_t now = personal ? events().current_tick() : 0;
+    const auto& components = objects().components();
+
+    // Reputations are gathered a block at a time so that the threshold test runs over a flat array
+    std::array<int32_t, 64> block;
+    for (size_t base = 0; base < targets.size(); base += 64) {
+        const size_t block_size = std::min<size_t>(64, targets.size() - base);
+        for (size_t i = 0; i < block_size; ++i) {
+            const auto* spatial = components.find_spatial(targets[base + i]);
+            const uint32_t target_faction = spatial ? spatial->faction : std::numeric_limits<uint32_t>::max();
+            const uint8_t value = row && target_faction < n ? row[target_faction] : no_reputation;
+            block[i] = value != no_reputation ? value : neutral_reputation;
+        }
+
+        if (personal) {
+            for (size_t i = 0; i < block_size; ++i) {
+                if (auto it = personal->find(targets[base + i].to_ull()); it != personal->end()) {
+                    block[i] += personal_adjustment(it->second, now);
+                }
+            }
+        }
+
+        uint64_t word = 0;
+        for (size_t i = 0; i < block_size; ++i) {
+            word |= uint64_t(block[i] <= hostile_threshold) << i;
+        }
+        result.words[base / 64] = word;
+    }
+
+    return result;
+}
+
+FactionSystem::PersonalReputation& FactionSystem::personal_entry(ObjectHandle observer, ObjectHandle target)
+{
+    if (personal_count_ >= next_prune_) {
+        prune_personal_reputation();
+        next_prune_ = std::max<size_t>(1024, personal_count_ * 2);
+    }
+
+    auto [it, inserted] = personal_[observer.to_ull()].try_emplace(target.to_ull());
+    if (inserted) { ++personal_count_; }
+    return it->second;
+}
+
+void FactionSystem::adjust_personal_reputation(ObjectHandle observer, ObjectHandle target, int32_t amount)
+{
+    personal_entry(observer, target).permanent += amount;
+}
+
+void FactionSystem::set_temporary_reputation(ObjectHandle observer, ObjectHandle target, int32_t amount,
+    uint64_t duration_ticks)
+{
+    auto& entry = personal_entry(observer, target);
+    entry.temporary = amount;
+    entry.expires_at = events().current_tick() + duration_ticks;
+}
+
+void FactionSystem::clear_personal_reputation(ObjectHandle observer)
+{
+    auto it = personal_.find(observer.to_ull());
+    if (it == personal_.end()) { return; }
+
+    personal_count_ -= it->second.size();
+    personal_.erase(it);
+}
+
+void FactionSystem::clear_personal_reputation(ObjectHandle observer, ObjectHandle target)
+{
+    auto it = personal_.find(observer.to_ull());
+    if (it == personal_.end()) { return; }
+
+    if (it->second.erase(target.to_ull())) {
+        --personal_count_;
+        if (it->second.empty()) { personal_.erase(it); }
+    }
+}
+
+size_t FactionSystem::prune_personal_reputation()
+{
+    const uint64_t now = events().current_tick();
+    auto& objs = objects();
+    size_t result = 0;
+
+    for (auto it = personal_.begin(); it != personal_.end();) {
+        auto& table = it->second;
+        if (!objs.get_object_base(ObjectHandle::from_ull(it->first))) {
+            result += table.size();
+            personal_.erase(it++);
+            continue;
+        }
+
+        for (auto entry = table.begin(); entry != table.end();) {
+            if (entry->second.temporary != 0 && now >= entry->second.expires_at) {
+                entry->second.temporary = 0;
+            }
+            if ((entry->second.permanent == 0 && entry->second.temporary == 0)
+                || !objs.get_object_base(ObjectHandle::from_ull(entry->first))) {
+                ++result;
+                table.erase(entry++);
+            } else {
+                ++entry;
+            }
+        }
+
+        if (table.empty()) {
+            personal_.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+
+    personal_count_ -= result;
+    return result;
+}
+
 nlohmann::json FactionSystem::stats() const
 {
     nlohmann::json j;
-    j["faction system"] = {};
+    j["faction system"] = {
+        {"factions", count()},
+        {"reputation_matrix_bytes", feelings_.size()},
+        {"personal_reputations", personal_count_},
+    };
     return j;
 }
 
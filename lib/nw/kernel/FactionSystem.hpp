@@ -1,15 +1,32 @@
+#pragma once
+
 #include "../formats/Faction.hpp"
 #include "../log.hpp"
+#include "../objects/ObjectHandle.hpp"
 #include "Kernel.hpp"
 
 #include <absl/container/flat_hash_map.h>
 
+#include <span>
 #include <string>
 
 namespace nw::kernel {
 
+/// Targets found hostile by ``FactionSystem::classify_hostility``, bit ``i`` is set if target ``i`` is
+struct HostilityMask {
+    Vector<uint64_t> words;
+    size_t size = 0;
+
+    /// Determines if target ``index`` is hostile
+    bool test(size_t index) const noexcept { return (words[index / 64] >> (index % 64)) & 1; }
+
+    /// Gets the number of hostile targets
+    size_t count() const noexcept;
+};
+
 struct FactionSystem : public Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     FactionSystem(MemoryResource* scope);
     virtual void initialize(ServiceInitTime time) override;
@@ -32,12 +49,68 @@ struct FactionSystem : public Service {
     /// Gets the reputation value between 2 factions
     uint32_t reputation(uint32_t faction1, uint32_t faction2) const;
 
+    // == Object Reputation ===================================================
+
+    /// Reputation at or below which an observer is hostile to a target
+    static constexpr int32_t hostile_threshold = 10;
+    /// Reputation at or above which an observer is friendly to a target
+    static constexpr int32_t friendly_threshold = 90;
+    /// Reputation when either faction is unknown or the faction file has no entry for the pair
+    static constexpr int32_t neutral_reputation = 50;
+
+    /// Gets the faction of an object, the faction tag of its spatial state
+    /// @note Creatures are tagged with their ``FactionID`` when instantiated
+    uint32_t faction_of(ObjectHandle obj) const;
+
+    /// Gets how much ``observer`` likes ``target``, 0 to 100
+    ///
+    /// Faction reputation, where ``FactionRep`` is how ``FactionID2`` feels about ``FactionID1``, plus
+    /// ``observer``'s personal reputation of ``target``.
+    int32_t reputation(ObjectHandle observer, ObjectHandle target) const;
+
+    /// Determines which of ``targets`` ``observer`` is hostile to
+    HostilityMask classify_hostility(ObjectHandle observer, std::span<const ObjectHandle> targets) const;
+
+    /// Adjusts ``observer``'s personal reputation of ``target`` permanently
+    void adjust_personal_reputation(ObjectHandle observer, ObjectHandle target, int32_t amount);
+
+    /// Sets ``observer``'s temporary personal reputation of ``target``, it decays after ``duration_ticks``
+    /// event ticks, replacing any earlier temporary adjustment
+    void set_temporary_reputation(ObjectHandle observer, ObjectHandle target, int32_t amount, uint64_t duration_ticks);
+
+    /// Clears ``observer``'s personal reputation of every object
+    void clear_personal_reputation(ObjectHandle observer);
+
+    /// Clears ``observer``'s personal reputation of ``target``
+    void clear_personal_reputation(ObjectHandle observer, ObjectHandle target);
+
+    /// Drops decayed temporary reputations and those of objects no longer alive, returns entries dropped
+    size_t prune_personal_reputation();
+
     /// Log service stats, if the service wants.
     virtual nlohmann::json stats() const override;
 
 private:
+    struct PersonalReputation {
+        int32_t permanent = 0;
+        int32_t temporary = 0;
+        uint64_t expires_at = 0; ///< Event tick the temporary adjustment decays at
+    };
+
+    using PersonalTable = absl::flat_hash_map<uint64_t, PersonalReputation>; ///< Target handle to reputation
+
+    static constexpr uint8_t no_reputation = 0xff;
+
     std::unique_ptr<Faction> factions_;
     absl::flat_hash_map<String, uint32_t> name_id_map_;
+    Vector<uint8_t> feelings_; ///< Dense matrix, ``feelings_[observer * count + target]``
+    absl::flat_hash_map<uint64_t, PersonalTable> personal_; ///< Observer handle to its personal reputations
+    size_t personal_count_ = 0;
+    size_t next_prune_ = 1024;
+
+    int32_t faction_reputation(uint32_t observer, uint32_t target) const noexcept;
+    PersonalReputation& personal_entry(ObjectHandle observer, ObjectHandle target);
+    static int32_t personal_adjustment(const PersonalReputation& entry, uint64_t now) noexcept;
 };
 
 inline FactionSystem& factions()
@@ -0,0 +1,352 @@
+#include "JobSystem.hpp"
+
+#include "../log.hpp"
+#include "../util/profile.hpp"
+#include "Config.hpp"
+#include "Memory.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <optional>
+#include <utility>
+
+namespace nw::kernel {
+
+namespace detail {
+
+struct JobWorker {
+    JobWorker(JobSystem* owner_, size_t index_)
+        : owner{owner_}
+        , index{index_}
+        , arena{MB(1)}
+    {
+    }
+
+    JobSystem* owner = nullptr;
+    size_t index = 0;
+    std::deque<Job> queue;
+    std::mutex mutex;
+    MemoryArena arena; ///< Scratch for jobs run on this worker, see ``JobSystem::scratch``
+    std::thread thread;
+};
+
+} // namespace detail
+
+namespace {
+
+thread_local detail::JobWorker* tls_worker_ = nullptr;
+thread_local MemoryScope* tls_job_scope_ = nullptr;
+
+} // namespace
+
+// == JobGroup ================================================================
+// ============================================================================
+
+JobGroup::~JobGroup()
+{
+    // The last job may still be releasing the lock after ``wait`` saw the group finish
+    std::lock_guard<std::mutex> lock(mutex_);
+}
+
+bool JobGroup::done() const noexcept
+{
+    return pending_.load(std::memory_order_acquire) == 0;
+}
+
+size_t JobGroup::pending() const noexcept
+{
+    return pending_.load(std::memory_order_acquire);
+}
+
+// == JobSystem ===============================================================
+// ============================================================================
+
+const std::type_index JobSystem::type_index{typeid(JobSystem)};
+size_t JobSystem::service_slot = Services::no_slot;
+
+JobSystem::JobSystem(MemoryResource* memory)
+    : JobSystem(memory, config().options().job_workers)
+{
+}
+
+JobSystem::JobSystem(MemoryResource* memory, size_t workers)
+    : Service(memory)
+    , main_thread_{std::this_thread::get_id()}
+{
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.push_back(std::make_unique<detail::JobWorker>(this, i));
+    }
+    // Every worker has to exist before any can steal
+    for (auto& worker : workers_) {
+        worker->thread = std::thread([this, w = worker.get()]() { work(w); });
+    }
+    if (workers) { LOG_F(INFO, "kernel: job system started {} workers", workers); }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+    workers_.clear();
+
+    if (is_main_thread()) {
+        run_main_thread_jobs();
+    } else if (main_queued_) {
+        LOG_F(WARNING, "kernel: job system destroyed with {} main thread jobs queued", main_queued_.load());
+    }
+}
+
+void JobSystem::execute(detail::Job& job)
+{
+    NW_PROFILE_SCOPE_N("kernel.jobs.execute");
+
+    std::exception_ptr error;
+    {
+        auto previous = tls_job_scope_;
+        std::optional<MemoryScope> scope;
+        if (tls_worker_ && tls_worker_->owner == this) {
+            scope.emplace(&tls_worker_->arena);
+            tls_job_scope_ = &*scope;
+        }
+        try {
+            job.fn();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        tls_job_scope_ = previous;
+    }
+    ++jobs_run_;
+    finish(job.group, error);
+}
+
+void JobSystem::finish(JobGroup* group, std::exception_ptr error)
+{
+    Vector<detail::Job> continuations;
+    {
+        std::lock_guard<std::mutex> lock(group->mutex_);
+        if (error && !group->error_) { group->error_ = error; }
+        if (group->pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) { return; }
+        continuations = std::move(group->continuations_);
+        group->continuations_.clear();
+    }
+
+    for (auto& job : continuations) {
+        submit(std::move(job));
+    }
+    notify(true);
+}
+
+bool JobSystem::is_main_thread() const noexcept
+{
+    return std::this_thread::get_id() == main_thread_;
+}
+
+void JobSystem::notify(bool all)
+{
+    // Waiters check their predicates under the lock, taking it here means none can miss the wake up
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    if (all) {
+        wake_.notify_all();
+    } else {
+        wake_.notify_one();
+    }
+}
+
+bool JobSystem::pop(detail::JobWorker* self, detail::Job& job)
+{
+    if (self) {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        if (!self->queue.empty()) {
+            job = std::move(self->queue.back());
+            self->queue.pop_back();
+            --queued_;
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex_);
+        if (!shared_.empty()) {
+            job = std::move(shared_.front());
+            shared_.pop_front();
+            --queued_;
+            return true;
+        }
+    }
+
+    const size_t start = self ? self->index + 1 : 0;
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        auto victim = workers_[(start + i) % workers_.size()].get();
+        if (victim == self) { continue; }
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->queue.empty()) {
+            job = std::move(victim->queue.front());
+            victim->queue.pop_front();
+            --queued_;
+            ++jobs_stolen_;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::pop_main(detail::Job& job)
+{
+    std::lock_guard<std::mutex> lock(main_mutex_);
+    if (main_jobs_.empty()) { return false; }
+    job = std::move(main_jobs_.front());
+    main_jobs_.pop_front();
+    --main_queued_;
+    return true;
+}
+
+void JobSystem::run(JobGroup& group, std::function<void()> job, JobAffinity affinity)
+{
+    group.pending_.fetch_add(1, std::memory_order_acq_rel);
+    submit(detail::Job{std::move(job), &group, affinity});
+}
+
+size_t JobSystem::run_main_thread_jobs()
+{
+    NW_PROFILE_SCOPE_N("kernel.jobs.main_thread");
+
+    if (!is_main_thread()) {
+        LOG_F(ERROR, "kernel: main thread jobs can only be run from the main thread");
+        return 0;
+    }
+
+    // Only what is queued now, jobs queued by these run next time
+    size_t result = 0;
+    detail::Job job;
+    for (size_t n = main_queued_.load(); n > 0 && pop_main(job); --n) {
+        ++main_jobs_run_;
+        execute(job);
+        ++result;
+    }
+    return result;
+}
+
+MemoryScope* JobSystem::scratch()
+{
+    return tls_job_scope_ ? tls_job_scope_ : tls_scratch();
+}
+
+void JobSystem::submit(detail::Job job)
+{
+    if (workers_.empty() && (job.affinity == JobAffinity::any || is_main_thread())) {
+        execute(job);
+        return;
+    }
+
+    if (job.affinity == JobAffinity::main_thread) {
+        {
+            std::lock_guard<std::mutex> lock(main_mutex_);
+            main_jobs_.push_back(std::move(job));
+        }
+        ++main_queued_;
+        notify(true);
+        return;
+    }
+
+    auto self = tls_worker_ && tls_worker_->owner == this ? tls_worker_ : nullptr;
+    if (self) {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        self->queue.push_back(std::move(job));
+    } else {
+        std::lock_guard<std::mutex> lock(shared_mutex_);
+        shared_.push_back(std::move(job));
+    }
+    ++queued_;
+    notify(false);
+}
+
+void JobSystem::then(JobGroup& group, JobGroup& next, std::function<void()> job, JobAffinity affinity)
+{
+    next.pending_.fetch_add(1, std::memory_order_acq_rel);
+    detail::Job continuation{std::move(job), &next, affinity};
+    {
+        std::lock_guard<std::mutex> lock(group.mutex_);
+        if (!group.done()) {
+            group.continuations_.push_back(std::move(continuation));
+            return;
+        }
+    }
+    submit(std::move(continuation));
+}
+
+bool JobSystem::try_run(detail::JobWorker* self, bool main)
+{
+    detail::Job job;
+    if (main && pop_main(job)) {
+        ++main_jobs_run_;
+        execute(job);
+        return true;
+    }
+    if (pop(self, job)) {
+        execute(job);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::wait(JobGroup& group)
+{
+    NW_PROFILE_SCOPE_N("kernel.jobs.wait");
+
+    const bool main = is_main_thread();
+    auto self = tls_worker_ && tls_worker_->owner == this ? tls_worker_ : nullptr;
+    while (!group.done()) {
+        if (try_run(self, main)) { continue; }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [&]() {
+            return group.done() || queued_ > 0 || (main && main_queued_ > 0);
+        });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(group.mutex_);
+        error = std::exchange(group.error_, nullptr);
+    }
+    if (error) { std::rethrow_exception(error); }
+}
+
+void JobSystem::work(detail::JobWorker* self)
+{
+    NW_PROFILE_THREAD_NAME("nw.jobs.worker");
+    tls_worker_ = self;
+
+    while (true) {
+        if (try_run(self, false)) { continue; }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        if (stopping_ && queued_ == 0) { break; }
+        wake_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+    }
+
+    tls_worker_ = nullptr;
+}
+
+size_t JobSystem::worker_count() const noexcept
+{
+    return workers_.size();
+}
+
+nlohmann::json JobSystem::stats() const
+{
+    nlohmann::json j;
+    j["job system service"] = {
+        {"workers", workers_.size()},
+        {"jobs_run", jobs_run_.load()},
+        {"jobs_stolen", jobs_stolen_.load()},
+        {"main_thread_jobs_run", main_jobs_run_.load()}};
+    return j;
+}
+
+} // namespace nw::kernel
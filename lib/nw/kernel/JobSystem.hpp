@@ -0,0 +1,204 @@
+#pragma once
+
+#include "../util/memory.hpp"
+#include "Kernel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+
+namespace nw::kernel {
+
+struct JobGroup;
+
+/// Where a job is allowed to run
+enum struct JobAffinity : uint8_t {
+    any,         ///< Any worker, or any thread waiting on a group
+    main_thread, ///< Only the thread that created the job system, e.g. jobs that touch ``ObjectManager``
+};
+
+namespace detail {
+
+struct Job {
+    std::function<void()> fn;
+    JobGroup* group = nullptr;
+    JobAffinity affinity = JobAffinity::any;
+};
+
+struct JobWorker;
+
+} // namespace detail
+
+/// A set of jobs that are waited on together, see ``JobSystem::run``
+/// @note A group must outlive its jobs and continuations, i.e. wait on it before it is destroyed.
+struct JobGroup {
+    JobGroup() = default;
+    JobGroup(const JobGroup&) = delete;
+    JobGroup(JobGroup&&) = delete;
+    ~JobGroup();
+
+    JobGroup& operator=(const JobGroup&) = delete;
+    JobGroup& operator=(JobGroup&&) = delete;
+
+    /// Determines if every job in the group has finished
+    bool done() const noexcept;
+
+    /// Number of jobs in the group that have not finished
+    size_t pending() const noexcept;
+
+private:
+    friend struct JobSystem;
+
+    std::atomic<size_t> pending_{0};
+    std::mutex mutex_;
+    Vector<detail::Job> continuations_;
+    std::exception_ptr error_;
+};
+
+/// Work-stealing thread pool
+///
+/// Every worker owns a queue, jobs queued from a worker go to its own queue and idle workers steal
+/// from the others.  Threads waiting on a group run queued jobs until the group is done.  If
+/// ``ConfigOptions::job_workers`` is 0, no threads are started and jobs run inline on the calling
+/// thread, in order.
+struct JobSystem : public Service {
+    const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
+
+    /// Constructs a job system with ``ConfigOptions::job_workers`` workers
+    JobSystem(MemoryResource* memory);
+    JobSystem(MemoryResource* memory, size_t workers);
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    ~JobSystem();
+
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    /// Determines if the calling thread is the thread that created the job system
+    bool is_main_thread() const noexcept;
+
+    /// Calls ``callback(i)`` for every ``i`` in [0, count), in chunks of at least ``grain``
+    /// @note The calling thread takes part, and returns once every call has finished.
+    template <typename Callback>
+    void parallel_for(size_t count, Callback&& callback, size_t grain = 1);
+
+    /// Calls ``callback(item)`` for every item in ``items``, in chunks of at least ``grain``
+    template <typename T, typename Callback>
+    void parallel_for(std::span<T> items, Callback&& callback, size_t grain = 1);
+
+    /// Queues ``job`` in ``group``
+    /// @note Without workers the job runs before returning, unless it has main thread affinity
+    /// and the caller is not the main thread.
+    void run(JobGroup& group, std::function<void()> job, JobAffinity affinity = JobAffinity::any);
+
+    /// Runs queued main thread jobs, returns the number run
+    /// @note Call from the main thread, e.g. once a tick.  ``wait`` also runs them on the main thread.
+    size_t run_main_thread_jobs();
+
+    /// Gets scratch memory for the running job
+    /// @note On workers each job gets its own scope that is rewound when the job finishes,
+    /// everywhere else this is ``tls_scratch()``.
+    static MemoryScope* scratch();
+
+    /// Queues ``job`` in ``next`` to run once every job in ``group`` has finished
+    /// @note If ``group`` is already done, the job is queued immediately.
+    void then(JobGroup& group, JobGroup& next, std::function<void()> job,
+        JobAffinity affinity = JobAffinity::any);
+
+    /// Waits for every job in ``group``, running queued jobs in the meantime
+    /// @note Rethrows the first exception thrown by a job in the group.
+    void wait(JobGroup& group);
+
+    /// Number of worker threads, 0 if jobs run inline
+    size_t worker_count() const noexcept;
+
+    nlohmann::json stats() const override;
+
+private:
+    Vector<std::unique_ptr<detail::JobWorker>> workers_;
+    std::deque<detail::Job> shared_; ///< Jobs queued from threads that are not workers
+    std::mutex shared_mutex_;
+    std::deque<detail::Job> main_jobs_;
+    std::mutex main_mutex_;
+    std::thread::id main_thread_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0};      ///< Jobs in ``shared_`` and worker queues
+    std::atomic<size_t> main_queued_{0}; ///< Jobs in ``main_jobs_``
+    bool stopping_ = false;
+
+    std::atomic<size_t> jobs_run_{0};
+    std::atomic<size_t> jobs_stolen_{0};
+    std::atomic<size_t> main_jobs_run_{0};
+
+    void execute(detail::Job& job);
+    void finish(JobGroup* group, std::exception_ptr error);
+    void notify(bool all);
+    bool pop(detail::JobWorker* self, detail::Job& job);
+    bool pop_main(detail::Job& job);
+    void submit(detail::Job job);
+    bool try_run(detail::JobWorker* self, bool main);
+    void work(detail::JobWorker* self);
+};
+
+template <typename Callback>
+void JobSystem::parallel_for(size_t count, Callback&& callback, size_t grain)
+{
+    if (count == 0) { return; }
+    grain = std::max<size_t>(grain, 1);
+    if (workers_.empty() || count <= grain) {
+        for (size_t i = 0; i < count; ++i) {
+            callback(i);
+        }
+        return;
+    }
+
+    // A few chunks per thread leaves room for stealing without a queued job per element
+    const size_t target = (workers_.size() + 1) * 4;
+    const size_t chunk = std::max(grain, (count + target - 1) / target);
+    JobGroup group;
+    for (size_t begin = chunk; begin < count; begin += chunk) {
+        const size_t end = std::min(begin + chunk, count);
+        run(group, [&callback, begin, end]() {
+            for (size_t i = begin; i < end; ++i) {
+                callback(i);
+            }
+        });
+    }
+    std::exception_ptr error;
+    try {
+        for (size_t i = 0; i < std::min(chunk, count); ++i) {
+            callback(i);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    wait(group);
+    if (error) { std::rethrow_exception(error); }
+}
+
+template <typename T, typename Callback>
+void JobSystem::parallel_for(std::span<T> items, Callback&& callback, size_t grain)
+{
+    parallel_for(items.size(), [&items, &callback](size_t i) { callback(items[i]); }, grain);
+}
+
+inline JobSystem& jobs()
+{
+    auto res = services().get_mut<JobSystem>();
+    if (!res) {
+        throw std::runtime_error("kernel: unable to load job system service");
+    }
+    return *res;
+}
+
+} // namespace nw::kernel
@@ -9,12 +9,14 @@
 #include "../util/string.hpp"
 #include "EventSystem.hpp"
 #include "FactionSystem.hpp"
+#include "JobSystem.hpp"
 #include "ModelCache.hpp"
 #include "Rules.hpp"
 #include "Strings.hpp"
 #include "TilesetRegistry.hpp"
 #include "TwoDACache.hpp"
 
+#include <atomic>
 #include <optional>
 #include <stdexcept>
 
@@ -27,6 +29,7 @@ namespace {
 const char* service_name(const ServiceEntry& entry)
 {
     if (entry.index == Strings::type_index) { return "strings"; }
+    if (entry.index == JobSystem::type_index) { return "jobs"; }
     if (entry.index == ResourceManager::type_index) { return "resources"; }
     if (entry.index == smalls::Runtime::type_index) { return "smalls.runtime"; }
     if (entry.index == TwoDACache::type_index) { return "twoda.cache"; }
@@ -148,6 +151,16 @@ MemoryResource* Service::allocator() const noexcept
     return memory_;
 }
 
+namespace detail {
+
+size_t next_service_slot() noexcept
+{
+    static std::atomic<size_t> s_next_slot{0};
+    return s_next_slot.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
 Services::Services()
     : kernel_arena_(MB(512))
     , kernel_scope_(&kernel_arena_)
@@ -234,7 +247,8 @@ void Services::shutdown()
     if (!serices_started_) { return; }
     LOG_F(INFO, "kernel: shutting down kernel services");
 
-    services_ = std::array<ServiceEntry, 32>{};
+    services_ = std::array<ServiceEntry, max_services>{};
+    slots_ = std::array<Service*, max_services>{};
     kernel_scope_.reset();
     if (!user_profile_) { profile_ = nullptr; }
     services_count_ = 0;
@@ -245,6 +259,15 @@ void Services::shutdown()
     mode_ = ServiceMode::game;
 }
 
+Service* Services::find(std::type_index index) const noexcept
+{
+    for (auto& s : services_) {
+        if (!s.service) { break; }
+        if (s.index == index) { return s.service; }
+    }
+    return nullptr;
+}
+
 uint64_t Services::generation() const noexcept
 {
     return generation_;
@@ -254,6 +277,7 @@ void Services::load_services()
 {
     // The ordering here is important.  Pretty much everything depends on strings and resman
     add<Strings>();
+    add<JobSystem>();
     add<ResourceManager>();
     add<smalls::Runtime>();
     if (mode_ == ServiceMode::language) {
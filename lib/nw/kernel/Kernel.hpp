@@ -9,6 +9,7 @@
 #include <array>
 #include <cstdint>
 #include <filesystem>
+#include <limits>
 #include <typeindex>
 
 namespace nw {
@@ -82,6 +83,13 @@ struct ServiceEntry {
     Service* service = nullptr;
 };
 
+/// @private
+namespace detail {
+/// Claims the next free service slot, called once per service type the first time it is added
+/// @note Slots are shared by all ``Services`` instances, a type keeps its slot across kernel restarts.
+size_t next_service_slot() noexcept;
+} // namespace detail
+
 struct Services {
     Services();
 
@@ -119,6 +127,21 @@ struct Services {
     template <typename T>
     T* get_mut();
 
+    /// Finds a service by type index
+    /// @note This is a linear search, prefer ``get`` or ``get_mut`` when the type is known.
+    Service* find(std::type_index index) const noexcept;
+
+    /// Maximum number of services
+    static constexpr size_t max_services = 32;
+
+    /// Slot of a service type that was never added
+    static constexpr size_t no_slot = std::numeric_limits<size_t>::max();
+
+    /// Gets the slot of a service type, assigned when the type is first added
+    /// @note Returns ``no_slot`` for a type that was never added, querying a type never claims a slot.
+    template <typename T>
+    static size_t slot() noexcept;
+
     friend GlobalMemory* global_allocator();
     friend void set_game_profile(GameProfile*);
     friend Module* load_module(const std::filesystem::path& path, bool instantiate, const ModuleLoadOptions& options);
@@ -126,7 +149,8 @@ struct Services {
     friend void unload_module();
 
 private:
-    std::array<ServiceEntry, 32> services_;
+    std::array<ServiceEntry, max_services> services_; ///< Services in the order they were added
+    std::array<Service*, max_services> slots_{};       ///< Services by ``slot<T>()``
     size_t services_count_ = 0;
     GameProfile* profile_ = nullptr;
     bool user_profile_ = false;
@@ -148,9 +172,14 @@ T* Services::add()
 {
     T* service = get_mut<T>();
     if (!service) {
+        // ``service_slot`` is defined next to the service, so the slot is the same in every shared library
+        if (T::service_slot == no_slot) { T::service_slot = detail::next_service_slot(); }
+        const size_t index = T::service_slot;
+        CHECK_F(services_count_ < max_services && index < max_services,
+            "Only {} total services are allowed", max_services);
         service = kernel_scope_.alloc_obj<T>(&kernel_scope_);
-        CHECK_F(services_count_ < 32, "Only 32 total services are allowed");
         services_[services_count_] = ServiceEntry{T::type_index, service};
+        slots_[index] = service;
         ++services_count_;
     }
     return service;
@@ -159,25 +188,21 @@ T* Services::add()
 template <typename T>
 const T* Services::get() const
 {
-    for (auto& s : services_) {
-        if (!s.service) { break; }
-        if (s.index == T::type_index) {
-            return static_cast<const T*>(s.service);
-        }
-    }
-    return nullptr;
+    const size_t index = slot<T>();
+    return index < max_services ? static_cast<const T*>(slots_[index]) : nullptr;
 }
 
 template <typename T>
 T* Services::get_mut()
 {
-    for (auto& s : services_) {
-        if (!s.service) { break; }
-        if (s.index == T::type_index) {
-            return static_cast<T*>(s.service);
-        }
-    }
-    return nullptr;
+    const size_t index = slot<T>();
+    return index < max_services ? static_cast<T*>(slots_[index]) : nullptr;
+}
+
+template <typename T>
+size_t Services::slot() noexcept
+{
+    return T::service_slot;
 }
 
 /// Gets configuration options
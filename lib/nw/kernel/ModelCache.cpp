@@ -9,6 +9,7 @@
 namespace nw::kernel {
 
 const std::type_index ModelCache::type_index{typeid(ModelCache)};
+size_t ModelCache::service_slot = Services::no_slot;
 
 ModelCache::ModelCache(MemoryResource* scope)
     : Service(scope)
@@ -17,6 +17,7 @@ struct ModelPayload {
 
 struct ModelCache : public Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     ModelCache(MemoryResource* scope);
     void clear();
@@ -12,6 +12,7 @@
 namespace nw::kernel {
 
 const std::type_index Rules::type_index{typeid(Rules)};
+size_t Rules::service_slot = Services::no_slot;
 
 Rules::Rules(MemoryResource* scope)
     : Service(scope)
@@ -21,6 +21,7 @@ namespace nw::kernel {
 
 struct Rules : public Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
     using QualifierMatcher = bool (*)(const Qualifier&, const ObjectBase*);
 
     Rules(MemoryResource* memory);
@@ -14,6 +14,7 @@ namespace fs = std::filesystem;
 namespace nw::kernel {
 
 const std::type_index Strings::type_index{typeid(Strings)};
+size_t Strings::service_slot = Services::no_slot;
 
 Strings::Strings(MemoryResource* memory)
     : Service(memory)
@@ -17,6 +17,7 @@ namespace nw::kernel {
 
 struct Strings : public Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     Strings(MemoryResource* memory);
     virtual ~Strings() = default;
@@ -9,6 +9,7 @@
 namespace nw::kernel {
 
 const std::type_index TilesetRegistry::type_index{typeid(TilesetRegistry)};
+size_t TilesetRegistry::service_slot = Services::no_slot;
 
 TilesetRegistry::TilesetRegistry(MemoryResource* memory)
     : Service(memory)
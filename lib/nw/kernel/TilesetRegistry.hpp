@@ -20,6 +20,7 @@ struct TilesetRegistryMetrics {
 
 struct TilesetRegistry : public Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     TilesetRegistry(MemoryResource* memory);
     void initialize(ServiceInitTime time) override;
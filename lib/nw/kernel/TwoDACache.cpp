@@ -4,9 +4,12 @@
 
 #include <nlohmann/json.hpp>
 
+#include <filesystem>
+
 namespace nw::kernel {
 
 const std::type_index TwoDACache::type_index{typeid(TwoDACache)};
+size_t TwoDACache::service_slot = Services::no_slot;
 
 TwoDACache::TwoDACache(MemoryResource* memory)
     : Service(memory)
@@ -33,7 +36,7 @@ const StaticTwoDA* TwoDACache::get(const Resource& tda)
     if (it != std::end(cached_2das_)) {
         return it->second.get();
     } else {
-        auto t = std::make_unique<StaticTwoDA>(kernel::resman().demand(tda));
+        auto t = load(tda);
         if (t->is_valid()) {
             cached_2das_[tda] = std::move(t);
             return cached_2das_[tda].get();
@@ -43,11 +46,40 @@ const StaticTwoDA* TwoDACache::get(const Resource& tda)
     return nullptr;
 }
 
+std::unique_ptr<StaticTwoDA> TwoDACache::load(const Resource& tda)
+{
+    auto data = kernel::resman().demand(tda);
+    const auto& sidecars = kernel::config().options().twoda_sidecars;
+    if (sidecars.empty() || data.bytes.size() == 0) {
+        auto result = std::make_unique<StaticTwoDA>(std::move(data));
+        result->compile();
+        return result;
+    }
+
+    // Sidecars are keyed by the hash of the source, an override of the same 2da is never stale.
+    const auto hash = StaticTwoDA::source_hash(data);
+    const auto path = std::filesystem::path{sidecars} / fmt::format("{}.2dac", tda.resref.view());
+    auto result = std::make_unique<StaticTwoDA>(StaticTwoDA::from_sidecar(path, tda, hash));
+    if (result->is_valid()) {
+        ++sidecar_hits_;
+        return result;
+    }
+
+    result = std::make_unique<StaticTwoDA>(std::move(data));
+    result->compile();
+    if (result->is_valid() && result->write_sidecar(path, hash)) {
+        ++sidecar_writes_;
+    }
+    return result;
+}
+
 nlohmann::json TwoDACache::stats() const
 {
     nlohmann::json j;
     j["twoda cache service"] = {
-        {"total_cached_twodas", cached_2das_.size()}};
+        {"total_cached_twodas", cached_2das_.size()},
+        {"sidecar_hits", sidecar_hits_},
+        {"sidecar_writes", sidecar_writes_}};
     return j;
 }
 
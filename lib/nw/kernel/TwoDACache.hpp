@@ -12,6 +12,7 @@ namespace nw::kernel {
 
 struct TwoDACache : public Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     TwoDACache(MemoryResource* memory);
     TwoDACache(const TwoDACache&) = delete;
@@ -26,12 +27,18 @@ struct TwoDACache : public Service {
     const StaticTwoDA* get(StringView tda);
 
     /// Gets a cached TwoDA
+    /// @note Cached 2das are compiled, and if ``ConfigOptions::twoda_sidecars`` is set, mapped from or
+    /// persisted to a sidecar.
     const StaticTwoDA* get(const nw::Resource& tda);
 
     nlohmann::json stats() const override;
 
 private:
     absl::flat_hash_map<Resource, std::unique_ptr<StaticTwoDA>> cached_2das_;
+    size_t sidecar_hits_ = 0;
+    size_t sidecar_writes_ = 0;
+
+    std::unique_ptr<StaticTwoDA> load(const Resource& tda);
 };
 
 inline TwoDACache& twodas()
@@ -378,7 +378,7 @@ Mdl::Mdl(ResourceData data)
     }
     if (data_.bytes[0] == 0) {
         try {
-            BinaryParser p{std::span<uint8_t>(data_.bytes.data(), data_.bytes.size()), this};
+            BinaryParser p{std::as_const(data_.bytes).span(), this};
             loaded_ = p.parse();
         } catch (std::exception& e) {
             LOG_F(ERROR, "failed to parse binary model <unknown>: {}", e.what());
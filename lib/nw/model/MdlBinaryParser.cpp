@@ -80,7 +80,7 @@ constexpr size_t max_binary_mdl_nodes = 65536;
 
 } // namespace detail
 
-BinaryParser::BinaryParser(std::span<uint8_t> bytes, Mdl* mdl)
+BinaryParser::BinaryParser(std::span<const uint8_t> bytes, Mdl* mdl)
     : mdl_{mdl}
     , bytes_{bytes}
 {
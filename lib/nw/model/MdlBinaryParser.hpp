@@ -315,7 +315,7 @@ struct Node;
 
 class BinaryParser {
     Mdl* mdl_;
-    std::span<uint8_t> bytes_;
+    std::span<const uint8_t> bytes_;
     detail::MdlBinaryHeader header;
 
     bool array_offset(const detail::MdlBinaryArray& array, size_t element_size, size_t* result) const;
@@ -329,7 +329,7 @@ class BinaryParser {
     bool parse_node(uint32_t offset, Geometry* geometry, Node* parent, size_t max_nodes, size_t depth);
 
 public:
-    BinaryParser(std::span<uint8_t> bytes, Mdl* mdl);
+    BinaryParser(std::span<const uint8_t> bytes, Mdl* mdl);
     bool parse();
 };
 
@@ -248,6 +248,19 @@ bool deserialize(AreaTile& self, const GffStruct& archive)
         && archive.get_to("Tile_SrcLight2", self.srclight2);
 }
 
+namespace {
+
+// Instances carry no area, tag them with the one they were loaded into so the area spatial index
+// picks them up.
+void place_in_area(const Area* area, const ObjectBase* obj)
+{
+    if (area->handle().id != object_invalid) {
+        nw::kernel::objects().components().set_area(obj->handle(), area->handle().id);
+    }
+}
+
+} // namespace
+
 bool deserialize(Area* obj, const GffStruct& are, const GffStruct& git, const GffStruct& gic)
 {
     if (!obj) {
@@ -273,6 +286,7 @@ bool deserialize(Area* obj, const GffStruct& are, const GffStruct& git, const Gf
                 if (i < comments.size()) {                             \
                     comments[i].get_to("Comment", o->comment, false);  \
                 }                                                      \
+                place_in_area(obj, o);                                 \
                 holder.push_back(o);                                   \
             } else {                                                   \
                 LOG_F(WARNING, "Something dreadfully wrong.");         \
@@ -349,6 +363,7 @@ bool deserialize(Area* obj, const nlohmann::json& are,
         for (size_t i = 0; i < sz; ++i) {                                \
             auto ob = nw::kernel::objects().load_instance<type>(arr[i]); \
             if (ob) {                                                    \
+                place_in_area(obj, ob);                                  \
                 obj->holder.push_back(ob);                               \
             } else {                                                     \
                 LOG_F(WARNING, "Something dreadfully wrong.");           \
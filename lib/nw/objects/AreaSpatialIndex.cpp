@@ -0,0 +1,235 @@
+#include "AreaSpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nw {
+
+namespace {
+
+// Keeps cell coordinates, and ring arithmetic on them, well inside int32_t.
+constexpr float max_cell_coord = float(1 << 29);
+
+float distance2(glm::vec3 a, glm::vec3 b) noexcept
+{
+    const glm::vec3 d = a - b;
+    return glm::dot(d, d);
+}
+
+} // namespace
+
+AreaSpatialIndex::AreaSpatialIndex(float cell_size)
+    : cell_size_{cell_size > 0.0f ? cell_size : default_cell_size}
+    , inverse_cell_size_{1.0f / cell_size_}
+{
+}
+
+template <typename Visitor>
+void AreaSpatialIndex::visit(CellCoord min, CellCoord max, Visitor&& visitor) const
+{
+    const int32_t x0 = std::max(min.x, min_cell_.x);
+    const int32_t y0 = std::max(min.y, min_cell_.y);
+    const int32_t x1 = std::min(max.x, max_cell_.x);
+    const int32_t y1 = std::min(max.y, max_cell_.y);
+    for (int32_t x = x0; x <= x1; ++x) {
+        for (int32_t y = y0; y <= y1; ++y) {
+            auto it = cells_.find(cell_key({x, y}));
+            if (it == cells_.end()) { continue; }
+            for (uint32_t index : it->second) {
+                visitor(entries_[index]);
+            }
+        }
+    }
+}
+
+void AreaSpatialIndex::update(ObjectHandle obj, glm::vec3 position, uint32_t faction)
+{
+    const CellCoord cell = cell_of(position);
+    const uint64_t key = cell_key(cell);
+
+    auto [it, inserted] = entry_index_.try_emplace(obj.to_ull(), static_cast<uint32_t>(entries_.size()));
+    if (inserted) {
+        entries_.push_back(Entry{obj, position, faction, key});
+        cells_[key].push_back(it->second);
+    } else {
+        Entry& entry = entries_[it->second];
+        entry.position = position;
+        entry.faction = faction;
+        if (entry.cell == key) { return; }
+        unlink(it->second, entry.cell);
+        entry.cell = key;
+        cells_[key].push_back(it->second);
+    }
+
+    if (max_cell_.x < min_cell_.x) {
+        min_cell_ = max_cell_ = cell;
+    } else {
+        min_cell_ = {std::min(min_cell_.x, cell.x), std::min(min_cell_.y, cell.y)};
+        max_cell_ = {std::max(max_cell_.x, cell.x), std::max(max_cell_.y, cell.y)};
+    }
+}
+
+bool AreaSpatialIndex::remove(ObjectHandle obj) noexcept
+{
+    auto it = entry_index_.find(obj.to_ull());
+    if (it == entry_index_.end()) { return false; }
+
+    const uint32_t index = it->second;
+    const uint32_t last = static_cast<uint32_t>(entries_.size() - 1);
+    entry_index_.erase(it);
+    unlink(index, entries_[index].cell);
+
+    if (index != last) {
+        // Move the last entry into the hole, its cell refers to it by index.
+        auto cell = cells_.find(entries_[last].cell);
+        if (cell != cells_.end()) { std::replace(cell->second.begin(), cell->second.end(), last, index); }
+        entries_[index] = entries_[last];
+        entry_index_.find(entries_[index].obj.to_ull())->second = index;
+    }
+    entries_.pop_back();
+    return true;
+}
+
+void AreaSpatialIndex::clear() noexcept
+{
+    entry_index_.clear();
+    entries_.clear();
+    cells_.clear();
+    min_cell_ = {0, 0};
+    max_cell_ = {-1, -1};
+}
+
+bool AreaSpatialIndex::contains(ObjectHandle obj) const noexcept
+{
+    return entry_index_.contains(obj.to_ull());
+}
+
+void AreaSpatialIndex::query_radius(glm::vec3 center, float radius, const SpatialFilter& filter,
+    Vector<ObjectHandle>& out) const
+{
+    if (!(radius >= 0.0f)) { return; }
+    const float radius2 = radius * radius;
+    const glm::vec3 extent{radius, radius, 0.0f};
+    visit(cell_of(center - extent), cell_of(center + extent), [&](const Entry& entry) {
+        if (matches(entry, filter) && distance2(entry.position, center) <= radius2) {
+            out.push_back(entry.obj);
+        }
+    });
+}
+
+void AreaSpatialIndex::query_box(glm::vec3 min, glm::vec3 max, const SpatialFilter& filter,
+    Vector<ObjectHandle>& out) const
+{
+    visit(cell_of(min), cell_of(max), [&](const Entry& entry) {
+        const glm::vec3& p = entry.position;
+        if (matches(entry, filter)
+            && p.x >= min.x && p.y >= min.y && p.z >= min.z
+            && p.x <= max.x && p.y <= max.y && p.z <= max.z) {
+            out.push_back(entry.obj);
+        }
+    });
+}
+
+void AreaSpatialIndex::query_cone(glm::vec3 apex, glm::vec3 direction, float half_angle, float range,
+    const SpatialFilter& filter, Vector<ObjectHandle>& out) const
+{
+    const float length = glm::length(direction);
+    if (!(range >= 0.0f) || !(length > 0.0f)) { return; }
+
+    const glm::vec3 axis = direction / length;
+    const float cos_half_angle = std::cos(std::clamp(half_angle, 0.0f, 3.14159265f));
+    const float range2 = range * range;
+    const glm::vec3 extent{range, range, 0.0f};
+    visit(cell_of(apex - extent), cell_of(apex + extent), [&](const Entry& entry) {
+        if (!matches(entry, filter)) { return; }
+        const glm::vec3 offset = entry.position - apex;
+        const float d2 = glm::dot(offset, offset);
+        if (d2 > range2) { return; }
+        if (d2 == 0.0f || glm::dot(offset, axis) >= cos_half_angle * std::sqrt(d2)) {
+            out.push_back(entry.obj);
+        }
+    });
+}
+
+void AreaSpatialIndex::query_nearest(glm::vec3 center, size_t count, const SpatialFilter& filter,
+    Vector<ObjectHandle>& out, float max_distance) const
+{
+    if (count == 0 || entries_.empty() || !(max_distance >= 0.0f)) { return; }
+
+    const float max_distance2 = max_distance < std::sqrt(std::numeric_limits<float>::max())
+        ? max_distance * max_distance
+        : std::numeric_limits<float>::max();
+    const CellCoord c = cell_of(center);
+    const int32_t max_ring = std::max({c.x - min_cell_.x, max_cell_.x - c.x, c.y - min_cell_.y, max_cell_.y - c.y, 0});
+
+    Vector<std::pair<float, ObjectHandle>> candidates;
+    const auto collect = [&](const Entry& entry) {
+        if (!matches(entry, filter)) { return; }
+        const float d2 = distance2(entry.position, center);
+        if (d2 <= max_distance2) { candidates.emplace_back(d2, entry.obj); }
+    };
+    const auto by_distance = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+
+    for (int32_t ring = 0; ring <= max_ring; ++ring) {
+        if (ring == 0) {
+            visit(c, c, collect);
+        } else {
+            visit({c.x - ring, c.y - ring}, {c.x + ring, c.y - ring}, collect);
+            visit({c.x - ring, c.y + ring}, {c.x + ring, c.y + ring}, collect);
+            visit({c.x - ring, c.y - ring + 1}, {c.x - ring, c.y + ring - 1}, collect);
+            visit({c.x + ring, c.y - ring + 1}, {c.x + ring, c.y + ring - 1}, collect);
+        }
+
+        // Nothing in ring ``ring + 1`` or beyond is closer than ``ring`` cells.
+        const float reach = float(ring) * cell_size_;
+        if (reach * reach > max_distance2) { break; }
+        if (candidates.size() >= count) {
+            std::nth_element(candidates.begin(), candidates.begin() + (count - 1), candidates.end(), by_distance);
+            if (candidates[count - 1].first <= reach * reach) { break; }
+        }
+    }
+
+    const size_t n = std::min(count, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end(), by_distance);
+    for (size_t i = 0; i < n; ++i) {
+        out.push_back(candidates[i].second);
+    }
+}
+
+AreaSpatialIndex::CellCoord AreaSpatialIndex::cell_of(glm::vec3 position) const noexcept
+{
+    const auto coord = [this](float value) {
+        const float scaled = std::floor(value * inverse_cell_size_);
+        if (std::isnan(scaled)) { return int32_t(0); }
+        return static_cast<int32_t>(std::clamp(scaled, -max_cell_coord, max_cell_coord));
+    };
+    return {coord(position.x), coord(position.y)};
+}
+
+uint64_t AreaSpatialIndex::cell_key(CellCoord cell) noexcept
+{
+    return (uint64_t(uint32_t(cell.x)) << 32) | uint32_t(cell.y);
+}
+
+bool AreaSpatialIndex::matches(const Entry& entry, const SpatialFilter& filter) noexcept
+{
+    const auto type = static_cast<uint32_t>(entry.obj.type);
+    return (type < 32 && (filter.types >> type) & 1)
+        && (filter.faction == SpatialFilter::any_faction || filter.faction == entry.faction)
+        && entry.obj != filter.exclude;
+}
+
+void AreaSpatialIndex::unlink(uint32_t index, uint64_t cell) noexcept
+{
+    auto it = cells_.find(cell);
+    if (it == cells_.end()) { return; }
+    auto& entries = it->second;
+    auto pos = std::find(entries.begin(), entries.end(), index);
+    if (pos != entries.end()) {
+        *pos = entries.back();
+        entries.pop_back();
+    }
+    if (entries.empty()) { cells_.erase(it); }
+}
+
+} // namespace nw
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../config.hpp"
+#include "ObjectHandle.hpp"
+
+#include <absl/container/flat_hash_map.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+
+namespace nw {
+
+/// Filters objects returned by ``AreaSpatialIndex`` queries
+struct SpatialFilter {
+    static constexpr uint32_t all_types = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t any_faction = std::numeric_limits<uint32_t>::max();
+
+    uint32_t types = all_types;      ///< Mask of ``type_bit`` values
+    uint32_t faction = any_faction;  ///< Faction tag an object must carry
+    ObjectHandle exclude{};          ///< Object never returned, e.g. the one asking
+
+    /// Gets the ``types`` bit of an object type
+    static constexpr uint32_t type_bit(ObjectType type) noexcept
+    {
+        return 1u << static_cast<uint32_t>(type);
+    }
+};
+
+/// Uniform grid over the objects of one area
+///
+/// Objects are bucketed by their x/y position into square cells, queries only visit the cells a
+/// shape overlaps.  Distances are measured in three dimensions.  The index is maintained by
+/// ``ObjectComponentSystem`` as spatial state changes, see ``ObjectComponentSystem::area_spatial_index``.
+struct AreaSpatialIndex {
+    /// Cell size in meters, the size of a tile
+    static constexpr float default_cell_size = 10.0f;
+
+    explicit AreaSpatialIndex(float cell_size = default_cell_size);
+
+    /// Inserts an object, or moves it if already present
+    void update(ObjectHandle obj, glm::vec3 position, uint32_t faction);
+
+    /// Removes an object
+    bool remove(ObjectHandle obj) noexcept;
+
+    /// Removes all objects
+    void clear() noexcept;
+
+    /// Determines if an object is indexed
+    bool contains(ObjectHandle obj) const noexcept;
+
+    /// Gets the number of indexed objects
+    size_t size() const noexcept { return entries_.size(); }
+
+    /// Appends objects within ``radius`` of ``center``, in no particular order
+    void query_radius(glm::vec3 center, float radius, const SpatialFilter& filter, Vector<ObjectHandle>& out) const;
+
+    /// Appends objects within the axis aligned box ``[min, max]``, in no particular order
+    void query_box(glm::vec3 min, glm::vec3 max, const SpatialFilter& filter, Vector<ObjectHandle>& out) const;
+
+    /// Appends objects within ``range`` of ``apex`` and ``half_angle`` radians of ``direction``, in no
+    /// particular order
+    void query_cone(glm::vec3 apex, glm::vec3 direction, float half_angle, float range,
+        const SpatialFilter& filter, Vector<ObjectHandle>& out) const;
+
+    /// Appends up to ``count`` objects nearest to ``center``, nearest first
+    void query_nearest(glm::vec3 center, size_t count, const SpatialFilter& filter, Vector<ObjectHandle>& out,
+        float max_distance = std::numeric_limits<float>::max()) const;
+
+private:
+    struct Entry {
+        ObjectHandle obj;
+        glm::vec3 position;
+        uint32_t faction;
+        uint64_t cell;
+    };
+
+    struct CellCoord {
+        int32_t x;
+        int32_t y;
+    };
+
+    float cell_size_;
+    float inverse_cell_size_;
+    absl::flat_hash_map<uint64_t, uint32_t> entry_index_; ///< Handle to entry
+    Vector<Entry> entries_;
+    absl::flat_hash_map<uint64_t, Vector<uint32_t>> cells_; ///< Cell key to entries
+    CellCoord min_cell_{0, 0};                              ///< Bounds of every cell ever occupied
+    CellCoord max_cell_{-1, -1};
+
+    CellCoord cell_of(glm::vec3 position) const noexcept;
+    static uint64_t cell_key(CellCoord cell) noexcept;
+    static bool matches(const Entry& entry, const SpatialFilter& filter) noexcept;
+    void unlink(uint32_t index, uint64_t cell) noexcept;
+
+    /// Calls ``visitor(entry)`` for every entry in cells overlapping ``[min, max]``
+    template <typename Visitor>
+    void visit(CellCoord min, CellCoord max, Visitor&& visitor) const;
+};
+
+} // namespace nw
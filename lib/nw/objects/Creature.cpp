@@ -155,6 +155,9 @@ bool deserialize(Creature* obj, const GffStruct& archive, SerializationProfile p
     }
 
     nwn1::import_creature_propsets_from_gff(&nw::kernel::runtime(), obj, archive, profile);
+    if (profile == SerializationProfile::savegame) {
+        nw::kernel::effects().deserialize_effects(obj, archive);
+    }
 
     return true;
 }
@@ -175,6 +178,9 @@ bool serialize(const Creature* obj, GffBuilderStruct& archive, SerializationProf
     if (!nwn1::export_inventory_component_to_gff(*obj, archive, profile)) { return false; }
 
     nwn1::export_creature_propsets_to_gff(&kernel::runtime(), obj, archive, profile);
+    if (profile == SerializationProfile::savegame) {
+        nw::kernel::effects().serialize_effects(obj, archive);
+    }
 
     nwn1::export_creature_legacy_gff_fields(archive);
 
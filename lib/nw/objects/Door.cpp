@@ -75,6 +75,9 @@ bool deserialize(Door* obj, const GffStruct& archive, SerializationProfile profi
     nw::kernel::objects().components().deserialize_locals(obj->handle(), archive);
 
     nwn1::import_door_propsets_from_gff(&nw::kernel::runtime(), obj, archive, profile);
+    if (profile == SerializationProfile::savegame) {
+        nw::kernel::effects().deserialize_effects(obj, archive);
+    }
     return true;
 }
 
@@ -92,6 +95,9 @@ bool serialize(const Door* obj, GffBuilderStruct& archive, SerializationProfile
     nw::kernel::objects().components().serialize_locals(obj->handle(), archive, profile);
 
     nwn1::export_door_propsets_to_gff(&kernel::runtime(), obj, archive, profile);
+    if (profile == SerializationProfile::savegame) {
+        nw::kernel::effects().serialize_effects(obj, archive);
+    }
 
     return true;
 }
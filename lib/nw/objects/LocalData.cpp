@@ -1,241 +1,268 @@
 #include "LocalData.hpp"
 
 #include "../kernel/Memory.hpp"
+#include "../kernel/Strings.hpp"
 #include "../serialization/Gff.hpp"
 #include "../serialization/GffBuilder.hpp"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+
 namespace nw {
 
-void LocalData::clear(StringView var, uint32_t type)
-{
-    auto it = vars_.find(var);
-    if (it == std::end(vars_)) {
-        return;
-    }
+namespace {
 
-    switch (type) {
-    default:
-        LOG_F(ERROR, "local data invalid local var type: {}", type);
-    case 1: // int
-        it->second.integer = 0;
-        it->second.flags.reset(LocalVarType::integer);
-        break;
-    case 2: // float
-        it->second.float_ = 0.0;
-        it->second.flags.reset(LocalVarType::float_);
-        break;
-    case 3: // string
-        it->second.string = "";
-        it->second.flags.reset(LocalVarType::string);
-        break;
-    case 4: // object
-        it->second.object = object_invalid;
-        it->second.flags.reset(LocalVarType::object);
-        break;
-    case 5: // location
-        it->second.loc = Location{};
-        it->second.flags.reset(LocalVarType::location);
-        break;
-    }
-    if (it->second.flags.none()) { vars_.erase(it); }
+// The kernel does not intern the empty string, which is still a valid variable name
+const String empty_local_name;
+
+template <typename T>
+size_t table_bytes(const absl::flat_hash_map<LocalKey, T>& table) noexcept
+{
+    // One control byte per slot
+    return table.capacity() * (sizeof(std::pair<const LocalKey, T>) + 1);
 }
 
-void LocalData::clear_all(uint32_t type)
+} // namespace
+
+// == LocalKey ================================================================
+// ============================================================================
+
+LocalKey::LocalKey(StringView name)
+    : name_{name.empty() ? InternedString{&empty_local_name} : kernel::strings().intern(name)}
 {
+}
 
-    if (type == LocalVarType::invalid) {
-        vars_.clear();
-        return;
-    }
+LocalKey LocalKey::find(StringView name)
+{
+    LocalKey result;
+    result.name_ = name.empty() ? InternedString{&empty_local_name} : kernel::strings().get_interned(name);
+    return result;
+}
 
-    static Vector<StringView> eraser{};
+// == LocalData ===============================================================
+// ============================================================================
 
-    for (auto& [k, v] : vars_) {
+Vector<std::pair<StringView, LocalVar>> LocalData::entries() const
+{
+    Vector<std::pair<StringView, LocalVar>> result;
+    for (const auto& [key, type] : sorted_keys(true)) {
+        if (result.empty() || result.back().first.data() != key.name().data()) {
+            result.emplace_back(key.name(), LocalVar{});
+        }
+        auto& var = result.back().second;
         switch (type) {
-        default:
-            LOG_F(ERROR, "local data invalid local var type: {}", type);
-        case 1: // int
-            v.integer = 0;
-            v.flags.reset(LocalVarType::integer);
+        case LocalVarType::integer:
+            var.integer = ints_.at(key);
             break;
-        case 2: // float
-            v.float_ = 0.0;
-            v.flags.reset(LocalVarType::float_);
+        case LocalVarType::float_:
+            var.float_ = floats_.at(key);
             break;
-        case 3: // string
-            v.string = "";
-            v.flags.reset(LocalVarType::string);
+        case LocalVarType::string:
+            var.string = strings_.at(key);
             break;
-        case 4: // object
-            v.object = object_invalid;
-            v.flags.reset(LocalVarType::object);
+        case LocalVarType::object:
+            var.object = objects_.at(key);
             break;
-        case 5: // location
-            v.loc = Location{};
-            v.flags.reset(LocalVarType::location);
+        case LocalVarType::location:
+            var.loc = locations_.at(key);
             break;
         }
-        if (v.flags.none()) { eraser.push_back(k); }
-    }
-
-    for (const auto& e : eraser) {
-        vars_.erase(e);
+        var.flags.set(type);
     }
-    eraser.clear();
+    return result;
 }
 
-void LocalData::delete_float(StringView var)
+bool LocalData::contains(StringView var, uint32_t type) const
 {
-    auto it = vars_.find(var);
-    if (it == std::end(vars_)) {
-        return;
-    }
-    it->second.float_ = 0.0;
-    it->second.flags.reset(LocalVarType::float_);
-    if (it->second.flags.none()) { vars_.erase(it); }
+    return contains(LocalKey::find(var), type);
 }
 
-void LocalData::delete_int(StringView var)
+bool LocalData::contains(LocalKey var, uint32_t type) const
 {
-    auto it = vars_.find(var);
-    if (it == std::end(vars_)) {
-        return;
+    switch (type) {
+    default:
+        return false;
+    case LocalVarType::integer:
+        return ints_.contains(var);
+    case LocalVarType::float_:
+        return floats_.contains(var);
+    case LocalVarType::string:
+        return strings_.contains(var);
+    case LocalVarType::object:
+        return objects_.contains(var);
+    case LocalVarType::location:
+        return locations_.contains(var);
     }
-    it->second.integer = 0;
-    it->second.flags.reset(LocalVarType::integer);
-    if (it->second.flags.none()) { vars_.erase(it); }
 }
 
-void LocalData::delete_object(StringView var)
+void LocalData::clear(StringView var, uint32_t type)
 {
-    auto it = vars_.find(var);
-    if (it == std::end(vars_)) {
-        return;
-    }
-    it->second.object = object_invalid;
-    it->second.flags.reset(LocalVarType::object);
-    if (it->second.flags.none()) { vars_.erase(it); }
+    clear(LocalKey::find(var), type);
 }
 
-void LocalData::delete_string(StringView var)
+void LocalData::clear(LocalKey var, uint32_t type)
 {
-    auto it = vars_.find(var);
-    if (it == std::end(vars_)) {
-        return;
+    switch (type) {
+    default:
+        LOG_F(ERROR, "local data invalid local var type: {}", type);
+        break;
+    case LocalVarType::integer:
+        ints_.erase(var);
+        break;
+    case LocalVarType::float_:
+        floats_.erase(var);
+        break;
+    case LocalVarType::string:
+        strings_.erase(var);
+        break;
+    case LocalVarType::object:
+        objects_.erase(var);
+        break;
+    case LocalVarType::location:
+        locations_.erase(var);
+        break;
     }
-    it->second.string = {};
-    it->second.flags.reset(LocalVarType::string);
-    if (it->second.flags.none()) { vars_.erase(it); }
 }
 
-void LocalData::delete_location(StringView var)
+void LocalData::clear_all(uint32_t type)
 {
-    auto it = vars_.find(var);
-    if (it == std::end(vars_)) {
-        return;
+    switch (type) {
+    default:
+        LOG_F(ERROR, "local data invalid local var type: {}", type);
+        break;
+    case LocalVarType::invalid:
+        ints_.clear();
+        floats_.clear();
+        strings_.clear();
+        objects_.clear();
+        locations_.clear();
+        break;
+    case LocalVarType::integer:
+        ints_.clear();
+        break;
+    case LocalVarType::float_:
+        floats_.clear();
+        break;
+    case LocalVarType::string:
+        strings_.clear();
+        break;
+    case LocalVarType::object:
+        objects_.clear();
+        break;
+    case LocalVarType::location:
+        locations_.clear();
+        break;
     }
-    it->second.loc = nw::Location();
-    it->second.flags.reset(LocalVarType::location);
-    if (it->second.flags.none()) { vars_.erase(it); }
 }
 
-float LocalData::get_float(StringView var) const
+void LocalData::delete_float(StringView var) { floats_.erase(LocalKey::find(var)); }
+void LocalData::delete_int(StringView var) { ints_.erase(LocalKey::find(var)); }
+void LocalData::delete_object(StringView var) { objects_.erase(LocalKey::find(var)); }
+void LocalData::delete_string(StringView var) { strings_.erase(LocalKey::find(var)); }
+void LocalData::delete_location(StringView var) { locations_.erase(LocalKey::find(var)); }
+
+void LocalData::delete_float(LocalKey var) { floats_.erase(var); }
+void LocalData::delete_int(LocalKey var) { ints_.erase(var); }
+void LocalData::delete_object(LocalKey var) { objects_.erase(var); }
+void LocalData::delete_string(LocalKey var) { strings_.erase(var); }
+void LocalData::delete_location(LocalKey var) { locations_.erase(var); }
+
+float LocalData::get_float(StringView var) const { return get_float(LocalKey::find(var)); }
+int32_t LocalData::get_int(StringView var) const { return get_int(LocalKey::find(var)); }
+ObjectID LocalData::get_object(StringView var) const { return get_object(LocalKey::find(var)); }
+String LocalData::get_string(StringView var) const { return String{get_string(LocalKey::find(var))}; }
+Location LocalData::get_location(StringView var) const { return get_location(LocalKey::find(var)); }
+
+float LocalData::get_float(LocalKey var) const
 {
-    auto it = vars_.find(var);
-    return it != vars_.end() ? it->second.float_ : 0.0f;
+    auto it = floats_.find(var);
+    return it != floats_.end() ? it->second : 0.0f;
 }
 
-int32_t LocalData::get_int(StringView var) const
+int32_t LocalData::get_int(LocalKey var) const
 {
-    auto it = vars_.find(var);
-    return it != vars_.end() ? it->second.integer : 0;
+    auto it = ints_.find(var);
+    return it != ints_.end() ? it->second : 0;
 }
 
-ObjectID LocalData::get_object(StringView var) const
+ObjectID LocalData::get_object(LocalKey var) const
 {
-    auto it = vars_.find(var);
-    return it != vars_.end() ? it->second.object : object_invalid;
+    auto it = objects_.find(var);
+    return it != objects_.end() ? it->second : object_invalid;
 }
 
-String LocalData::get_string(StringView var) const
+StringView LocalData::get_string(LocalKey var) const
 {
-    auto it = vars_.find(var);
-    return it != vars_.end() ? it->second.string : String{};
+    auto it = strings_.find(var);
+    return it != strings_.end() ? StringView{it->second} : StringView{};
 }
 
-Location LocalData::get_location(StringView var) const
+Location LocalData::get_location(LocalKey var) const
 {
-    auto it = vars_.find(var);
-    return it != vars_.end() ? it->second.loc : Location{};
+    auto it = locations_.find(var);
+    return it != locations_.end() ? it->second : Location{};
 }
 
-void LocalData::set_float(StringView var, float value)
-{
-    auto& payload = vars_[var];
-    payload.float_ = value;
-    payload.flags.set(LocalVarType::float_);
-}
+void LocalData::set_float(StringView var, float value) { set_float(LocalKey{var}, value); }
+void LocalData::set_int(StringView var, int32_t value) { set_int(LocalKey{var}, value); }
+void LocalData::set_object(StringView var, ObjectID value) { set_object(LocalKey{var}, value); }
+void LocalData::set_string(StringView var, StringView value) { set_string(LocalKey{var}, value); }
+void LocalData::set_location(StringView var, Location value) { set_location(LocalKey{var}, value); }
 
-void LocalData::set_int(StringView var, int32_t value)
-{
-    auto& payload = vars_[var];
-    payload.integer = value;
-    payload.flags.set(LocalVarType::integer);
-}
+void LocalData::set_float(LocalKey var, float value) { floats_[var] = value; }
+void LocalData::set_int(LocalKey var, int32_t value) { ints_[var] = value; }
+void LocalData::set_object(LocalKey var, ObjectID value) { objects_[var] = value; }
+void LocalData::set_location(LocalKey var, Location value) { locations_[var] = value; }
 
-void LocalData::set_object(StringView var, ObjectID value)
+void LocalData::set_string(LocalKey var, StringView value)
 {
-    auto& payload = vars_[var];
-    payload.object = value;
-    payload.flags.set(LocalVarType::object);
+    strings_[var].assign(value.data(), value.size());
 }
 
-void LocalData::set_string(StringView var, StringView value)
+size_t LocalData::size() const noexcept
 {
-    auto& payload = vars_[var];
-    payload.string = String(value);
-    payload.flags.set(LocalVarType::string);
+    return ints_.size() + floats_.size() + strings_.size() + objects_.size() + locations_.size();
 }
 
-void LocalData::set_location(StringView var, Location value)
+size_t LocalData::memory_usage() const noexcept
 {
-    auto& payload = vars_[var];
-    payload.loc = value;
-    payload.flags.set(LocalVarType::location);
+    size_t result = table_bytes(ints_) + table_bytes(floats_) + table_bytes(strings_)
+        + table_bytes(objects_) + table_bytes(locations_);
+    for (const auto& [_, value] : strings_) {
+        // Strings that fit the small string buffer have capacity() below sizeof(String)
+        if (value.capacity() >= sizeof(String)) {
+            result += value.capacity() + 1;
+        }
+    }
+    return result;
 }
 
 bool LocalData::from_json(const nlohmann::json& archive)
 {
     try {
-        for (const auto& [key, value] : archive.items()) {
-            auto& payload = vars_[key];
+        for (const auto& [name, value] : archive.items()) {
+            const LocalKey key{name};
 
             auto it = value.find("float");
             if (it != std::end(value)) {
-                payload.float_ = it->get<float>();
-                payload.flags.set(LocalVarType::float_);
+                set_float(key, it->get<float>());
             }
             it = value.find("integer");
             if (it != std::end(value)) {
-                payload.integer = it->get<int>();
-                payload.flags.set(LocalVarType::integer);
+                set_int(key, it->get<int>());
             }
             it = value.find("object");
             if (it != std::end(value)) {
-                payload.object = static_cast<ObjectID>(it->get<uint32_t>());
-                payload.flags.set(LocalVarType::object);
+                set_object(key, static_cast<ObjectID>(it->get<uint32_t>()));
             }
             it = value.find("string");
             if (it != std::end(value)) {
-                payload.string = it->get<String>();
-                payload.flags.set(LocalVarType::string);
+                set_string(key, it->get<String>());
             }
             it = value.find("location");
             if (it != std::end(value)) {
-                payload.loc = it->get<Location>();
-                payload.flags.set(LocalVarType::location);
+                set_location(key, it->get<Location>());
             }
         }
     } catch (const nlohmann::json::exception& e) {
@@ -249,27 +276,18 @@ bool LocalData::from_json(const nlohmann::json& archive)
 nlohmann::json LocalData::to_json(SerializationProfile profile) const
 {
     nlohmann::json j = nlohmann::json::object();
-    for (const auto& [key, value] : vars_) {
-        if (!value.flags.any()) {
-            continue;
-        }
-        auto& payload = j[key] = nlohmann::json::object();
-
-        if (value.flags.test(LocalVarType::float_)) {
-            payload["float"] = value.float_;
-        } else if (value.flags.test(LocalVarType::integer)) {
-            payload["integer"] = value.integer;
-        } else if (value.flags.test(LocalVarType::string)) {
-            payload["string"] = value.string;
-        }
-        if (profile != SerializationProfile::blueprint) {
-
-            if (value.flags.test(LocalVarType::object)) {
-                payload["object"] = value.object;
-            } else if (value.flags.test(LocalVarType::location)) {
-                payload["location"] = value.loc;
-            }
+    const auto emit = [&j](const auto& table, const char* type) {
+        for (const auto& [key, value] : table) {
+            j[String{key.name()}][type] = value;
         }
+    };
+
+    emit(ints_, "integer");
+    emit(floats_, "float");
+    emit(strings_, "string");
+    if (profile != SerializationProfile::blueprint) {
+        emit(objects_, "object");
+        emit(locations_, "location");
     }
     return j;
 }
@@ -282,7 +300,7 @@ bool deserialize(LocalData& self, const GffStruct& archive)
     }
     size_t sz = st.size();
     String name;
-    uint32_t type, obj;
+    uint32_t type;
 
     for (size_t i = 0; i < sz; ++i) {
         if (!st[i].get_to("Name", name)
@@ -291,37 +309,41 @@ bool deserialize(LocalData& self, const GffStruct& archive)
             break;
         }
 
-        auto& payload = self.vars_[name];
+        const LocalKey key{name};
 
         switch (type) {
         default:
             LOG_F(ERROR, "local data invalid local var type at index {}", i);
-            self.vars_.clear();
+            self.clear_all();
             return false;
-        case 1: // int
-            st[i].get_to("Value", payload.integer);
-            payload.flags.set(LocalVarType::integer);
-            break;
-        case 2: // float
-            st[i].get_to("Value", payload.float_);
-            payload.flags.set(LocalVarType::float_);
-            break;
-        case 3: // string
-            st[i].get_to("Value", payload.string);
-            payload.flags.set(LocalVarType::string);
-            break;
-        case 4: // object
-            st[i].get_to("Value", obj);
-            payload.object = static_cast<ObjectID>(obj);
-            payload.flags.set(LocalVarType::object);
-            break;
-        case 5: { // location
+        case LocalVarType::integer: {
+            int32_t value = 0;
+            st[i].get_to("Value", value);
+            self.set_int(key, value);
+        } break;
+        case LocalVarType::float_: {
+            float value = 0.0f;
+            st[i].get_to("Value", value);
+            self.set_float(key, value);
+        } break;
+        case LocalVarType::string: {
+            String value;
+            st[i].get_to("Value", value);
+            self.strings_[key] = std::move(value);
+        } break;
+        case LocalVarType::object: {
+            uint32_t value = 0;
+            st[i].get_to("Value", value);
+            self.set_object(key, static_cast<ObjectID>(value));
+        } break;
+        case LocalVarType::location: {
             if (auto s = st[i].get<GffStruct>("Value")) {
-                deserialize(payload.loc, *s, SerializationProfile::any);
-                payload.flags.set(LocalVarType::location);
+                Location loc;
+                deserialize(loc, *s, SerializationProfile::any);
+                self.set_location(key, loc);
             } else {
                 LOG_F(ERROR, "failed to read location struct");
-                self.vars_.clear();
+                self.clear_all();
                 return false;
             }
         } break;
@@ -333,47 +355,72 @@ bool deserialize(LocalData& self, const GffStruct& archive)
 
 bool serialize(const LocalData& self, GffBuilderStruct& archive, SerializationProfile profile)
 {
-    if (self.vars_.empty()) {
+    if (!self.size()) {
         return true;
     }
 
     auto& list = archive.add_list("VarTable");
+    const auto push = [&list](LocalKey key, uint32_t type) -> GffBuilderStruct& {
+        return list.push_back(0).add_field("Name", String{key.name()}).add_field("Type", type);
+    };
 
-    for (const auto& [key, value] : self.vars_) {
-        if (!value.flags.any()) {
-            continue;
-        }
-        auto& payload = list.push_back(0).add_field("Name", key);
-
-        if (value.flags.test(LocalVarType::float_)) {
-            payload.add_field("Type", LocalVarType::float_);
-            payload.add_field("Value", value.float_);
-        } else if (value.flags.test(LocalVarType::integer)) {
-            payload.add_field("Type", LocalVarType::integer);
-            payload.add_field("Value", value.integer);
-        } else if (value.flags.test(LocalVarType::string)) {
-            payload.add_field("Type", LocalVarType::string);
-            payload.add_field("Value", value.string);
-        }
-        if (profile != SerializationProfile::blueprint) {
-            if (value.flags.test(LocalVarType::object)) {
-                payload.add_field("Type", LocalVarType::object);
-                payload.add_field("Value", static_cast<uint32_t>(value.object));
-            } else if (value.flags.test(LocalVarType::location)) {
-                payload.add_field("Type", LocalVarType::location);
-                payload.add_struct("Value", 1)
-                    .add_field("Area", static_cast<uint32_t>(value.loc.area))
-                    .add_field("PositionX", value.loc.position.x)
-                    .add_field("PositionY", value.loc.position.y)
-                    .add_field("PositionZ", value.loc.position.z)
-                    .add_field("OrientationX", value.loc.orientation.x)
-                    .add_field("OrientationY", value.loc.orientation.y)
-                    .add_field("OrientationZ", value.loc.orientation.z);
-            }
-        }
+    for (const auto& [key, value] : self.ints_) {
+        push(key, LocalVarType::integer).add_field("Value", value);
+    }
+    for (const auto& [key, value] : self.floats_) {
+        push(key, LocalVarType::float_).add_field("Value", value);
+    }
+    for (const auto& [key, value] : self.strings_) {
+        push(key, LocalVarType::string).add_field("Value", value);
+    }
+    if (profile == SerializationProfile::blueprint) {
+        return true;
+    }
+
+    for (const auto& [key, value] : self.objects_) {
+        push(key, LocalVarType::object).add_field("Value", static_cast<uint32_t>(value));
+    }
+    for (const auto& [key, loc] : self.locations_) {
+        push(key, LocalVarType::location)
+            .add_struct("Value", 1)
+            .add_field("Area", static_cast<uint32_t>(loc.area))
+            .add_field("PositionX", loc.position.x)
+            .add_field("PositionY", loc.position.y)
+            .add_field("PositionZ", loc.position.z)
+            .add_field("OrientationX", loc.orientation.x)
+            .add_field("OrientationY", loc.orientation.y)
+            .add_field("OrientationZ", loc.orientation.z);
     }
 
     return true;
 }
 
+Vector<LocalData::EntryKey> LocalData::sorted_keys(bool with_object_types) const
+{
+    Vector<EntryKey> result;
+    result.reserve(size());
+
+    const auto append = [&result](const auto& table, uint32_t type) {
+        for (const auto& [key, _] : table) {
+            result.push_back({key, type});
+        }
+    };
+
+    append(ints_, LocalVarType::integer);
+    append(floats_, LocalVarType::float_);
+    append(strings_, LocalVarType::string);
+    if (with_object_types) {
+        append(objects_, LocalVarType::object);
+        append(locations_, LocalVarType::location);
+    }
+
+    std::sort(result.begin(), result.end(), [](const EntryKey& lhs, const EntryKey& rhs) {
+        if (lhs.key != rhs.key) {
+            return lhs.key.name() < rhs.key.name();
+        }
+        return lhs.type < rhs.type;
+    });
+    return result;
+}
+
 } // namespace nw
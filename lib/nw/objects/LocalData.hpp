@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../serialization/Serialization.hpp"
+#include "../util/InternedString.hpp"
 #include "Location.hpp"
 
 #include <absl/container/flat_hash_map.h>
@@ -19,31 +20,81 @@ struct LocalVarType {
     static constexpr uint32_t location = 5;
 };
 
+/// Snapshot of every value stored under one local variable name, see ``LocalData::entries``
 struct LocalVar {
-    float float_;
-    int32_t integer;
-    ObjectID object;
+    float float_ = 0.0f;
+    int32_t integer = 0;
+    ObjectID object = object_invalid;
     String string;
     Location loc;
 
     std::bitset<8> flags;
 };
 
-using LocalVarTable = absl::flat_hash_map<String, LocalVar>;
+/// Pre-interned local variable name
+///
+/// Local variable names are interned by the kernel strings service, so a key can be created once, e.g.
+/// by a script or system that reads the same variable repeatedly, and used with any ``LocalData``
+/// without hashing the name again.
+struct LocalKey {
+    LocalKey() = default;
 
+    /// Interns ``name``
+    explicit LocalKey(StringView name);
+
+    /// Gets the key of ``name`` if it has ever been interned, an invalid key otherwise
+    static LocalKey find(StringView name);
+
+    /// Gets the name of the key
+    StringView name() const noexcept { return name_.view(); }
+
+    /// Determines if the key refers to an interned name
+    bool valid() const noexcept { return !!name_; }
+
+    bool operator==(const LocalKey& rhs) const noexcept = default;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const LocalKey& key)
+    {
+        return H::combine(std::move(h), key.name_.ptr());
+    }
+
+private:
+    InternedString name_;
+};
+
+/// Local variables of an object
+///
+/// Values are partitioned by type, each type has its own table keyed by ``LocalKey``.  A variable name
+/// can hold one value of each type at the same time, e.g. an int and a string named ``"count"``.
 struct LocalData {
     LocalData() = default;
 
     bool from_json(const nlohmann::json& archive);
     nlohmann::json to_json(SerializationProfile profile) const;
 
-    LocalVarTable::iterator begin() { return vars_.begin(); }
-    LocalVarTable::const_iterator begin() const { return vars_.begin(); }
-    LocalVarTable::iterator end() { return vars_.end(); }
-    LocalVarTable::const_iterator end() const { return vars_.end(); }
+    /// Gets all variables grouped by name, sorted by name
+    Vector<std::pair<StringView, LocalVar>> entries() const;
+
+    /// Calls ``f(type, key, value)`` for every variable, in table order
+    /// @note ``value`` is an ``int32_t``, ``float``, ``ObjectID``, ``String`` or ``Location`` per ``LocalVarType``
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        for (const auto& [key, value] : ints_) { f(LocalVarType::integer, key, value); }
+        for (const auto& [key, value] : floats_) { f(LocalVarType::float_, key, value); }
+        for (const auto& [key, value] : strings_) { f(LocalVarType::string, key, value); }
+        for (const auto& [key, value] : objects_) { f(LocalVarType::object, key, value); }
+        for (const auto& [key, value] : locations_) { f(LocalVarType::location, key, value); }
+    }
+
+    /// Determines if a variable of a type is set
+    bool contains(StringView var, uint32_t type) const;
+    bool contains(LocalKey var, uint32_t type) const;
 
     /// Clears a variable by type
     void clear(StringView var, uint32_t type);
+    void clear(LocalKey var, uint32_t type);
 
     /// Clears all variables by type
     void clear_all(uint32_t type = LocalVarType::invalid);
@@ -54,25 +105,63 @@ struct LocalData {
     void delete_string(StringView var);
     void delete_location(StringView var);
 
+    void delete_float(LocalKey var);
+    void delete_int(LocalKey var);
+    void delete_object(LocalKey var);
+    void delete_string(LocalKey var);
+    void delete_location(LocalKey var);
+
     float get_float(StringView var) const;
     int32_t get_int(StringView var) const;
     ObjectID get_object(StringView var) const;
     String get_string(StringView var) const;
     Location get_location(StringView var) const;
 
+    float get_float(LocalKey var) const;
+    int32_t get_int(LocalKey var) const;
+    ObjectID get_object(LocalKey var) const;
+    /// Gets a string variable, the view is valid until the variable is next modified
+    StringView get_string(LocalKey var) const;
+    Location get_location(LocalKey var) const;
+
     void set_float(StringView var, float value);
     void set_int(StringView var, int32_t value);
     void set_object(StringView var, ObjectID value);
     void set_string(StringView var, StringView value);
     void set_location(StringView var, Location value);
 
-    size_t size() const noexcept { return vars_.size(); }
+    void set_float(LocalKey var, float value);
+    void set_int(LocalKey var, int32_t value);
+    void set_object(LocalKey var, ObjectID value);
+    void set_string(LocalKey var, StringView value);
+    void set_location(LocalKey var, Location value);
+
+    /// Gets the number of variables, a name with values of two types counts twice
+    size_t size() const noexcept;
+
+    /// Gets the number of bytes allocated for variables, including the tables themselves
+    size_t memory_usage() const noexcept;
 
     friend bool deserialize(LocalData& self, const GffStruct& archive);
     friend bool serialize(const LocalData& self, GffBuilderStruct& archive, SerializationProfile profile);
 
 private:
-    LocalVarTable vars_;
+    struct EntryKey {
+        LocalKey key;
+        uint32_t type;
+    };
+
+    template <typename T>
+    using Table = absl::flat_hash_map<LocalKey, T>;
+
+    Table<int32_t> ints_;
+    Table<float> floats_;
+    Table<ObjectID> objects_;
+    Table<String> strings_; ///< Short strings are stored inline by ``String`` itself
+    Table<Location> locations_;
+
+    /// Gets every variable sorted by name then type, see ``entries``
+    Vector<EntryKey> sorted_keys(bool with_object_types) const;
 };
 
 // [TODO] NWNX:EE POS, Sqlite3
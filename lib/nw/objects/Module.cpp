@@ -1,5 +1,6 @@
 #include "Module.hpp"
 
+#include "../kernel/JobSystem.hpp"
 #include "../kernel/Strings.hpp"
 #include "../profiles/nwn1/legacy_gff_compat.hpp"
 #include "../serialization/Gff.hpp"
@@ -13,6 +14,7 @@
 #include <algorithm>
 #include <array>
 #include <exception>
+#include <span>
 
 namespace nw {
 
@@ -78,6 +80,38 @@ Module::Module(nw::MemoryResource* allocator)
 {
 }
 
+namespace {
+
+// Areas demanded and parsed together by parallel instantiation, bounds the resources held at once.
+constexpr size_t parallel_area_batch = 32;
+
+int64_t elapsed_ms(std::chrono::high_resolution_clock::time_point begin,
+    std::chrono::high_resolution_clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+}
+
+Area* load_deferred_area(Resref resref)
+{
+    auto area = nw::kernel::objects().make_area(resref);
+    if (!area) {
+        LOG_F(ERROR, "kernel: failed to load area '{}'", resref.view());
+        return nullptr;
+    }
+
+    try {
+        if (area->instantiate()) { return area; }
+        LOG_F(ERROR, "kernel: failed to instantiate area '{}'", resref.view());
+    } catch (const std::exception& e) {
+        LOG_F(ERROR, "kernel: failed to instantiate area '{}': {}", resref.view(), e.what());
+    }
+    area->clear();
+    nw::kernel::objects().destroy(area->handle());
+    return nullptr;
+}
+
+} // namespace
+
 size_t Module::area_count() const noexcept
 {
     if (areas.is<Vector<Area*>>()) {
@@ -88,11 +122,16 @@ size_t Module::area_count() const noexcept
 
 Area* Module::get_area(size_t index)
 {
-    if (areas.is<Vector<Area*>>() && index < area_count()) {
-        return areas.as<Vector<Area*>>()[index];
+    if (!areas.is<Vector<Area*>>() || index >= area_count()) {
+        return nullptr;
     }
 
-    return nullptr;
+    auto& area = areas.as<Vector<Area*>>()[index];
+    if (!area && index < deferred_areas_.size() && !failed_areas_[index]) {
+        area = load_deferred_area(deferred_areas_[index]);
+        if (!area) { failed_areas_[index] = 1; }
+    }
+    return area;
 }
 
 const Area* Module::get_area(size_t index) const
@@ -104,14 +143,29 @@ const Area* Module::get_area(size_t index) const
     return nullptr;
 }
 
+Resref Module::get_area_resref(size_t index) const
+{
+    if (areas.is<Vector<Resref>>()) {
+        const auto& area_list = areas.as<Vector<Resref>>();
+        return index < area_list.size() ? area_list[index] : Resref{};
+    }
+
+    if (const Area* area = get_area(index)) {
+        return area->resref;
+    }
+    return index < deferred_areas_.size() ? deferred_areas_[index] : Resref{};
+}
+
 void Module::clear()
 {
     if (areas.is<Vector<Area*>>()) {
         for (auto it : areas.as<Vector<Area*>>()) {
-            nw::kernel::objects().destroy(it->handle());
+            if (it) { nw::kernel::objects().destroy(it->handle()); }
         }
     }
     areas = Vector<Resref>{};
+    deferred_areas_.clear();
+    failed_areas_.clear();
     ObjectBase::clear();
     instantiated_ = false;
 }
@@ -122,9 +176,21 @@ bool Module::instantiate()
     if (instantiated_) { return true; }
 
     auto start = std::chrono::high_resolution_clock::now();
+    const auto mode = nw::kernel::config().options().area_load_mode;
+    ObjectManager::AreaLoadProfile profile{};
+    auto& area_list = areas.as<Vector<Resref>>();
+
+    if (mode == AreaLoadMode::lazy) {
+        profile.deferred_areas = static_cast<uint32_t>(area_list.size());
+        deferred_areas_ = std::move(area_list);
+        areas = Vector<Area*>(deferred_areas_.size(), nullptr);
+        failed_areas_.assign(deferred_areas_.size(), 0);
+        LOG_F(INFO, "kernel: instantiated module: {} areas deferred", profile.deferred_areas);
+        NW_PROFILE_PLOT("nw.module.instantiate.deferred_areas", int64_t(profile.deferred_areas));
+        instantiated_ = true;
+        return true;
+    }
 
-    int64_t area_make_ms = 0;
-    int64_t area_instantiate_ms = 0;
     int64_t slowest_area_ms = -1;
     Resref slowest_area;
     static constexpr size_t top_area_count = 3;
@@ -132,9 +198,7 @@ bool Module::instantiate()
     for (auto& it : top_slowest_areas) {
         it.first = -1;
     }
-    ObjectManager::AreaLoadProfile profile{};
 
-    auto& area_list = areas.as<Vector<Resref>>();
     Vector<Area*> area_objects;
     area_objects.reserve(area_list.size());
     const auto destroy_loaded_areas = [&area_objects] {
@@ -144,18 +208,17 @@ bool Module::instantiate()
         }
         area_objects.clear();
     };
-    for (auto& area : area_list) {
-        auto t0 = std::chrono::high_resolution_clock::now();
-        auto a = nw::kernel::objects().make_area(area, &profile);
+
+    // Areas are committed in module order on this thread, whichever mode produced them, so object
+    // handles are allocated deterministically.
+    const auto commit = [&](Resref area, Area* a, std::chrono::high_resolution_clock::time_point t0) {
         if (!a) {
             LOG_F(ERROR, "kernel: failed to load area '{}'", area.view());
             destroy_loaded_areas();
             return false;
         }
-        auto t1 = std::chrono::high_resolution_clock::now();
-        area_make_ms += std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
 
-        auto t2 = std::chrono::high_resolution_clock::now();
+        auto t1 = std::chrono::high_resolution_clock::now();
         area_objects.push_back(a);
         try {
             if (!a->instantiate()) {
@@ -168,10 +231,10 @@ bool Module::instantiate()
             destroy_loaded_areas();
             return false;
         }
-        auto t3 = std::chrono::high_resolution_clock::now();
-        area_instantiate_ms += std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        profile.instantiate_ms += elapsed_ms(t1, t2);
 
-        auto total_area_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t0).count();
+        auto total_area_ms = elapsed_ms(t0, t2);
         if (total_area_ms > slowest_area_ms) {
             slowest_area_ms = total_area_ms;
             slowest_area = area;
@@ -187,17 +250,66 @@ bool Module::instantiate()
                 }
             }
         }
+        return true;
+    };
+
+    if (mode == AreaLoadMode::parallel) {
+        const auto format = nw::kernel::resman().module_format();
+        if (format == ModuleResourceFormat::invalid) {
+            LOG_F(ERROR, "kernel: unable to load areas, no module resource format is active");
+            return false;
+        }
+
+        for (size_t begin = 0; begin < area_list.size(); begin += parallel_area_batch) {
+            const size_t count = std::min(parallel_area_batch, area_list.size() - begin);
+
+            Vector<Resource> uris;
+            Vector<size_t> offsets;
+            for (size_t i = 0; i < count; ++i) {
+                offsets.push_back(uris.size());
+                const auto resources = ObjectManager::area_resources(area_list[begin + i], format);
+                uris.insert(uris.end(), resources.begin(), resources.end());
+            }
+            offsets.push_back(uris.size());
+
+            auto t0 = std::chrono::high_resolution_clock::now();
+            auto data = nw::kernel::resman().demand_many(uris);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            Vector<ObjectManager::AreaSource> sources(count);
+            nw::kernel::jobs().parallel_for(count, [&](size_t i) {
+                auto area_data = std::span<ResourceData>{data}.subspan(offsets[i], offsets[i + 1] - offsets[i]);
+                sources[i] = ObjectManager::parse_area(area_list[begin + i], format, area_data);
+            });
+            auto t2 = std::chrono::high_resolution_clock::now();
+            profile.demand_ms += elapsed_ms(t0, t1);
+            profile.parse_ms += elapsed_ms(t1, t2);
+
+            for (size_t i = 0; i < count; ++i) {
+                auto t3 = std::chrono::high_resolution_clock::now();
+                auto a = nw::kernel::objects().make_area(sources[i], &profile);
+                sources[i] = {};
+                if (!commit(area_list[begin + i], a, t3)) { return false; }
+            }
+        }
+    } else {
+        for (auto& area : area_list) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            auto a = nw::kernel::objects().make_area(area, &profile);
+            if (!commit(area, a, t0)) { return false; }
+        }
     }
     areas = std::move(area_objects);
 
     auto elapsed = std::chrono::high_resolution_clock::now() - start;
-    LOG_F(INFO, "kernel: instantiated module: {} areas in {}ms", area_count(),
-        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+    LOG_F(INFO, "kernel: instantiated module: {} areas in {}ms (demand {}ms, parse {}ms, deserialize {}ms, instantiate {}ms)",
+        area_count(), std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(),
+        profile.demand_ms, profile.parse_ms, profile.deserialize_ms, profile.instantiate_ms);
 
-    NW_PROFILE_PLOT("nw.module.instantiate.area_make_ms", area_make_ms);
+    NW_PROFILE_PLOT("nw.module.instantiate.area_make_ms", profile.demand_ms + profile.parse_ms + profile.deserialize_ms);
     NW_PROFILE_PLOT("nw.module.instantiate.area_demand_ms", profile.demand_ms);
+    NW_PROFILE_PLOT("nw.module.instantiate.area_parse_ms", profile.parse_ms);
     NW_PROFILE_PLOT("nw.module.instantiate.area_deserialize_ms", profile.deserialize_ms);
-    NW_PROFILE_PLOT("nw.module.instantiate.area_instantiate_ms", area_instantiate_ms);
+    NW_PROFILE_PLOT("nw.module.instantiate.area_instantiate_ms", profile.instantiate_ms);
     NW_PROFILE_PLOT("nw.module.instantiate.objects.creatures", profile.creatures);
     NW_PROFILE_PLOT("nw.module.instantiate.objects.doors", profile.doors);
     NW_PROFILE_PLOT("nw.module.instantiate.objects.encounters", profile.encounters);
@@ -384,8 +496,8 @@ bool Module::serialize(const Module* obj, nlohmann::json& archive)
         archive["areas"] = obj->areas.as<Vector<Resref>>();
     } else {
         auto& area_list = archive["areas"] = nlohmann::json::array();
-        for (const auto area : obj->areas.as<Vector<Area*>>()) {
-            area_list.push_back(area->resref);
+        for (size_t i = 0; i < obj->area_count(); ++i) {
+            area_list.push_back(obj->get_area_resref(i));
         }
     }
 
@@ -446,8 +558,8 @@ bool serialize(const Module* obj, GffBuilderStruct& archive)
             area_list.push_back(6).add_field("Area_Name", area);
         }
     } else {
-        for (const auto& area : obj->areas.as<Vector<Area*>>()) {
-            area_list.push_back(6).add_field("Area_Name", area->resref);
+        for (size_t i = 0; i < obj->area_count(); ++i) {
+            area_list.push_back(6).add_field("Area_Name", obj->get_area_resref(i));
         }
     }
 
@@ -61,9 +61,18 @@ struct Module : public ObjectBase {
     virtual bool instantiate() override;
 
     size_t area_count() const noexcept;
+
+    /// Gets an area, loading it first if instantiation deferred it
+    /// @note A deferred area that fails to load is not retried, later calls return ``nullptr``.
     Area* get_area(size_t index);
+
+    /// Gets an area
+    /// @note Returns ``nullptr`` for an area deferred by lazy instantiation and not yet loaded.
     const Area* get_area(size_t index) const;
 
+    /// Gets the resref of an area whether loaded or not
+    Resref get_area_resref(size_t index) const;
+
     // Serialization
     static bool deserialize(Module* ent, const nlohmann::json& archive);
     static bool serialize(const Module* ent, nlohmann::json& archive);
@@ -98,6 +107,8 @@ struct Module : public ObjectBase {
     uint8_t xpscale = 0;
 
     bool instantiated_ = false;
+    Vector<Resref> deferred_areas_; ///< Area resrefs under lazy instantiation, parallel to ``areas``
+    Vector<uint8_t> failed_areas_;  ///< Deferred areas that failed to load, parallel to ``areas``
 };
 
 // == Module - Serialization - Gff ============================================
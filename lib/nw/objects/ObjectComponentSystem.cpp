@@ -144,7 +144,7 @@ bool same_slotted_ability_slot(const ObjectAbilityLoadoutEntry& lhs,
         && lhs.slot == rhs.slot;
 }
 
-bool duplicates_existing_ability_entry(const Vector<ObjectAbilityLoadoutEntry>& entries,
+bool duplicates_existing_ability_entry(std::span<const ObjectAbilityLoadoutEntry> entries,
     const ObjectAbilityLoadoutEntry& entry) noexcept
 {
     for (const ObjectAbilityLoadoutEntry& existing : entries) {
@@ -272,10 +272,12 @@ bool ObjectComponentSystem::from_json_spatial(ObjectHandle obj, const nlohmann::
     if (!row) {
         return false;
     }
+    const ObjectID previous_area = row->area;
     row->area = parsed.area;
     row->position = parsed.position;
     row->orientation = parsed.orientation;
     row->scale = scale;
+    reindex_spatial(*row, previous_area);
     return true;
 }
 
@@ -326,9 +328,11 @@ bool ObjectComponentSystem::set_location(ObjectHandle obj, Location location)
         return false;
     }
 
+    const ObjectID previous_area = row->area;
     row->area = location.area;
     row->position = location.position;
     row->orientation = location.orientation;
+    reindex_spatial(*row, previous_area);
     return true;
 }
 
@@ -339,10 +343,43 @@ bool ObjectComponentSystem::set_area(ObjectHandle obj, ObjectID area)
         return false;
     }
 
+    const ObjectID previous_area = row->area;
     row->area = area;
+    reindex_spatial(*row, previous_area);
     return true;
 }
 
+bool ObjectComponentSystem::set_faction(ObjectHandle obj, uint32_t faction)
+{
+    ObjectSpatialState* row = get_or_create_spatial(obj);
+    if (!row) {
+        return false;
+    }
+
+    row->faction = faction;
+    reindex_spatial(*row, row->area);
+    return true;
+}
+
+const AreaSpatialIndex* ObjectComponentSystem::area_spatial_index(ObjectID area) const noexcept
+{
+    auto it = area_spatial_.find(area);
+    return it != area_spatial_.end() ? &it->second : nullptr;
+}
+
+void ObjectComponentSystem::reindex_spatial(const ObjectSpatialState& row, ObjectID previous_area)
+{
+    if (previous_area != row.area) {
+        if (auto it = area_spatial_.find(previous_area); it != area_spatial_.end()) {
+            it->second.remove(row.owner);
+        }
+    }
+
+    if (row.area != object_invalid && row.owner.type != ObjectType::area) {
+        area_spatial_[row.area].update(row.owner, row.position, row.faction);
+    }
+}
+
 LocalData* ObjectComponentSystem::get_or_create_locals(ObjectHandle obj)
 {
     if (auto* existing = find_locals(obj)) {
@@ -1307,16 +1344,26 @@ bool ObjectComponentSystem::from_json_ability_loadout(ObjectHandle obj, const nl
             || !read_i32(entry_json, "slot", entry.slot)
             || !read_i32(entry_json, "ability", entry.ability)
             || !read_i32(entry_json, "modifier", entry.modifier)
-            || !read_u32(entry_json, "flags", entry.flags)
-            || !is_valid_ability_loadout_entry(entry)
-            || duplicates_existing_ability_entry(parsed, entry)) {
+            || !read_u32(entry_json, "flags", entry.flags)) {
             return false;
         }
 
         parsed.push_back(entry);
     }
 
-    if (parsed.empty()) {
+    return set_ability_loadout(obj, parsed);
+}
+
+bool ObjectComponentSystem::set_ability_loadout(ObjectHandle obj, std::span<const ObjectAbilityLoadoutEntry> entries)
+{
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!is_valid_ability_loadout_entry(entries[i])
+            || duplicates_existing_ability_entry(entries.first(i), entries[i])) {
+            return false;
+        }
+    }
+
+    if (entries.empty()) {
         remove_ability_loadout(obj);
         return true;
     }
@@ -1324,7 +1371,7 @@ bool ObjectComponentSystem::from_json_ability_loadout(ObjectHandle obj, const nl
     ObjectAbilityLoadoutState* row = get_or_create_ability_loadout(obj);
     if (!row) { return false; }
 
-    row->entries = std::move(parsed);
+    row->entries.assign(entries.begin(), entries.end());
     sort_ability_loadout(*row);
     return true;
 }
@@ -1648,6 +1695,7 @@ bool ObjectComponentSystem::set_position(ObjectHandle obj, glm::vec3 position)
     }
 
     row->position = position;
+    reindex_spatial(*row, row->area);
     return true;
 }
 
@@ -1739,9 +1787,16 @@ void ObjectComponentSystem::remove(ObjectBase& obj) noexcept
 
 void ObjectComponentSystem::remove_spatial(ObjectHandle obj) noexcept
 {
+    if (obj.type == ObjectType::area) {
+        area_spatial_.erase(obj.id);
+    }
+
     auto it = spatial_index_.find(obj.to_ull());
     if (it != spatial_index_.end()) {
         const size_t index = it->second;
+        if (auto area = area_spatial_.find(spatial_[index].area); area != area_spatial_.end()) {
+            area->second.remove(obj);
+        }
         const size_t last = spatial_.size() - 1;
         spatial_index_.erase(it);
 
@@ -2095,6 +2150,7 @@ void ObjectComponentSystem::clear() noexcept
 {
     spatial_index_.clear();
     spatial_.clear();
+    area_spatial_.clear();
     local_data_index_.clear();
     local_data_.clear();
     vitals_index_.clear();
@@ -2123,9 +2179,20 @@ void ObjectComponentSystem::clear() noexcept
 
 nlohmann::json ObjectComponentSystem::stats() const
 {
+    size_t local_vars = 0;
+    size_t local_bytes = 0;
+    for (const auto& row : local_data_) {
+        local_vars += row.locals.size();
+        local_bytes += row.locals.memory_usage();
+    }
+
     return {
         {"spatial", spatial_.size()},
+        {"area_spatial_indices", area_spatial_.size()},
         {"local_data", local_data_.size()},
+        {"local_variables", local_vars},
+        {"local_variable_bytes", local_bytes},
+        {"local_bytes_per_variable", local_vars ? double(local_bytes) / double(local_vars) : 0.0},
         {"vitals", vitals_.size()},
         {"geometry", geometry_.size()},
         {"visual", visual_.size()},
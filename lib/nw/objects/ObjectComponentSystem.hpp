@@ -3,6 +3,7 @@
 #include "../formats/Plt.hpp"
 #include "../resources/assets.hpp"
 #include "../rules/items.hpp"
+#include "AreaSpatialIndex.hpp"
 #include "Inventory.hpp"
 #include "LocalData.hpp"
 #include "ObjectHandle.hpp"
@@ -28,6 +29,7 @@ struct ObjectSpatialState {
     glm::vec3 velocity{0.0f};
     glm::vec3 angular_velocity{0.0f};
     uint32_t flags = 0;
+    uint32_t faction = SpatialFilter::any_faction; ///< Faction tag matched by spatial query filters
 };
 
 struct ObjectLocalDataState {
@@ -224,6 +226,11 @@ struct ObjectComponentSystem {
 
     bool set_location(ObjectHandle obj, Location location);
     bool set_area(ObjectHandle obj, ObjectID area);
+    bool set_faction(ObjectHandle obj, uint32_t faction);
+
+    /// Gets the spatial index of the objects whose spatial state places them in ``area``
+    const AreaSpatialIndex* area_spatial_index(ObjectID area) const noexcept;
+
     bool deserialize_locals(ObjectHandle obj, const GffStruct& archive);
     bool from_json_locals(ObjectHandle obj, const nlohmann::json& component_archive);
     bool serialize_locals(ObjectHandle obj, GffBuilderStruct& archive, SerializationProfile profile) const;
@@ -303,6 +310,7 @@ struct ObjectComponentSystem {
     ObjectAbilityLoadoutState* find_ability_loadout(ObjectHandle obj) noexcept;
     const ObjectAbilityLoadoutState* find_ability_loadout(ObjectHandle obj) const noexcept;
     bool from_json_ability_loadout(ObjectHandle obj, const nlohmann::json& archive);
+    bool set_ability_loadout(ObjectHandle obj, std::span<const ObjectAbilityLoadoutEntry> entries);
     nlohmann::json ability_loadout_to_json(ObjectHandle obj) const;
 
     bool add_unslotted_ability(ObjectHandle obj, int32_t source, int32_t tier, int32_t ability);
@@ -334,6 +342,7 @@ struct ObjectComponentSystem {
     void clear() noexcept;
 
     size_t spatial_count() const noexcept { return spatial_.size(); }
+    size_t area_spatial_index_count() const noexcept { return area_spatial_.size(); }
     size_t local_data_count() const noexcept { return local_data_.size(); }
     size_t vitals_count() const noexcept { return vitals_.size(); }
     size_t geometry_count() const noexcept { return geometry_.size(); }
@@ -348,6 +357,7 @@ struct ObjectComponentSystem {
     nlohmann::json stats() const;
 
 private:
+    void reindex_spatial(const ObjectSpatialState& row, ObjectID previous_area);
     void remove_spatial(ObjectHandle obj) noexcept;
     void remove_locals(ObjectHandle obj) noexcept;
     void remove_inventory(ObjectHandle obj) noexcept;
@@ -358,6 +368,7 @@ private:
 
     absl::flat_hash_map<uint64_t, size_t> spatial_index_;
     Vector<ObjectSpatialState> spatial_;
+    absl::flat_hash_map<ObjectID, AreaSpatialIndex> area_spatial_;
 
     absl::flat_hash_map<uint64_t, size_t> local_data_index_;
     Vector<ObjectLocalDataState> local_data_;
@@ -20,6 +20,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <array>
 #include <chrono>
 
 namespace nw {
@@ -194,6 +195,7 @@ bool ObjectArray::valid(ObjectHandle handle) const
 }
 
 const std::type_index ObjectManager::type_index{typeid(ObjectManager)};
+size_t ObjectManager::service_slot = kernel::Services::no_slot;
 
 ObjectManager::ObjectManager(MemoryResource* scope)
     : nw::kernel::Service(scope)
@@ -264,6 +266,40 @@ nw::Player* ObjectManager::load_player(StringView cdkey, StringView resref)
     return obj;
 }
 
+Vector<Resource> ObjectManager::area_resources(Resref area, ModuleResourceFormat format)
+{
+    if (format == ModuleResourceFormat::native_json) {
+        return {Resource{area, ResourceType::caf}};
+    }
+    return {Resource{area, ResourceType::are}, Resource{area, ResourceType::git}, Resource{area, ResourceType::gic}};
+}
+
+ObjectManager::AreaSource ObjectManager::parse_area(Resref area, ModuleResourceFormat format, std::span<ResourceData> data)
+{
+    NW_PROFILE_SCOPE_N("ObjectManager::parse_area");
+    AreaSource result;
+    result.resref = area;
+    result.format = format;
+
+    if (format == ModuleResourceFormat::native_json) {
+        if (data.size() < 1) { return result; }
+        try {
+            result.caf = nlohmann::json::parse(data[0].bytes.string_view());
+            result.valid = result.caf.value("$type", "") == "CAF"
+                && result.caf.value("$version", 0) == Area::json_archive_version;
+        } catch (const std::exception& e) {
+            LOG_F(ERROR, "Failed to parse area CAF '{}': {}", area.view(), e.what());
+        }
+    } else if (format == ModuleResourceFormat::legacy_gff) {
+        if (data.size() < 3) { return result; }
+        result.are = std::make_unique<Gff>(std::move(data[0]));
+        result.git = std::make_unique<Gff>(std::move(data[1]));
+        result.gic = std::make_unique<Gff>(std::move(data[2]));
+        result.valid = result.are->valid() && result.git->valid();
+    }
+    return result;
+}
+
 Area* ObjectManager::make_area(Resref area, ObjectManager::AreaLoadProfile* profile)
 {
     NW_PROFILE_SCOPE_N("ObjectManager::make_area");
@@ -274,49 +310,51 @@ Area* ObjectManager::make_area(Resref area, ObjectManager::AreaLoadProfile* prof
         return nullptr;
     }
 
-    auto t1 = t0;
-    Area* obj = nullptr;
+    const auto uris = area_resources(area, format);
+    auto data = kernel::resman().demand_many(uris);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto source = parse_area(area, format, data);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    if (profile) {
+        profile->demand_ms += std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+        profile->parse_ms += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    }
+
+    return make_area(source, profile);
+}
+
+Area* ObjectManager::make_area(AreaSource& source, ObjectManager::AreaLoadProfile* profile)
+{
+    NW_PROFILE_SCOPE_N("ObjectManager::make_area");
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    Area* obj = make<Area>();
     bool loaded = false;
-    if (format == ModuleResourceFormat::native_json) {
-        auto caf = kernel::resman().demand({area, ResourceType::caf});
-        t1 = std::chrono::high_resolution_clock::now();
-        obj = make<Area>();
-        try {
-            const auto json = nlohmann::json::parse(caf.bytes.string_view());
-            loaded = json.value("$type", "") == "CAF"
-                && json.value("$version", 0) == Area::json_archive_version
-                && deserialize(obj, json);
-        } catch (const std::exception& e) {
-            LOG_F(ERROR, "Failed to parse area CAF '{}': {}", area.view(), e.what());
-        }
-    } else {
-        auto are_data = kernel::resman().demand({area, ResourceType::are});
-        auto git_data = kernel::resman().demand({area, ResourceType::git});
-        auto gic_data = kernel::resman().demand({area, ResourceType::gic});
-        t1 = std::chrono::high_resolution_clock::now();
-        Gff are{std::move(are_data)};
-        Gff git{std::move(git_data)};
-        Gff gic{std::move(gic_data)};
-        obj = make<Area>();
-        if (are.valid() && git.valid()) {
-            loaded = deserialize(obj, are.toplevel(), git.toplevel(), gic.toplevel());
+    if (source.valid) {
+        if (source.format == ModuleResourceFormat::native_json) {
+            try {
+                loaded = deserialize(obj, source.caf);
+            } catch (const std::exception& e) {
+                LOG_F(ERROR, "Failed to deserialize area CAF '{}': {}", source.resref.view(), e.what());
+            }
+        } else {
+            loaded = deserialize(obj, source.are->toplevel(), source.git->toplevel(), source.gic->toplevel());
         }
     }
-    auto t2 = std::chrono::high_resolution_clock::now();
+    auto t1 = std::chrono::high_resolution_clock::now();
 
     if (!loaded) {
-        LOG_F(ERROR, "Failed to deserialize area '{}' from {}", area.view(),
-            format == ModuleResourceFormat::native_json ? "CAF" : "ARE/GIT");
-        if (obj) {
-            obj->clear();
-            destroy(obj->handle());
-        }
+        LOG_F(ERROR, "Failed to deserialize area '{}' from {}", source.resref.view(),
+            source.format == ModuleResourceFormat::native_json ? "CAF" : "ARE/GIT");
+        obj->clear();
+        destroy(obj->handle());
         return nullptr;
     }
 
     if (profile) {
-        profile->demand_ms += std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
-        profile->deserialize_ms += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+        profile->deserialize_ms += std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+        profile->areas += 1;
         profile->creatures += static_cast<uint32_t>(obj->creatures.size());
         profile->doors += static_cast<uint32_t>(obj->doors.size());
         profile->encounters += static_cast<uint32_t>(obj->encounters.size());
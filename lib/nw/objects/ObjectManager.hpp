@@ -25,6 +25,8 @@
 #include <nlohmann/json.hpp>
 
 #include <limits>
+#include <memory>
+#include <span>
 
 namespace nw {
 
@@ -99,6 +101,7 @@ private:
 
 struct ObjectManager : public kernel::Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
     ObjectManager(MemoryResource* scope);
     ObjectManager(const ObjectManager&) = delete;
     ObjectManager(ObjectManager&&) = default;
@@ -136,6 +139,10 @@ struct ObjectManager : public kernel::Service {
     template <typename T>
     T* load_instance(const nlohmann::json& archive);
 
+    /// Loads an object instance with ``decode``, a callable ``bool(T*)`` that fills the object before it is instantiated
+    template <typename T, typename Decode>
+    T* load_instance_with(Decode&& decode);
+
     /// Loads an object from resource system
     Player* load_player(StringView cdkey, StringView resref);
 
@@ -150,9 +157,15 @@ struct ObjectManager : public kernel::Service {
     template <typename T>
     T* make();
 
+    /// Per-phase area load times in milliseconds and object counts
+    /// @note Phases run on worker threads are timed by wall clock as a whole, not summed per area.
     struct AreaLoadProfile {
         int64_t demand_ms = 0;
+        int64_t parse_ms = 0;
         int64_t deserialize_ms = 0;
+        int64_t instantiate_ms = 0;
+        uint32_t areas = 0;
+        uint32_t deferred_areas = 0; ///< Areas registered to be loaded on first access
         uint32_t creatures = 0;
         uint32_t doors = 0;
         uint32_t encounters = 0;
@@ -164,9 +177,30 @@ struct ObjectManager : public kernel::Service {
         uint32_t waypoints = 0;
     };
 
+    /// Area resources demanded and parsed, but not yet turned into objects
+    struct AreaSource {
+        Resref resref;
+        ModuleResourceFormat format = ModuleResourceFormat::invalid;
+        std::unique_ptr<Gff> are;
+        std::unique_ptr<Gff> git;
+        std::unique_ptr<Gff> gic;
+        nlohmann::json caf;
+        bool valid = false;
+    };
+
+    /// Gets the resources an area is loaded from
+    static Vector<Resource> area_resources(Resref area, ModuleResourceFormat format);
+
+    /// Parses demanded area resources, ordered as ``area_resources``
+    /// @note Touches no kernel state, safe to call from any thread.
+    static AreaSource parse_area(Resref area, ModuleResourceFormat format, std::span<ResourceData> data);
+
     /// Creates an area object
     Area* make_area(Resref area, AreaLoadProfile* profile = nullptr);
 
+    /// Creates an area object from a parsed source
+    Area* make_area(AreaSource& source, AreaLoadProfile* profile = nullptr);
+
     /// Creates a module object
     /// @warning: `nw::kernel::resman().load_module(...)` **must** be called before this.
     Module* make_module();
@@ -404,4 +438,18 @@ T* ObjectManager::load_instance(const nlohmann::json& archive)
     return nullptr;
 }
 
+template <typename T, typename Decode>
+T* ObjectManager::load_instance_with(Decode&& decode)
+{
+    auto ob = make<T>();
+    if (ob && decode(ob) && ob->instantiate()) {
+        if (auto tag = ob->tag) {
+            object_tag_map_.insert({tag, ob->handle()});
+        }
+        return ob;
+    }
+    if (ob) { destroy(ob->handle()); }
+    return nullptr;
+}
+
 } // namespace nw
@@ -0,0 +1,921 @@
+#include "ObjectSnapshot.hpp"
+
+#include "Area.hpp"
+#include "Creature.hpp"
+#include "Door.hpp"
+#include "Encounter.hpp"
+#include "Item.hpp"
+#include "ObjectManager.hpp"
+#include "Placeable.hpp"
+#include "Sound.hpp"
+#include "Store.hpp"
+#include "Trigger.hpp"
+#include "Waypoint.hpp"
+
+#include "../kernel/Kernel.hpp"
+#include "../kernel/Strings.hpp"
+#include "../log.hpp"
+#include "../rules/effects.hpp"
+#include "../smalls/propset_binary.hpp"
+#include "../smalls/runtime.hpp"
+#include "../util/BinaryStream.hpp"
+#include "../util/MappedFile.hpp"
+
+#include "xxhash/xxh3.h"
+
+#include <absl/container/flat_hash_map.h>
+
+#include <array>
+#include <cstring>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace nw {
+
+namespace {
+
+/// @cond NEVER
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t schema;
+    uint32_t record_count;
+    uint32_t record_size;
+    uint64_t data_offset;
+    uint32_t propset_count; ///< Entries of the propset table, between the records and ``data_offset``
+    uint32_t area; ///< ID of the snapshotted area, locations in it are moved to the restoring area
+};
+
+struct SnapshotRecord {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset; ///< Offset of the object's encoding from ``data_offset``
+    uint64_t size;
+};
+
+/// Components present in an object's encoding, each is written in this order when present
+struct SnapshotSection {
+    enum type : uint32_t {
+        locals = 1u << 0,
+        ability_loadout = 1u << 1,
+        geometry = 1u << 2,
+        inventory = 1u << 3,
+        equipment = 1u << 4,
+        item_properties = 1u << 5,
+        item_visuals = 1u << 6,
+        store_inventory = 1u << 7,
+        spatial = 1u << 8,
+        in_area = 1u << 9,
+        vitals = 1u << 10,
+        effects = 1u << 11,
+    };
+};
+/// @endcond
+
+static_assert(sizeof(SnapshotHeader) == 40);
+static_assert(sizeof(SnapshotRecord) == 24);
+
+constexpr char snapshot_magic[4] = {'N', 'W', 'O', 'S'};
+
+// Any change to what is encoded or how must be reflected here.  Propset layouts are not part of the schema,
+// the propset table carries a layout hash per propset.
+constexpr StringView record_schema = "record:type:u32,reserved:u32,offset:u64,size:u64 "
+                                     "propset:name:str,layout:u64 "
+                                     "object:sections:u32,id:u32,resref:str,tag:str,name:locstring,comment:str,"
+                                     "palette_id:u8,uuid:u8[16],locals,ability_loadout,geometry,inventory,"
+                                     "equipment,item_properties,item_visuals,store_inventory,propsets,"
+                                     "spatial,vitals,effects "
+                                     "locals:[type:u8,name:str,value] "
+                                     "inventory:[x:u16,y:u16,infinite:u8,object] equipment:mask:u32,[object] "
+                                     "spatial:position:vec3,orientation:vec3,scale:vec3,velocity:vec3,"
+                                     "angular_velocity:vec3,flags:u32,faction:u32 "
+                                     "vitals:hp_current:i32,hp_max:i32 "
+                                     "effects:count:u32,[effect:binary]";
+
+constexpr size_t equip_slot_count = 18;
+
+bool range_contains(size_t file_size, uint64_t offset, uint64_t size) noexcept
+{
+    if (offset > file_size) { return false; }
+    return size <= file_size - offset;
+}
+
+Inventory* object_inventory(ObjectBase& obj)
+{
+    if (auto* creature = obj.as_creature()) { return &creature->inventory(); }
+    if (auto* item = obj.as_item()) { return &item->inventory(); }
+    if (auto* placeable = obj.as_placeable()) { return &placeable->inventory(); }
+    return nullptr;
+}
+
+template <typename Callback>
+void visit_area_objects(const Area* area, Callback&& callback)
+{
+    for (auto* it : area->creatures) { callback(it); }
+    for (auto* it : area->doors) { callback(it); }
+    for (auto* it : area->encounters) { callback(it); }
+    for (auto* it : area->items) { callback(it); }
+    for (auto* it : area->placeables) { callback(it); }
+    for (auto* it : area->sounds) { callback(it); }
+    for (auto* it : area->stores) { callback(it); }
+    for (auto* it : area->triggers) { callback(it); }
+    for (auto* it : area->waypoints) { callback(it); }
+}
+
+// == Propsets ================================================================
+
+// Objects refer to their propsets by index into the snapshot's propset table
+struct PropsetTable {
+    struct Entry {
+        uint16_t index;
+        smalls::TypeID type;
+        const smalls::StructDef* def;
+    };
+
+    const Vector<Entry>& entries(smalls::Runtime& rt, ObjectType object_type)
+    {
+        auto [it, inserted] = by_object_type.try_emplace(static_cast<uint32_t>(object_type));
+        if (!inserted) { return it->second; }
+
+        std::vector<smalls::TypeID> propset_types;
+        rt.object_propset_types(object_type, propset_types);
+        for (smalls::TypeID tid : propset_types) {
+            const smalls::StructDef* def = rt.get_struct_def(tid);
+            if (!def || !def->is_propset || def->is_transient) { continue; }
+
+            auto [index, added] = indices.try_emplace(tid, static_cast<uint16_t>(types.size()));
+            if (added) { types.push_back(tid); }
+            it->second.push_back(Entry{index->second, tid, def});
+        }
+        return it->second;
+    }
+
+    Vector<smalls::TypeID> types; ///< Table order
+    absl::flat_hash_map<smalls::TypeID, uint16_t> indices;
+    absl::flat_hash_map<uint32_t, Vector<Entry>> by_object_type;
+};
+
+struct ResolvedPropset {
+    smalls::TypeID type;
+    const smalls::StructDef* def = nullptr;
+};
+
+// == SnapshotWriter ==========================================================
+
+struct SnapshotWriter {
+    BinaryWriter& out;
+    smalls::Runtime& rt;
+    PropsetTable& propsets;
+
+    void locstring(const LocString& value)
+    {
+        out.pod(value.strref());
+        out.pod(static_cast<uint32_t>(value.size()));
+        for (const auto& [lang, string] : value) {
+            out.pod(lang);
+            out.str(string);
+        }
+    }
+
+    void object(const ObjectBase* obj, const Area* area);
+    void inventory(const Inventory& inventory);
+};
+
+void SnapshotWriter::object(const ObjectBase* obj, const Area* area)
+{
+    const auto& components = kernel::objects().components();
+    const auto handle = obj->handle();
+    const auto* spatial = components.find_spatial(handle);
+    const auto* vitals = components.find_vitals(handle);
+    const auto* locals = components.find_locals(handle);
+    const auto* loadout = components.find_ability_loadout(handle);
+    const auto* geometry = components.find_geometry(handle);
+    const auto* inventory = components.find_inventory(*obj);
+    const auto* item_properties = components.find_item_properties(handle);
+    const auto* item_visuals = components.find_item_visuals(handle);
+    const auto* store = components.find_store_inventory(*obj);
+    const auto* creature = obj->as_creature();
+
+    // Item property effects are re-applied when equipment instantiates
+    uint32_t effect_count = 0;
+    for (const auto& it : obj->effects()) {
+        effect_count += it.effect && it.category != EffectCategory::item;
+    }
+
+    uint32_t equip_mask = 0;
+    for (size_t i = 0; creature && i < equip_slot_count; ++i) {
+        if (equip_item_ptr(creature->equipment.equips[i])) { equip_mask |= 1u << i; }
+    }
+
+    uint32_t sections = 0;
+    if (locals && locals->size()) { sections |= SnapshotSection::locals; }
+    if (loadout && !loadout->entries.empty()) { sections |= SnapshotSection::ability_loadout; }
+    if (geometry) { sections |= SnapshotSection::geometry; }
+    if (inventory) { sections |= SnapshotSection::inventory; }
+    if (equip_mask) { sections |= SnapshotSection::equipment; }
+    if (item_properties) { sections |= SnapshotSection::item_properties; }
+    if (item_visuals) { sections |= SnapshotSection::item_visuals; }
+    if (store) { sections |= SnapshotSection::store_inventory; }
+    if (spatial) {
+        sections |= SnapshotSection::spatial;
+        if (area && spatial->area != object_invalid && spatial->area == area->handle().id) {
+            sections |= SnapshotSection::in_area;
+        }
+    }
+    if (vitals) { sections |= SnapshotSection::vitals; }
+    if (effect_count) { sections |= SnapshotSection::effects; }
+
+    out.pod(sections);
+    out.pod(static_cast<uint32_t>(handle.id));
+    out.str(obj->resref.view());
+    out.str(obj->tag.view());
+    locstring(obj->name);
+    out.str(obj->comment);
+    out.pod(obj->palette_id);
+    const auto uuid = obj->uuid.as_bytes();
+    out.bytes(uuid.data(), uuid.size());
+
+    if (sections & SnapshotSection::locals) {
+        out.pod(static_cast<uint32_t>(locals->size()));
+        locals->for_each([this](uint32_t type, LocalKey key, const auto& value) {
+            out.pod(static_cast<uint8_t>(type));
+            out.str(key.name());
+            if constexpr (std::is_same_v<std::decay_t<decltype(value)>, String>) {
+                out.str(value);
+            } else {
+                out.pod(value);
+            }
+        });
+    }
+    if (sections & SnapshotSection::ability_loadout) {
+        out.pods(loadout->entries);
+    }
+    if (sections & SnapshotSection::geometry) {
+        out.pod(geometry->highlight_height);
+        out.pods(geometry->points);
+        out.pods(geometry->spawn_points);
+    }
+    if (sections & SnapshotSection::inventory) {
+        this->inventory(*inventory);
+    }
+    if (sections & SnapshotSection::equipment) {
+        out.pod(equip_mask);
+        for (size_t i = 0; i < equip_slot_count; ++i) {
+            if (auto* item = equip_item_ptr(creature->equipment.equips[i])) { object(item, nullptr); }
+        }
+    }
+    if (sections & SnapshotSection::item_properties) {
+        out.pod(static_cast<uint32_t>(item_properties->entries.size()));
+        for (const auto& property : item_properties->entries) {
+            out.pod(property.type);
+            out.pod(property.subtype);
+            out.pod(property.cost_table);
+            out.pod(property.cost_value);
+            out.pod(property.param_table);
+            out.pod(property.param_value);
+            out.str(property.tag);
+        }
+    }
+    if (sections & SnapshotSection::item_visuals) {
+        out.pod(item_visuals->model_colors);
+        out.pod(item_visuals->model_parts);
+        out.pod(item_visuals->part_colors);
+    }
+    if (sections & SnapshotSection::store_inventory) {
+        this->inventory(store->armor);
+        this->inventory(store->miscellaneous);
+        this->inventory(store->potions);
+        this->inventory(store->rings);
+        this->inventory(store->weapons);
+        out.pods(store->will_not_buy);
+        out.pods(store->will_only_buy);
+    }
+
+    // The count is patched in case a propset has no instance for this object
+    const auto& entries = propsets.entries(rt, handle.type);
+    const size_t count_pos = out.reserve<uint16_t>();
+    uint16_t propset_count = 0;
+    smalls::BinarySerializer serializer{&rt};
+    for (const auto& entry : entries) {
+        smalls::Value ref = rt.find_propset_ref(entry.type, handle);
+        if (ref.type_id == smalls::invalid_type_id) { continue; }
+        out.pod(entry.index);
+        serializer.serialize(ref, entry.def, out);
+        ++propset_count;
+    }
+    out.patch(count_pos, propset_count);
+
+    if (sections & SnapshotSection::spatial) {
+        out.pod(spatial->position);
+        out.pod(spatial->orientation);
+        out.pod(spatial->scale);
+        out.pod(spatial->velocity);
+        out.pod(spatial->angular_velocity);
+        out.pod(spatial->flags);
+        out.pod(spatial->faction);
+    }
+    if (sections & SnapshotSection::vitals) {
+        out.pod(vitals->hp_current);
+        out.pod(vitals->hp_max);
+    }
+    if (sections & SnapshotSection::effects) {
+        out.pod(effect_count);
+        for (const auto& it : obj->effects()) {
+            if (it.effect && it.category != EffectCategory::item) { serialize(it.effect, out); }
+        }
+    }
+}
+
+void SnapshotWriter::inventory(const Inventory& inventory)
+{
+    uint32_t count = 0;
+    for (const auto& it : inventory.items) { count += !!inventory_item_ptr(it); }
+
+    out.pod(count);
+    for (const auto& it : inventory.items) {
+        auto* item = inventory_item_ptr(it);
+        if (!item) { continue; }
+        out.pod(it.pos_x);
+        out.pod(it.pos_y);
+        out.pod(static_cast<uint8_t>(it.infinite));
+        object(item, nullptr);
+    }
+}
+
+// == SnapshotStaging =========================================================
+
+// Restored objects are kept out of the area until every record decoded, a snapshot that fails partway
+// leaves the area as it was.
+struct SnapshotStaging {
+    Vector<Creature*> creatures;
+    Vector<Door*> doors;
+    Vector<Encounter*> encounters;
+    Vector<Item*> items;
+    Vector<Placeable*> placeables;
+    Vector<Sound*> sounds;
+    Vector<Store*> stores;
+    Vector<Trigger*> triggers;
+    Vector<Waypoint*> waypoints;
+
+    Vector<ObjectHandle> created; ///< Every restored object, including inventory and equipment items
+    absl::flat_hash_map<ObjectID, ObjectHandle> ids; ///< Snapshot object IDs to restored handles
+    Vector<std::pair<ObjectHandle, Vector<Effect*>>> effects; ///< Applied once creators are remapped
+
+    ObjectID source_area = object_invalid;
+    ObjectID target_area = object_invalid;
+
+    ObjectID remap(ObjectID id) const
+    {
+        if (id == source_area) { return target_area; }
+        auto it = ids.find(id);
+        return it != ids.end() ? it->second.id : id;
+    }
+
+    ObjectHandle remap(ObjectHandle handle) const
+    {
+        auto it = ids.find(handle.id);
+        return it != ids.end() ? it->second : handle;
+    }
+
+    void commit(Area* area);
+    void discard();
+    void remap_references();
+};
+
+// Object IDs held by locals and effects refer to objects as they were when the snapshot was written.
+// IDs of objects outside the snapshot are kept as they are.
+void SnapshotStaging::remap_references()
+{
+    auto& components = kernel::objects().components();
+    Vector<std::pair<LocalKey, ObjectID>> objects;
+    Vector<std::pair<LocalKey, Location>> locations;
+    for (const auto handle : created) {
+        auto* locals = components.find_locals(handle);
+        if (!locals) { continue; }
+
+        objects.clear();
+        locations.clear();
+        locals->for_each([&](uint32_t, LocalKey key, const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, ObjectID>) {
+                objects.emplace_back(key, value);
+            } else if constexpr (std::is_same_v<T, Location>) {
+                locations.emplace_back(key, value);
+            }
+        });
+        for (auto& [key, value] : objects) { locals->set_object(key, remap(value)); }
+        for (auto& [key, value] : locations) {
+            value.area = remap(value.area);
+            locals->set_location(key, value);
+        }
+    }
+
+    for (auto& [handle, list] : effects) {
+        for (auto* effect : list) { effect->handle().creator = remap(effect->handle().creator); }
+    }
+}
+
+void SnapshotStaging::commit(Area* area)
+{
+    remap_references();
+
+    area->clear();
+    area->creatures = std::move(creatures);
+    area->doors = std::move(doors);
+    area->encounters = std::move(encounters);
+    area->items = std::move(items);
+    area->placeables = std::move(placeables);
+    area->sounds = std::move(sounds);
+    area->stores = std::move(stores);
+    area->triggers = std::move(triggers);
+    area->waypoints = std::move(waypoints);
+
+    auto& system = kernel::effects();
+    Vector<Effect*> failed;
+    for (auto& [handle, list] : effects) {
+        failed.clear();
+        auto* obj = kernel::objects().get_object_base(handle);
+        if (obj) {
+            system.apply_to(obj, list, &failed);
+        } else {
+            failed = std::move(list);
+        }
+        for (auto* effect : failed) { system.destroy(effect); }
+    }
+    effects.clear();
+}
+
+void SnapshotStaging::discard()
+{
+    auto& system = kernel::effects();
+    for (auto& [handle, list] : effects) {
+        for (auto* effect : list) { system.destroy(effect); }
+    }
+    effects.clear();
+
+    // Destroying a stale handle does nothing, items already destroyed with their owner are skipped
+    for (auto it = created.rbegin(); it != created.rend(); ++it) {
+        kernel::objects().destroy(*it);
+    }
+    created.clear();
+}
+
+// == SnapshotReader ==========================================================
+
+struct SnapshotReader {
+    BinaryReader& in;
+    smalls::Runtime& rt;
+    std::span<const ResolvedPropset> propsets;
+    SnapshotStaging& staging;
+
+    LocString locstring()
+    {
+        LocString result{in.pod<uint32_t>()};
+        const auto n = in.count(2 * sizeof(uint32_t));
+        for (uint32_t i = 0; i < n && in.ok(); ++i) {
+            const auto lang = in.pod<uint32_t>();
+            auto string = in.str();
+            auto base_lang = Language::to_base_id(lang);
+            result.add(base_lang.first, string, base_lang.second);
+        }
+        return result;
+    }
+
+    template <typename T>
+    T* object();
+    bool object_body(ObjectBase* obj, uint32_t sections);
+    bool object_state(ObjectBase* obj, uint32_t sections);
+    bool inventory(Inventory& inventory);
+};
+
+// Component state derived from other state, i.e. location and vitals, is applied after the object is
+// instantiated so that it wins over anything instantiation derives.
+template <typename T>
+T* SnapshotReader::object()
+{
+    uint32_t sections = 0;
+    ObjectID id = object_invalid;
+    T* obj = kernel::objects().load_instance_with<T>([&](T* ob) {
+        sections = in.pod<uint32_t>();
+        id = static_cast<ObjectID>(in.pod<uint32_t>());
+        return object_body(ob, sections);
+    });
+    if (!obj) {
+        in.fail();
+        return nullptr;
+    }
+
+    staging.created.push_back(obj->handle());
+    staging.ids[id] = obj->handle();
+    if (!object_state(obj, sections)) {
+        in.fail();
+        return nullptr;
+    }
+    return obj;
+}
+
+bool SnapshotReader::object_body(ObjectBase* obj, uint32_t sections)
+{
+    obj->resref = Resref{in.str()};
+    auto tag = in.str();
+    obj->tag = tag.empty() ? InternedString{} : kernel::strings().intern(tag);
+    obj->name = locstring();
+    obj->comment = String{in.str()};
+    obj->palette_id = in.pod<uint8_t>();
+    std::array<uint8_t, 16> uuid{};
+    in.bytes(uuid.data(), uuid.size());
+    obj->uuid = uuids::uuid{uuid.begin(), uuid.end()};
+    if (!in.ok()) { return false; }
+
+    auto& components = kernel::objects().components();
+    const auto handle = obj->handle();
+    if (sections & SnapshotSection::locals) {
+        auto* locals = components.get_or_create_locals(handle);
+        if (!locals) { return false; }
+        const auto n = in.count(sizeof(uint8_t) + sizeof(uint32_t));
+        for (uint32_t i = 0; i < n && in.ok(); ++i) {
+            const auto type = in.pod<uint8_t>();
+            const LocalKey key{in.str()};
+            switch (type) {
+            default:
+                in.fail();
+                break;
+            case LocalVarType::integer:
+                locals->set_int(key, in.pod<int32_t>());
+                break;
+            case LocalVarType::float_:
+                locals->set_float(key, in.pod<float>());
+                break;
+            case LocalVarType::string:
+                locals->set_string(key, in.str());
+                break;
+            case LocalVarType::object:
+                locals->set_object(key, in.pod<ObjectID>());
+                break;
+            case LocalVarType::location:
+                locals->set_location(key, in.pod<Location>());
+                break;
+            }
+        }
+    }
+    if (sections & SnapshotSection::ability_loadout) {
+        Vector<ObjectAbilityLoadoutEntry> entries;
+        in.pods(entries);
+        if (!in.ok() || !components.set_ability_loadout(handle, entries)) { return false; }
+    }
+    if (sections & SnapshotSection::geometry) {
+        const auto highlight_height = in.pod<float>();
+        Vector<glm::vec3> points;
+        in.pods(points);
+        Vector<ObjectSpawnPoint> spawn_points;
+        in.pods(spawn_points);
+        if (!in.ok()
+            || !components.set_geometry(handle, points)
+            || !components.set_spawn_points(handle, spawn_points)
+            || !components.set_highlight_height(handle, highlight_height)) {
+            return false;
+        }
+    }
+    if (sections & SnapshotSection::inventory) {
+        auto* inventory = object_inventory(*obj);
+        if (!inventory || !this->inventory(*inventory)) { return false; }
+    }
+    if (sections & SnapshotSection::equipment) {
+        auto* creature = obj->as_creature();
+        if (!creature) { return false; }
+        const auto mask = in.pod<uint32_t>();
+        for (size_t i = 0; i < equip_slot_count && in.ok(); ++i) {
+            if (!(mask & (1u << i))) { continue; }
+            auto* item = object<Item>();
+            if (!item) { return false; }
+            creature->equipment.equips[i] = item->handle();
+        }
+    }
+    if (sections & SnapshotSection::item_properties) {
+        Vector<ItemProperty> properties;
+        const auto n = in.count(9 + sizeof(uint32_t));
+        properties.reserve(n);
+        for (uint32_t i = 0; i < n && in.ok(); ++i) {
+            auto& property = properties.emplace_back();
+            property.type = in.pod<uint16_t>();
+            property.subtype = in.pod<uint16_t>();
+            property.cost_table = in.pod<uint8_t>();
+            property.cost_value = in.pod<uint16_t>();
+            property.param_table = in.pod<uint8_t>();
+            property.param_value = in.pod<uint8_t>();
+            property.tag = std::string{in.str()};
+        }
+        if (!in.ok() || !components.set_item_properties(handle, properties)) { return false; }
+    }
+    if (sections & SnapshotSection::item_visuals) {
+        auto model_colors = in.pod<decltype(ObjectItemVisualState::model_colors)>();
+        auto model_parts = in.pod<decltype(ObjectItemVisualState::model_parts)>();
+        auto part_colors = in.pod<decltype(ObjectItemVisualState::part_colors)>();
+        if (!in.ok() || !components.set_item_visuals(handle, model_colors, model_parts, part_colors)) {
+            return false;
+        }
+    }
+    if (sections & SnapshotSection::store_inventory) {
+        auto* store = obj->as_store();
+        if (!store) { return false; }
+        auto& inventory = store->inventory();
+        if (!this->inventory(inventory.armor)
+            || !this->inventory(inventory.miscellaneous)
+            || !this->inventory(inventory.potions)
+            || !this->inventory(inventory.rings)
+            || !this->inventory(inventory.weapons)) {
+            return false;
+        }
+        in.pods(inventory.will_not_buy);
+        in.pods(inventory.will_only_buy);
+    }
+
+    rt.init_object_propsets(handle);
+    const auto propset_count = in.pod<uint16_t>();
+    smalls::BinarySerializer serializer{&rt};
+    for (uint16_t i = 0; i < propset_count && in.ok(); ++i) {
+        const auto index = in.pod<uint16_t>();
+        if (!in.ok() || index >= propsets.size()) { return false; }
+        smalls::Value ref = rt.get_or_create_propset_ref(propsets[index].type, handle);
+        if (ref.type_id == smalls::invalid_type_id || !serializer.deserialize(in, ref, propsets[index].def)) {
+            return false;
+        }
+    }
+    return in.ok();
+}
+
+bool SnapshotReader::object_state(ObjectBase* obj, uint32_t sections)
+{
+    auto& components = kernel::objects().components();
+    const auto handle = obj->handle();
+    if (sections & SnapshotSection::spatial) {
+        Location location;
+        location.position = in.pod<glm::vec3>();
+        location.orientation = in.pod<glm::vec3>();
+        const auto scale = in.pod<glm::vec3>();
+        const auto velocity = in.pod<glm::vec3>();
+        const auto angular_velocity = in.pod<glm::vec3>();
+        const auto flags = in.pod<uint32_t>();
+        const auto faction = in.pod<uint32_t>();
+        if (!in.ok()) { return false; }
+
+        auto* spatial = components.get_or_create_spatial(handle);
+        if (!spatial) { return false; }
+        spatial->scale = scale;
+        spatial->velocity = velocity;
+        spatial->angular_velocity = angular_velocity;
+        spatial->flags = flags;
+
+        // Location and faction go through their setters so the area spatial index follows
+        location.area = (sections & SnapshotSection::in_area) ? staging.target_area : spatial->area;
+        components.set_faction(handle, faction);
+        components.set_location(handle, location);
+    }
+    if (sections & SnapshotSection::vitals) {
+        const auto hp_current = in.pod<int32_t>();
+        const auto hp_max = in.pod<int32_t>();
+        if (!in.ok()) { return false; }
+        components.set_vitals(handle, hp_current, hp_max);
+    }
+    if (sections & SnapshotSection::effects) {
+        auto& system = kernel::effects();
+        auto& [owner, effects] = staging.effects.emplace_back(handle, Vector<Effect*>{});
+        const auto n = in.count();
+        effects.reserve(n);
+        for (uint32_t i = 0; i < n && in.ok(); ++i) {
+            auto* effect = system.create(EffectType::invalid());
+            if (!effect) { return false; }
+            effects.push_back(effect);
+            if (!deserialize(effect, in)) { return false; }
+        }
+    }
+    return in.ok();
+}
+
+bool SnapshotReader::inventory(Inventory& inventory)
+{
+    const auto n = in.count(2 * sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint32_t));
+    for (uint32_t i = 0; i < n && in.ok(); ++i) {
+        InventoryItem ii;
+        ii.pos_x = in.pod<uint16_t>();
+        ii.pos_y = in.pod<uint16_t>();
+        ii.infinite = in.pod<uint8_t>() != 0;
+        auto* item = object<Item>();
+        if (!item) { return false; }
+        ii.item = item->handle();
+        inventory.items.push_back(std::move(ii));
+    }
+    return in.ok();
+}
+
+ObjectBase* restore_object(SnapshotReader& reader, ObjectType type)
+{
+    auto restore = [&reader]<typename T>(Vector<T*>& holder) -> ObjectBase* {
+        auto obj = reader.object<T>();
+        if (obj) { holder.push_back(obj); }
+        return obj;
+    };
+
+    auto& staging = reader.staging;
+    switch (type) {
+    default:
+        return nullptr;
+    case ObjectType::creature:
+        return restore(staging.creatures);
+    case ObjectType::door:
+        return restore(staging.doors);
+    case ObjectType::encounter:
+        return restore(staging.encounters);
+    case ObjectType::item:
+        return restore(staging.items);
+    case ObjectType::placeable:
+        return restore(staging.placeables);
+    case ObjectType::sound:
+        return restore(staging.sounds);
+    case ObjectType::store:
+        return restore(staging.stores);
+    case ObjectType::trigger:
+        return restore(staging.triggers);
+    case ObjectType::waypoint:
+        return restore(staging.waypoints);
+    }
+}
+
+bool restore_snapshot(Area* area, std::span<const uint8_t> bytes)
+{
+    if (!area) { return false; }
+
+    SnapshotHeader header;
+    if (!range_contains(bytes.size(), 0, sizeof(header))) {
+        LOG_F(WARNING, "[objects] area snapshot is truncated");
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, snapshot_magic, 4) != 0
+        || header.version != AreaSnapshot::version
+        || header.schema != AreaSnapshot::schema()
+        || header.record_size != sizeof(SnapshotRecord)) {
+        LOG_F(WARNING, "[objects] area snapshot has an unsupported version or schema");
+        return false;
+    }
+
+    const uint64_t records_end = sizeof(SnapshotHeader) + uint64_t(header.record_count) * sizeof(SnapshotRecord);
+    if (!range_contains(bytes.size(), 0, records_end)
+        || header.data_offset < records_end
+        || !range_contains(bytes.size(), 0, header.data_offset)) {
+        LOG_F(WARNING, "[objects] area snapshot is corrupt");
+        return false;
+    }
+
+    Vector<SnapshotRecord> records(header.record_count);
+    std::memcpy(records.data(), bytes.data() + sizeof(SnapshotHeader), records.size() * sizeof(SnapshotRecord));
+    const auto data = bytes.subspan(header.data_offset);
+    for (const auto& rec : records) {
+        if (!range_contains(data.size(), rec.offset, rec.size)) {
+            LOG_F(WARNING, "[objects] area snapshot is corrupt");
+            return false;
+        }
+    }
+
+    // Propsets are resolved by name, a propset whose layout changed since the snapshot was written is rejected
+    auto& rt = kernel::runtime();
+    smalls::BinarySerializer serializer{&rt};
+    Vector<ResolvedPropset> propsets;
+    BinaryReader table{bytes.first(header.data_offset), records_end};
+    for (uint32_t i = 0; i < header.propset_count; ++i) {
+        auto name = table.str();
+        const auto layout = table.pod<uint64_t>();
+        if (!table.ok()) {
+            LOG_F(WARNING, "[objects] area snapshot is corrupt");
+            return false;
+        }
+        ResolvedPropset propset;
+        propset.type = rt.type_id(name, false);
+        propset.def = rt.get_struct_def(propset.type);
+        if (!propset.def || serializer.layout_hash(propset.def) != layout) {
+            LOG_F(WARNING, "[objects] area snapshot propset '{}' is missing or has changed", name);
+            return false;
+        }
+        propsets.push_back(propset);
+    }
+
+    SnapshotStaging staging;
+    staging.source_area = static_cast<ObjectID>(header.area);
+    staging.target_area = area->handle().id;
+    for (const auto& rec : records) {
+        BinaryReader in{data.subspan(rec.offset, rec.size)};
+        SnapshotReader reader{in, rt, propsets, staging};
+        if (!restore_object(reader, static_cast<ObjectType>(rec.type))) {
+            LOG_F(WARNING, "[objects] unable to restore area snapshot object of type {}", rec.type);
+            staging.discard();
+            return false;
+        }
+    }
+
+    staging.commit(area);
+    return true;
+}
+
+} // namespace
+
+// == AreaSnapshot ============================================================
+// ============================================================================
+
+uint64_t AreaSnapshot::schema() noexcept
+{
+    return XXH3_64bits(record_schema.data(), record_schema.size());
+}
+
+ByteArray AreaSnapshot::write(const Area* area)
+{
+    ByteArray result;
+    if (!area) { return result; }
+
+    auto& rt = kernel::runtime();
+    PropsetTable propsets;
+    Vector<SnapshotRecord> records;
+    ByteArray data;
+    BinaryWriter data_writer{data};
+    SnapshotWriter writer{data_writer, rt, propsets};
+    visit_area_objects(area, [&](const ObjectBase* obj) {
+        if (!obj) { return; }
+        SnapshotRecord rec{};
+        rec.type = static_cast<uint32_t>(obj->handle().type);
+        rec.offset = data.size();
+        writer.object(obj, area);
+        rec.size = data.size() - rec.offset;
+        records.push_back(rec);
+    });
+
+    ByteArray table;
+    BinaryWriter table_writer{table};
+    smalls::BinarySerializer serializer{&rt};
+    for (smalls::TypeID tid : propsets.types) {
+        table_writer.str(rt.type_name(tid));
+        table_writer.pod(serializer.layout_hash(rt.get_struct_def(tid)));
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, 4);
+    header.version = AreaSnapshot::version;
+    header.schema = AreaSnapshot::schema();
+    header.record_count = static_cast<uint32_t>(records.size());
+    header.record_size = sizeof(SnapshotRecord);
+    header.propset_count = static_cast<uint32_t>(propsets.types.size());
+    header.area = static_cast<uint32_t>(area->handle().id);
+    header.data_offset = sizeof(SnapshotHeader) + records.size() * sizeof(SnapshotRecord) + table.size();
+
+    result.reserve(header.data_offset + data.size());
+    result.append(&header, sizeof(SnapshotHeader));
+    result.append(records.data(), records.size() * sizeof(SnapshotRecord));
+    result.append(table.data(), table.size());
+    result.append(data.data(), data.size());
+    return result;
+}
+
+bool AreaSnapshot::write(const Area* area, const fs::path& path)
+{
+    if (!area) { return false; }
+
+    auto bytes = write(area);
+
+    // Written beside the destination and renamed, a crash mid write leaves the previous snapshot intact.
+    std::error_code ec;
+    if (path.has_parent_path()) { fs::create_directories(path.parent_path(), ec); }
+    auto tmp = path;
+    tmp += ".tmp";
+    if (!bytes.write_to(tmp)) {
+        LOG_F(ERROR, "[objects] unable to write area snapshot '{}'", tmp);
+        fs::remove(tmp, ec);
+        return false;
+    }
+
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        LOG_F(ERROR, "[objects] unable to replace area snapshot '{}': {}", path, ec.message());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool AreaSnapshot::restore(Area* area, std::span<const uint8_t> bytes)
+{
+    return restore_snapshot(area, bytes);
+}
+
+bool AreaSnapshot::restore(Area* area, const fs::path& path)
+{
+    auto file = MappedFile::open(path);
+    if (!file) {
+        LOG_F(ERROR, "[objects] unable to map area snapshot '{}'", path);
+        return false;
+    }
+    return restore_snapshot(area, {file->data(), file->size()});
+}
+
+} // namespace nw
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../util/ByteArray.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace nw {
+
+struct Area;
+
+/// Binary snapshot of the dynamic object state of an area
+///
+/// A snapshot is a fixed width record table, a propset table and one binary encoding per object.  An
+/// object is encoded component by component: locals, ability loadout, geometry, inventories, equipment,
+/// item state, smalls propsets, the full spatial state, vitals and applied effects.  Snapshots are tagged
+/// with a format version and a schema hash of the encoding, and each propset with a hash of its layout,
+/// a snapshot written by an incompatible build is rejected rather than misread.
+struct AreaSnapshot {
+    static constexpr uint32_t version = 2;
+
+    /// Gets the schema hash of the object encoding
+    static uint64_t schema() noexcept;
+
+    /// Snapshots the objects of ``area``
+    static ByteArray write(const Area* area);
+
+    /// Snapshots the objects of ``area`` to a file
+    static bool write(const Area* area, const std::filesystem::path& path);
+
+    /// Replaces the objects of ``area`` with those in a snapshot
+    /// @note ``bytes`` must outlive the call, nothing is retained afterwards.  Object IDs held by locals
+    /// and effect creators are moved to the restored objects.  If any object fails to restore, ``area``
+    /// is left unchanged.
+    static bool restore(Area* area, std::span<const uint8_t> bytes);
+
+    /// Replaces the objects of ``area`` with those in a memory mapped snapshot file
+    static bool restore(Area* area, const std::filesystem::path& path);
+};
+
+} // namespace nw
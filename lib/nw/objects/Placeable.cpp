@@ -114,6 +114,9 @@ bool deserialize(Placeable* obj, const GffStruct& archive, SerializationProfile
     }
 
     nwn1::import_placeable_propsets_from_gff(&nw::kernel::runtime(), obj, archive, profile);
+    if (profile == SerializationProfile::savegame) {
+        nw::kernel::effects().deserialize_effects(obj, archive);
+    }
     return true;
 }
 
@@ -133,6 +136,9 @@ bool serialize(const Placeable* obj, GffBuilderStruct& archive, SerializationPro
     if (!nwn1::export_inventory_component_to_gff(*obj, archive, profile)) { return false; }
 
     nwn1::export_placeable_propsets_to_gff(&kernel::runtime(), obj, archive, profile);
+    if (profile == SerializationProfile::savegame) {
+        nw::kernel::effects().serialize_effects(obj, archive);
+    }
 
     return true;
 }
@@ -307,6 +307,16 @@ void initialize_creature_health(nw::smalls::Runtime& rt, nw::ObjectBase* obj)
     }
 }
 
+void initialize_creature_faction(nw::smalls::Runtime& rt, nw::ObjectBase* obj)
+{
+    nw::Vector<nw::smalls::Value> args;
+    args.push_back(nw::smalls::detail::make_value(&rt, obj->handle()));
+    auto result = rt.execute_script("nwn1.creature", "sync_creature_faction", args);
+    if (!result.ok()) {
+        LOG_F(WARNING, "nwn1: failed to initialize creature faction: {}", result.error_message);
+    }
+}
+
 void recompute_creature_available_spell_slots(nw::smalls::Runtime& rt, nw::ObjectBase* obj)
 {
     nw::Vector<nw::smalls::Value> args;
@@ -362,6 +372,7 @@ bool Profile::load_rules() const
             NW_PROFILE_SCOPE_N("nwn1::creature_post_instantiate");
             auto* cre = obj->as_creature();
             initialize_creature_health(rt, obj);
+            initialize_creature_faction(rt, obj);
             recompute_creature_available_spell_slots(rt, obj);
             refresh_combat_weapon_cache(cre);
             update_creature_visual_body(rt, obj);
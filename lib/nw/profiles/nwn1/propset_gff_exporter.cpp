@@ -22,6 +22,7 @@
 #include "../../util/HandlePool.hpp"
 #include "legacy_spellbook_gff.hpp"
 #include "propset_gff_object_io.hpp"
+#include "propset_gff_plan.hpp"
 
 #include <fmt/format.h>
 
@@ -164,19 +165,13 @@ bool PropsetGffExporter::export_object_propset(const nw::ObjectBase* obj, const
 {
     if (!obj || !qname || !rt_ || !registry_) { return false; }
 
-    const PropsetGffPolicy* policy = registry_->find(qname);
-    if (!policy) { return false; }
+    const auto plan = propset_gff_plan(rt_, registry_, qname, profile);
+    if (!plan) { return false; }
 
-    nw::smalls::TypeID tid = rt_->type_id(qname, false);
-    if (tid == nw::smalls::invalid_type_id) { return false; }
-
-    nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
+    nw::smalls::Value ref = rt_->get_or_create_propset_ref(plan->type_id, obj->handle());
     if (ref.type_id == nw::smalls::invalid_type_id) { return false; }
 
-    const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-    if (!def) { return false; }
-
-    return export_propset(ref, def, *policy, out, profile);
+    return export_propset(ref, *plan, out);
 }
 
 void PropsetGffExporter::export_creature(const nw::Creature* obj, nw::GffBuilderStruct& out,
@@ -256,19 +251,7 @@ void PropsetGffExporter::export_item(const nw::Item* obj, nw::GffBuilderStruct&
         "nwn1.propsets.ItemStats",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 
     export_item_properties(obj, out);
@@ -361,19 +344,7 @@ void PropsetGffExporter::export_door(const nw::Door* obj, nw::GffBuilderStruct&
         "nwn1.propsets.DoorState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 }
 
@@ -385,19 +356,7 @@ void PropsetGffExporter::export_encounter(const nw::Encounter* obj, nw::GffBuild
         "nwn1.propsets.EncounterState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 }
 
@@ -409,19 +368,7 @@ void PropsetGffExporter::export_placeable(const nw::Placeable* obj, nw::GffBuild
         "nwn1.propsets.PlaceableState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 }
 
@@ -433,19 +380,7 @@ void PropsetGffExporter::export_sound(const nw::Sound* obj, nw::GffBuilderStruct
         "nwn1.propsets.SoundState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 }
 
@@ -457,19 +392,7 @@ void PropsetGffExporter::export_store(const nw::Store* obj, nw::GffBuilderStruct
         "nwn1.propsets.StoreState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 }
 
@@ -481,19 +404,7 @@ void PropsetGffExporter::export_trigger(const nw::Trigger* obj, nw::GffBuilderSt
         "nwn1.propsets.TriggerState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 }
 
@@ -505,19 +416,7 @@ void PropsetGffExporter::export_waypoint(const nw::Waypoint* obj, nw::GffBuilder
         "nwn1.propsets.WaypointState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        export_propset(ref, def, *policy, out, profile);
+        export_object_propset(obj, qname, out, profile);
     }
 }
 
@@ -526,41 +425,27 @@ void PropsetGffExporter::export_waypoint(const nw::Waypoint* obj, nw::GffBuilder
 // ---------------------------------------------------------------------------
 
 bool PropsetGffExporter::export_propset(const nw::smalls::Value& ref,
-    const nw::smalls::StructDef* def,
-    const PropsetGffPolicy& policy,
-    nw::GffBuilderStruct& out,
-    nw::SerializationProfile profile) const
+    const PropsetGffPlan& plan,
+    nw::GffBuilderStruct& out) const
 {
-    for (const auto& fp : policy.fields) {
-        if (fp.encoding == GffEncoding::skip) { continue; }
-        if (fp.import_only) { continue; }
-        if (fp.instance_only && profile == nw::SerializationProfile::blueprint) { continue; }
-        if (fp.blueprint_only && profile != nw::SerializationProfile::blueprint) { continue; }
-
-        uint32_t idx_a = def->field_index(fp.propset_field_name);
-        if (idx_a == UINT32_MAX) { continue; }
-        const nw::smalls::FieldDef& field_a = def->fields[idx_a];
+    for (const auto& step : plan.steps) {
+        if (step.import_only) { continue; }
 
-        switch (fp.encoding) {
-        case GffEncoding::scalar:
-            export_scalar(fp, field_a, ref, out);
+        switch (step.op) {
+        case PropsetGffOp::scalar:
+            export_scalar(step, ref, out);
             break;
-        case GffEncoding::spread:
-            export_spread(fp, field_a, ref, out);
+        case PropsetGffOp::spread:
+            export_spread(plan, step, ref, out);
             break;
-        case GffEncoding::list_scalar:
-            export_list_scalar(fp, field_a, ref, out);
+        case PropsetGffOp::list_scalar:
+            export_list_scalar(plan, step, ref, out);
             break;
-        case GffEncoding::list_paired: {
-            uint32_t idx_b = def->field_index(fp.list_paired.propset_field_b);
-            if (idx_b == UINT32_MAX) { break; }
-            export_list_paired(fp, &field_a, &def->fields[idx_b], ref, out);
-            break;
-        }
-        case GffEncoding::list_struct:
-            export_list_struct(fp, field_a, ref, out);
+        case PropsetGffOp::list_paired:
+            export_list_paired(plan, step, ref, out);
             break;
-        case GffEncoding::skip:
+        case PropsetGffOp::list_struct:
+            export_list_struct(plan, step, ref, out);
             break;
         }
     }
@@ -617,71 +502,66 @@ nw::smalls::IArray* PropsetGffExporter::get_array(const nw::smalls::Value& ref,
     return rt_->object_pool().get_unmanaged_array(h);
 }
 
-void PropsetGffExporter::export_scalar(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+void PropsetGffExporter::write_scalar(nw::GffBuilderStruct& out, std::string_view label,
+    nw::SerializationType::type gff_type, const nw::smalls::FieldDef& field,
+    const nw::smalls::Value& ref) const
+{
+    if (label.empty()) { return; }
+    switch (gff_type) {
+    case nw::SerializationType::uint8:
+        out.add_field(label, static_cast<uint8_t>(read_int(ref, field.offset)));
+        break;
+    case nw::SerializationType::int8:
+        out.add_field(label, static_cast<int8_t>(read_int(ref, field.offset)));
+        break;
+    case nw::SerializationType::uint16:
+        out.add_field(label, static_cast<uint16_t>(read_int(ref, field.offset)));
+        break;
+    case nw::SerializationType::int16:
+        out.add_field(label, static_cast<int16_t>(read_int(ref, field.offset)));
+        break;
+    case nw::SerializationType::uint32:
+        out.add_field(label, static_cast<uint32_t>(read_int(ref, field.offset)));
+        break;
+    case nw::SerializationType::int32:
+        out.add_field(label, read_int(ref, field.offset));
+        break;
+    case nw::SerializationType::float_:
+        out.add_field(label, read_float(ref, field.offset));
+        break;
+    case nw::SerializationType::resref:
+        out.add_field(label, read_resref(ref, field));
+        break;
+    case nw::SerializationType::string:
+        out.add_field(label, read_string(ref, field));
+        break;
+    case nw::SerializationType::locstring:
+        out.add_field(label, read_locstring(ref, field));
+        break;
+    default:
+        break;
+    }
+}
+
+void PropsetGffExporter::export_scalar(const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     nw::GffBuilderStruct& out) const
 {
-    const auto& sm = fp.scalar;
-
-    auto emit = [&](const char* label, nw::SerializationType::type gff_type) {
-        if (!label) { return; }
-        switch (gff_type) {
-        case nw::SerializationType::uint8:
-            out.add_field(label, static_cast<uint8_t>(read_int(ref, field.offset)));
-            break;
-        case nw::SerializationType::int8:
-            out.add_field(label, static_cast<int8_t>(read_int(ref, field.offset)));
-            break;
-        case nw::SerializationType::uint16:
-            out.add_field(label, static_cast<uint16_t>(read_int(ref, field.offset)));
-            break;
-        case nw::SerializationType::int16:
-            out.add_field(label, static_cast<int16_t>(read_int(ref, field.offset)));
-            break;
-        case nw::SerializationType::uint32:
-            out.add_field(label, static_cast<uint32_t>(read_int(ref, field.offset)));
-            break;
-        case nw::SerializationType::int32:
-            out.add_field(label, read_int(ref, field.offset));
-            break;
-        case nw::SerializationType::float_:
-            out.add_field(label, read_float(ref, field.offset));
-            break;
-        case nw::SerializationType::resref:
-            out.add_field(label, read_resref(ref, field));
-            break;
-        case nw::SerializationType::string:
-            out.add_field(label, read_string(ref, field));
-            break;
-        case nw::SerializationType::locstring:
-            out.add_field(label, read_locstring(ref, field));
-            break;
-        default:
-            break;
-        }
-    };
-
-    emit(sm.gff_label, sm.gff_type);
+    write_scalar(out, step.gff_label, step.gff_type, *step.field, ref);
 
     // also_write: e.g. "StartingPackage" (uint8) alongside "xStartingPackage" (uint32).
-    if (sm.also_write_gff_label) {
-        emit(sm.also_write_gff_label, sm.also_write_gff_type);
-    }
+    write_scalar(out, step.also_write_gff_label, step.also_write_gff_type, *step.field, ref);
 }
 
-void PropsetGffExporter::export_spread(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+void PropsetGffExporter::export_spread(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     nw::GffBuilderStruct& out) const
 {
-    const auto& sm = fp.spread;
-    for (uint8_t i = 0; i < sm.count; ++i) {
-        const char* label = sm.gff_labels[i];
-        if (!label) { break; }
-        uint32_t offset = field.offset + uint32_t(i) * 4u;
-        int32_t v = read_int(ref, offset);
-        switch (sm.element_gff_type) {
+    for (uint32_t i = 0; i < step.count; ++i) {
+        std::string_view label = plan.labels[step.first + i];
+        int32_t v = read_int(ref, step.field->offset + i * 4u);
+        switch (step.gff_type) {
         case nw::SerializationType::uint8:
             out.add_field(label, static_cast<uint8_t>(v));
             break;
@@ -700,34 +580,34 @@ void PropsetGffExporter::export_spread(const FieldGffPolicy& fp,
     }
 }
 
-void PropsetGffExporter::export_list_scalar(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+void PropsetGffExporter::export_list_scalar(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     nw::GffBuilderStruct& out) const
 {
-    const auto& lm = fp.list_scalar;
-    nw::smalls::IArray* arr = get_array(ref, field);
+    nw::smalls::IArray* arr = get_array(ref, *step.field);
     if (!arr) { return; }
 
-    auto& gff_list = out.add_list(lm.list_name);
+    std::string_view element_field = plan.labels[step.first];
+    auto& gff_list = out.add_list(step.gff_label);
     size_t sz = arr->size();
     for (size_t i = 0; i < sz; ++i) {
         nw::smalls::Value v;
         if (!arr->get_value(i, v, *rt_)) { continue; }
-        auto& entry = gff_list.push_back(lm.gff_struct_id);
-        switch (lm.element_gff_type) {
+        auto& entry = gff_list.push_back(step.gff_struct_id);
+        switch (step.gff_type) {
         case nw::SerializationType::uint8:
-            entry.add_field(lm.element_field, static_cast<uint8_t>(v.data.ival));
+            entry.add_field(element_field, static_cast<uint8_t>(v.data.ival));
             break;
         case nw::SerializationType::uint16:
-            entry.add_field(lm.element_field, static_cast<uint16_t>(v.data.ival));
+            entry.add_field(element_field, static_cast<uint16_t>(v.data.ival));
             break;
         case nw::SerializationType::int32:
-            entry.add_field(lm.element_field, v.data.ival);
+            entry.add_field(element_field, v.data.ival);
             break;
         case nw::SerializationType::resref: {
             auto* ptr = static_cast<nw::Resref*>(rt_->get_value_data_ptr(v));
-            entry.add_field(lm.element_field, ptr ? *ptr : nw::Resref{});
+            entry.add_field(element_field, ptr ? *ptr : nw::Resref{});
             break;
         }
         default:
@@ -736,50 +616,43 @@ void PropsetGffExporter::export_list_scalar(const FieldGffPolicy& fp,
     }
 }
 
-void PropsetGffExporter::export_list_paired(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef* field_a,
-    const nw::smalls::FieldDef* field_b,
+void PropsetGffExporter::export_list_paired(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     nw::GffBuilderStruct& out) const
 {
-    const auto& lm = fp.list_paired;
-    auto& gff_list = out.add_list(lm.list_name);
-
-    // ClassList has 8 slots; skip trailing invalid entries (class value == -1).
-    // We determine the count from field_a (classes fixed array).
-    // Max is 8 slots (nwn1.propsets.CreatureLevels.classes).
-    for (size_t i = 0; i < 8; ++i) {
-        int32_t va = read_int(ref, field_a->offset + uint32_t(i) * 4u);
-        if (va == -1) { continue; } // skip invalid (sparse) class slots
-        int32_t vb = read_int(ref, field_b->offset + uint32_t(i) * 4u);
-        gff_list.push_back(lm.gff_struct_id)
-            .add_field(lm.field_a, static_cast<int32_t>(va))
-            .add_field(lm.field_b, static_cast<int32_t>(vb));
+    auto& gff_list = out.add_list(step.gff_label);
+    std::string_view label_a = plan.labels[step.first];
+    std::string_view label_b = plan.labels[step.first + 1];
+
+    // Slots are sparse, e.g. CreatureLevels.classes; skip invalid entries (value == -1).
+    for (uint32_t i = 0; i < step.slots; ++i) {
+        int32_t va = read_int(ref, step.field->offset + i * 4u);
+        if (va == -1) { continue; }
+        int32_t vb = read_int(ref, step.field_b->offset + i * 4u);
+        gff_list.push_back(step.gff_struct_id)
+            .add_field(label_a, va)
+            .add_field(label_b, vb);
     }
 }
 
-void PropsetGffExporter::export_list_struct(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+void PropsetGffExporter::export_list_struct(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     nw::GffBuilderStruct& out) const
 {
-    const auto& lm = fp.list_struct;
-    nw::smalls::IArray* arr = get_array(ref, field);
-    if (!arr) { return; }
-
-    const nw::smalls::StructDef* elem_def = rt_->get_struct_def(arr->element_type());
-    if (!elem_def) { return; }
+    nw::smalls::IArray* arr = get_array(ref, *step.field);
+    if (!arr || arr->element_type() != step.element_type) { return; }
 
-    auto& gff_list = out.add_list(lm.list_name);
+    auto& gff_list = out.add_list(step.gff_label);
     for (size_t i = 0; i < arr->size(); ++i) {
         nw::smalls::Value elem_value;
         if (!arr->get_value(i, elem_value, *rt_)) { continue; }
 
-        auto& entry = gff_list.push_back(lm.gff_struct_id);
-        for (const auto& fm : lm.fields) {
-            uint32_t idx = elem_def->field_index(fm.propset_field_name);
-            if (idx == UINT32_MAX) { continue; }
-            const nw::smalls::FieldDef& elem_field = elem_def->fields[idx];
+        auto& entry = gff_list.push_back(step.gff_struct_id);
+        for (uint32_t j = 0; j < step.count; ++j) {
+            const PropsetGffPlanElement& fm = plan.elements[step.first + j];
+            const nw::smalls::FieldDef& elem_field = *fm.field;
             switch (fm.gff_type) {
             case nw::SerializationType::uint8:
                 entry.add_field(fm.gff_label, static_cast<uint8_t>(read_int(elem_value, elem_field.offset)));
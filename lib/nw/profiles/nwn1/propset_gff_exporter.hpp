@@ -3,6 +3,8 @@
 #include "../../serialization/Serialization.hpp"
 #include "propset_gff_policy.hpp"
 
+#include <string_view>
+
 namespace nw {
 struct ObjectBase;
 struct Creature;
@@ -29,6 +31,9 @@ struct Value;
 
 namespace nwn1 {
 
+struct PropsetGffPlan;
+struct PropsetGffPlanStep;
+
 /// Propset → GFF exporter.
 ///
 /// Reads field values from propsets and writes them into a GffBuilderStruct.
@@ -69,28 +74,26 @@ private:
     nw::smalls::Runtime* rt_;
     const PropsetGffPolicyRegistry* registry_;
 
-    /// Export a single propset to a GffBuilderStruct using the given policy.
-    bool export_propset(const nw::smalls::Value& ref,
-        const nw::smalls::StructDef* def,
-        const PropsetGffPolicy& policy,
-        nw::GffBuilderStruct& out,
-        nw::SerializationProfile profile) const;
+    /// Export a single propset to a GffBuilderStruct through its compiled plan.
+    bool export_propset(const nw::smalls::Value& ref, const PropsetGffPlan& plan,
+        nw::GffBuilderStruct& out) const;
     void export_item_properties(const nw::Item* obj, nw::GffBuilderStruct& out) const;
     void export_item_visuals(const nw::Item* obj, nw::GffBuilderStruct& out,
         nw::SerializationProfile profile) const;
 
     // Encoding-specific helpers
-    void export_scalar(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    void write_scalar(nw::GffBuilderStruct& out, std::string_view label,
+        nw::SerializationType::type gff_type, const nw::smalls::FieldDef& field,
+        const nw::smalls::Value& ref) const;
+    void export_scalar(const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, nw::GffBuilderStruct& out) const;
-    void export_spread(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    void export_spread(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, nw::GffBuilderStruct& out) const;
-    void export_list_scalar(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    void export_list_scalar(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, nw::GffBuilderStruct& out) const;
-    void export_list_paired(const FieldGffPolicy& fp,
-        const nw::smalls::FieldDef* field_a,
-        const nw::smalls::FieldDef* field_b,
+    void export_list_paired(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, nw::GffBuilderStruct& out) const;
-    void export_list_struct(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    void export_list_struct(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, nw::GffBuilderStruct& out) const;
 
     // Helper: read int32 from a propset field
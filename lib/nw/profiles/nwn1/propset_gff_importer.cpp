@@ -22,6 +22,7 @@
 #include "../../smalls/runtime.hpp"
 #include "../../util/HandlePool.hpp"
 #include "propset_gff_object_io.hpp"
+#include "propset_gff_plan.hpp"
 
 #include <fmt/format.h>
 
@@ -115,16 +116,6 @@ PropsetGffImporter::PropsetGffImporter(nw::smalls::Runtime* rt,
     : rt_(rt)
     , registry_(registry)
 {
-    type_id_cache_.assign(registry_->policies().size(), nw::smalls::invalid_type_id);
-}
-
-nw::smalls::TypeID PropsetGffImporter::resolve_type_id(size_t idx) const
-{
-    if (idx >= type_id_cache_.size()) { return nw::smalls::invalid_type_id; }
-    if (type_id_cache_[idx] == nw::smalls::invalid_type_id) {
-        type_id_cache_[idx] = rt_->type_id(registry_->policies()[idx].qualified_name, false);
-    }
-    return type_id_cache_[idx];
 }
 
 // ---------------------------------------------------------------------------
@@ -144,19 +135,7 @@ void PropsetGffImporter::import_creature(nw::Creature* obj, const nw::GffStruct&
         "nwn1.propsets.CreatureCombat",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -169,19 +148,7 @@ void PropsetGffImporter::import_item(nw::Item* obj, const nw::GffStruct& gff,
         "nwn1.propsets.ItemStats",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
     import_item_properties(obj, gff);
     import_item_visuals(obj, gff);
@@ -195,19 +162,7 @@ void PropsetGffImporter::import_door(nw::Door* obj, const nw::GffStruct& gff,
         "nwn1.propsets.DoorState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -219,19 +174,7 @@ void PropsetGffImporter::import_encounter(nw::Encounter* obj, const nw::GffStruc
         "nwn1.propsets.EncounterState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -243,19 +186,7 @@ void PropsetGffImporter::import_placeable(nw::Placeable* obj, const nw::GffStruc
         "nwn1.propsets.PlaceableState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -267,19 +198,7 @@ void PropsetGffImporter::import_sound(nw::Sound* obj, const nw::GffStruct& gff,
         "nwn1.propsets.SoundState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -291,19 +210,7 @@ void PropsetGffImporter::import_store(nw::Store* obj, const nw::GffStruct& gff,
         "nwn1.propsets.StoreState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -315,19 +222,7 @@ void PropsetGffImporter::import_trigger(nw::Trigger* obj, const nw::GffStruct& g
         "nwn1.propsets.TriggerState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -339,19 +234,7 @@ void PropsetGffImporter::import_waypoint(nw::Waypoint* obj, const nw::GffStruct&
         "nwn1.propsets.WaypointState",
     };
     for (auto* qname : names) {
-        const PropsetGffPolicy* policy = registry_->find(qname);
-        if (!policy) { continue; }
-
-        nw::smalls::TypeID tid = rt_->type_id(qname, false);
-        if (tid == nw::smalls::invalid_type_id) { continue; }
-
-        nw::smalls::Value ref = rt_->get_or_create_propset_ref(tid, obj->handle());
-        if (ref.type_id == nw::smalls::invalid_type_id) { continue; }
-
-        const nw::smalls::StructDef* def = rt_->get_struct_def(tid);
-        if (!def) { continue; }
-
-        import_propset(ref, def, *policy, gff, profile);
+        import_object_propset(obj, qname, gff, profile);
     }
 }
 
@@ -359,42 +242,40 @@ void PropsetGffImporter::import_waypoint(nw::Waypoint* obj, const nw::GffStruct&
 // Core import logic
 // ---------------------------------------------------------------------------
 
+bool PropsetGffImporter::import_object_propset(const nw::ObjectBase* obj, const char* qname,
+    const nw::GffStruct& gff, nw::SerializationProfile profile) const
+{
+    if (!obj || !qname || !rt_ || !registry_) { return false; }
+
+    const auto plan = propset_gff_plan(rt_, registry_, qname, profile);
+    if (!plan) { return false; }
+
+    nw::smalls::Value ref = rt_->get_or_create_propset_ref(plan->type_id, obj->handle());
+    if (ref.type_id == nw::smalls::invalid_type_id) { return false; }
+
+    return import_propset(ref, *plan, gff);
+}
+
 bool PropsetGffImporter::import_propset(const nw::smalls::Value& ref,
-    const nw::smalls::StructDef* def,
-    const PropsetGffPolicy& policy,
-    const nw::GffStruct& gff,
-    nw::SerializationProfile profile) const
-{
-    for (const auto& fp : policy.fields) {
-        if (fp.encoding == GffEncoding::skip) { continue; }
-        if (fp.instance_only && profile == nw::SerializationProfile::blueprint) { continue; }
-        if (fp.blueprint_only && profile != nw::SerializationProfile::blueprint) { continue; }
-
-        uint32_t idx_a = def->field_index(fp.propset_field_name);
-        if (idx_a == UINT32_MAX) { continue; }
-        const nw::smalls::FieldDef& field_a = def->fields[idx_a];
-
-        switch (fp.encoding) {
-        case GffEncoding::scalar:
-            import_scalar(fp, field_a, ref, gff);
-            break;
-        case GffEncoding::spread:
-            import_spread(fp, field_a, ref, gff);
+    const PropsetGffPlan& plan,
+    const nw::GffStruct& gff) const
+{
+    for (const auto& step : plan.steps) {
+        switch (step.op) {
+        case PropsetGffOp::scalar:
+            import_scalar(step, ref, gff);
             break;
-        case GffEncoding::list_scalar:
-            import_list_scalar(fp, field_a, ref, gff);
+        case PropsetGffOp::spread:
+            import_spread(plan, step, ref, gff);
             break;
-        case GffEncoding::list_paired: {
-            // The secondary field name is in list_paired.propset_field_b
-            uint32_t idx_b = def->field_index(fp.list_paired.propset_field_b);
-            if (idx_b == UINT32_MAX) { break; }
-            import_list_paired(fp, &field_a, &def->fields[idx_b], ref, gff);
+        case PropsetGffOp::list_scalar:
+            import_list_scalar(plan, step, ref, gff);
             break;
-        }
-        case GffEncoding::list_struct:
-            import_list_struct(fp, field_a, ref, gff);
+        case PropsetGffOp::list_paired:
+            import_list_paired(plan, step, ref, gff);
             break;
-        case GffEncoding::skip:
+        case PropsetGffOp::list_struct:
+            import_list_struct(plan, step, ref, gff);
             break;
         }
     }
@@ -449,103 +330,100 @@ nw::smalls::IArray* PropsetGffImporter::get_array(const nw::smalls::Value& ref,
     return rt_->object_pool().get_unmanaged_array(h);
 }
 
-void PropsetGffImporter::import_scalar(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+bool PropsetGffImporter::read_scalar(const nw::GffStruct& gff, std::string_view label,
+    nw::SerializationType::type gff_type, const nw::smalls::FieldDef& field,
+    const nw::smalls::Value& ref) const
+{
+    if (label.empty()) { return false; }
+    switch (gff_type) {
+    case nw::SerializationType::uint8: {
+        uint8_t v = 0;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_int(ref, field.offset, static_cast<int32_t>(v));
+        return true;
+    }
+    case nw::SerializationType::int8: {
+        int8_t v = 0;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_int(ref, field.offset, static_cast<int32_t>(v));
+        return true;
+    }
+    case nw::SerializationType::uint16: {
+        uint16_t v = 0;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_int(ref, field.offset, static_cast<int32_t>(v));
+        return true;
+    }
+    case nw::SerializationType::int16: {
+        int16_t v = 0;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_int(ref, field.offset, static_cast<int32_t>(v));
+        return true;
+    }
+    case nw::SerializationType::uint32: {
+        uint32_t v = 0;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_int(ref, field.offset, static_cast<int32_t>(v));
+        return true;
+    }
+    case nw::SerializationType::int32: {
+        int32_t v = 0;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_int(ref, field.offset, v);
+        return true;
+    }
+    case nw::SerializationType::float_: {
+        float v = 0.0f;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_float(ref, field.offset, v);
+        return true;
+    }
+    case nw::SerializationType::resref: {
+        nw::Resref v;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_resref(ref, field, v);
+        return true;
+    }
+    case nw::SerializationType::string: {
+        nw::String v;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_string(ref, field, nw::StringView{v});
+        return true;
+    }
+    case nw::SerializationType::locstring: {
+        nw::LocString v;
+        if (!gff.get_to(label, v, false)) { return false; }
+        write_locstring(ref, field, v);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void PropsetGffImporter::import_scalar(const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     const nw::GffStruct& gff) const
 {
-    const auto& sm = fp.scalar;
-
-    // Helper lambda: try to read gff_label with given type, return true on success.
-    auto try_read = [&](const char* label, nw::SerializationType::type gff_type) -> bool {
-        if (!label) { return false; }
-        switch (gff_type) {
-        case nw::SerializationType::uint8: {
-            uint8_t v = 0;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_int(ref, field.offset, static_cast<int32_t>(v));
-            return true;
-        }
-        case nw::SerializationType::int8: {
-            int8_t v = 0;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_int(ref, field.offset, static_cast<int32_t>(v));
-            return true;
-        }
-        case nw::SerializationType::uint16: {
-            uint16_t v = 0;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_int(ref, field.offset, static_cast<int32_t>(v));
-            return true;
-        }
-        case nw::SerializationType::int16: {
-            int16_t v = 0;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_int(ref, field.offset, static_cast<int32_t>(v));
-            return true;
-        }
-        case nw::SerializationType::uint32: {
-            uint32_t v = 0;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_int(ref, field.offset, static_cast<int32_t>(v));
-            return true;
-        }
-        case nw::SerializationType::int32: {
-            int32_t v = 0;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_int(ref, field.offset, v);
-            return true;
-        }
-        case nw::SerializationType::float_: {
-            float v = 0.0f;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_float(ref, field.offset, v);
-            return true;
-        }
-        case nw::SerializationType::resref: {
-            nw::Resref v;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_resref(ref, field, v);
-            return true;
-        }
-        case nw::SerializationType::string: {
-            nw::String v;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_string(ref, field, nw::StringView{v});
-            return true;
-        }
-        case nw::SerializationType::locstring: {
-            nw::LocString v;
-            if (!gff.get_to(label, v, false)) { return false; }
-            write_locstring(ref, field, v);
-            return true;
-        }
-        default:
-            return false;
-        }
-    };
-
-    bool read = try_read(sm.gff_label, sm.gff_type);
-    if (!read && sm.fallback_gff_label) {
-        read = try_read(sm.fallback_gff_label, sm.fallback_gff_type);
+    bool read = read_scalar(gff, step.gff_label, step.gff_type, *step.field, ref);
+    if (!read && !step.fallback_gff_label.empty()) {
+        read = read_scalar(gff, step.fallback_gff_label, step.fallback_gff_type, *step.field, ref);
     }
-    if (!read && sm.default_int_on_missing) {
-        write_int(ref, field.offset, sm.missing_int_value);
+    if (!read && step.default_int_on_missing) {
+        write_int(ref, step.field->offset, step.missing_int_value);
     }
     // also_write_gff_label is export-only — ignored here.
 }
 
-void PropsetGffImporter::import_spread(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+void PropsetGffImporter::import_spread(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     const nw::GffStruct& gff) const
 {
-    const auto& sm = fp.spread;
-    for (uint8_t i = 0; i < sm.count; ++i) {
-        const char* label = sm.gff_labels[i];
-        if (!label) { break; }
-        uint32_t offset = field.offset + uint32_t(i) * 4u;
-        switch (sm.element_gff_type) {
+    for (uint32_t i = 0; i < step.count; ++i) {
+        std::string_view label = plan.labels[step.first + i];
+        uint32_t offset = step.field->offset + i * 4u;
+        switch (step.gff_type) {
         case nw::SerializationType::uint8: {
             uint8_t v = 0;
             if (gff.get_to(label, v, false)) { write_int(ref, offset, v); }
@@ -572,49 +450,49 @@ void PropsetGffImporter::import_spread(const FieldGffPolicy& fp,
     }
 }
 
-void PropsetGffImporter::import_list_scalar(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+void PropsetGffImporter::import_list_scalar(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     const nw::GffStruct& gff) const
 {
-    const auto& lm = fp.list_scalar;
-    auto list = gff[lm.list_name];
-    if (!list.valid() && !lm.pad_to_rules_skill_count) { return; }
+    auto list = gff[step.gff_label];
+    if (!list.valid() && !step.pad_to_rules_skill_count) { return; }
 
-    nw::smalls::IArray* arr = get_array(ref, field);
+    nw::smalls::IArray* arr = get_array(ref, *step.field);
     if (!arr) { return; }
 
+    std::string_view element_field = plan.labels[step.first];
     size_t sz = list.valid() ? list.size() : 0;
     size_t out_size = sz;
-    if (lm.pad_to_rules_skill_count) {
+    if (step.pad_to_rules_skill_count) {
         size_t rules_skill_count = nw::kernel::rules().skills.entries.size();
         if (out_size < rules_skill_count) { out_size = rules_skill_count; }
     }
     std::vector<nw::smalls::Value> values;
     values.reserve(out_size);
     for (size_t i = 0; i < sz; ++i) {
-        switch (lm.element_gff_type) {
+        switch (step.gff_type) {
         case nw::SerializationType::uint8: {
             uint8_t v = 0;
-            list[i].get_to(lm.element_field, v, false);
+            list[i].get_to(element_field, v, false);
             values.push_back(nw::smalls::Value::make_int(static_cast<int32_t>(v)));
             break;
         }
         case nw::SerializationType::uint16: {
             uint16_t v = 0;
-            list[i].get_to(lm.element_field, v, false);
+            list[i].get_to(element_field, v, false);
             values.push_back(nw::smalls::Value::make_int(static_cast<int32_t>(v)));
             break;
         }
         case nw::SerializationType::int32: {
             int32_t v = 0;
-            list[i].get_to(lm.element_field, v, false);
+            list[i].get_to(element_field, v, false);
             values.push_back(nw::smalls::Value::make_int(v));
             break;
         }
         case nw::SerializationType::resref: {
             nw::Resref v;
-            list[i].get_to(lm.element_field, v, false);
+            list[i].get_to(element_field, v, false);
             values.push_back(nw::smalls::detail::make_value(rt_, v));
             break;
         }
@@ -626,7 +504,7 @@ void PropsetGffImporter::import_list_scalar(const FieldGffPolicy& fp,
         values.push_back(nw::smalls::Value::make_int(0));
     }
 
-    if (lm.sort_int_values) {
+    if (step.sort_int_values) {
         std::sort(values.begin(), values.end(), [](nw::smalls::Value lhs, nw::smalls::Value rhs) {
             return lhs.data.ival < rhs.data.ival;
         });
@@ -639,57 +517,50 @@ void PropsetGffImporter::import_list_scalar(const FieldGffPolicy& fp,
     }
 }
 
-void PropsetGffImporter::import_list_paired(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef* field_a,
-    const nw::smalls::FieldDef* field_b,
+void PropsetGffImporter::import_list_paired(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     const nw::GffStruct& gff) const
 {
-    const auto& lm = fp.list_paired;
-
-    // Determine array capacity from the fixed-array type.
-    int32_t max_slots = 8;
-    const nw::smalls::Type* arr_type = rt_->get_type(field_a->type_id);
-    if (arr_type && arr_type->type_kind == nw::smalls::TK_fixed_array) {
-        max_slots = arr_type->type_params[1].as<int32_t>();
-    }
+    const uint32_t offset_a = step.field->offset;
+    const uint32_t offset_b = step.field_b->offset;
 
     // Pre-fill all slots with sentinel values (-1 / 0) so absent list entries
     // have the same shape as default-initialized propset arrays.
-    for (int32_t i = 0; i < max_slots; ++i) {
-        write_int(ref, field_a->offset + uint32_t(i) * 4u, -1);
-        write_int(ref, field_b->offset + uint32_t(i) * 4u, 0);
+    for (uint32_t i = 0; i < step.slots; ++i) {
+        write_int(ref, offset_a + i * 4u, -1);
+        write_int(ref, offset_b + i * 4u, 0);
     }
 
-    auto list = gff[lm.list_name];
+    auto list = gff[step.gff_label];
     if (!list.valid()) { return; }
 
-    size_t sz = std::min(size_t(max_slots), list.size());
+    std::string_view label_a = plan.labels[step.first];
+    std::string_view label_b = plan.labels[step.first + 1];
+    size_t sz = std::min(size_t(step.slots), list.size());
     for (size_t i = 0; i < sz; ++i) {
         int32_t va = -1, vb = 0;
-        list[i].get_to(lm.field_a, va, false);
-        list[i].get_to(lm.field_b, vb, false);
-        write_int(ref, field_a->offset + uint32_t(i) * 4u, va);
-        write_int(ref, field_b->offset + uint32_t(i) * 4u, vb);
+        list[i].get_to(label_a, va, false);
+        list[i].get_to(label_b, vb, false);
+        write_int(ref, offset_a + uint32_t(i) * 4u, va);
+        write_int(ref, offset_b + uint32_t(i) * 4u, vb);
     }
 }
 
-void PropsetGffImporter::import_list_struct(const FieldGffPolicy& fp,
-    const nw::smalls::FieldDef& field,
+void PropsetGffImporter::import_list_struct(const PropsetGffPlan& plan,
+    const PropsetGffPlanStep& step,
     const nw::smalls::Value& ref,
     const nw::GffStruct& gff) const
 {
-    const auto& lm = fp.list_struct;
-    auto list = gff[lm.list_name];
+    auto list = gff[step.gff_label];
     if (!list.valid()) { return; }
 
-    nw::smalls::IArray* arr = get_array(ref, field);
-    if (!arr) { return; }
+    nw::smalls::IArray* arr = get_array(ref, *step.field);
+    if (!arr || arr->element_type() != step.element_type) { return; }
 
-    nw::smalls::TypeID elem_tid = arr->element_type();
+    const nw::smalls::TypeID elem_tid = step.element_type;
     const nw::smalls::Type* elem_type = rt_->get_type(elem_tid);
-    const nw::smalls::StructDef* elem_def = rt_->get_struct_def(elem_tid);
-    if (!elem_type || !elem_def) { return; }
+    if (!elem_type) { return; }
 
     arr->clear();
     arr->reserve(list.size());
@@ -700,42 +571,42 @@ void PropsetGffImporter::import_list_struct(const FieldGffPolicy& fp,
         rt_->initialize_zero_defaults(elem_tid, data);
         nw::smalls::Value elem_value = nw::smalls::Value::make_heap(ptr, elem_tid);
 
-        for (const auto& fm : lm.fields) {
-            uint32_t idx = elem_def->field_index(fm.propset_field_name);
-            if (idx == UINT32_MAX) { continue; }
-            const nw::smalls::FieldDef& elem_field = elem_def->fields[idx];
+        auto row = list[i];
+        for (uint32_t j = 0; j < step.count; ++j) {
+            const PropsetGffPlanElement& fm = plan.elements[step.first + j];
+            const nw::smalls::FieldDef& elem_field = *fm.field;
             switch (fm.gff_type) {
             case nw::SerializationType::uint8: {
                 uint8_t v = 0;
-                if (list[i].get_to(fm.gff_label, v, false)) {
+                if (row.get_to(fm.gff_label, v, false)) {
                     write_int(elem_value, elem_field.offset, static_cast<int32_t>(v));
                 }
                 break;
             }
             case nw::SerializationType::uint16: {
                 uint16_t v = 0;
-                if (list[i].get_to(fm.gff_label, v, false)) {
+                if (row.get_to(fm.gff_label, v, false)) {
                     write_int(elem_value, elem_field.offset, static_cast<int32_t>(v));
                 }
                 break;
             }
             case nw::SerializationType::int32: {
                 int32_t v = 0;
-                if (list[i].get_to(fm.gff_label, v, false)) {
+                if (row.get_to(fm.gff_label, v, false)) {
                     write_int(elem_value, elem_field.offset, v);
                 }
                 break;
             }
             case nw::SerializationType::float_: {
                 float v = 0.0f;
-                if (list[i].get_to(fm.gff_label, v, false)) {
+                if (row.get_to(fm.gff_label, v, false)) {
                     write_float(elem_value, elem_field.offset, v);
                 }
                 break;
             }
             case nw::SerializationType::resref: {
                 nw::Resref v;
-                if (list[i].get_to(fm.gff_label, v, false)) {
+                if (row.get_to(fm.gff_label, v, false)) {
                     write_resref(elem_value, elem_field, v);
                 }
                 break;
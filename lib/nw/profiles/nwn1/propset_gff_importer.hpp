@@ -9,6 +9,7 @@
 
 namespace nw {
 struct Creature;
+struct ObjectBase;
 struct Door;
 struct Encounter;
 struct GffStruct;
@@ -30,11 +31,15 @@ struct Value;
 
 namespace nwn1 {
 
+struct PropsetGffPlan;
+struct PropsetGffPlanStep;
+
 /// Reflection-based GFF → propset importer.
 ///
 /// Uses PropsetGffPolicyRegistry to know how to map GFF fields into propset
-/// fields. This is the transition adapter for deserialize-time propset
-/// initialization and the eventual standalone object conversion tooling.
+/// fields, compiled once per propset type and profile (see propset_gff_plan.hpp).
+/// This is the transition adapter for deserialize-time propset initialization
+/// and the eventual standalone object conversion tooling.
 ///
 /// Wire-up: call import_* from the GFF deserialize path after the C++ object is
 /// loaded. Do not add runtime service state here.
@@ -61,34 +66,31 @@ public:
     void import_waypoint(nw::Waypoint* obj, const nw::GffStruct& gff,
         nw::SerializationProfile profile);
 
+    /// Imports one propset through ``plan``, whether cached or compiled by the caller
+    bool import_propset(const nw::smalls::Value& ref, const PropsetGffPlan& plan,
+        const nw::GffStruct& gff) const;
+
 private:
     nw::smalls::Runtime* rt_;
     const PropsetGffPolicyRegistry* registry_;
 
-    // Lazily-resolved TypeID cache keyed on qualified_name index in registry.
-    // Populated on first use.
-    mutable std::vector<nw::smalls::TypeID> type_id_cache_; // parallel to registry_->policies()
-    nw::smalls::TypeID resolve_type_id(size_t policy_index) const;
-
-    /// Import a single propset from a GFF struct using the given policy.
-    bool import_propset(const nw::smalls::Value& ref,
-        const nw::smalls::StructDef* def,
-        const PropsetGffPolicy& policy,
-        const nw::GffStruct& gff,
-        nw::SerializationProfile profile) const;
+    /// Import a single propset through its compiled plan.
+    bool import_object_propset(const nw::ObjectBase* obj, const char* qname,
+        const nw::GffStruct& gff, nw::SerializationProfile profile) const;
 
     // Encoding-specific helpers
-    void import_scalar(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    bool read_scalar(const nw::GffStruct& gff, std::string_view label,
+        nw::SerializationType::type gff_type, const nw::smalls::FieldDef& field,
+        const nw::smalls::Value& ref) const;
+    void import_scalar(const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, const nw::GffStruct& gff) const;
-    void import_spread(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    void import_spread(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, const nw::GffStruct& gff) const;
-    void import_list_scalar(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    void import_list_scalar(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, const nw::GffStruct& gff) const;
-    void import_list_paired(const FieldGffPolicy& fp,
-        const nw::smalls::FieldDef* field_a,
-        const nw::smalls::FieldDef* field_b,
+    void import_list_paired(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, const nw::GffStruct& gff) const;
-    void import_list_struct(const FieldGffPolicy& fp, const nw::smalls::FieldDef& field,
+    void import_list_struct(const PropsetGffPlan& plan, const PropsetGffPlanStep& step,
         const nw::smalls::Value& ref, const nw::GffStruct& gff) const;
     void import_item_properties(nw::Item* obj, const nw::GffStruct& gff) const;
     void import_item_visuals(nw::Item* obj, const nw::GffStruct& gff) const;
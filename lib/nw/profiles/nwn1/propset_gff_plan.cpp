@@ -0,0 +1,188 @@
+#include "propset_gff_plan.hpp"
+
+#include "../../smalls/runtime.hpp"
+
+#include <absl/container/flat_hash_map.h>
+
+#include <atomic>
+#include <memory>
+#include <tuple>
+
+namespace nwn1 {
+
+namespace {
+
+std::string_view to_view(const char* label)
+{
+    return label ? std::string_view{label} : std::string_view{};
+}
+
+struct PlanCache {
+    // The name is a view of the policy's qualified name, a string literal, so keys never allocate
+    using Key = std::tuple<uint64_t, std::string_view, nw::SerializationProfile>;
+
+    const nw::smalls::Runtime* runtime = nullptr;
+    uint64_t generation = 0;
+    uint64_t epoch = 0;
+    absl::flat_hash_map<Key, PropsetGffPlanHandle> plans;
+};
+
+// Bumped by ``clear_propset_gff_plans``, every thread drops its plans on its next lookup
+std::atomic<uint64_t> plan_epoch{1};
+
+PlanCache& plan_cache()
+{
+    // One cache per thread, so lookups take no lock
+    thread_local PlanCache cache;
+    return cache;
+}
+
+} // namespace
+
+bool compile_propset_gff_plan(nw::smalls::Runtime* rt, const PropsetGffPolicy& policy,
+    nw::SerializationProfile profile, PropsetGffPlan& out)
+{
+    // Cleared rather than reset, so a plan recompiled in place keeps its capacity
+    out.type_id = nw::smalls::invalid_type_id;
+    out.def = nullptr;
+    out.steps.clear();
+    out.labels.clear();
+    out.elements.clear();
+    if (!rt || !policy.qualified_name) { return false; }
+
+    out.type_id = rt->type_id(policy.qualified_name, false);
+    if (out.type_id == nw::smalls::invalid_type_id) { return false; }
+    out.def = rt->get_struct_def(out.type_id);
+    if (!out.def) { return false; }
+    out.profile = profile;
+
+    const auto* def = out.def;
+    for (const auto& fp : policy.fields) {
+        if (fp.encoding == GffEncoding::skip) { continue; }
+        if (fp.instance_only && profile == nw::SerializationProfile::blueprint) { continue; }
+        if (fp.blueprint_only && profile != nw::SerializationProfile::blueprint) { continue; }
+
+        uint32_t idx = def->field_index(fp.propset_field_name);
+        if (idx == UINT32_MAX) { continue; }
+
+        PropsetGffPlanStep step;
+        step.field = &def->fields[idx];
+        step.import_only = fp.import_only;
+
+        switch (fp.encoding) {
+        case GffEncoding::scalar:
+            step.op = PropsetGffOp::scalar;
+            step.gff_type = fp.scalar.gff_type;
+            step.gff_label = to_view(fp.scalar.gff_label);
+            step.fallback_gff_label = to_view(fp.scalar.fallback_gff_label);
+            step.fallback_gff_type = fp.scalar.fallback_gff_type;
+            step.also_write_gff_label = to_view(fp.scalar.also_write_gff_label);
+            step.also_write_gff_type = fp.scalar.also_write_gff_type;
+            step.default_int_on_missing = fp.scalar.default_int_on_missing;
+            step.missing_int_value = fp.scalar.missing_int_value;
+            break;
+        case GffEncoding::spread:
+            step.op = PropsetGffOp::spread;
+            step.gff_type = fp.spread.element_gff_type;
+            step.first = uint32_t(out.labels.size());
+            for (uint8_t i = 0; i < fp.spread.count && fp.spread.gff_labels[i]; ++i) {
+                out.labels.push_back(fp.spread.gff_labels[i]);
+            }
+            step.count = uint32_t(out.labels.size()) - step.first;
+            break;
+        case GffEncoding::list_scalar:
+            step.op = PropsetGffOp::list_scalar;
+            step.gff_type = fp.list_scalar.element_gff_type;
+            step.gff_label = to_view(fp.list_scalar.list_name);
+            step.gff_struct_id = fp.list_scalar.gff_struct_id;
+            step.pad_to_rules_skill_count = fp.list_scalar.pad_to_rules_skill_count;
+            step.sort_int_values = fp.list_scalar.sort_int_values;
+            step.first = uint32_t(out.labels.size());
+            step.count = 1;
+            out.labels.push_back(to_view(fp.list_scalar.element_field));
+            break;
+        case GffEncoding::list_paired: {
+            uint32_t idx_b = def->field_index(fp.list_paired.propset_field_b);
+            if (idx_b == UINT32_MAX) { continue; }
+            step.op = PropsetGffOp::list_paired;
+            step.field_b = &def->fields[idx_b];
+            step.gff_label = to_view(fp.list_paired.list_name);
+            step.gff_struct_id = fp.list_paired.gff_struct_id;
+
+            // Capacity comes from the fixed-array type, 8 is the CreatureLevels class slot count
+            step.slots = 8;
+            const nw::smalls::Type* arr_type = rt->get_type(step.field->type_id);
+            if (arr_type && arr_type->type_kind == nw::smalls::TK_fixed_array) {
+                step.slots = uint32_t(arr_type->type_params[1].as<int32_t>());
+            }
+            step.first = uint32_t(out.labels.size());
+            step.count = 2;
+            out.labels.push_back(to_view(fp.list_paired.field_a));
+            out.labels.push_back(to_view(fp.list_paired.field_b));
+            break;
+        }
+        case GffEncoding::list_struct: {
+            const nw::smalls::Type* arr_type = rt->get_type(step.field->type_id);
+            if (!step.field->is_unmanaged_array || !arr_type || arr_type->type_kind != nw::smalls::TK_array) {
+                continue;
+            }
+            step.op = PropsetGffOp::list_struct;
+            step.gff_label = to_view(fp.list_struct.list_name);
+            step.gff_struct_id = fp.list_struct.gff_struct_id;
+            step.element_type = arr_type->type_params[0].as<nw::smalls::TypeID>();
+            step.element_def = rt->get_struct_def(step.element_type);
+            if (!step.element_def) { continue; }
+
+            step.first = uint32_t(out.elements.size());
+            for (const auto& fm : fp.list_struct.fields) {
+                uint32_t elem_idx = step.element_def->field_index(fm.propset_field_name);
+                if (elem_idx == UINT32_MAX) { continue; }
+                out.elements.push_back({to_view(fm.gff_label), fm.gff_type, &step.element_def->fields[elem_idx]});
+            }
+            step.count = uint32_t(out.elements.size()) - step.first;
+            break;
+        }
+        case GffEncoding::skip:
+            continue;
+        }
+
+        out.steps.push_back(step);
+    }
+
+    return true;
+}
+
+PropsetGffPlanHandle propset_gff_plan(nw::smalls::Runtime* rt, const PropsetGffPolicyRegistry* registry,
+    std::string_view qualified_name, nw::SerializationProfile profile)
+{
+    if (!rt || !registry) { return nullptr; }
+
+    auto& cache = plan_cache();
+    const uint64_t epoch = plan_epoch.load(std::memory_order_acquire);
+    if (cache.runtime != rt || cache.generation != rt->module_generation() || cache.epoch != epoch) {
+        cache.plans.clear();
+        cache.runtime = rt;
+        cache.generation = rt->module_generation();
+        cache.epoch = epoch;
+    }
+
+    auto it = cache.plans.find(PlanCache::Key{registry->version(), qualified_name, profile});
+    if (it != cache.plans.end()) { return it->second; }
+
+    const PropsetGffPolicy* policy = registry->find(qualified_name);
+    if (!policy) { return nullptr; }
+
+    // Failures are not cached, the propset type may not be loaded yet
+    auto plan = std::make_shared<PropsetGffPlan>();
+    if (!compile_propset_gff_plan(rt, *policy, profile, *plan)) { return nullptr; }
+    cache.plans.emplace(PlanCache::Key{registry->version(), to_view(policy->qualified_name), profile}, plan);
+    return plan;
+}
+
+void clear_propset_gff_plans()
+{
+    plan_epoch.fetch_add(1, std::memory_order_acq_rel);
+    plan_cache().plans.clear();
+}
+
+} // namespace nwn1
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../../serialization/Serialization.hpp"
+#include "../../smalls/types.hpp"
+#include "propset_gff_policy.hpp"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace nw::smalls {
+struct Runtime;
+} // namespace nw::smalls
+
+namespace nwn1 {
+
+// Compiled form of a PropsetGffPolicy: the policy resolved against the propset
+// StructDef once, so importing or exporting an object is a loop over flat steps
+// with no registry, type or field name lookups.
+
+// -- Steps -------------------------------------------------------------------
+
+enum class PropsetGffOp : uint8_t {
+    scalar,      // one GFF label ↔ one field, converted per ``gff_type``
+    spread,      // ``count`` GFF labels ↔ int[N]
+    list_scalar, // GFF List, one field per row ↔ array!(scalar)
+    list_paired, // GFF List, two fields per row ↔ two int[N]
+    list_struct, // GFF List, one row per element ↔ array!(struct)
+};
+
+/// Field of the element struct of a ``list_struct`` step
+struct PropsetGffPlanElement {
+    std::string_view gff_label;
+    nw::SerializationType::type gff_type = nw::SerializationType::invalid;
+    const nw::smalls::FieldDef* field = nullptr;
+};
+
+struct PropsetGffPlanStep {
+    PropsetGffOp op = PropsetGffOp::scalar;
+    nw::SerializationType::type gff_type = nw::SerializationType::invalid; // scalar, spread and list_scalar
+    std::string_view gff_label;                                            // scalar label or list label
+
+    // Scalar only
+    std::string_view fallback_gff_label;
+    nw::SerializationType::type fallback_gff_type = nw::SerializationType::invalid;
+    std::string_view also_write_gff_label;
+    nw::SerializationType::type also_write_gff_type = nw::SerializationType::invalid;
+    bool default_int_on_missing = false;
+    int32_t missing_int_value = 0;
+
+    bool import_only = false; // Skipped by the exporter
+    bool pad_to_rules_skill_count = false;
+    bool sort_int_values = false;
+    uint32_t gff_struct_id = 0;
+
+    const nw::smalls::FieldDef* field = nullptr;
+    const nw::smalls::FieldDef* field_b = nullptr; // list_paired secondary field
+    uint32_t slots = 0;                            // list_paired fixed array length
+
+    // spread, list_scalar and list_paired: range of ``PropsetGffPlan::labels``
+    // list_struct: range of ``PropsetGffPlan::elements``
+    uint32_t first = 0;
+    uint32_t count = 0;
+
+    nw::smalls::TypeID element_type = nw::smalls::invalid_type_id; // list_struct
+    const nw::smalls::StructDef* element_def = nullptr;            // list_struct
+};
+
+// -- Plan --------------------------------------------------------------------
+
+/// A propset policy compiled for one serialization profile
+struct PropsetGffPlan {
+    nw::smalls::TypeID type_id = nw::smalls::invalid_type_id;
+    const nw::smalls::StructDef* def = nullptr;
+    nw::SerializationProfile profile = nw::SerializationProfile::any;
+
+    std::vector<PropsetGffPlanStep> steps; // Policy order, filtered by profile
+    std::vector<std::string_view> labels;
+    std::vector<PropsetGffPlanElement> elements;
+};
+
+/// Shared handle to a compiled plan, stays valid after the plan cache drops it
+using PropsetGffPlanHandle = std::shared_ptr<const PropsetGffPlan>;
+
+/// Compiles ``policy`` against its propset type in ``rt``
+/// @note ``out`` is cleared first, its storage is reused.
+/// @return false if the propset type is not registered
+bool compile_propset_gff_plan(nw::smalls::Runtime* rt, const PropsetGffPolicy& policy,
+    nw::SerializationProfile profile, PropsetGffPlan& out);
+
+/// Gets the compiled plan of a propset, compiling it on first use
+/// @note Plans are cached per thread, registry version, name and profile, and dropped whenever
+/// the runtime or its module generation changes.  A plan's field definitions are only valid
+/// until then.  Plans only refer to the policy's labels, which are expected to be string
+/// literals, never to the registry itself.
+PropsetGffPlanHandle propset_gff_plan(nw::smalls::Runtime* rt, const PropsetGffPolicyRegistry* registry,
+    std::string_view qualified_name, nw::SerializationProfile profile);
+
+/// Drops every cached plan, on every thread
+void clear_propset_gff_plans();
+
+} // namespace nwn1
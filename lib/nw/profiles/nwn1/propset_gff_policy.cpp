@@ -1,9 +1,17 @@
 #include "propset_gff_policy.hpp"
 
+#include <atomic>
+
 namespace nwn1 {
 
 namespace {
 
+uint64_t next_registry_version() noexcept
+{
+    static std::atomic<uint64_t> version{0};
+    return ++version;
+}
+
 using ST = nw::SerializationType;
 using GE = GffEncoding;
 
@@ -140,6 +148,7 @@ FieldGffPolicy list_struct(const char* name, const char* list_name,
 void PropsetGffPolicyRegistry::register_policy(PropsetGffPolicy policy)
 {
     policies_.push_back(std::move(policy));
+    version_ = next_registry_version();
 }
 
 const PropsetGffPolicy* PropsetGffPolicyRegistry::find(std::string_view qualified_name) const
@@ -123,8 +123,13 @@ public:
 
     const std::vector<PropsetGffPolicy>& policies() const { return policies_; }
 
+    /// Changes whenever a policy is registered, unique across registries.
+    /// Copies share a version, their policies are identical.
+    uint64_t version() const noexcept { return version_; }
+
 private:
     std::vector<PropsetGffPolicy> policies_;
+    uint64_t version_ = 0;
 };
 
 /// Build the hardcoded NWN1 propset → GFF mapping table.
@@ -9,47 +9,62 @@
 #include "../../objects/ObjectManager.hpp"
 #include "../../rules/combat_scheduler.hpp"
 #include "../../smalls/Array.hpp"
+#include "../../smalls/ScriptFunction.hpp"
 #include "../../util/profile.hpp"
 
 namespace nwn1::bridge {
 namespace {
 
-bool is_int_compatible_type(nw::smalls::Runtime& rt, nw::smalls::TypeID type_id) noexcept
-{
-    while (type_id != rt.int_type()) {
-        const auto* type = rt.get_type(type_id);
-        if (!type) {
-            return false;
-        }
+using nw::smalls::detail::is_int_compatible_type;
 
-        if (type->type_kind != nw::smalls::TK_alias && type->type_kind != nw::smalls::TK_newtype) {
-            return type->primitive_kind == nw::smalls::PK_int;
-        }
+/// Resolved functions by module and name, so by-name calls only pay for two hash lookups
+thread_local absl::flat_hash_map<nw::String, absl::flat_hash_map<nw::String, nw::smalls::ResolvedScriptFunction>>
+    s_bridge_functions;
 
-        if (type->type_params.empty()) {
-            return false;
-        }
+nw::smalls::ResolvedScriptFunction& bridge_function(nw::StringView module, nw::StringView fn)
+{
+    auto module_it = s_bridge_functions.find(module);
+    if (module_it == s_bridge_functions.end()) {
+        module_it = s_bridge_functions.try_emplace(nw::String(module)).first;
+    }
+    auto fn_it = module_it->second.find(fn);
+    if (fn_it == module_it->second.end()) {
+        fn_it = module_it->second.try_emplace(nw::String(fn), nw::String(module), nw::String(fn)).first;
+    }
+    return fn_it->second;
+}
 
-        const auto alias_target = type->type_params[0];
-        if (!alias_target.is<nw::smalls::TypeID>()) {
-            return false;
-        }
+std::optional<nw::smalls::Value> call_bridge_function(nw::StringView module, nw::StringView fn,
+    std::span<const nw::smalls::Value> args)
+{
+    if (!ensure_nwn1_smalls_initialized()) {
+        return std::nullopt;
+    }
 
-        type_id = alias_target.as<nw::smalls::TypeID>();
+    auto result = bridge_function(module, fn).call(nw::kernel::runtime(), args);
+    if (!result.ok()) {
+        return std::nullopt;
     }
-    return true;
+    return result.value;
 }
 
 } // namespace
 
 bool ensure_nwn1_smalls_initialized()
 {
+    // nwn1.init.init is idempotent, it only needs to run again once modules are evicted or the
+    // runtime is restarted.
+    thread_local uint64_t initialized_generation = 0;
+    thread_local nw::smalls::ScriptFunction<void()> init{"nwn1.init", "init"};
+
     auto& rt = nw::kernel::runtime();
-    auto result = rt.execute_script("nwn1.init", "init");
-    if (!result.ok()) {
-        LOG_F(WARNING, "[nwn1.bridge] nwn1.init.init failed: {}", result.error_message);
+    if (initialized_generation == rt.module_generation()) {
+        return true;
+    }
+    if (!init.call(rt)) {
         return false;
     }
+    initialized_generation = rt.module_generation();
     return true;
 }
 
@@ -64,40 +79,24 @@ nw::smalls::Value make_object_arg(nw::ObjectHandle handle)
 std::optional<int32_t> call_nwn1_module_int(nw::StringView module, nw::StringView fn,
     const nw::Vector<nw::smalls::Value>& args)
 {
-    if (!ensure_nwn1_smalls_initialized()) {
+    auto result = call_bridge_function(module, fn, args);
+    if (!result) {
         return std::nullopt;
     }
 
     auto& rt = nw::kernel::runtime();
-    auto result = rt.execute_script(module, fn, args);
-    if (!result.ok()) {
-        LOG_F(WARNING, "[nwn1.bridge] {}.{} failed: {}", module, fn, result.error_message);
-        return std::nullopt;
-    }
-
-    if (!is_int_compatible_type(rt, result.value.type_id)) {
+    if (!is_int_compatible_type(rt, result->type_id)) {
         LOG_F(WARNING, "[nwn1.bridge] {}.{} returned non-int-compatible type", module, fn);
         return std::nullopt;
     }
 
-    return result.value.data.ival;
+    return result->data.ival;
 }
 
 std::optional<nw::smalls::Value> call_nwn1_module_value(nw::StringView module, nw::StringView fn,
     const nw::Vector<nw::smalls::Value>& args)
 {
-    if (!ensure_nwn1_smalls_initialized()) {
-        return std::nullopt;
-    }
-
-    auto& rt = nw::kernel::runtime();
-    auto result = rt.execute_script(module, fn, args);
-    if (!result.ok()) {
-        LOG_F(WARNING, "[nwn1.bridge] {}.{} failed: {}", module, fn, result.error_message);
-        return std::nullopt;
-    }
-
-    return result.value;
+    return call_bridge_function(module, fn, args);
 }
 
 std::optional<float> call_nwn1_module_float(nw::StringView module, nw::StringView fn,
@@ -143,68 +142,33 @@ std::optional<bool> call_nwn1_module_bool(nw::StringView module, nw::StringView
 bool call_nwn1_module_void(nw::StringView module, nw::StringView fn,
     const nw::Vector<nw::smalls::Value>& args)
 {
-    if (!ensure_nwn1_smalls_initialized()) {
-        return false;
-    }
-
-    auto& rt = nw::kernel::runtime();
-    auto result = rt.execute_script(module, fn, args);
-    if (!result.ok()) {
-        LOG_F(WARNING, "[nwn1.bridge] {}.{} failed: {}", module, fn, result.error_message);
-        return false;
-    }
-
-    return true;
+    return call_bridge_function(module, fn, args).has_value();
 }
 
 } // namespace nwn1::bridge
 
-namespace {
-
-void push_object_arg(nw::Vector<nw::smalls::Value>& args, const nw::ObjectBase* obj)
-{
-    args.push_back(nwn1::bridge::make_object_arg(obj->handle()));
-}
-
-} // namespace
-
 namespace nwn1 {
 
 bool equip_item(nw::Creature* obj, nw::Item* item, nw::EquipIndex slot)
 {
     if (!obj || !item) { return false; }
+    if (!bridge::ensure_nwn1_smalls_initialized()) { return false; }
 
-    auto& rt = nw::kernel::runtime();
-
-    nw::Vector<nw::smalls::Value> args;
-    push_object_arg(args, obj);
-    push_object_arg(args, item);
-    args.push_back(nw::smalls::Value::make_int(static_cast<int32_t>(slot)));
-
-    if (auto result = bridge::call_nwn1_module_value("nwn1.item", "equip_item", args)) {
-        if (result->type_id == rt.bool_type()) {
-            return result->data.bval;
-        }
-        if (result->type_id == rt.int_type()) {
-            return result->data.ival != 0;
-        }
-    }
-
-    return false;
+    thread_local nw::smalls::ScriptFunction<bool(nw::ObjectHandle, nw::ObjectHandle, nw::EquipIndex)> fn{
+        "nwn1.item", "equip_item"};
+    return fn(obj->handle(), item->handle(), slot).value_or(false);
 }
 
 nw::Item* unequip_item(nw::Creature* obj, nw::EquipIndex slot)
 {
     if (!obj) { return nullptr; }
+    if (!bridge::ensure_nwn1_smalls_initialized()) { return nullptr; }
 
-    nw::Vector<nw::smalls::Value> args;
-    push_object_arg(args, obj);
-    args.push_back(nw::smalls::Value::make_int(static_cast<int32_t>(slot)));
-
-    if (auto result = bridge::call_nwn1_module_value("nwn1.item", "unequip_item", args)) {
-        auto handle = result->data.oval;
-        if (handle.type == nw::ObjectType::item && nw::kernel::objects().valid(handle)) {
-            return nw::kernel::objects().get<nw::Item>(handle);
+    thread_local nw::smalls::ScriptFunction<nw::ObjectHandle(nw::ObjectHandle, nw::EquipIndex)> fn{
+        "nwn1.item", "unequip_item"};
+    if (auto handle = fn(obj->handle(), slot)) {
+        if (handle->type == nw::ObjectType::item && nw::kernel::objects().valid(*handle)) {
+            return nw::kernel::objects().get<nw::Item>(*handle);
         }
     }
 
@@ -220,25 +184,19 @@ int process_item_properties(nw::Creature* obj, const nw::Item* item, nw::EquipIn
     auto& rt = nw::kernel::runtime();
     rt.init_object_propsets(item->handle());
 
-    nw::Vector<nw::smalls::Value> args;
-    push_object_arg(args, obj);
-    push_object_arg(args, item);
-    args.push_back(nw::smalls::Value::make_int(static_cast<int32_t>(index)));
-    args.push_back(nw::smalls::Value::make_bool(remove));
-
     constexpr uint64_t item_props_gas_limit = 10'000'000;
-    auto result = rt.execute_script("core.item", "process_item_properties", args, item_props_gas_limit);
-    if (result.ok()) { return result.value.data.ival; }
-    LOG_F(ERROR, "[nwn1.bridge] core.item.process_item_properties failed: {}", result.error_message);
-    return 0;
+    thread_local nw::smalls::ScriptFunction<int32_t(nw::ObjectHandle, nw::ObjectHandle, nw::EquipIndex, bool)> fn{
+        "core.item", "process_item_properties", item_props_gas_limit};
+    return fn.call(rt, obj->handle(), item->handle(), index, remove).value_or(0);
 }
 
 void refresh_combat_weapon_cache(nw::Creature* obj)
 {
     if (!obj) { return; }
-    nw::Vector<nw::smalls::Value> args;
-    push_object_arg(args, obj);
-    bridge::call_nwn1_module_value("nwn1.combat", "refresh_combat_weapon_cache", args);
+    if (!bridge::ensure_nwn1_smalls_initialized()) { return; }
+
+    thread_local nw::smalls::ScriptFunction<void(nw::ObjectHandle)> fn{"nwn1.combat", "refresh_combat_weapon_cache"};
+    fn(obj->handle());
 }
 
 } // namespace nwn1
@@ -8,6 +8,7 @@
 namespace nw::render {
 
 const std::type_index RenderService::type_index{typeid(RenderService)};
+size_t RenderService::service_slot = kernel::Services::no_slot;
 
 RenderService::RenderService(MemoryResource* memory)
     : Service(memory)
@@ -18,6 +18,7 @@ namespace nw::render {
 
 struct RenderService : public kernel::Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     explicit RenderService(MemoryResource* memory);
 
@@ -26,6 +26,13 @@ struct Container {
     /// Reads resource data, empty ResourceData if no match.
     virtual ResourceData demand(const ContainerKey* key) const = 0;
 
+    /// Maps backing files into memory so that ``demand`` borrows from the mapping rather than
+    /// reading into a new buffer.  Returns false if unsupported or mapping failed.
+    virtual bool memory_map() { return false; }
+
+    /// Determines if ``demand`` borrows from a memory mapping
+    virtual bool memory_mapped() const noexcept { return false; }
+
     /// Equivalent to `basename path()`
     virtual const String& name() const = 0;
 
@@ -41,6 +48,22 @@ struct Container {
     /// Enumerates all assets in a container
     virtual void visit(std::function<void(Resource, const ContainerKey*)> visitor) const = 0;
 
+    /// Gets the key of the ``ordinal``th asset enumerated by ``visit``, nullptr if out of range
+    /// or unsupported.  Containers that support this can be restored from a registry snapshot.
+    virtual const ContainerKey* key_at(size_t ordinal) const
+    {
+        (void)ordinal;
+        return nullptr;
+    }
+
+    /// Gets a sort key for ``key`` such that demanding keys in ascending order reads the backing
+    /// file(s) sequentially, i.e. a file offset.  Used to batch reads, see ``ResourceManager::demand_many``.
+    virtual uint64_t read_order(const ContainerKey* key) const
+    {
+        (void)key;
+        return 0;
+    }
+
 private:
     nw::MemoryResource* allocator_;
 };
@@ -521,7 +521,7 @@ ResourceData Erf::read(const ErfElement& e) const
         } else {
             data.bytes.resize(ele.size);
             file_.seekg(ele.offset, file_.beg);
-            istream_read(file_, data.bytes.data(), ele.size);
+            istream_read(file_, data.bytes.mutable_data(), ele.size);
         }
     }
     return data;
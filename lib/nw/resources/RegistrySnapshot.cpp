@@ -0,0 +1,267 @@
+#include "RegistrySnapshot.hpp"
+
+#include "Container.hpp"
+
+#include "../log.hpp"
+#include "../util/MappedFile.hpp"
+#include "../util/templates.hpp"
+
+#include "xxhash/xxh3.h"
+
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace nw {
+
+namespace {
+
+/// @cond NEVER
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t container_count;
+    uint32_t bucket_count;
+    uint32_t entry_count;
+    uint32_t strings_size;
+    uint64_t containers_offset;
+    uint64_t buckets_offset;
+    uint64_t strings_offset;
+};
+
+struct SnapshotContainer {
+    uint64_t file_size;
+    int64_t mtime;
+    uint32_t path_offset;
+    uint32_t path_size;
+    uint32_t resource_count;
+    uint32_t reserved;
+};
+/// @endcond
+
+static_assert(sizeof(SnapshotHeader) == 48);
+static_assert(sizeof(SnapshotContainer) == 32);
+
+constexpr char snapshot_magic[4] = {'N', 'W', 'R', 'S'};
+
+bool range_contains(size_t file_size, uint64_t offset, uint64_t size) noexcept
+{
+    if (offset > file_size) { return false; }
+    return size <= file_size - offset;
+}
+
+size_t align8(size_t value) noexcept
+{
+    return (value + 7) & ~size_t(7);
+}
+
+} // namespace
+
+// == ContainerStamp ==========================================================
+// ============================================================================
+
+std::optional<ContainerStamp> ContainerStamp::from_container(const Container* container)
+{
+    if (!container || !container->valid() || container->size() == 0) { return std::nullopt; }
+    if (!container->key_at(0)) { return std::nullopt; }
+
+    std::error_code ec;
+    const fs::path path{container->path()};
+    if (!fs::is_regular_file(path, ec) || ec) { return std::nullopt; }
+
+    ContainerStamp result;
+    result.path = container->path();
+    result.file_size = fs::file_size(path, ec);
+    if (ec) { return std::nullopt; }
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) { return std::nullopt; }
+    result.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    result.resource_count = static_cast<uint32_t>(container->size());
+    return result;
+}
+
+// == RegistrySnapshot ========================================================
+// ============================================================================
+
+ContainerStamp RegistrySnapshot::container(size_t index) const
+{
+    ContainerStamp result;
+    if (index >= containers_count_) { return result; }
+
+    SnapshotContainer c;
+    std::memcpy(&c, containers_ + index * sizeof(SnapshotContainer), sizeof(SnapshotContainer));
+    result.path = String{strings_ + c.path_offset, c.path_size};
+    result.file_size = c.file_size;
+    result.mtime = c.mtime;
+    result.resource_count = c.resource_count;
+    return result;
+}
+
+uint64_t RegistrySnapshot::hash(Resource uri) noexcept
+{
+    auto view = uri.resref.view();
+    return XXH3_64bits_withSeed(view.data(), view.size(), static_cast<uint64_t>(uri.type));
+}
+
+void RegistrySnapshot::visit(std::function<void(Resource, uint32_t, uint32_t)> visitor) const
+{
+    for (size_t i = 0; i < bucket_count_; ++i) {
+        const Bucket b = bucket(i);
+        if (b.container == empty_bucket) { continue; }
+        if (size_t(b.resref_offset) + b.resref_size > strings_size_) { continue; }
+        Resource res{StringView{strings_ + b.resref_offset, b.resref_size},
+            static_cast<ResourceType::type>(b.type)};
+        visitor(res, b.container, b.ordinal);
+    }
+}
+
+std::shared_ptr<RegistrySnapshot> RegistrySnapshot::open(const fs::path& path)
+{
+    std::error_code ec;
+    if (!fs::exists(path, ec)) { return nullptr; }
+
+    auto file = MappedFile::open(path);
+    if (!file) { return nullptr; }
+
+    SnapshotHeader header;
+    if (!range_contains(file->size(), 0, sizeof(header))) {
+        LOG_F(WARNING, "[resman] registry snapshot '{}' is truncated", path);
+        return nullptr;
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, snapshot_magic, 4) != 0 || header.version != version) {
+        LOG_F(INFO, "[resman] registry snapshot '{}' has an unsupported version", path);
+        return nullptr;
+    }
+
+    const bool valid = range_contains(file->size(), header.containers_offset,
+                           uint64_t(header.container_count) * sizeof(SnapshotContainer))
+        && range_contains(file->size(), header.buckets_offset, uint64_t(header.bucket_count) * sizeof(Bucket))
+        && range_contains(file->size(), header.strings_offset, header.strings_size)
+        && (header.bucket_count == 0 || std::has_single_bit(header.bucket_count))
+        && header.entry_count <= header.bucket_count;
+    if (!valid) {
+        LOG_F(WARNING, "[resman] registry snapshot '{}' is corrupt", path);
+        return nullptr;
+    }
+
+    auto result = std::make_shared<RegistrySnapshot>();
+    result->containers_ = file->data() + header.containers_offset;
+    result->buckets_ = file->data() + header.buckets_offset;
+    result->strings_ = reinterpret_cast<const char*>(file->data() + header.strings_offset);
+    result->containers_count_ = header.container_count;
+    result->bucket_count_ = header.bucket_count;
+    result->entry_count_ = header.entry_count;
+    result->strings_size_ = header.strings_size;
+
+    for (size_t i = 0; i < result->containers_count_; ++i) {
+        SnapshotContainer c;
+        std::memcpy(&c, result->containers_ + i * sizeof(SnapshotContainer), sizeof(SnapshotContainer));
+        if (!range_contains(result->strings_size_, c.path_offset, c.path_size)) {
+            LOG_F(WARNING, "[resman] registry snapshot '{}' is corrupt", path);
+            return nullptr;
+        }
+    }
+
+    result->file_ = std::move(file);
+    return result;
+}
+
+bool RegistrySnapshot::write(const fs::path& path, const Vector<ContainerStamp>& containers,
+    const Vector<Vector<Entry>>& entries)
+{
+    if (containers.size() != entries.size()) { return false; }
+
+    size_t entry_count = 0;
+    for (const auto& it : entries) {
+        entry_count += it.size();
+    }
+
+    // Keep the table at most half full so probe sequences stay short.
+    const size_t bucket_count = entry_count == 0 ? 0 : std::bit_ceil(entry_count * 2);
+
+    String strings;
+    Vector<SnapshotContainer> records;
+    records.reserve(containers.size());
+    for (const auto& c : containers) {
+        SnapshotContainer rec{};
+        rec.file_size = c.file_size;
+        rec.mtime = c.mtime;
+        rec.path_offset = static_cast<uint32_t>(strings.size());
+        rec.path_size = static_cast<uint32_t>(c.path.size());
+        rec.resource_count = c.resource_count;
+        strings.append(c.path);
+        records.push_back(rec);
+    }
+
+    Vector<Bucket> buckets(bucket_count, Bucket{0, 0, 0, 0, empty_bucket, 0});
+    const size_t mask = bucket_count - 1;
+    for (size_t ci = 0; ci < entries.size(); ++ci) {
+        for (const auto& e : entries[ci]) {
+            auto view = e.resource.resref.view();
+            Bucket b{hash(e.resource), static_cast<uint32_t>(strings.size()),
+                static_cast<uint16_t>(view.size()), static_cast<uint16_t>(e.resource.type),
+                static_cast<uint32_t>(ci), e.ordinal};
+            strings.append(view);
+
+            size_t i = b.hash & mask;
+            while (buckets[i].container != empty_bucket) {
+                i = (i + 1) & mask;
+            }
+            buckets[i] = b;
+        }
+    }
+
+    if (strings.size() > std::numeric_limits<uint32_t>::max()) {
+        LOG_F(ERROR, "[resman] registry snapshot string table is too large");
+        return false;
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, 4);
+    header.version = version;
+    header.container_count = static_cast<uint32_t>(records.size());
+    header.bucket_count = static_cast<uint32_t>(bucket_count);
+    header.entry_count = static_cast<uint32_t>(entry_count);
+    header.strings_size = static_cast<uint32_t>(strings.size());
+    header.containers_offset = sizeof(SnapshotHeader);
+    header.buckets_offset = align8(header.containers_offset + records.size() * sizeof(SnapshotContainer));
+    header.strings_offset = header.buckets_offset + buckets.size() * sizeof(Bucket);
+
+    // Written beside the destination and renamed, so a concurrent reader never maps a partial file.
+    std::error_code ec;
+    if (path.has_parent_path()) { fs::create_directories(path.parent_path(), ec); }
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+        if (!out) {
+            LOG_F(ERROR, "[resman] unable to write registry snapshot '{}'", tmp);
+            return false;
+        }
+        const char padding[8] = {};
+        ostream_write(out, &header, sizeof(header));
+        ostream_write(out, records.data(), records.size() * sizeof(SnapshotContainer));
+        ostream_write(out, padding, header.buckets_offset - header.containers_offset - records.size() * sizeof(SnapshotContainer));
+        ostream_write(out, buckets.data(), buckets.size() * sizeof(Bucket));
+        ostream_write(out, strings.data(), strings.size());
+        if (!out) {
+            LOG_F(ERROR, "[resman] unable to write registry snapshot '{}'", tmp);
+            return false;
+        }
+    }
+
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        LOG_F(ERROR, "[resman] unable to replace registry snapshot '{}': {}", path, ec.message());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace nw
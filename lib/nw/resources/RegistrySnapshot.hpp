@@ -0,0 +1,127 @@
+#pragma once
+
+#include "assets.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace nw {
+
+struct Container;
+struct MappedFile;
+
+/// Identifies a container file on disk, a snapshot is only reused for containers whose stamp matches
+struct ContainerStamp {
+    String path;
+    uint64_t file_size = 0;
+    int64_t mtime = 0;
+    uint32_t resource_count = 0;
+
+    bool operator==(const ContainerStamp&) const = default;
+
+    /// Stamps a container, std::nullopt if its backing path is not a regular file or it cannot
+    /// resolve keys by ordinal.
+    static std::optional<ContainerStamp> from_container(const Container* container);
+};
+
+/// Persisted, memory mapped resource registry
+///
+/// A snapshot records, for every container it was built from, the ordinal (in ``Container::visit``
+/// order) of each resource.  Lookups probe an open addressing table directly in the mapping, so
+/// no hash map has to be rebuilt on load.
+struct RegistrySnapshot {
+    static constexpr uint32_t version = 1;
+
+    /// A resource entry in a snapshot container
+    struct Entry {
+        Resource resource;
+        uint32_t ordinal = 0;
+    };
+
+    RegistrySnapshot() = default;
+    RegistrySnapshot(const RegistrySnapshot&) = delete;
+    RegistrySnapshot& operator=(const RegistrySnapshot&) = delete;
+
+    /// Gets the number of containers in the snapshot
+    size_t container_count() const noexcept { return containers_count_; }
+
+    /// Gets the stamp of a snapshot container
+    ContainerStamp container(size_t index) const;
+
+    /// Gets the number of entries in the snapshot
+    size_t entry_count() const noexcept { return entry_count_; }
+
+    /// Calls ``visitor(container, ordinal)`` for every entry matching ``uri``
+    template <typename Visitor>
+    void find(Resource uri, Visitor&& visitor) const;
+
+    /// Calls ``visitor(resource, container, ordinal)`` for every entry
+    void visit(std::function<void(Resource, uint32_t, uint32_t)> visitor) const;
+
+    /// Maps and validates a snapshot, nullptr if missing, corrupt, or of a different version
+    static std::shared_ptr<RegistrySnapshot> open(const std::filesystem::path& path);
+
+    /// Writes a snapshot, ``entries[i]`` are the resources of ``containers[i]``
+    static bool write(const std::filesystem::path& path, const Vector<ContainerStamp>& containers,
+        const Vector<Vector<Entry>>& entries);
+
+    /// @private
+    struct Bucket {
+        uint64_t hash;
+        uint32_t resref_offset;
+        uint16_t resref_size;
+        uint16_t type;
+        uint32_t container;
+        uint32_t ordinal;
+    };
+    static_assert(sizeof(Bucket) == 24);
+
+    static constexpr uint32_t empty_bucket = 0xFFFFFFFF;
+
+    /// Hash of a resource, stable across processes
+    static uint64_t hash(Resource uri) noexcept;
+
+private:
+    Bucket bucket(size_t index) const noexcept
+    {
+        Bucket result;
+        std::memcpy(&result, buckets_ + index * sizeof(Bucket), sizeof(Bucket));
+        return result;
+    }
+
+    bool matches(const Bucket& b, uint64_t h, Resource uri) const noexcept
+    {
+        if (b.hash != h || b.type != static_cast<uint16_t>(uri.type)) { return false; }
+        if (size_t(b.resref_offset) + b.resref_size > strings_size_) { return false; }
+        return StringView{strings_ + b.resref_offset, b.resref_size} == uri.resref.view();
+    }
+
+    std::shared_ptr<MappedFile> file_;
+    const uint8_t* containers_ = nullptr;
+    const uint8_t* buckets_ = nullptr;
+    const char* strings_ = nullptr;
+    size_t containers_count_ = 0;
+    size_t bucket_count_ = 0;
+    size_t entry_count_ = 0;
+    size_t strings_size_ = 0;
+};
+
+template <typename Visitor>
+void RegistrySnapshot::find(Resource uri, Visitor&& visitor) const
+{
+    if (bucket_count_ == 0) { return; }
+
+    const uint64_t h = hash(uri);
+    const size_t mask = bucket_count_ - 1;
+    for (size_t i = h & mask, n = 0; n < bucket_count_; i = (i + 1) & mask, ++n) {
+        const Bucket b = bucket(i);
+        if (b.container == empty_bucket) { return; }
+        if (matches(b, h, uri)) { visitor(b.container, b.ordinal); }
+    }
+}
+
+} // namespace nw
@@ -1,5 +1,6 @@
 #include "ResourceManager.hpp"
 
+#include "RegistrySnapshot.hpp"
 #include "StaticDirectory.hpp"
 #include "StaticErf.hpp"
 #include "StaticKey.hpp"
@@ -7,12 +8,14 @@
 
 #include "../formats/palette_textures.hpp"
 #include "../kernel/GameProfile.hpp"
+#include "../kernel/JobSystem.hpp"
 #include "../util/macros.hpp"
 #include "../util/platform.hpp"
 #include "../util/profile.hpp"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <filesystem>
@@ -21,6 +24,7 @@
 #include <memory>
 #include <optional>
 #include <string_view>
+#include <tuple>
 
 namespace fs = std::filesystem;
 using namespace std::literals;
@@ -28,6 +32,7 @@ using namespace std::literals;
 namespace nw {
 
 const std::type_index ResourceManager::type_index{typeid(ResourceManager)};
+size_t ResourceManager::service_slot = kernel::Services::no_slot;
 
 inline Container* get_container(const LocatorVariant& var)
 {
@@ -107,6 +112,12 @@ ResourceManager::ResourceManager(MemoryResource* scope, const ResourceManager* p
 {
 }
 
+ResourceManager::~ResourceManager()
+{
+    // Kernel services are unreachable by now, the job system is destroyed after this service
+    if (async_job_system_ && !async_jobs_.done()) { async_job_system_->wait(async_jobs_); }
+}
+
 void ResourceManager::initialize(kernel::ServiceInitTime time)
 {
     NW_PROFILE_SCOPE_N("resman.initialize");
@@ -243,6 +254,18 @@ nlohmann::json ResourceManager::stats() const
     j["name"] = "resources service";
     j["total_static_assets"] = registry_.size();
     j["generation"] = generation_;
+    j["memory_mapped_containers"] = memory_mapped_containers_;
+    j["build_registry"] = {
+        {"containers", build_stats_.containers},
+        {"workers", build_stats_.workers},
+        {"index_ms", build_stats_.index_ms},
+        {"merge_ms", build_stats_.merge_ms},
+    };
+    j["registry_snapshot"] = {
+        {"reused_containers", snapshot_stats_.reused},
+        {"rescanned_containers", snapshot_stats_.rescanned},
+        {"written", snapshot_stats_.written},
+    };
     return j;
 }
 
@@ -346,14 +369,141 @@ void ResourceManager::build_registry()
     NW_PROFILE_SCOPE_N("resman.build_registry");
 
     ENSURE_OR_RETURN(!frozen_, "[resman] asset registry is already frozen");
-    Container* current = nullptr;
+
+    using clock = std::chrono::high_resolution_clock;
+    auto start = clock::now();
+
+    Vector<Container*> containers;
+    containers.reserve(search_.size());
+    for (auto& [cont, _] : search_) {
+        containers.push_back(get_container(cont));
+    }
+
+    // Containers whose stamp matches the persisted snapshot are not rescanned, ``reuse[i]`` is the
+    // index of container ``i`` in the snapshot.
+    const fs::path snapshot_path = kernel::config().options().registry_snapshot;
+    std::shared_ptr<RegistrySnapshot> snapshot;
+    Vector<std::optional<ContainerStamp>> stamps(containers.size());
+    Vector<int64_t> reuse(containers.size(), -1);
+    if (!snapshot_path.empty()) {
+        NW_PROFILE_SCOPE_N("resman.build_registry.snapshot_load");
+        snapshot = RegistrySnapshot::open(snapshot_path);
+        for (size_t i = 0; i < containers.size(); ++i) {
+            stamps[i] = ContainerStamp::from_container(containers[i]);
+            if (!snapshot || !stamps[i]) { continue; }
+            for (size_t j = 0; j < snapshot->container_count(); ++j) {
+                if (snapshot->container(j) == *stamps[i]) {
+                    reuse[i] = static_cast<int64_t>(j);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Containers are indexed independently, so their enumeration can proceed in parallel.  The
+    // merge below is done in search order, so the top container still wins.
+    using ContainerIndex = Vector<std::pair<Resource, const ContainerKey*>>;
+    Vector<ContainerIndex> indices(containers.size());
+    Vector<uint8_t> indexed_containers(containers.size(), 0);
+    Vector<uint8_t> mapped(containers.size(), 0);
+    const bool memory_map = kernel::config().options().memory_map_containers;
+
+    auto index_container = [&](size_t i) {
+        NW_PROFILE_SCOPE_N("resman.build_registry.index_container");
+        Container* c = containers[i];
+        if (memory_map && !mapped[i] && c->memory_map()) { mapped[i] = 1; }
+        if (reuse[i] >= 0 || indexed_containers[i]) { return; }
+        auto& index = indices[i];
+        index.reserve(c->size());
+        c->visit([&index](Resource uri, const ContainerKey* key) {
+            index.emplace_back(uri, key);
+        });
+        indexed_containers[i] = 1;
+    };
+
+    auto* jobs = kernel::services().get_mut<kernel::JobSystem>();
+    auto index_all = [&]() {
+        NW_PROFILE_SCOPE_N("resman.build_registry.index");
+        if (jobs) {
+            NW_PROFILE_VALUE(jobs->worker_count());
+            jobs->parallel_for(containers.size(), index_container);
+        } else {
+            for (size_t i = 0; i < containers.size(); ++i) {
+                index_container(i);
+            }
+        }
+    };
+    index_all();
+    auto indexed = clock::now();
+
+    snapshot_stats_ = {};
+    if (!snapshot_path.empty()) {
+        NW_PROFILE_SCOPE_N("resman.build_registry.snapshot_write");
+
+        size_t stamped = 0;
+        bool current = !!snapshot;
+        for (size_t i = 0; i < containers.size(); ++i) {
+            if (!stamps[i]) { continue; }
+            ++stamped;
+            current = current && reuse[i] >= 0;
+        }
+        current = current && snapshot->container_count() == stamped;
+
+        if (!current) {
+            // Entries of reused containers are carried over from the old snapshot, the rest come from
+            // the fresh indices.  Ordinals are positions in ``Container::visit`` order.
+            Vector<ContainerStamp> out_stamps;
+            Vector<Vector<RegistrySnapshot::Entry>> out_entries;
+            Vector<int64_t> out_slot(containers.size(), -1);
+            Vector<int64_t> snapshot_slot(snapshot ? snapshot->container_count() : 0, -1);
+            for (size_t i = 0; i < containers.size(); ++i) {
+                if (!stamps[i]) { continue; }
+                out_slot[i] = static_cast<int64_t>(out_stamps.size());
+                out_stamps.push_back(*stamps[i]);
+                auto& entries = out_entries.emplace_back();
+                if (reuse[i] >= 0) {
+                    snapshot_slot[static_cast<size_t>(reuse[i])] = out_slot[i];
+                } else {
+                    entries.reserve(indices[i].size());
+                    for (size_t k = 0; k < indices[i].size(); ++k) {
+                        entries.push_back({indices[i][k].first, static_cast<uint32_t>(k)});
+                    }
+                }
+            }
+            if (snapshot) {
+                snapshot->visit([&](Resource res, uint32_t container, uint32_t ordinal) {
+                    if (container < snapshot_slot.size() && snapshot_slot[container] >= 0) {
+                        out_entries[static_cast<size_t>(snapshot_slot[container])].push_back({res, ordinal});
+                    }
+                });
+            }
+
+            // Release the old mapping before it is replaced on disk.
+            snapshot.reset();
+            if (RegistrySnapshot::write(snapshot_path, out_stamps, out_entries)) {
+                snapshot = RegistrySnapshot::open(snapshot_path);
+                snapshot_stats_.written = !!snapshot;
+            }
+
+            if (snapshot) {
+                for (size_t i = 0; i < containers.size(); ++i) {
+                    reuse[i] = out_slot[i];
+                }
+            } else {
+                // Without a snapshot every container has to be in the hash map.
+                std::fill(reuse.begin(), reuse.end(), -1);
+                index_all();
+            }
+        }
+    }
 
     size_t sz = 0;
+    memory_mapped_containers_ = 0;
     {
         NW_PROFILE_SCOPE_N("resman.build_registry.count");
-        for (auto& [cont, _] : search_) {
-            current = get_container(cont);
-            sz += current->size();
+        for (size_t i = 0; i < indices.size(); ++i) {
+            if (reuse[i] < 0) { sz += indices[i].size(); }
+            memory_mapped_containers_ += mapped[i];
         }
     }
 
@@ -363,17 +513,36 @@ void ResourceManager::build_registry()
     }
 
     // The registry will determine how assets stack..
-    auto cb = [this, &current](Resource uri, const ContainerKey* key) {
-        registry_.insert(uri, current, key);
-    };
-
     {
-        NW_PROFILE_SCOPE_N("resman.build_registry.visit");
-        for (auto& [cont, _] : search_) {
-            current = get_container(cont);
-            current->visit(cb);
+        NW_PROFILE_SCOPE_N("resman.build_registry.merge");
+        for (size_t i = 0; i < containers.size(); ++i) {
+            if (reuse[i] >= 0) {
+                ++snapshot_stats_.reused;
+                continue;
+            }
+            if (stamps[i]) { ++snapshot_stats_.rescanned; }
+            for (const auto& [uri, key] : indices[i]) {
+                registry_.insert(uri, containers[i], key, static_cast<uint32_t>(i));
+            }
+        }
+
+        if (snapshot) {
+            Vector<Container*> snapshot_containers(snapshot->container_count(), nullptr);
+            Vector<uint32_t> priorities(snapshot->container_count(), 0);
+            for (size_t i = 0; i < containers.size(); ++i) {
+                if (reuse[i] < 0) { continue; }
+                snapshot_containers[static_cast<size_t>(reuse[i])] = containers[i];
+                priorities[static_cast<size_t>(reuse[i])] = static_cast<uint32_t>(i);
+            }
+            registry_.attach(std::move(snapshot), std::move(snapshot_containers), std::move(priorities));
         }
     }
+    auto merged = clock::now();
+
+    build_stats_.containers = containers.size();
+    build_stats_.workers = jobs ? std::clamp<size_t>(jobs->worker_count() + 1, 1, std::max<size_t>(containers.size(), 1)) : 1;
+    build_stats_.index_ms = std::chrono::duration<double, std::milli>(indexed - start).count();
+    build_stats_.merge_ms = std::chrono::duration<double, std::milli>(merged - indexed).count();
 
     frozen_ = true;
     advance_generation();
@@ -394,6 +563,101 @@ ResourceData ResourceManager::demand(Resource uri) const
     return result;
 }
 
+Vector<ResourceData> ResourceManager::demand_many(std::span<const Resource> uris) const
+{
+    Vector<ResourceData> result(uris.size());
+    demand_many(uris, [&result](size_t index, ResourceData data) {
+        result[index] = std::move(data);
+    });
+    return result;
+}
+
+void ResourceManager::demand_many(std::span<const Resource> uris,
+    const std::function<void(size_t, ResourceData)>& callback) const
+{
+    NW_PROFILE_SCOPE_N("resman.demand_many");
+    if (uris.empty()) { return; }
+
+    struct Request {
+        Container* container;
+        const ContainerKey* key;
+        uint64_t order;
+        size_t index;
+    };
+
+    // Resolve everything up front so requests can be grouped by container and sorted by file
+    // offset, anything not in this registry falls through to the parent.
+    Vector<Request> requests;
+    requests.reserve(uris.size());
+    Vector<size_t> missing;
+    for (size_t i = 0; i < uris.size(); ++i) {
+        auto [container, key] = registry_.locate(uris[i]);
+        if (container) {
+            requests.push_back({container, key, container->read_order(key), i});
+        } else {
+            missing.push_back(i);
+        }
+    }
+
+    std::sort(requests.begin(), requests.end(), [](const Request& lhs, const Request& rhs) {
+        return std::tie(lhs.container, lhs.order) < std::tie(rhs.container, rhs.order);
+    });
+
+    Vector<std::pair<size_t, size_t>> groups;
+    for (size_t i = 0; i < requests.size();) {
+        size_t j = i + 1;
+        while (j < requests.size() && requests[j].container == requests[i].container) {
+            ++j;
+        }
+        groups.emplace_back(i, j);
+        i = j;
+    }
+
+    auto read_group = [&](size_t g) {
+        NW_PROFILE_SCOPE_N("resman.demand_many.container");
+        for (size_t i = groups[g].first; i < groups[g].second; ++i) {
+            auto data = requests[i].container->demand(requests[i].key);
+            if (parent_ && data.bytes.size() == 0) {
+                data = parent_->demand(uris[requests[i].index]);
+            }
+            callback(requests[i].index, std::move(data));
+        }
+    };
+
+    if (auto* jobs = kernel::services().get_mut<kernel::JobSystem>()) {
+        jobs->parallel_for(groups.size(), read_group);
+    } else {
+        for (size_t g = 0; g < groups.size(); ++g) {
+            read_group(g);
+        }
+    }
+
+    for (size_t i : missing) {
+        callback(i, parent_ ? parent_->demand(uris[i]) : ResourceData{});
+    }
+}
+
+std::future<Vector<ResourceData>> ResourceManager::demand_many_async(Vector<Resource> uris) const
+{
+    auto promise = std::make_shared<std::promise<Vector<ResourceData>>>();
+    auto result = promise->get_future();
+    auto job = [this, promise, uris = std::move(uris)]() {
+        try {
+            promise->set_value(demand_many(uris));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    };
+
+    if (auto* jobs = kernel::services().get_mut<kernel::JobSystem>()) {
+        async_job_system_ = jobs;
+        jobs->run(async_jobs_, std::move(job));
+    } else {
+        job();
+    }
+    return result;
+}
+
 ResourceData ResourceManager::demand_in_order(Resref resref, std::initializer_list<ResourceType::type> restypes) const
 {
     ResourceData result;
@@ -4,9 +4,13 @@
 
 #include "../formats/Image.hpp"
 #include "../formats/Plt.hpp"
+#include "../kernel/JobSystem.hpp"
 #include "../kernel/Kernel.hpp"
 
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <span>
 #include <variant>
 
 namespace nw {
@@ -35,11 +39,27 @@ struct LocatorPayload {
     ResourceType::type restype = ResourceType::invalid;
 };
 
+/// Timings of the most recent ``ResourceManager::build_registry``
+struct RegistryBuildStats {
+    size_t containers = 0; ///< Number of containers indexed
+    size_t workers = 0;    ///< Number of threads containers were indexed on
+    double index_ms = 0.0; ///< Time spent enumerating containers
+    double merge_ms = 0.0; ///< Time spent merging container indices into the registry
+};
+
+/// Outcome of loading the registry snapshot in the most recent ``ResourceManager::build_registry``
+struct RegistrySnapshotStats {
+    size_t reused = 0;    ///< Containers restored from the snapshot
+    size_t rescanned = 0; ///< Snapshot capable containers that had changed and were rescanned
+    bool written = false; ///< Whether a new snapshot was written
+};
+
 struct ResourceManager final : public kernel::Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     ResourceManager(MemoryResource* memory, const ResourceManager* parent = nullptr);
-    virtual ~ResourceManager() = default;
+    virtual ~ResourceManager();
 
     using SearchVector = Vector<LocatorPayload>;
 
@@ -62,14 +82,38 @@ struct ResourceManager final : public kernel::Service {
         ResourceType::type restype = ResourceType::invalid);
 
     /// Builds resource main registry
+    /// @note Containers are enumerated in parallel on the job system, then merged in priority order.
     void build_registry();
 
+    /// Gets timings of the most recent registry build
+    const RegistryBuildStats& build_stats() const noexcept { return build_stats_; }
+
+    /// Gets registry snapshot usage of the most recent registry build
+    /// @note Snapshots are enabled by ``ConfigOptions::registry_snapshot``
+    const RegistrySnapshotStats& snapshot_stats() const noexcept { return snapshot_stats_; }
+
     /// Determines if a resource is in the resource manager
     bool contains(Resource uri) const noexcept;
 
     /// Demand some resource
     ResourceData demand(Resource uri) const;
 
+    /// Demands a batch of resources, ``result[i]`` is the data of ``uris[i]``
+    /// @note Requests are grouped by container and sorted so that each container's file is read
+    /// sequentially, containers are read in parallel on the job system.
+    Vector<ResourceData> demand_many(std::span<const Resource> uris) const;
+
+    /// Demands a batch of resources, calling ``callback(i, data)`` as soon as ``uris[i]`` is read
+    /// @note ``callback`` is invoked concurrently from job system workers, so that parsing overlaps I/O.
+    /// Returns once every callback has completed.
+    void demand_many(std::span<const Resource> uris,
+        const std::function<void(size_t, ResourceData)>& callback) const;
+
+    /// Demands a batch of resources as a job system job
+    /// @note The registry must not be rebuilt until the future is ready.  Without job system workers
+    /// the batch is read before returning.
+    std::future<Vector<ResourceData>> demand_many_async(Vector<Resource> uris) const;
+
     /// Demand some resource by resource priority
     ResourceData demand_in_order(Resref resref, std::initializer_list<ResourceType::type> restypes) const;
 
@@ -151,6 +195,11 @@ private:
     std::array<std::unique_ptr<Image>, plt_layer_size> palette_textures_;
 
     ResourceRegistry registry_;
+    size_t memory_mapped_containers_ = 0;
+    RegistryBuildStats build_stats_;
+    RegistrySnapshotStats snapshot_stats_;
+    mutable kernel::JobGroup async_jobs_; ///< Pending ``demand_many_async`` batches
+    mutable kernel::JobSystem* async_job_system_ = nullptr; ///< Runs ``async_jobs_``, outlives this service
     uint64_t generation_ = 1;
     bool frozen_ = false;
 };
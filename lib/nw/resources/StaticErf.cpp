@@ -2,6 +2,7 @@
 
 #include "../i18n/conversion.hpp"
 #include "../log.hpp"
+#include "../util/MappedFile.hpp"
 #include "../util/templates.hpp"
 
 #include <nowide/convert.hpp>
@@ -96,6 +97,19 @@ ResourceData StaticErf::demand(const ContainerKey* key) const
     return result;
 }
 
+bool StaticErf::memory_map()
+{
+    if (!is_loaded_) { return false; }
+    if (mapped_) { return true; }
+
+    mapped_ = MappedFile::open(path_);
+    if (mapped_ && static_cast<std::streamsize>(mapped_->size()) != fsize_) {
+        LOG_F(ERROR, "[erf] '{}' changed size since it was loaded", path_);
+        mapped_.reset();
+    }
+    return !!mapped_;
+}
+
 void StaticErf::visit(std::function<void(Resource, const ContainerKey*)> visitor) const
 {
     for (const auto& it : elements_) {
@@ -103,6 +117,18 @@ void StaticErf::visit(std::function<void(Resource, const ContainerKey*)> visitor
     }
 }
 
+const ContainerKey* StaticErf::key_at(size_t ordinal) const
+{
+    if (ordinal >= elements_.size()) { return nullptr; }
+    return reinterpret_cast<const ContainerKey*>(&elements_[ordinal]);
+}
+
+uint64_t StaticErf::read_order(const ContainerKey* key) const
+{
+    auto k = reinterpret_cast<const detail::ErfKey*>(key);
+    return k ? k->offset : 0;
+}
+
 size_t StaticErf::size() const
 {
     return elements_.size();
@@ -243,18 +269,24 @@ ResourceData StaticErf::read(const detail::ErfKey* ele) const
         return data;
     }
 
-    std::ifstream stream(path_, std::ios::binary);
-    if (!stream) {
-        LOG_F(ERROR, "[erf] failed to open file at '{}', path");
-        return data;
-    }
-
     if (!file_range_contains(fsize_, ele->offset, ele->size)) {
         LOG_F(ERROR, "[erf] failed reading asset from '{}': range offset={}, size={} is out of bounds.",
             path_, ele->offset, ele->size);
         return data;
     }
 
+    if (mapped_) {
+        auto bytes = mapped_->slice(ele->offset, ele->size);
+        data.bytes = ByteArray::borrow(mapped_, bytes.data(), bytes.size());
+        return data;
+    }
+
+    std::ifstream stream(path_, std::ios::binary);
+    if (!stream) {
+        LOG_F(ERROR, "[erf] failed to open file at '{}'", path_);
+        return data;
+    }
+
     stream.seekg(ele->offset);
     if (!stream) {
         LOG_F(ERROR, "[erf] failed reading asset from '{}': file offset out of bounds.", path_);
@@ -262,7 +294,7 @@ ResourceData StaticErf::read(const detail::ErfKey* ele) const
     }
 
     data.bytes.resize(ele->size);
-    istream_read(stream, data.bytes.data(), ele->size);
+    istream_read(stream, data.bytes.mutable_data(), ele->size);
 
     return data;
 }
@@ -7,9 +7,12 @@
 #include <absl/container/flat_hash_map.h>
 
 #include <filesystem>
+#include <memory>
 
 namespace nw {
 
+struct MappedFile;
+
 namespace detail {
 
 /// @private
@@ -38,6 +41,12 @@ public:
     /// Reads resource data, empty ResourceData if no match.
     ResourceData demand(const ContainerKey* key) const override;
 
+    /// Maps the erf into memory, demanded resources borrow from the mapping
+    bool memory_map() override;
+
+    /// Determines if the erf is memory mapped
+    bool memory_mapped() const noexcept override { return !!mapped_; }
+
     /// Gets the shortend name of the container, should be analog to `basename container`
     const String& name() const override { return name_; }
 
@@ -53,6 +62,12 @@ public:
     /// Enumerates all assets in a container
     void visit(std::function<void(Resource, const ContainerKey*)> visitor) const override;
 
+    /// Gets the key of the ``ordinal``th asset enumerated by ``visit``
+    const ContainerKey* key_at(size_t ordinal) const override;
+
+    /// Gets the offset of ``key`` in the erf
+    uint64_t read_order(const ContainerKey* key) const override;
+
     /// Erf type.
     ErfType type = ErfType::erf;
     /// Version
@@ -69,6 +84,7 @@ private:
     std::streamsize fsize_;
     bool is_loaded_ = false;
     PVector<detail::ErfKey> elements_;
+    std::shared_ptr<MappedFile> mapped_;
 
     bool load(const std::filesystem::path& path);
     ResourceData read(const detail::ErfKey* element) const;
@@ -2,6 +2,7 @@
 
 #include "../log.hpp"
 #include "../util/ByteArray.hpp"
+#include "../util/MappedFile.hpp"
 #include "../util/templates.hpp"
 
 #include <nowide/convert.hpp>
@@ -122,16 +123,32 @@ ByteArray Bif::demand(size_t index) const
     } else if (!file_range_contains(fsize_, elements[index].offset, elements[index].size)) {
         LOG_F(ERROR, "{}: Invalid range offset={}, size={}, file size={}", path_,
             elements[index].offset, elements[index].size, fsize_);
+    } else if (mapped_) {
+        auto bytes = mapped_->slice(elements[index].offset, elements[index].size);
+        ba = ByteArray::borrow(mapped_, bytes.data(), bytes.size());
     } else {
         std::ifstream file_{path_, std::ios_base::binary};
         ba.resize(elements[index].size);
         file_.seekg(elements[index].offset, std::ios_base::beg);
-        istream_read(file_, ba.data(), elements[index].size);
+        istream_read(file_, ba.mutable_data(), elements[index].size);
     }
 
     return ba;
 }
 
+bool Bif::memory_map()
+{
+    if (!is_loaded_) { return false; }
+    if (mapped_) { return true; }
+
+    mapped_ = MappedFile::open(path_);
+    if (mapped_ && static_cast<std::streamsize>(mapped_->size()) != fsize_) {
+        LOG_F(ERROR, "{}: BIF changed size since it was loaded", path_);
+        mapped_.reset();
+    }
+    return !!mapped_;
+}
+
 #undef CHECK_RANGE
 
 }
@@ -197,6 +214,23 @@ ResourceData StaticKey::demand(const ContainerKey* key) const
     return data;
 }
 
+bool StaticKey::memory_map()
+{
+    if (!is_loaded_) { return false; }
+    if (memory_mapped_) { return true; }
+
+    for (auto& bif : bifs_) {
+        if (!bif.memory_map()) {
+            for (auto& it : bifs_) {
+                it.mapped_.reset();
+            }
+            return false;
+        }
+    }
+    memory_mapped_ = true;
+    return true;
+}
+
 int StaticKey::extract(const std::regex& pattern, const std::filesystem::path& output) const
 {
     if (!std::filesystem::is_directory(output)) {
@@ -236,6 +270,21 @@ void StaticKey::visit(std::function<void(Resource, const ContainerKey*)> visitor
     }
 }
 
+const ContainerKey* StaticKey::key_at(size_t ordinal) const
+{
+    if (ordinal >= elements_.size()) { return nullptr; }
+    return reinterpret_cast<const ContainerKey*>(&elements_[ordinal]);
+}
+
+uint64_t StaticKey::read_order(const ContainerKey* key) const
+{
+    auto k = static_cast<const detail::StaticKeyKey*>(key);
+    if (!k || k->element.bif >= bifs_.size()) { return 0; }
+    const auto& bif = bifs_[k->element.bif];
+    uint64_t offset = k->element.index < bif.elements.size() ? bif.elements[k->element.index].offset : 0;
+    return (uint64_t(k->element.bif) << 32) | offset;
+}
+
 // ---- Private ---------------------------------------------------------------
 
 #define CHECK_RANGE(offset, size)                                                      \
@@ -13,6 +13,7 @@
 namespace nw {
 
 struct ByteArray;
+struct MappedFile;
 struct StaticKey;
 
 namespace detail {
@@ -38,12 +39,16 @@ struct Bif {
 
     ByteArray demand(size_t index) const;
 
+    /// Maps the bif into memory, demanded resources borrow from the mapping
+    bool memory_map();
+
     StaticKey* key_ = nullptr;
     std::filesystem::path path_;
     std::streamsize fsize_ = 0;
     PVector<BifElement> elements;
     bool is_loaded_ = false;
     nw::MemoryResource* allocator_ = nullptr;
+    std::shared_ptr<MappedFile> mapped_;
 
     bool load();
 };
@@ -77,6 +82,12 @@ struct StaticKey final : public Container {
     /// Reads resource data, empty ResourceData if no match.
     ResourceData demand(const ContainerKey* key) const override;
 
+    /// Maps all bifs into memory, demanded resources borrow from the mappings
+    bool memory_map() override;
+
+    /// Determines if the bifs are memory mapped
+    bool memory_mapped() const noexcept override { return memory_mapped_; }
+
     /// Extracts resources by regex
     /// @note If one prefers glob syntax see `nw::string::glob_to_regex`
     int extract(const std::regex& pattern, const std::filesystem::path& output) const;
@@ -96,6 +107,12 @@ struct StaticKey final : public Container {
     /// Enumerates all assets in a container
     void visit(std::function<void(Resource, const ContainerKey*)> visitor) const override;
 
+    /// Gets the key of the ``ordinal``th asset enumerated by ``visit``
+    const ContainerKey* key_at(size_t ordinal) const override;
+
+    /// Gets the bif and offset of ``key``, bif in the upper 32 bits
+    uint64_t read_order(const ContainerKey* key) const override;
+
     StaticKey& operator=(const StaticKey&) = delete;
     StaticKey& operator=(StaticKey&&) = default;
 
@@ -106,6 +123,7 @@ private:
     PVector<detail::Bif> bifs_;
     PVector<detail::StaticKeyKey> elements_;
     bool is_loaded_ = false;
+    bool memory_mapped_ = false;
 
     bool load();
 };
@@ -39,14 +39,21 @@ StaticZip::StaticZip(const fs::path& path, nw::MemoryResource* allocator)
 
 StaticZip::~StaticZip() = default;
 
+void StaticZip::ArchiveDeleter::operator()(zip_t* zip) const noexcept
+{
+    // Archives are opened read-only, there is nothing to write back.
+    if (zip) { zip_discard(zip); }
+}
+
 bool StaticZip::load()
 {
     int err = 0;
-    zip_t* zip = zip_open(path_.c_str(), ZIP_RDONLY, &err);
-    if (!zip) {
+    ArchiveHandle archive{zip_open(path_.c_str(), ZIP_RDONLY, &err)};
+    if (!archive) {
         LOG_F(ERROR, "zip unable to open {} (err={})", path_, err);
         return false;
     }
+    zip_t* zip = archive.get();
 
     zip_int64_t count = zip_get_num_entries(zip, 0);
     for (zip_uint64_t i = 0; i < static_cast<zip_uint64_t>(count); ++i) {
@@ -77,12 +84,47 @@ bool StaticZip::load()
         }
     }
 
-    zip_close(zip);
+    max_pooled_archives_ = std::max(size_t(1), size_t(nw::kernel::config().options().zip_pooled_archives));
+    pool_.push_back(std::move(archive));
 
     LOG_F(INFO, "{}: Loaded {} resource(s).", path_, elements_.size());
     return true;
 }
 
+StaticZip::ArchiveHandle StaticZip::acquire_archive() const
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (!pool_.empty()) {
+            auto result = std::move(pool_.back());
+            pool_.pop_back();
+            return result;
+        }
+    }
+
+    int err = 0;
+    ArchiveHandle archive{zip_open(path_.c_str(), ZIP_RDONLY, &err)};
+    if (!archive) {
+        LOG_F(ERROR, "Unable to reopen zip '{}' (err={})", path_, err);
+    }
+    return archive;
+}
+
+void StaticZip::release_archive(ArchiveHandle archive) const
+{
+    if (!archive) { return; }
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (pool_.size() < max_pooled_archives_) {
+        pool_.push_back(std::move(archive));
+    }
+}
+
+size_t StaticZip::pooled_archives() const
+{
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    return pool_.size();
+}
+
 ResourceData StaticZip::demand(const ContainerKey* key) const
 {
     auto k = reinterpret_cast<const detail::StaticZipKey*>(key);
@@ -91,17 +133,13 @@ ResourceData StaticZip::demand(const ContainerKey* key) const
     ResourceData data;
     data.name = k->name;
 
-    int err = 0;
-    zip_t* zip = zip_open(path_.c_str(), ZIP_RDONLY, &err);
-    if (!zip) {
-        LOG_F(ERROR, "Unable to reopen zip '{}' (err={})", path_, err);
-        return data;
-    }
+    auto archive = acquire_archive();
+    if (!archive) { return data; }
 
-    zip_file_t* zf = zip_fopen_index(zip, k->index, 0);
+    zip_file_t* zf = zip_fopen_index(archive.get(), k->index, 0);
     if (zf) {
         data.bytes.resize(k->size);
-        if (zip_fread(zf, data.bytes.data(), k->size) < 0) {
+        if (zip_fread(zf, data.bytes.mutable_data(), k->size) < 0) {
             LOG_F(ERROR, "Failed to read file {} at index {}", k->path, k->index);
             data.bytes.clear();
         }
@@ -110,7 +148,7 @@ ResourceData StaticZip::demand(const ContainerKey* key) const
         LOG_F(ERROR, "zip_fopen_index failed for {}", k->path);
     }
 
-    zip_close(zip);
+    release_archive(std::move(archive));
     return data;
 }
 
@@ -130,4 +168,16 @@ void StaticZip::visit(std::function<void(Resource, const ContainerKey*)> visitor
     }
 }
 
+const ContainerKey* StaticZip::key_at(size_t ordinal) const
+{
+    if (ordinal >= elements_.size()) { return nullptr; }
+    return reinterpret_cast<const ContainerKey*>(&elements_[ordinal]);
+}
+
+uint64_t StaticZip::read_order(const ContainerKey* key) const
+{
+    auto k = reinterpret_cast<const detail::StaticZipKey*>(key);
+    return k ? k->index : 0;
+}
+
 } // namespace nw
@@ -7,6 +7,8 @@
 
 #include <filesystem>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace nw {
@@ -51,14 +53,39 @@ public:
     /// Enumerates all assets in a container
     void visit(std::function<void(Resource, const ContainerKey*)> visitor) const override;
 
+    /// Gets the key of the ``ordinal``th asset enumerated by ``visit``
+    const ContainerKey* key_at(size_t ordinal) const override;
+
+    /// Gets the index of ``key`` in the archive
+    uint64_t read_order(const ContainerKey* key) const override;
+
+    /// Gets the number of idle archive handles held for reuse by ``demand``
+    size_t pooled_archives() const;
+
 private:
+    struct ArchiveDeleter {
+        void operator()(zip_t* zip) const noexcept;
+    };
+    using ArchiveHandle = std::unique_ptr<zip_t, ArchiveDeleter>;
+
     bool load();
 
+    /// Takes an open archive handle from the pool, opening a new one if none are idle
+    ArchiveHandle acquire_archive() const;
+    /// Returns an archive handle to the pool
+    void release_archive(ArchiveHandle archive) const;
+
     String name_;
     String path_;
     bool is_loaded_ = false;
 
     PVector<detail::StaticZipKey> elements_;
+
+    // libzip archives may not be shared between threads, so each concurrent ``demand`` inflates
+    // through its own handle.  The lock only guards the idle list, never a read.
+    mutable std::mutex pool_mutex_;
+    mutable Vector<ArchiveHandle> pool_;
+    size_t max_pooled_archives_ = 1;
 };
 
 } // namespace nw
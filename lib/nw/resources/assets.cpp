@@ -4,6 +4,7 @@
 #include "../log.hpp"
 #include "../util/platform.hpp"
 #include "Container.hpp"
+#include "RegistrySnapshot.hpp"
 
 #include <nlohmann/json.hpp>
 
@@ -169,32 +170,70 @@ void to_json(nlohmann::json& j, const Resource& r)
 // == ResourceRegistry ========================================================
 // ============================================================================
 
+void ResourceRegistry::attach(std::shared_ptr<const RegistrySnapshot> snapshot, Vector<Container*> containers,
+    Vector<uint32_t> priorities)
+{
+    snapshot_ = std::move(snapshot);
+    snapshot_containers_ = std::move(containers);
+    snapshot_priorities_ = std::move(priorities);
+    snapshot_size_ = 0;
+}
+
 void ResourceRegistry::clear()
 {
     entries_.clear();
+    snapshot_.reset();
+    snapshot_containers_.clear();
+    snapshot_priorities_.clear();
+    snapshot_size_ = 0;
 }
 
 bool ResourceRegistry::contains(Resource uri) const noexcept
 {
-    return entries_.find(uri) != std::end(entries_);
+    Entry entry;
+    return lookup(uri, entry);
 }
 
 ResourceData ResourceRegistry::demand(Resource uri) const
 {
-    auto entry = lookup(uri);
-    if (!entry) { return {}; }
-    return entry->container->demand(entry->key);
+    Entry entry;
+    if (!lookup(uri, entry)) { return {}; }
+    return entry.container->demand(entry.key);
 }
 
-void ResourceRegistry::insert(Resource uri, Container* container, const ContainerKey* key)
+void ResourceRegistry::insert(Resource uri, Container* container, const ContainerKey* key, uint32_t priority)
 {
-    entries_.insert({uri, {container, key}});
+    entries_.insert({uri, {container, key, priority}});
 }
 
-const ResourceRegistry::Entry* ResourceRegistry::lookup(Resource uri) const
+std::pair<Container*, const ContainerKey*> ResourceRegistry::locate(Resource uri) const
+{
+    Entry entry;
+    if (!lookup(uri, entry)) { return {nullptr, nullptr}; }
+    return {entry.container, entry.key};
+}
+
+bool ResourceRegistry::lookup(Resource uri, Entry& out) const
 {
     auto it = entries_.find(uri);
-    return it != std::end(entries_) ? &it->second : nullptr;
+    bool found = it != std::end(entries_);
+    if (found) { out = it->second; }
+    if (!snapshot_) { return found; }
+
+    uint32_t best_ordinal = 0;
+    snapshot_->find(uri, [&](uint32_t container, uint32_t ordinal) {
+        if (container >= snapshot_containers_.size() || !snapshot_containers_[container]) { return; }
+        const uint32_t priority = snapshot_priorities_[container];
+        if (found && (priority > out.priority || (priority == out.priority && ordinal >= best_ordinal))) {
+            return;
+        }
+        auto key = snapshot_containers_[container]->key_at(ordinal);
+        if (!key) { return; }
+        out = Entry{snapshot_containers_[container], key, priority};
+        best_ordinal = ordinal;
+        found = true;
+    });
+    return found;
 }
 
 void ResourceRegistry::reserve(size_t size)
@@ -204,14 +243,33 @@ void ResourceRegistry::reserve(size_t size)
 
 size_t ResourceRegistry::size() const noexcept
 {
-    return entries_.size();
+    if (!snapshot_) { return entries_.size(); }
+
+    // Counted lazily, the snapshot stores every container's entries, not just the visible ones.
+    size_t result = snapshot_size_.load(std::memory_order_relaxed);
+    if (result == 0) {
+        visit([&result](Resource) { ++result; });
+        snapshot_size_.store(result, std::memory_order_relaxed);
+    }
+    return result;
 }
 
 void ResourceRegistry::visit(std::function<void(Resource)> visitor) const
 {
-    for (const auto& [k, _] : entries_) {
-        visitor(k);
+    Entry winner;
+    for (const auto& [k, v] : entries_) {
+        if (!snapshot_ || (lookup(k, winner) && winner.key == v.key)) {
+            visitor(k);
+        }
     }
+
+    if (!snapshot_) { return; }
+    snapshot_->visit([&](Resource res, uint32_t container, uint32_t ordinal) {
+        if (container >= snapshot_containers_.size() || !snapshot_containers_[container]) { return; }
+        if (lookup(res, winner) && winner.key == snapshot_containers_[container]->key_at(ordinal)) {
+            visitor(res);
+        }
+    });
 }
 
 // == ResourceDescriptor ======================================================
@@ -9,9 +9,11 @@
 #include <absl/hash/hash.h>
 #include <nlohmann/json_fwd.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <tuple>
 
 namespace nw {
@@ -650,6 +652,7 @@ void to_json(nlohmann::json& j, const Resource& r);
 // ============================================================================
 
 struct ContainerKey;
+struct RegistrySnapshot;
 struct ResourceData;
 
 struct ResourceRegistry {
@@ -657,22 +660,41 @@ private:
     struct Entry {
         Container* container;
         const ContainerKey* key;
+        uint32_t priority = 0;
     };
 
     absl::flat_hash_map<Resource, Entry> entries_;
 
-    const Entry* lookup(Resource uri) const;
+    // Persisted snapshot consulted for containers that were not rescanned, see ``attach``.
+    std::shared_ptr<const RegistrySnapshot> snapshot_;
+    Vector<Container*> snapshot_containers_;
+    Vector<uint32_t> snapshot_priorities_;
+    mutable std::atomic<size_t> snapshot_size_{0};
+
+    bool lookup(Resource uri, Entry& out) const;
 
 public:
+    /// Attaches a persisted snapshot.  ``containers[j]`` and ``priorities[j]`` are the live container
+    /// and search priority of snapshot container ``j``, a nullptr container is ignored.  Inserted
+    /// entries and snapshot entries are resolved by priority, lowest first.
+    void attach(std::shared_ptr<const RegistrySnapshot> snapshot, Vector<Container*> containers,
+        Vector<uint32_t> priorities);
+
     void clear();
     bool contains(Resource uri) const noexcept;
     ResourceData demand(Resource uri) const;
-    void insert(Resource uri, Container* container, const ContainerKey* key);
+    void insert(Resource uri, Container* container, const ContainerKey* key, uint32_t priority = 0);
+
+    /// Resolves the container and key a resource would be demanded from, {nullptr, nullptr} if not found
+    std::pair<Container*, const ContainerKey*> locate(Resource uri) const;
     void reserve(size_t size);
 
     /// Gets the number of resources in the registry
     size_t size() const noexcept;
 
+    /// Gets attached snapshot, if any
+    const RegistrySnapshot* snapshot() const noexcept { return snapshot_.get(); }
+
     /// Executes the callback for every resource in the registry
     void visit(std::function<void(Resource)> visitor) const;
 };
@@ -8,12 +8,14 @@
 #include "../profiles/nwn1/scriptbridge.hpp"
 #include "../smalls/Array.hpp"
 #include "../smalls/Bytecode.hpp"
+#include "../smalls/ScriptFunction.hpp"
 #include "../smalls/runtime.hpp"
 #include "combat.hpp"
 #include "effects.hpp"
 
+#include <absl/container/flat_hash_map.h>
+
 #include <algorithm>
-#include <vector>
 
 namespace nw::combat {
 namespace {
@@ -112,134 +114,23 @@ struct ResolveAttackCache {
     bool nwn1_initialized = false;
     bool known_missing = false;
     bool function_resolved = false;
+    bool round_resolved = false;
     smalls::BytecodeModule* bytecode_module = nullptr;
     const smalls::CompiledFunction* compiled_function = nullptr;
+    const smalls::CompiledFunction* round_function = nullptr; ///< Optional batched entry point
     AttackDataOffsetCache offsets;
 };
 
 thread_local ResolveAttackCache s_resolve_attack;
 
-struct ScheduledAttackEvent {
-    ObjectHandle attacker;
-    ObjectHandle target;
-};
-
-struct AutoAttackEvent {
-    ObjectHandle attacker;
-    uint64_t generation;
-};
-
-struct AutoAttackState {
-    ObjectHandle attacker;
-    ObjectHandle target;
-    uint64_t generation = 0;
-    uint32_t round_ticks = 60;
-    bool active = false;
-};
-
-thread_local std::vector<AutoAttackState> auto_attack_states;
-
-AutoAttackState* find_auto_attack_state(ObjectHandle attacker)
+/// Readies ``s_resolve_attack`` for the configured combat policy module, nullptr if it is unusable
+ResolveAttackCache* prepare_combat_policy(smalls::Runtime& rt, StringView module_sv)
 {
-    for (auto& state : auto_attack_states) {
-        if (state.attacker == attacker) {
-            return &state;
-        }
-    }
-    return nullptr;
-}
-
-AutoAttackState& upsert_auto_attack_state(ObjectHandle attacker)
-{
-    if (auto* state = find_auto_attack_state(attacker)) {
-        return *state;
-    }
-
-    auto_attack_states.push_back(AutoAttackState{.attacker = attacker});
-    return auto_attack_states.back();
-}
-
-void scheduled_attack_payload_delete(void* data)
-{
-    delete static_cast<ScheduledAttackEvent*>(data);
-}
-
-void auto_attack_payload_delete(void* data)
-{
-    delete static_cast<AutoAttackEvent*>(data);
-}
-
-bool creature_is_dead(const Creature& cre) noexcept
-{
-    if (const auto* vitals = kernel::objects().components().find_vitals(cre.handle())) {
-        return vitals->hp_current <= 0;
-    }
-    return false;
-}
-
-void scheduled_attack_event_callback(const kernel::EventHandle& ev)
-{
-    auto* payload = static_cast<ScheduledAttackEvent*>(ev.data);
-    if (!payload) {
-        return;
-    }
-
-    auto* attacker = kernel::objects().get<Creature>(payload->attacker);
-    auto* target = kernel::objects().get_object_base(payload->target);
-    if (!attacker || !target) {
-        return;
-    }
-
-    combat::resolve_attack(attacker, target);
-}
-
-void auto_attack_event_callback(const kernel::EventHandle& ev)
-{
-    auto* payload = static_cast<AutoAttackEvent*>(ev.data);
-    if (!payload) {
-        return;
-    }
-
-    auto* attacker = kernel::objects().get<Creature>(payload->attacker);
-    auto* state = find_auto_attack_state(payload->attacker);
-    if (!attacker || !state || !state->active || state->generation != payload->generation) {
-        return;
-    }
-
-    auto* target = kernel::objects().get_object_base(state->target);
-    if (!target) {
-        state->active = false;
-        return;
-    }
-
-    if (auto* cre = target->as_creature(); cre && creature_is_dead(*cre)) {
-        state->active = false;
-        return;
-    }
-
-    combat::resolve_attack(attacker, target);
-
-    auto delay = combat::resolve_attack_cooldown_ticks(attacker, state->round_ticks);
-    auto* next = new AutoAttackEvent{.attacker = payload->attacker, .generation = payload->generation};
-    kernel::events().add_custom(payload->attacker, &auto_attack_event_callback, delay,
-        next, &auto_attack_payload_delete);
-}
-
-} // namespace
-
-bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out)
-{
-    if (!attacker || !target) {
-        return false;
-    }
-
-    auto module_sv = configured_combat_module();
     if (module_sv.empty()) {
         LOG_F(ERROR, "[combat] resolve_attack: no combat policy module configured");
-        return false;
+        return nullptr;
     }
 
-    auto& rt = kernel::runtime();
     auto& cache = s_resolve_attack;
 
     // Invalidate cache when the configured policy module name changes.
@@ -252,12 +143,12 @@ bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out)
     auto* script = rt.get_module(module_sv);
     if (!script) {
         LOG_F(ERROR, "[combat] combat policy module '{}' not found", module_sv);
-        return false;
+        return nullptr;
     }
     auto* fresh_module = rt.get_or_compile_module(script);
     if (!fresh_module) {
         LOG_F(ERROR, "[combat] combat policy module '{}' failed to compile", module_sv);
-        return false;
+        return nullptr;
     }
 
     // If BytecodeModule pointer changed (e.g., runtime restarted between calls),
@@ -268,18 +159,20 @@ bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out)
         cache.compiled_function = nullptr;
         cache.function_resolved = false;
         cache.known_missing = false;
+        cache.round_function = nullptr;
+        cache.round_resolved = false;
         cache.offsets = {};
     }
 
     // Ensure nwn1 smalls are initialized once per (policy module, runtime instance).
     if (!cache.nwn1_initialized) {
         if (!nwn1::bridge::ensure_nwn1_smalls_initialized()) {
-            return false;
+            return nullptr;
         }
         cache.nwn1_initialized = true;
     }
 
-    // Resolve and cache the compiled function pointer.
+    // Resolve and cache the compiled function pointers.
     if (!cache.function_resolved) {
         cache.compiled_function = cache.bytecode_module->get_function("resolve_attack");
         cache.function_resolved = true;
@@ -289,26 +182,23 @@ bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out)
         }
     }
 
-    if (cache.known_missing) {
-        return false;
+    if (!cache.round_resolved) {
+        cache.round_function = cache.bytecode_module->get_function("resolve_round");
+        cache.round_resolved = true;
     }
 
-    Vector<smalls::Value> args;
-    args.push_back(nwn1::bridge::make_object_arg(attacker->handle()));
-    args.push_back(nwn1::bridge::make_object_arg(target->handle()));
-
-    auto exec_result = rt.execute_compiled(cache.bytecode_module, cache.compiled_function, args);
-
-    if (!exec_result.ok()) {
-        LOG_F(WARNING, "[combat] {}.resolve_attack failed: {}", module_sv, exec_result.error_message);
-        return false;
-    }
+    return cache.known_missing ? nullptr : &cache;
+}
 
+/// Decodes an ``nwn1.combat_primitives.AttackData`` value returned by the combat policy
+bool decode_attack_data(smalls::Runtime& rt, ResolveAttackCache& cache, const smalls::Value& value,
+    Creature* attacker, ObjectBase* target, AttackData* out)
+{
     // Build the field-offset cache once from the first valid return value.
     if (!cache.offsets.valid) {
-        const auto* def = get_attack_data_def(rt, exec_result.value);
+        const auto* def = get_attack_data_def(rt, value);
         if (!def) {
-            LOG_F(ERROR, "[combat] {}.resolve_attack returned invalid nwn1.combat_primitives.AttackData", module_sv);
+            LOG_F(ERROR, "[combat] {}.resolve_attack returned invalid nwn1.combat_primitives.AttackData", cache.module);
             return false;
         }
         auto& c = cache.offsets;
@@ -336,20 +226,26 @@ bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out)
     }
 
     if (!cache.offsets.valid) {
-        LOG_F(ERROR, "[combat] {}.resolve_attack AttackData missing required fields", module_sv);
+        LOG_F(ERROR, "[combat] {}.resolve_attack AttackData missing required fields", cache.module);
         return false;
     }
 
     // Decode using pre-cached byte offsets.
     const auto& c = cache.offsets;
     auto read_int = [&](const AttackDataFieldCache& fc) -> int32_t {
-        return rt.read_value_field_at_offset(exec_result.value, fc.offset, fc.type_id).data.ival;
+        return rt.read_value_field_at_offset(value, fc.offset, fc.type_id).data.ival;
     };
     auto read_bool = [&](const AttackDataFieldCache& fc) -> bool {
-        auto v = rt.read_value_field_at_offset(exec_result.value, fc.offset, fc.type_id);
+        auto v = rt.read_value_field_at_offset(value, fc.offset, fc.type_id);
         return (fc.type_id == rt.bool_type()) ? v.data.bval : (v.data.ival != 0);
     };
 
+    // Swings a policy skipped, e.g. because an earlier swing of the round killed the target, carry an
+    // invalid attack type.
+    if (read_int(c.attack_type) < 0) {
+        return false;
+    }
+
     AttackData scratch;
     auto* data = out ? out : &scratch;
     data->attacker = attacker;
@@ -368,25 +264,342 @@ bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out)
     data->concealment = read_int(c.concealment);
     data->iteration_penalty = read_int(c.iteration_penalty);
 
-    read_effects_apply_at_offset(rt, exec_result.value,
+    read_effects_apply_at_offset(rt, value,
         c.effects_to_apply.offset, c.effects_to_apply.type_id, data->effects_to_apply);
-    read_effects_remove_at_offset(rt, exec_result.value,
+    read_effects_remove_at_offset(rt, value,
         c.effects_to_remove.offset, c.effects_to_remove.type_id, data->effects_to_remove);
 
     return true;
 }
 
+smalls::Value make_object_array(smalls::Runtime& rt, std::span<const ObjectHandle> objects)
+{
+    auto array_ptr = rt.create_array_typed(rt.object_type(), objects.size());
+    auto* array = array_ptr.value ? rt.get_array_typed(array_ptr) : nullptr;
+    if (!array) { return {}; }
+
+    for (auto obj : objects) {
+        auto value = smalls::Value::make_object(obj);
+        value.type_id = rt.object_type();
+        array->append_value(value, rt);
+    }
+
+    auto* header = rt.heap_.get_header(array_ptr);
+    if (!header) { return {}; }
+    return smalls::Value::make_heap(array_ptr, header->type_id);
+}
+
+struct ScheduledAttackEvent {
+    ObjectHandle attacker;
+    ObjectHandle target;
+};
+
+/// Payload of the one event that resolves every auto attack due on a tick
+struct AutoAttackRoundEvent {
+    uint64_t tick = 0;
+};
+
+struct AutoAttackState {
+    ObjectHandle target;
+    uint64_t due_tick = 0; ///< Tick of the round holding the next swing
+    uint32_t swing = 0;    ///< Bumped per scheduled swing, older round entries are stale
+    uint32_t round_ticks = 60;
+};
+
+struct AutoAttackSwing {
+    ObjectHandle attacker;
+    uint32_t swing = 0;
+};
+
+/// Auto attacks due on one tick, in the order they were scheduled
+struct AutoAttackRound {
+    kernel::EventId event;
+    Vector<AutoAttackSwing> swings;
+};
+
+/// Auto attack state of every attacker, only active attackers have an entry
+struct AutoAttackTable {
+    uint64_t events_generation = 0;                        ///< Event system generation ``rounds`` belong to
+    absl::flat_hash_map<uint64_t, AutoAttackState> states; ///< Attacker handle to state
+    absl::flat_hash_map<uint64_t, AutoAttackRound> rounds; ///< Tick to due swings
+};
+
+thread_local AutoAttackTable s_auto_attacks;
+
+AutoAttackTable& auto_attacks()
+{
+    // Pending rounds die with the event system that held them, e.g. across kernel restarts.  A new event
+    // system may reuse the old one's address, its generation is always new.
+    auto& table = s_auto_attacks;
+    const auto generation = kernel::events().generation();
+    if (table.events_generation != generation) {
+        table.states.clear();
+        table.rounds.clear();
+        table.events_generation = generation;
+    }
+    return table;
+}
+
+void scheduled_attack_payload_delete(void* data)
+{
+    delete static_cast<ScheduledAttackEvent*>(data);
+}
+
+void auto_attack_round_payload_delete(void* data)
+{
+    delete static_cast<AutoAttackRoundEvent*>(data);
+}
+
+void scheduled_attack_event_callback(const kernel::EventHandle& ev)
+{
+    auto* payload = static_cast<ScheduledAttackEvent*>(ev.data);
+    if (!payload) {
+        return;
+    }
+
+    auto* attacker = kernel::objects().get<Creature>(payload->attacker);
+    auto* target = kernel::objects().get_object_base(payload->target);
+    if (!attacker || !target) {
+        return;
+    }
+
+    combat::resolve_attack(attacker, target);
+}
+
+void auto_attack_round_callback(const kernel::EventHandle& ev);
+
+void schedule_swing(AutoAttackTable& table, ObjectHandle attacker, AutoAttackState& state, uint64_t delay_ticks)
+{
+    auto& events = kernel::events();
+    const uint64_t tick = events.current_tick() + delay_ticks;
+    auto& round = table.rounds[tick];
+    if (round.swings.empty()) {
+        round.event = events.add_custom(ObjectHandle{}, &auto_attack_round_callback, delay_ticks,
+            new AutoAttackRoundEvent{tick}, &auto_attack_round_payload_delete);
+    }
+    round.swings.push_back({attacker, ++state.swing});
+    state.due_tick = tick;
+}
+
+void unschedule_swing(AutoAttackTable& table, ObjectHandle attacker, const AutoAttackState& state)
+{
+    auto it = table.rounds.find(state.due_tick);
+    if (it == table.rounds.end()) {
+        return;
+    }
+
+    auto& swings = it->second.swings;
+    auto pos = std::find_if(swings.begin(), swings.end(), [&](const AutoAttackSwing& swing) {
+        return swing.attacker == attacker && swing.swing == state.swing;
+    });
+    if (pos != swings.end()) {
+        swings.erase(pos);
+    }
+    if (swings.empty()) {
+        kernel::events().cancel(it->second.event);
+        table.rounds.erase(it);
+    }
+}
+
+void auto_attack_round_callback(const kernel::EventHandle& ev)
+{
+    auto* payload = static_cast<AutoAttackRoundEvent*>(ev.data);
+    if (!payload) {
+        return;
+    }
+
+    auto& table = auto_attacks();
+    auto round = table.rounds.find(payload->tick);
+    if (round == table.rounds.end()) {
+        return;
+    }
+    auto swings = std::move(round->second.swings);
+    table.rounds.erase(round);
+
+    Vector<Creature*> attackers;
+    Vector<ObjectBase*> targets;
+    Vector<AutoAttackSwing> resolved;
+    attackers.reserve(swings.size());
+    targets.reserve(swings.size());
+    resolved.reserve(swings.size());
+    for (const auto& swing : swings) {
+        auto it = table.states.find(swing.attacker.to_ull());
+        if (it == table.states.end() || it->second.swing != swing.swing) {
+            continue;
+        }
+
+        // Reclaim attackers that are gone or whose target is gone or dead.
+        auto* attacker = kernel::objects().get<Creature>(swing.attacker);
+        auto* target = kernel::objects().get_object_base(it->second.target);
+        if (!attacker || !target || combat::target_is_dead(target)) {
+            table.states.erase(it);
+            continue;
+        }
+
+        attackers.push_back(attacker);
+        targets.push_back(target);
+        resolved.push_back(swing);
+    }
+
+    combat::resolve_round(attackers, targets);
+
+    // Policy scripts may have started or stopped auto attacks, the table may have moved.
+    for (const auto& swing : resolved) {
+        auto it = table.states.find(swing.attacker.to_ull());
+        if (it == table.states.end() || it->second.swing != swing.swing) {
+            continue;
+        }
+        auto* attacker = kernel::objects().get<Creature>(swing.attacker);
+        if (!attacker || combat::target_is_dead(kernel::objects().get_object_base(it->second.target))) {
+            table.states.erase(it);
+            continue;
+        }
+
+        auto delay = combat::resolve_attack_cooldown_ticks(attacker, it->second.round_ticks);
+        schedule_swing(table, swing.attacker, it->second, delay);
+    }
+}
+
+} // namespace
+
+bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out)
+{
+    if (!attacker || !target) {
+        return false;
+    }
+
+    auto module_sv = configured_combat_module();
+    auto& rt = kernel::runtime();
+    auto* cache = prepare_combat_policy(rt, module_sv);
+    if (!cache) {
+        return false;
+    }
+
+    Vector<smalls::Value> args;
+    args.push_back(nwn1::bridge::make_object_arg(attacker->handle()));
+    args.push_back(nwn1::bridge::make_object_arg(target->handle()));
+
+    auto exec_result = rt.execute_compiled(cache->bytecode_module, cache->compiled_function, args);
+
+    if (!exec_result.ok()) {
+        LOG_F(WARNING, "[combat] {}.resolve_attack failed: {}", module_sv, exec_result.error_message);
+        return false;
+    }
+
+    return decode_attack_data(rt, *cache, exec_result.value, attacker, target, out);
+}
+
+size_t resolve_round(std::span<Creature* const> attackers, std::span<ObjectBase* const> targets,
+    Vector<AttackData>* out)
+{
+    if (out) {
+        out->clear();
+    }
+    if (attackers.size() != targets.size()) {
+        LOG_F(ERROR, "[combat] resolve_round: {} attackers for {} targets", attackers.size(), targets.size());
+        return 0;
+    }
+
+    Vector<ObjectHandle> attacker_handles;
+    Vector<ObjectHandle> target_handles;
+    attacker_handles.reserve(attackers.size());
+    target_handles.reserve(targets.size());
+    for (size_t i = 0; i < attackers.size(); ++i) {
+        if (attackers[i] && targets[i]) {
+            attacker_handles.push_back(attackers[i]->handle());
+            target_handles.push_back(targets[i]->handle());
+        }
+    }
+    if (attacker_handles.empty()) {
+        return 0;
+    }
+
+    auto module_sv = configured_combat_module();
+    auto& rt = kernel::runtime();
+    auto* cache = prepare_combat_policy(rt, module_sv);
+    if (!cache) {
+        return 0;
+    }
+
+    size_t resolved = 0;
+    AttackData scratch;
+    auto next_result = [&]() -> AttackData* {
+        return out ? &out->emplace_back() : &scratch;
+    };
+
+    // Policies without a batched entry point resolve one VM call per attack.
+    if (!cache->round_function) {
+        for (size_t i = 0; i < attackers.size(); ++i) {
+            if (!attackers[i] || !targets[i] || combat::target_is_dead(targets[i])) { continue; }
+            auto* data = next_result();
+            if (combat::resolve_attack(attackers[i], targets[i], data)) {
+                ++resolved;
+            } else if (out) {
+                out->pop_back();
+            }
+        }
+        return resolved;
+    }
+
+    Vector<smalls::Value> args;
+    args.push_back(make_object_array(rt, attacker_handles));
+    args.push_back(make_object_array(rt, target_handles));
+    if (!args[0].type_id.value || !args[1].type_id.value) {
+        return 0;
+    }
+
+    auto exec_result = rt.execute_compiled(cache->bytecode_module, cache->round_function, args);
+    if (!exec_result.ok()) {
+        LOG_F(WARNING, "[combat] {}.resolve_round failed: {}", module_sv, exec_result.error_message);
+        return 0;
+    }
+
+    auto* values = smalls::detail::value_cast<smalls::IArray*>(&rt, exec_result.value);
+    if (!values) {
+        LOG_F(ERROR, "[combat] {}.resolve_round did not return an array", module_sv);
+        return 0;
+    }
+
+    smalls::Value elem;
+    const size_t count = std::min(values->size(), attacker_handles.size());
+    for (size_t i = 0, pair = 0; i < attackers.size() && pair < count; ++i) {
+        if (!attackers[i] || !targets[i]) { continue; }
+        if (values->get_value(pair++, elem, rt)) {
+            auto* data = next_result();
+            if (decode_attack_data(rt, *cache, elem, attackers[i], targets[i], data)) {
+                ++resolved;
+            } else if (out) {
+                out->pop_back();
+            }
+        }
+    }
+    return resolved;
+}
+
+bool target_is_dead(const ObjectBase* target)
+{
+    if (!target || !target->as_creature()) {
+        return false;
+    }
+    if (const auto* vitals = kernel::objects().components().find_vitals(target->handle())) {
+        return vitals->hp_current <= 0;
+    }
+    return false;
+}
+
 uint32_t resolve_attack_cooldown_ticks(const Creature* attacker, uint32_t round_ticks)
 {
     if (!attacker) {
         return 1;
     }
 
-    Vector<smalls::Value> args;
-    args.push_back(nwn1::bridge::make_object_arg(attacker->handle()));
-    args.push_back(smalls::Value::make_int(static_cast<int32_t>(round_ticks)));
+    if (!nwn1::bridge::ensure_nwn1_smalls_initialized()) {
+        return 1;
+    }
 
-    if (auto value = nwn1::bridge::call_nwn1_module_int("nwn1.combat", "resolve_attack_cooldown_ticks", args)) {
+    thread_local smalls::ScriptFunction<int32_t(ObjectHandle, int32_t)> fn{
+        "nwn1.combat", "resolve_attack_cooldown_ticks"};
+    if (auto value = fn(attacker->handle(), static_cast<int32_t>(round_ticks))) {
         return std::max<uint32_t>(1, static_cast<uint32_t>(*value));
     }
 
@@ -412,15 +625,15 @@ bool start_auto_attack(Creature* attacker, ObjectBase* target,
         return false;
     }
 
-    auto& state = upsert_auto_attack_state(attacker->handle());
+    auto& table = auto_attacks();
+    auto [it, inserted] = table.states.try_emplace(attacker->handle().to_ull());
+    auto& state = it->second;
+    if (!inserted) {
+        unschedule_swing(table, attacker->handle(), state);
+    }
     state.target = target->handle();
     state.round_ticks = std::max<uint32_t>(1, round_ticks);
-    state.active = true;
-    ++state.generation;
-
-    auto* payload = new AutoAttackEvent{.attacker = attacker->handle(), .generation = state.generation};
-    kernel::events().add_custom(attacker->handle(), &auto_attack_event_callback, initial_delay_ticks,
-        payload, &auto_attack_payload_delete);
+    schedule_swing(table, attacker->handle(), state, initial_delay_ticks);
     return true;
 }
 
@@ -430,16 +643,22 @@ bool stop_auto_attack(Creature* attacker)
         return false;
     }
 
-    auto* state = find_auto_attack_state(attacker->handle());
-    if (!state || !state->active) {
+    auto& table = auto_attacks();
+    auto it = table.states.find(attacker->handle().to_ull());
+    if (it == table.states.end()) {
         return false;
     }
 
-    state->active = false;
-    ++state->generation;
+    unschedule_swing(table, attacker->handle(), it->second);
+    table.states.erase(it);
     return true;
 }
 
+size_t auto_attack_count()
+{
+    return auto_attacks().states.size();
+}
+
 bool resolve_attack_and_schedule(Creature* attacker, ObjectBase* target,
     uint32_t round_ticks, AttackData* out)
 {
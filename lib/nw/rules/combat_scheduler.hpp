@@ -1,6 +1,10 @@
 #pragma once
 
+#include "../config.hpp"
+
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 namespace nw {
 struct AttackData;
@@ -12,11 +16,27 @@ namespace combat {
 /// Resolves one attack using the configured combat policy module.
 bool resolve_attack(Creature* attacker, ObjectBase* target, AttackData* out = nullptr);
 
+/// Resolves one attack of each ``attackers[i]`` against ``targets[i]`` in a single call into the
+/// combat policy module's ``resolve_round``, or one ``resolve_attack`` call per pair if the policy
+/// has none.  Null pairs are skipped.  Whether a pair whose target an earlier attack of the round
+/// killed is skipped is up to the policy, the nwn1 policy and the per pair fallback skip it.  ``out``,
+/// if provided, receives the resolved attacks in order.
+/// Returns the number of attacks resolved.
+size_t resolve_round(std::span<Creature* const> attackers, std::span<ObjectBase* const> targets,
+    Vector<AttackData>* out = nullptr);
+
+/// Determines if a target can no longer be attacked, i.e. a creature with no hit points left
+bool target_is_dead(const ObjectBase* target);
+
 uint32_t resolve_attack_cooldown_ticks(const Creature* attacker, uint32_t round_ticks = 60);
 bool schedule_attack(Creature* attacker, ObjectBase* target, uint64_t delay_ticks);
 bool start_auto_attack(Creature* attacker, ObjectBase* target,
     uint64_t initial_delay_ticks = 0, uint32_t round_ticks = 60);
 bool stop_auto_attack(Creature* attacker);
+
+/// Gets the number of creatures with an active auto attack
+size_t auto_attack_count();
+
 bool resolve_attack_and_schedule(Creature* attacker, ObjectBase* target,
     uint32_t round_ticks = 60, AttackData* out = nullptr);
 
@@ -1,17 +1,24 @@
 #include "effects.hpp"
 
+#include "../kernel/EventSystem.hpp"
 #include "../kernel/Kernel.hpp"
 #include "../kernel/TwoDACache.hpp"
 #include "../objects/ObjectBase.hpp"
+#include "../objects/ObjectManager.hpp"
+#include "../serialization/Gff.hpp"
+#include "../serialization/GffBuilder.hpp"
 #include "../smalls/Array.hpp"
 #include "../smalls/Bytecode.hpp"
 #include "../smalls/runtime.hpp"
+#include "../util/BinaryStream.hpp"
 #include "../util/profile.hpp"
 
 #include "nlohmann/json.hpp"
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <utility>
 
 namespace nw {
 
@@ -154,6 +161,7 @@ void Effect::reset()
     duration = 0.0f;
     expire_day = 0;
     expire_time = 0;
+    expire_tick = 0;
 
     versus_ = Versus{};
     std::fill(ints(), ints() + ints_count, 0);
@@ -207,6 +215,199 @@ void Effect::set_versus(Versus vs) { versus_ = vs; }
 
 const Versus& Effect::versus() const noexcept { return versus_; }
 
+namespace {
+
+// Ticks restart with each session, what is left of the duration is kept instead
+uint64_t effect_ticks_left(const Effect* effect)
+{
+    if (effect->expire_tick == 0) { return 0; }
+    auto* events = kernel::services().get_mut<kernel::EventSystem>();
+    const uint64_t now = events ? events->current_tick() : 0;
+    return effect->expire_tick > now ? effect->expire_tick - now : uint64_t(1);
+}
+
+void restore_effect_ticks_left(Effect* effect, uint64_t ticks_left)
+{
+    auto* events = kernel::services().get_mut<kernel::EventSystem>();
+    if (ticks_left > 0 && events) { effect->expire_tick = events->current_tick() + ticks_left; }
+}
+
+// Trailing zero values are left out
+template <typename T>
+size_t trimmed_count(const T* values, size_t count)
+{
+    while (count > 0 && values[count - 1] == T{}) { --count; }
+    return count;
+}
+
+} // namespace
+
+bool deserialize(Effect* effect, const GffStruct& archive)
+{
+    if (!effect) { return false; }
+
+    int32_t type = -1;
+    if (!archive.get_to("Type", type)) { return false; }
+
+    auto& handle = effect->handle();
+    handle.type = EffectType::make(type);
+    archive.get_to("SubType", handle.subtype, false);
+
+    int32_t category = 0;
+    archive.get_to("Category", category, false);
+    handle.category = static_cast<EffectCategory>(category);
+
+    uint64_t creator = 0;
+    if (archive.get_to("CreatorId", creator, false)) {
+        handle.creator = ObjectHandle::from_ull(creator);
+    }
+
+    int32_t spell = -1;
+    archive.get_to("SpellId", spell, false);
+    handle.spell_id = Spell::make(spell);
+
+    Versus vs;
+    int32_t race = -1;
+    uint32_t align = 0;
+    uint8_t trap = 0;
+    archive.get_to("VersusRace", race, false);
+    archive.get_to("VersusAlign", align, false);
+    archive.get_to("VersusTrap", trap, false);
+    vs.race = Race::make(race);
+    vs.align_flags = static_cast<AlignmentFlags>(align);
+    vs.trap = !!trap;
+    effect->set_versus(vs);
+
+    archive.get_to("Duration", effect->duration, false);
+    archive.get_to("ExpireDay", effect->expire_day, false);
+    archive.get_to("ExpireTime", effect->expire_time, false);
+
+    uint64_t ticks_left = 0;
+    if (archive.get_to("ExpireTicks", ticks_left, false)) { restore_effect_ticks_left(effect, ticks_left); }
+
+    auto ints = archive["IntList"];
+    for (size_t i = 0; i < std::min(ints.size(), size_t(Effect::ints_count)); ++i) {
+        ints[i].get_to("Value", effect->ints()[i]);
+    }
+    auto floats = archive["FloatList"];
+    for (size_t i = 0; i < std::min(floats.size(), size_t(Effect::floats_count)); ++i) {
+        floats[i].get_to("Value", effect->floats()[i]);
+    }
+    auto strings = archive["StringList"];
+    for (size_t i = 0; i < std::min(strings.size(), size_t(Effect::strings_count)); ++i) {
+        strings[i].get_to("Value", effect->strings()[i]);
+    }
+
+    return true;
+}
+
+bool serialize(const Effect* effect, GffBuilderStruct& archive)
+{
+    if (!effect) { return false; }
+
+    const auto& handle = effect->handle();
+    const auto& vs = effect->versus();
+    archive.add_field("Type", *handle.type)
+        .add_field("SubType", handle.subtype)
+        .add_field("Category", static_cast<int32_t>(handle.category))
+        .add_field("CreatorId", handle.creator.to_ull())
+        .add_field("SpellId", *handle.spell_id)
+        .add_field("VersusRace", *vs.race)
+        .add_field("VersusAlign", static_cast<uint32_t>(vs.align_flags))
+        .add_field("VersusTrap", static_cast<uint8_t>(vs.trap))
+        .add_field("Duration", effect->duration)
+        .add_field("ExpireDay", effect->expire_day)
+        .add_field("ExpireTime", effect->expire_time);
+
+    if (effect->expire_tick != 0) { archive.add_field("ExpireTicks", effect_ticks_left(effect)); }
+
+    auto& ints = archive.add_list("IntList");
+    for (size_t i = 0; i < trimmed_count(effect->ints(), Effect::ints_count); ++i) {
+        ints.push_back(0).add_field("Value", effect->ints()[i]);
+    }
+    auto& floats = archive.add_list("FloatList");
+    for (size_t i = 0; i < trimmed_count(effect->floats(), Effect::floats_count); ++i) {
+        floats.push_back(0).add_field("Value", effect->floats()[i]);
+    }
+    auto& strings = archive.add_list("StringList");
+    for (size_t i = 0; i < trimmed_count(effect->strings(), Effect::strings_count); ++i) {
+        strings.push_back(0).add_field("Value", effect->strings()[i]);
+    }
+
+    return true;
+}
+
+bool deserialize(Effect* effect, BinaryReader& archive)
+{
+    if (!effect) { return false; }
+
+    auto& handle = effect->handle();
+    handle.type = EffectType::make(archive.pod<int32_t>());
+    handle.subtype = archive.pod<int32_t>();
+    handle.category = static_cast<EffectCategory>(archive.pod<int32_t>());
+    handle.creator = ObjectHandle::from_ull(archive.pod<uint64_t>());
+    handle.spell_id = Spell::make(archive.pod<int32_t>());
+
+    Versus vs;
+    vs.race = Race::make(archive.pod<int32_t>());
+    vs.align_flags = static_cast<AlignmentFlags>(archive.pod<uint32_t>());
+    vs.trap = archive.pod<uint8_t>() != 0;
+    effect->set_versus(vs);
+
+    effect->duration = archive.pod<float>();
+    effect->expire_day = archive.pod<uint32_t>();
+    effect->expire_time = archive.pod<uint32_t>();
+    restore_effect_ticks_left(effect, archive.pod<uint64_t>());
+
+    const auto ints = archive.pod<uint8_t>();
+    if (ints > Effect::ints_count) { archive.fail(); }
+    archive.bytes(effect->ints(), archive.ok() ? ints * sizeof(int) : 0);
+    const auto floats = archive.pod<uint8_t>();
+    if (floats > Effect::floats_count) { archive.fail(); }
+    archive.bytes(effect->floats(), archive.ok() ? floats * sizeof(float) : 0);
+    const auto strings = archive.pod<uint8_t>();
+    if (strings > Effect::strings_count) { archive.fail(); }
+    for (uint8_t i = 0; i < strings && archive.ok(); ++i) {
+        effect->set_string(i, String{archive.str()});
+    }
+
+    return archive.ok();
+}
+
+bool serialize(const Effect* effect, BinaryWriter& archive)
+{
+    if (!effect) { return false; }
+
+    const auto& handle = effect->handle();
+    const auto& vs = effect->versus();
+    archive.pod(static_cast<int32_t>(*handle.type));
+    archive.pod(static_cast<int32_t>(handle.subtype));
+    archive.pod(static_cast<int32_t>(handle.category));
+    archive.pod(handle.creator.to_ull());
+    archive.pod(static_cast<int32_t>(*handle.spell_id));
+    archive.pod(static_cast<int32_t>(*vs.race));
+    archive.pod(static_cast<uint32_t>(vs.align_flags));
+    archive.pod(static_cast<uint8_t>(vs.trap));
+    archive.pod(effect->duration);
+    archive.pod(effect->expire_day);
+    archive.pod(effect->expire_time);
+    archive.pod(effect_ticks_left(effect));
+
+    const auto ints = static_cast<uint8_t>(trimmed_count(effect->ints(), Effect::ints_count));
+    archive.pod(ints);
+    archive.bytes(effect->ints(), ints * sizeof(int));
+    const auto floats = static_cast<uint8_t>(trimmed_count(effect->floats(), Effect::floats_count));
+    archive.pod(floats);
+    archive.bytes(effect->floats(), floats * sizeof(float));
+    const auto strings = static_cast<uint8_t>(trimmed_count(effect->strings(), Effect::strings_count));
+    archive.pod(strings);
+    for (uint8_t i = 0; i < strings; ++i) {
+        archive.str(effect->strings()[i]);
+    }
+
+    return true;
+}
+
 // == EffectArray =============================================================
 // ============================================================================
 
@@ -277,6 +478,7 @@ size_t EffectArray::size() const noexcept
 // ============================================================================
 
 const std::type_index EffectSystem::type_index{typeid(EffectSystem)};
+size_t EffectSystem::service_slot = kernel::Services::no_slot;
 
 EffectSystem::EffectSystem(MemoryResource* allocator)
     : Service(allocator)
@@ -340,6 +542,7 @@ bool EffectSystem::apply_to(ObjectBase* obj, Effect* effect)
     if (!obj->effects().add(effect)) {
         return false;
     }
+    index_expiry(obj, effect);
 
     dispatch_on_effects(obj, {effect}, true);
 
@@ -368,6 +571,7 @@ size_t EffectSystem::apply_to(ObjectBase* obj, const Vector<Effect*>& effects, V
             if (failed) { failed->push_back(effect); }
             continue;
         }
+        index_expiry(obj, effect);
         ++applied;
         applied_effects.push_back(effect);
     }
@@ -386,6 +590,25 @@ size_t EffectSystem::apply_to(ObjectBase* obj, const Vector<Effect*>& effects, V
     return applied;
 }
 
+void EffectSystem::cancel_expiry(Effect* effect)
+{
+    const uint32_t id = effect->handle().runtime_handle.id;
+    if (id >= expiry_locations_.size() || expiry_locations_[id].position == no_expiry) { return; }
+
+    const auto location = std::exchange(expiry_locations_[id], ExpiryLocation{});
+    auto it = expiry_buckets_.find(location.tick);
+    if (it == std::end(expiry_buckets_)) { return; }
+
+    auto& bucket = it->second;
+    if (location.position + 1 < bucket.size()) {
+        bucket[location.position] = bucket.back();
+        expiry_locations_[bucket[location.position].effect->handle().runtime_handle.id].position = location.position;
+    }
+    bucket.pop_back();
+    if (bucket.empty()) { expiry_buckets_.erase(it); }
+    --expiring_;
+}
+
 Effect* EffectSystem::create(EffectType type)
 {
     TypedHandle handle = pool_.allocate_effect();
@@ -402,6 +625,84 @@ Effect* EffectSystem::create(EffectType type)
     return effect;
 }
 
+size_t EffectSystem::deserialize_effects(ObjectBase* obj, const GffStruct& archive)
+{
+    auto list = archive["EffectList"];
+    if (!obj || !list.valid()) { return 0; }
+
+    Vector<Effect*> effects;
+    effects.reserve(list.size());
+    for (size_t i = 0; i < list.size(); ++i) {
+        auto* effect = create(EffectType::invalid());
+        if (!effect) { break; }
+        if (!deserialize(effect, list[i])) {
+            LOG_F(ERROR, "[effects] invalid effect at index {} of effect list", i);
+            destroy(effect);
+            continue;
+        }
+        effects.push_back(effect);
+    }
+
+    Vector<Effect*> failed;
+    const size_t applied = apply_to(obj, effects, &failed);
+    for (auto* effect : failed) { destroy(effect); }
+    return applied;
+}
+
+size_t EffectSystem::expire(uint64_t tick, bool destroy)
+{
+    NW_PROFILE_SCOPE_N("effects.expire");
+
+    // Due buckets are unindexed before any removal, callbacks may apply or remove other timed effects
+    Vector<ExpiryEntry> expired;
+    auto last = expiry_buckets_.upper_bound(tick);
+    for (auto it = std::begin(expiry_buckets_); it != last; ++it) {
+        for (const auto& entry : it->second) {
+            expiry_locations_[entry.effect->handle().runtime_handle.id] = ExpiryLocation{};
+            expired.push_back(entry);
+        }
+    }
+    expiry_buckets_.erase(std::begin(expiry_buckets_), last);
+    expiring_ -= expired.size();
+    if (expired.empty()) { return 0; }
+
+    std::stable_sort(std::begin(expired), std::end(expired), [](const ExpiryEntry& lhs, const ExpiryEntry& rhs) {
+        return lhs.object < rhs.object;
+    });
+
+    size_t removed = 0;
+    Vector<Effect*> batch;
+    Vector<Effect*> failed;
+    for (size_t i = 0; i < expired.size();) {
+        batch.clear();
+        const auto object = expired[i].object;
+        for (; i < expired.size() && expired[i].object == object; ++i) {
+            batch.push_back(expired[i].effect);
+        }
+
+        if (auto obj = kernel::objects().get_object_base(object)) {
+            failed.clear();
+            removed += remove_from(obj, batch, destroy, &failed);
+            // An effect whose remove handler refused is still in effect, it stays and is retried next tick
+            for (auto* effect : failed) {
+                effect->expire_tick = tick + 1;
+                index_expiry(obj, effect);
+            }
+        } else if (destroy) {
+            // Object is gone, nothing is left to remove its effects from
+            for (auto* effect : batch) { this->destroy(effect); }
+        }
+    }
+
+    NW_PROFILE_PLOT("effects.expired", static_cast<int64_t>(removed));
+    return removed;
+}
+
+size_t EffectSystem::expiring() const noexcept
+{
+    return expiring_;
+}
+
 Effect* EffectSystem::get(TypedHandle handle)
 {
     if (!handle.is_valid() || handle.type != RuntimeObjectPool::TYPE_EFFECT) {
@@ -421,6 +722,7 @@ const Effect* EffectSystem::get(TypedHandle handle) const
 void EffectSystem::destroy(Effect* effect)
 {
     if (!effect) { return; }
+    cancel_expiry(effect);
     pool_.destroy(effect->handle().to_typed_handle());
 }
 
@@ -559,6 +861,43 @@ const StaticTwoDA* EffectSystem::itemprops() const noexcept
     return itemprop_table_;
 }
 
+void EffectSystem::index_expiry(ObjectBase* obj, Effect* effect)
+{
+    cancel_expiry(effect);
+    auto* events = kernel::services().get_mut<kernel::EventSystem>();
+    if (effect->expire_tick == 0 && effect->duration > 0.0f && events) {
+        const auto ticks = std::ceil(effect->duration * float(kernel::config().options().ticks_per_second));
+        effect->expire_tick = events->current_tick() + std::max(uint64_t(1), static_cast<uint64_t>(ticks));
+    }
+    if (effect->expire_tick == 0) { return; }
+
+    const uint32_t id = effect->handle().runtime_handle.id;
+    if (id >= expiry_locations_.size()) { expiry_locations_.resize(id + 1); }
+    auto& bucket = expiry_buckets_[effect->expire_tick];
+    expiry_locations_[id] = ExpiryLocation{effect->expire_tick, static_cast<uint32_t>(bucket.size())};
+    bucket.push_back(ExpiryEntry{obj->handle(), effect});
+    ++expiring_;
+    schedule_expiry();
+}
+
+void EffectSystem::expiry_event_callback(const kernel::EventHandle& ev)
+{
+    auto* effects = kernel::services().get_mut<EffectSystem>();
+    if (!effects) { return; }
+
+    if (ev.tick >= effects->expiry_event_tick_) {
+        effects->expiry_event_tick_ = std::numeric_limits<uint64_t>::max();
+    }
+    effects->expire(kernel::events().current_tick());
+    effects->schedule_expiry();
+}
+
+uint64_t EffectSystem::next_expiry() const noexcept
+{
+    if (expiry_buckets_.empty()) { return std::numeric_limits<uint64_t>::max(); }
+    return std::begin(expiry_buckets_)->first;
+}
+
 bool EffectSystem::remove(ObjectBase* obj, Effect* effect)
 {
     if (!effect) { return false; }
@@ -593,6 +932,7 @@ bool EffectSystem::remove_from(ObjectBase* obj, Effect* effect)
     if (!obj->effects().remove(effect)) {
         return false;
     }
+    cancel_expiry(effect);
 
     dispatch_on_effects(obj, {effect}, false);
 
@@ -622,6 +962,7 @@ size_t EffectSystem::remove_from(ObjectBase* obj, const Vector<Effect*>& effects
             if (failed) { failed->push_back(effect); }
             continue;
         }
+        cancel_expiry(effect);
         ++removed;
         removed_effects.push_back(effect);
     }
@@ -644,6 +985,40 @@ size_t EffectSystem::remove_from(ObjectBase* obj, const Vector<Effect*>& effects
     return removed;
 }
 
+void EffectSystem::schedule_expiry()
+{
+    auto* events = kernel::services().get_mut<kernel::EventSystem>();
+    if (!events) { return; }
+
+    // The pending event dies with the event system that held it, e.g. across kernel restarts.  A new event
+    // system may reuse the old one's address, its generation is always new.
+    if (expiry_events_generation_ != events->generation()) {
+        expiry_events_generation_ = events->generation();
+        expiry_event_tick_ = std::numeric_limits<uint64_t>::max();
+    }
+
+    // One event waits for the earliest expiry, an event made redundant by an earlier one just finds
+    // nothing to expire.
+    const uint64_t next = next_expiry();
+    if (next >= expiry_event_tick_) { return; }
+
+    const uint64_t now = events->current_tick();
+    events->add_custom(ObjectHandle{}, &EffectSystem::expiry_event_callback, next > now ? next - now : 0);
+    expiry_event_tick_ = next;
+}
+
+bool EffectSystem::serialize_effects(const ObjectBase* obj, GffBuilderStruct& archive) const
+{
+    if (!obj) { return false; }
+
+    auto& list = archive.add_list("EffectList");
+    for (const auto& handle : obj->effects()) {
+        if (!handle.effect || handle.category == EffectCategory::item) { continue; }
+        if (!serialize(handle.effect, list.push_back(2))) { return false; }
+    }
+    return true;
+}
+
 void EffectSystem::set_event_callback(EffectEventFunc callback)
 {
     event_callback_ = callback;
@@ -674,6 +1049,8 @@ nlohmann::json EffectSystem::stats() const
     nlohmann::json j;
     j["effect system"] = {
         {"callback_timing_enabled", callback_timing_enabled_},
+        {"expiring", expiring_},
+        {"expiry_buckets", expiry_buckets_.size()},
         {"callback_timing", {
             {"filter_ns", callback_timing_stats_.filter_ns},
             {"marshal_ns", callback_timing_stats_.marshal_ns},
@@ -9,8 +9,22 @@
 #include "items.hpp"
 #include "rule_type.hpp"
 
+#include <absl/container/btree_map.h>
+
+#include <limits>
+
 namespace nw {
 
+struct BinaryReader;
+struct BinaryWriter;
+struct GffBuilderStruct;
+struct GffStruct;
+
+namespace kernel {
+struct EventHandle;
+struct EventSystem;
+}
+
 // == Effect ==================================================================
 // ============================================================================
 
@@ -103,15 +117,29 @@ struct Effect : RuntimeObject {
     /// Gets the versus value
     const Versus& versus() const noexcept;
 
-    float duration = 0.0f;
+    float duration = 0.0f; ///< Seconds, if set ``EffectSystem::apply_to`` sets ``expire_tick`` from it
     uint32_t expire_day = 0;
     uint32_t expire_time = 0;
+    uint64_t expire_tick = 0; ///< Tick ``EffectSystem::expire`` removes the effect at, 0 if it does not expire
 
 private:
     EffectHandle handle_;
     Versus versus_;
 };
 
+/// Deserializes an effect from an ``EffectList`` entry
+/// @note A timed effect's ``expire_tick`` is restored relative to the current event tick
+bool deserialize(Effect* effect, const GffStruct& archive);
+
+/// Serializes an effect to an ``EffectList`` entry, a timed effect stores the ticks it has left
+bool serialize(const Effect* effect, GffBuilderStruct& archive);
+
+/// Deserializes an effect written by ``serialize(const Effect*, BinaryWriter&)``
+bool deserialize(Effect* effect, BinaryReader& archive);
+
+/// Serializes an effect in a compact binary form, with the same expiry handling as the GFF form
+bool serialize(const Effect* effect, BinaryWriter& archive);
+
 // == EffectArray =============================================================
 // ============================================================================
 
@@ -204,6 +232,7 @@ struct EffectLimits {
 
 struct EffectSystem : public kernel::Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     EffectSystem(MemoryResource* scope);
     virtual ~EffectSystem() = default;
@@ -222,6 +251,8 @@ struct EffectSystem : public kernel::Service {
     bool apply(ObjectBase* obj, Effect* effect);
 
     /// Applies and commits an effect to an object
+    /// @note An effect with a ``duration`` and no ``expire_tick`` expires ``duration`` seconds of event
+    /// ticks from now, the event system calls ``expire`` once it is due.
     bool apply_to(ObjectBase* obj, Effect* effect);
 
     /// Applies and commits multiple effects; returns committed count
@@ -230,6 +261,17 @@ struct EffectSystem : public kernel::Service {
     /// Creates an effect
     Effect* create(EffectType type);
 
+    /// Removes and destroys every committed effect with an ``Effect::expire_tick`` at or before ``tick``
+    /// @note Expired effects are removed with one ``remove_from`` per object, so each object gets
+    /// one batch event.  Effects whose remove handler refuses stay on their object and are due again
+    /// at ``tick + 1``.
+    /// @param destroy Destroy effects once removed
+    /// @return Number of effects removed
+    size_t expire(uint64_t tick, bool destroy = true);
+
+    /// Gets the number of committed effects waiting to expire
+    size_t expiring() const noexcept;
+
     /// Gets an effect by typed handle
     Effect* get(TypedHandle handle);
     const Effect* get(TypedHandle handle) const;
@@ -255,6 +297,9 @@ struct EffectSystem : public kernel::Service {
     /// Gets the 'itemprops.2da' table;
     const StaticTwoDA* itemprops() const noexcept;
 
+    /// Gets the earliest tick a committed effect expires at, or ``UINT64_MAX`` if none will
+    uint64_t next_expiry() const noexcept;
+
     /// Removes an effect to an object
     bool remove(ObjectBase* obj, Effect* effect);
 
@@ -265,6 +310,13 @@ struct EffectSystem : public kernel::Service {
     size_t remove_from(ObjectBase* obj, const Vector<Effect*>& effects,
         bool destroy = false, Vector<Effect*>* failed = nullptr);
 
+    /// Applies the effects of an object's ``EffectList``, e.g. from a savegame
+    /// @return Number of effects applied
+    size_t deserialize_effects(ObjectBase* obj, const GffStruct& archive);
+
+    /// Writes an object's ``EffectList``, effects of equipped items are left to be reapplied by them
+    bool serialize_effects(const ObjectBase* obj, GffBuilderStruct& archive) const;
+
     /// Sets post-commit effect event callback
     void set_event_callback(EffectEventFunc callback);
 
@@ -287,6 +339,23 @@ struct EffectSystem : public kernel::Service {
     EffectLimits limits;
 
 private:
+    static constexpr uint32_t no_expiry = std::numeric_limits<uint32_t>::max();
+
+    struct ExpiryEntry {
+        ObjectHandle object;
+        Effect* effect = nullptr;
+    };
+
+    struct ExpiryLocation {
+        uint64_t tick = 0;
+        uint32_t position = no_expiry;
+    };
+
+    void cancel_expiry(Effect* effect);
+    void index_expiry(ObjectBase* obj, Effect* effect);
+    void schedule_expiry();
+    static void expiry_event_callback(const kernel::EventHandle& ev);
+
     absl::flat_hash_map<int32_t, EffectTypeMetadata> registry_;
     Vector<ItemPropertyDefinition> ip_definitions_;
     Vector<const StaticTwoDA*> ip_cost_table_;
@@ -297,6 +366,12 @@ private:
     bool callback_timing_enabled_ = false;
     EffectCallbackTimingStats callback_timing_stats_;
 
+    absl::btree_map<uint64_t, Vector<ExpiryEntry>> expiry_buckets_; ///< Committed timed effects by expiry tick
+    Vector<ExpiryLocation> expiry_locations_;                        ///< By effect pool index
+    size_t expiring_ = 0;
+    uint64_t expiry_events_generation_ = 0;                             ///< Event system holding the expiry event
+    uint64_t expiry_event_tick_ = std::numeric_limits<uint64_t>::max(); ///< Tick of the earliest pending expiry event
+
     RuntimeObjectPool pool_;
 };
 
@@ -2,6 +2,7 @@
 
 #include "../log.hpp"
 
+#include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <limits>
@@ -140,12 +141,20 @@ GffField GffStruct::operator[](StringView label) const
         return {};
     }
 
+    const uint32_t label_idx = parent_->label_index(label);
+    if (label_idx == Gff::no_label) { return {}; }
+    const bool ambiguous = label_idx == Gff::ambiguous_label;
+#if defined(ROLLNW_ENABLE_GFF_STATS)
+    if (!ambiguous) { Gff::bump(parent_->lookups_); }
+#endif
+
     if (entry_->field_count == 1) {
         if (entry_->field_index >= parent_->head_->field_count) {
             return {};
         }
         auto f = GffField(parent_, &parent_->fields_[entry_->field_index]);
-        return string::icmp(f.name(), label) ? f : GffField{};
+        if (ambiguous) { return string::icmp(f.name(), label) ? f : GffField{}; }
+        return f.entry_->label_idx == label_idx ? f : GffField{};
     } else {
         if (entry_->field_index >= parent_->head_->field_idx_count) {
             return {};
@@ -158,13 +167,39 @@ GffField GffStruct::operator[](StringView label) const
             return {};
         }
         auto fi = &parent_->field_indices_[entry_->field_index / 4];
+
+        if (ambiguous) {
+            for (size_t i = 0; i < entry_->field_count; ++i) {
+                if (fi[i] >= parent_->head_->field_count) {
+                    return {};
+                }
+                GffField field(parent_, &parent_->fields_[fi[i]]);
+                if (string::icmp(field.name(), label)) {
+                    return field;
+                }
+            }
+            return GffField();
+        }
+
+        // Structs of the same type almost always share a layout, so try the slot the label had
+        // in the first struct of this type before scanning.
+        if (auto layout = parent_->slot_layout(entry_->type)) {
+            const size_t slot = layout[label_idx];
+            if (slot && slot <= entry_->field_count && fi[slot - 1] < parent_->head_->field_count
+                && parent_->fields_[fi[slot - 1]].label_idx == label_idx) {
+#if defined(ROLLNW_ENABLE_GFF_STATS)
+                Gff::bump(parent_->slot_hits_);
+#endif
+                return GffField(parent_, &parent_->fields_[fi[slot - 1]]);
+            }
+        }
+
         for (size_t i = 0; i < entry_->field_count; ++i) {
             if (fi[i] >= parent_->head_->field_count) {
                 return {};
             }
-            GffField field(parent_, &parent_->fields_[fi[i]]);
-            if (string::icmp(field.name(), label)) {
-                return field;
+            if (parent_->fields_[fi[i]].label_idx == label_idx) {
+                return GffField(parent_, &parent_->fields_[fi[i]]);
             }
         }
         return GffField();
@@ -213,8 +248,9 @@ Gff::Gff(const std::filesystem::path& file, nw::LanguageID lang)
     is_loaded_ = parse();
 }
 
-Gff::Gff(ResourceData data, nw::LanguageID lang)
+Gff::Gff(ResourceData data, nw::LanguageID lang, bool in_place)
     : data_{std::move(data)}
+    , in_place_{in_place}
     , lang_{lang}
 {
     is_loaded_ = parse();
@@ -230,6 +266,83 @@ bool Gff::valid() const
     return is_loaded_;
 }
 
+GffLookupStats Gff::lookup_stats() const noexcept
+{
+#if defined(ROLLNW_ENABLE_GFF_STATS)
+    return {lookups_.load(std::memory_order_relaxed), slot_hits_.load(std::memory_order_relaxed)};
+#else
+    return {};
+#endif
+}
+
+namespace {
+
+bool fold_label(StringView label, GffLabel::Storage& out) noexcept
+{
+    if (label.size() > GffLabel::max_size) { return false; }
+    out.fill(0);
+    for (size_t i = 0; i < label.size(); ++i) {
+        char c = label[i];
+        out[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    return true;
+}
+
+} // namespace
+
+void Gff::build_label_index()
+{
+    label_index_.clear();
+    slot_layouts_.clear();
+    slots_.clear();
+
+    label_index_.reserve(head_->label_count);
+    GffLabel::Storage key;
+    for (uint32_t i = 0; i < head_->label_count; ++i) {
+        if (!fold_label(labels_[i].view(), key)) { continue; }
+        auto [it, inserted] = label_index_.emplace(key, i);
+        if (!inserted) { it->second = ambiguous_label; }
+    }
+
+    if (head_->label_count >= ambiguous_label) { return; }
+    for (uint32_t s = 0; s < head_->struct_count && slot_layouts_.size() < max_slot_layouts; ++s) {
+        const auto& st = structs_[s];
+        if (st.field_count <= 1 || st.field_count >= std::numeric_limits<uint16_t>::max()) { continue; }
+        if (slot_layouts_.contains(st.type)) { continue; }
+        if (st.field_index % 4 != 0
+            || static_cast<size_t>(st.field_index) + static_cast<size_t>(st.field_count) * sizeof(uint32_t)
+                > static_cast<size_t>(head_->field_idx_count)) {
+            continue;
+        }
+
+        const uint32_t offset = static_cast<uint32_t>(slots_.size());
+        slots_.resize(slots_.size() + head_->label_count, 0);
+        const uint32_t* fi = &field_indices_[st.field_index / 4];
+        for (uint32_t i = 0; i < st.field_count; ++i) {
+            if (fi[i] >= head_->field_count) { continue; }
+            const uint32_t label = fields_[fi[i]].label_idx;
+            if (label < head_->label_count && slots_[offset + label] == 0) {
+                slots_[offset + label] = static_cast<uint16_t>(i + 1);
+            }
+        }
+        slot_layouts_.emplace(st.type, offset);
+    }
+}
+
+uint32_t Gff::label_index(StringView label) const noexcept
+{
+    GffLabel::Storage key;
+    if (!fold_label(label, key)) { return no_label; }
+    auto it = label_index_.find(key);
+    return it == label_index_.end() ? no_label : it->second;
+}
+
+const uint16_t* Gff::slot_layout(uint32_t type) const noexcept
+{
+    auto it = slot_layouts_.find(type);
+    return it == slot_layouts_.end() ? nullptr : slots_.data() + it->second;
+}
+
 bool Gff::fail(std::string message)
 {
     error_ = std::move(message);
@@ -248,7 +361,9 @@ bool Gff::parse()
 {
     error_.clear();
 
-    auto in_bounds = [size = data_.bytes.size()](size_t offset, size_t bytes) {
+    // Read through a const view so borrowed (memory mapped) bytes are never copied.
+    const ByteArray& buffer = data_.bytes;
+    auto in_bounds = [size = buffer.size()](size_t offset, size_t bytes) {
         if (offset > size) { return false; }
         return bytes <= (size - offset);
     };
@@ -257,45 +372,53 @@ bool Gff::parse()
         return fail("Corrupt GFF: header out of bounds");
     }
 
-    std::memcpy(&header_storage_, data_.bytes.data(), sizeof(GffHeader));
+    std::memcpy(&header_storage_, buffer.data(), sizeof(GffHeader));
     head_ = &header_storage_;
 
-    const auto copy_table = [&](size_t offset, size_t elem_count, size_t elem_size, auto& out_vec) {
+    // Tables are pointed straight into the resource data when it is suitably aligned, the storage
+    // vectors are only a fallback for misaligned input.  ``data_`` is never mutated after this, so
+    // the pointers stay valid for the lifetime of the Gff.
+    copied_tables_ = 0;
+    const auto load_table = [&](size_t offset, size_t elem_count, auto& out_ptr, auto& out_vec) {
         using Elem = typename std::remove_reference_t<decltype(out_vec)>::value_type;
+        static_assert(std::is_trivially_copyable_v<Elem>);
+        out_vec.clear();
+        out_ptr = nullptr;
         if (elem_count == 0) {
-            out_vec.clear();
             return true;
         }
-        if (elem_count > (std::numeric_limits<size_t>::max() / elem_size)) {
+        if (elem_count > (std::numeric_limits<size_t>::max() / sizeof(Elem))) {
             return false;
         }
-        const size_t bytes = elem_count * elem_size;
+        const size_t bytes = elem_count * sizeof(Elem);
         if (!in_bounds(offset, bytes)) {
             return false;
         }
+        const uint8_t* src = buffer.data() + offset;
+        if (in_place_ && reinterpret_cast<uintptr_t>(src) % alignof(Elem) == 0) {
+            out_ptr = reinterpret_cast<const Elem*>(src);
+            return true;
+        }
         out_vec.resize(elem_count);
-        std::memcpy(out_vec.data(), data_.bytes.data() + offset, bytes);
-        static_assert(std::is_same_v<Elem, std::remove_cv_t<Elem>>);
+        std::memcpy(out_vec.data(), src, bytes);
+        out_ptr = out_vec.data();
+        ++copied_tables_;
         return true;
     };
 
-    CHECK_OFF(copy_table(head_->label_offset, head_->label_count, sizeof(GffLabel), labels_storage_));
-    CHECK_OFF(copy_table(head_->struct_offset, head_->struct_count, sizeof(GffStructEntry), structs_storage_));
-    CHECK_OFF(copy_table(head_->field_offset, head_->field_count, sizeof(GffFieldEntry), fields_storage_));
+    CHECK_OFF(load_table(head_->label_offset, head_->label_count, labels_, labels_storage_));
+    CHECK_OFF(load_table(head_->struct_offset, head_->struct_count, structs_, structs_storage_));
+    CHECK_OFF(load_table(head_->field_offset, head_->field_count, fields_, fields_storage_));
 
     CHECK_OFF(in_bounds(head_->field_data_offset, head_->field_data_count));
 
     CHECK_OFF(head_->field_idx_count % sizeof(uint32_t) == 0);
-    CHECK_OFF(copy_table(head_->field_idx_offset, head_->field_idx_count / sizeof(uint32_t), sizeof(uint32_t), field_indices_storage_));
+    CHECK_OFF(load_table(head_->field_idx_offset, head_->field_idx_count / sizeof(uint32_t), field_indices_, field_indices_storage_));
 
     CHECK_OFF(head_->list_idx_count % sizeof(uint32_t) == 0);
-    CHECK_OFF(copy_table(head_->list_idx_offset, head_->list_idx_count / sizeof(uint32_t), sizeof(uint32_t), list_indices_storage_));
+    CHECK_OFF(load_table(head_->list_idx_offset, head_->list_idx_count / sizeof(uint32_t), list_indices_, list_indices_storage_));
 
-    labels_ = labels_storage_.empty() ? nullptr : labels_storage_.data();
-    structs_ = structs_storage_.empty() ? nullptr : structs_storage_.data();
-    fields_ = fields_storage_.empty() ? nullptr : fields_storage_.data();
-    field_indices_ = field_indices_storage_.empty() ? nullptr : field_indices_storage_.data();
-    list_indices_ = list_indices_storage_.empty() ? nullptr : list_indices_storage_.data();
+    build_label_index();
 
     return true;
 }
@@ -11,6 +11,9 @@
 #include "../util/macros.hpp"
 #include "../util/string.hpp"
 
+#include <absl/container/flat_hash_map.h>
+
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
@@ -100,10 +103,18 @@ private:
     GffStruct(const Gff* parent, const GffStructEntry* entry);
 };
 
+/// Label lookup counters of a ``Gff``
+struct GffLookupStats {
+    uint64_t lookups = 0;   ///< Number of ``GffStruct::operator[](StringView)`` calls resolved through the label index
+    uint64_t slot_hits = 0; ///< Number of those answered by the slot layout cache
+};
+
 struct Gff {
     Gff() = default;
     explicit Gff(const std::filesystem::path& file, nw::LanguageID lang = nw::LanguageID::english);
-    explicit Gff(ResourceData data, nw::LanguageID lang = nw::LanguageID::english);
+    /// @param in_place If true, tables are read directly from ``data`` when suitably aligned rather
+    /// than copied out of it.
+    explicit Gff(ResourceData data, nw::LanguageID lang = nw::LanguageID::english, bool in_place = true);
     Gff(const Gff&) = delete;
     Gff(Gff&&) = delete;
     Gff& operator=(const Gff&) = delete;
@@ -121,15 +132,22 @@ struct Gff {
     /// Parse error message when ``valid()`` is false.
     const std::string& error() const noexcept { return error_; }
 
+    /// Determines if every table is read in place from the underlying resource data
+    bool in_place() const noexcept { return valid() && in_place_ && copied_tables_ == 0; }
+
+    /// Gets label lookup counters
+    /// @note Counters are only kept in builds with ``ROLLNW_ENABLE_GFF_STATS``, otherwise they are zero.
+    GffLookupStats lookup_stats() const noexcept;
+
     /// Get the Gff Version
     StringView version() const { return valid() && head_ ? StringView{head_->version, 4} : StringView{}; }
 
-    GffHeader* head_ = nullptr;
-    GffLabel* labels_ = nullptr;
-    GffStructEntry* structs_ = nullptr;
-    GffFieldEntry* fields_ = nullptr;
-    uint32_t* field_indices_ = nullptr;
-    uint32_t* list_indices_ = nullptr;
+    const GffHeader* head_ = nullptr;
+    const GffLabel* labels_ = nullptr;
+    const GffStructEntry* structs_ = nullptr;
+    const GffFieldEntry* fields_ = nullptr;
+    const uint32_t* field_indices_ = nullptr;
+    const uint32_t* list_indices_ = nullptr;
 
 private:
     friend struct GffField;
@@ -137,6 +155,7 @@ private:
 
     ResourceData data_;
     GffHeader header_storage_{};
+    // Only used for tables that can't be read in place, see ``parse``.
     std::vector<GffLabel> labels_storage_;
     std::vector<GffStructEntry> structs_storage_;
     std::vector<GffFieldEntry> fields_storage_;
@@ -144,8 +163,37 @@ private:
     std::vector<uint32_t> list_indices_storage_;
     std::string error_;
     bool is_loaded_ = false;
+    bool in_place_ = true;
+    uint32_t copied_tables_ = 0;
     nw::LanguageID lang_ = nw::LanguageID::english;
 
+    static constexpr uint32_t no_label = 0xFFFFFFFF;
+    static constexpr uint32_t ambiguous_label = 0xFFFFFFFE;
+    static constexpr size_t max_slot_layouts = 64;
+
+    // Case folded label -> label index, built once in ``parse``.  Labels that fold to the same key
+    // are marked ambiguous and looked up by comparing strings.
+    absl::flat_hash_map<GffLabel::Storage, uint32_t> label_index_;
+    // Struct type -> offset into ``slots_`` of the layout of the first struct of that type.
+    // ``slots_[offset + label]`` is one past the position of the label's field, 0 if absent.
+    absl::flat_hash_map<uint32_t, uint32_t> slot_layouts_;
+    std::vector<uint16_t> slots_;
+#if defined(ROLLNW_ENABLE_GFF_STATS)
+    mutable std::atomic<uint64_t> lookups_{0};
+    mutable std::atomic<uint64_t> slot_hits_{0};
+
+    // Relaxed load and store rather than fetch_add, the counters are only approximate when a Gff is
+    // read from several threads.
+    static void bump(std::atomic<uint64_t>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+#endif
+
+    void build_label_index();
+    uint32_t label_index(StringView label) const noexcept;
+    const uint16_t* slot_layout(uint32_t type) const noexcept;
+
     bool fail(std::string message);
     bool parse();
 };
@@ -18,25 +18,22 @@ GffBuilderStruct::GffBuilderStruct(GffBuilder* parent_)
 
 GffBuilderList& GffBuilderStruct::add_list(StringView name)
 {
-    GffBuilderField f{parent};
-    f.label_index = to_u32(parent->add_label(name));
-    f.type = SerializationType::list;
-    f.structures = GffBuilderList{parent};
-    field_entries.push_back(f);
-    return std::get<GffBuilderList>(field_entries.back().structures);
+    auto label = to_u32(parent->add_label(name));
+    auto result = parent->make_handle<GffBuilderList>();
+    result->index = to_u32(parent->list_fields_.size());
+    parent->list_fields_.push_back(parent->add_field_entry(index, label, SerializationType::list, 0));
+    return *result;
 }
 
 GffBuilderStruct& GffBuilderStruct::add_struct(StringView name, uint32_t id_)
 {
-
-    field_entries.emplace_back(parent);
-    GffBuilderField& f = field_entries.back();
-    f.label_index = to_u32(parent->add_label(name));
-    f.type = SerializationType::struct_;
-    f.structures = GffBuilderStruct{parent};
-    auto& result = std::get<GffBuilderStruct>(field_entries.back().structures);
-    result.id = id_;
-    return result;
+    auto label = to_u32(parent->add_label(name));
+    auto field = parent->add_field_entry(index, label, SerializationType::struct_, 0);
+    auto result = parent->make_handle<GffBuilderStruct>();
+    result->id = id_;
+    result->index = parent->add_struct_entry(id_, GffBuilder::no_list);
+    parent->field_entries[field].data_or_offset = result->index;
+    return *result;
 }
 
 // -- GffBuilderList ----------------------------------------------------
@@ -48,112 +45,106 @@ GffBuilderList::GffBuilderList(GffBuilder* parent_)
 
 GffBuilderStruct& GffBuilderList::push_back(uint32_t id)
 {
-    structs.emplace_back(parent);
-    GffBuilderStruct& result = structs.back();
-    result.id = id;
-    return result;
-}
-
-// -- GffBuilderField ---------------------------------------------------
-
-GffBuilderField::GffBuilderField(GffBuilder* parent_)
-    : parent{parent_}
-{
+    auto result = parent->make_handle<GffBuilderStruct>();
+    result->id = id;
+    result->index = parent->add_struct_entry(id, index);
+    ++size_;
+    return *result;
 }
 
 // -- GffBuilder --------------------------------------------------------
 
 GffBuilder::GffBuilder(StringView type, StringView version)
     : top{this}
+    , arena_{KB(4)}
 {
     std::memcpy(header.type, type.data(), 3);
     header.type[3] = ' ';
     std::memcpy(header.version, version.data(), 4);
 
     top.id = 0xffffffff;
+    top.index = add_struct_entry(top.id, no_list);
 }
 
 size_t GffBuilder::add_label(StringView name)
 {
-    auto it = std::find_if(std::begin(labels), std::end(labels),
-        [&name](const GffLabel& label) -> bool {
-            return label.view() == name;
-        });
-    if (it == std::end(labels)) {
+    // Overlong names are truncated and never match an existing label.
+    if (name.size() > GffLabel::max_size) {
         labels.emplace_back(name);
         return labels.size() - 1;
-    } else {
-        return static_cast<size_t>(std::distance(std::begin(labels), it));
     }
-}
 
-void build_arrays(GffBuilder& archive, GffBuilderField& field);
-void build_arrays(GffBuilder& archive, GffBuilderStruct& str);
-void build_indicies(GffBuilder& archive, const GffBuilderField& field);
-void build_indicies(GffBuilder& archive, const GffBuilderStruct& str);
+    GffLabel::Storage key{};
+    std::memcpy(key.data(), name.data(), name.size());
+    auto [it, inserted] = label_map_.try_emplace(key, to_u32(labels.size()));
+    if (inserted) { labels.emplace_back(key); }
+    return it->second;
+}
 
-void build_arrays(GffBuilder& archive, GffBuilderField& field)
+uint32_t GffBuilder::add_field_entry(uint32_t owner, uint32_t label, SerializationType::type type, uint32_t data_or_offset)
 {
-    field.index = to_u32(archive.field_entries.size());
-    archive.field_entries.push_back({field.type, field.label_index, field.data_or_offset});
-    if (field.type == SerializationType::struct_) {
-        build_arrays(archive, std::get<GffBuilderStruct>(field.structures));
-    } else if (field.type == SerializationType::list) {
-        auto& list = std::get<GffBuilderList>(field.structures);
-        for (auto& s : list.structs) {
-            build_arrays(archive, s);
-        }
-    }
+    auto result = to_u32(field_entries.size());
+    field_entries.push_back({type, label, data_or_offset});
+    field_owners_.push_back(owner);
+    ++struct_entries[owner].field_count;
+    return result;
 }
 
-void build_arrays(GffBuilder& archive, GffBuilderStruct& str)
+uint32_t GffBuilder::add_struct_entry(uint32_t id, uint32_t list)
 {
-    str.index = to_u32(archive.struct_entries.size());
-    archive.struct_entries.push_back({str.id, 0, to_u32(str.field_entries.size())});
-    for (auto& f : str.field_entries) {
-        build_arrays(archive, f);
-    }
+    auto result = to_u32(struct_entries.size());
+    struct_entries.push_back({id, 0, 0});
+    struct_lists_.push_back(list);
+    return result;
 }
 
-void build_indicies(GffBuilder& archive, const GffBuilderField& field)
+void GffBuilder::build()
 {
-    if (field.type == SerializationType::struct_) {
-        const auto& data = std::get<GffBuilderStruct>(field.structures);
-        archive.field_entries[field.index].data_or_offset = data.index;
-        build_indicies(archive, data);
-    } else if (field.type == SerializationType::list) {
-        const auto& data = std::get<GffBuilderList>(field.structures);
-        archive.field_entries[field.index].data_or_offset = to_u32(archive.list_indices.size() * 4); // byte offset
-        archive.list_indices.push_back(to_u32(data.structs.size()));
-        for (auto& s : data.structs) {
-            archive.list_indices.push_back(s.index);
-        }
-        for (auto& s : data.structs) {
-            build_indicies(archive, s);
+    // Field entries and struct entries are already in their final order.  What remains is laying
+    // out each multi-field struct's field indices and each list's struct indices, in struct and list
+    // order respectively.
+    Vector<uint32_t> cursor(struct_entries.size());
+    size_t field_idx_count = 0;
+    for (size_t i = 0; i < struct_entries.size(); ++i) {
+        cursor[i] = to_u32(field_idx_count);
+        if (struct_entries[i].field_count != 1) {
+            struct_entries[i].field_index = to_u32(field_idx_count * 4); // byte offset
+            field_idx_count += struct_entries[i].field_count;
         }
     }
-}
 
-void build_indicies(GffBuilder& archive, const GffBuilderStruct& str)
-{
-    if (str.field_entries.size() == 1) {
-        archive.struct_entries[str.index].field_index = str.field_entries[0].index;
-        build_indicies(archive, str.field_entries[0]);
-    } else {
-        archive.struct_entries[str.index].field_index = to_u32(archive.field_indices.size() * 4); // byte offset
-        for (auto& f : str.field_entries) {
-            archive.field_indices.push_back(f.index);
-        }
-        for (auto& f : str.field_entries) {
-            build_indicies(archive, f);
+    field_indices.assign(field_idx_count, 0);
+    for (size_t i = 0; i < field_entries.size(); ++i) {
+        auto& st = struct_entries[field_owners_[i]];
+        if (st.field_count == 1) {
+            st.field_index = to_u32(i);
+        } else {
+            field_indices[cursor[field_owners_[i]]++] = to_u32(i);
         }
     }
-}
 
-void GffBuilder::build()
-{
-    build_arrays(*this, top);
-    build_indicies(*this, top);
+    Vector<uint32_t> list_sizes(list_fields_.size(), 0);
+    for (auto list : struct_lists_) {
+        if (list != no_list) { ++list_sizes[list]; }
+    }
+
+    cursor.assign(list_fields_.size(), 0);
+    size_t list_idx_count = 0;
+    for (size_t i = 0; i < list_fields_.size(); ++i) {
+        field_entries[list_fields_[i]].data_or_offset = to_u32(list_idx_count * 4); // byte offset
+        cursor[i] = to_u32(list_idx_count + 1);
+        list_idx_count += list_sizes[i] + 1;
+    }
+
+    list_indices.assign(list_idx_count, 0);
+    for (size_t i = 0; i < list_fields_.size(); ++i) {
+        list_indices[cursor[i] - 1] = list_sizes[i];
+    }
+    for (size_t i = 0; i < struct_lists_.size(); ++i) {
+        if (struct_lists_[i] != no_list) {
+            list_indices[cursor[struct_lists_[i]]++] = to_u32(i);
+        }
+    }
 
     header.struct_offset = sizeof(GffHeader);
     header.struct_count = to_u32(struct_entries.size());
@@ -169,9 +160,16 @@ void GffBuilder::build()
     header.list_idx_count = to_u32(list_indices.size() * 4);
 }
 
+size_t GffBuilder::byte_size() const noexcept
+{
+    return sizeof(header) + struct_entries.size() * 12 + field_entries.size() * 12 + labels.size() * 16
+        + data.size() + field_indices.size() * 4 + list_indices.size() * 4;
+}
+
 ByteArray GffBuilder::to_byte_array() const
 {
     ByteArray result;
+    result.reserve(byte_size());
     result.append(&header, sizeof(header));
     result.append(struct_entries.data(), struct_entries.size() * 12);
     result.append(field_entries.data(), field_entries.size() * 12);
@@ -192,6 +190,14 @@ bool GffBuilder::write_to(const fs::path& filename) const
     if (!out.good())
         return false;
 
+    if (!write_to(out)) { return false; }
+    out.close();
+
+    return move_file_safely(temp, filename);
+}
+
+bool GffBuilder::write_to(std::ostream& out) const
+{
     ostream_write(out, &header, sizeof(header));
     ostream_write(out, struct_entries.data(), struct_entries.size() * 12);
     ostream_write(out, field_entries.data(), field_entries.size() * 12);
@@ -199,9 +205,7 @@ bool GffBuilder::write_to(const fs::path& filename) const
     ostream_write(out, data.data(), data.size());
     ostream_write(out, field_indices.data(), field_indices.size() * 4);
     ostream_write(out, list_indices.data(), list_indices.size() * 4);
-    out.close();
-
-    return move_file_safely(temp, filename);
+    return out.good();
 }
 
 } // namespace nw
@@ -2,18 +2,23 @@
 
 #include "../i18n/conversion.hpp"
 #include "../serialization/Serialization.hpp"
+#include "../util/memory.hpp"
 #include "../util/templates.hpp"
 #include "gff_common.hpp"
 
+#include <absl/container/flat_hash_map.h>
+
 #include <cstdint>
+#include <iosfwd>
 
 namespace nw {
 
-// Not super concerned about the efficiency of this, only the correctness.  Ideally, the way it's written,
-// will be exactly the way an object reads it.
+// Fields are streamed into flat tables as they are added, there is no intermediate tree.  Struct and
+// list handles are allocated from the builder's arena, so references to them stay valid.  Nested
+// structs and lists should be completed before adding further fields to an enclosing struct, then the
+// output is laid out exactly as an object reads it.  Out of order additions still produce a valid file.
 
 struct GffBuilder;
-struct GffBuilderField;
 struct GffBuilderList;
 struct GffBuilderStruct;
 
@@ -29,7 +34,6 @@ struct GffBuilderStruct {
     GffBuilder* parent = nullptr;
     uint32_t index = 0;
     uint32_t id = 0;
-    Vector<GffBuilderField> field_entries;
 };
 
 struct GffBuilderList {
@@ -37,31 +41,29 @@ struct GffBuilderList {
     explicit GffBuilderList(GffBuilder* parent_);
 
     GffBuilderStruct& push_back(uint32_t id);
-    size_t size() const noexcept { return structs.size(); }
+    size_t size() const noexcept { return size_; }
 
     GffBuilder* parent = nullptr;
-    Vector<GffBuilderStruct> structs;
-};
-
-struct GffBuilderField {
-    explicit GffBuilderField(GffBuilder* parent_);
-
-    GffBuilder* parent = nullptr;
-    SerializationType::type type;
     uint32_t index = 0;
-    uint32_t label_index = 0;
-    uint32_t data_or_offset = 0;
-    std::variant<GffBuilderStruct, GffBuilderList> structures;
+    uint32_t size_ = 0;
 };
 
 struct GffBuilder {
     explicit GffBuilder(StringView type, StringView version = "V3.2");
+    GffBuilder(const GffBuilder&) = delete;
+    GffBuilder(GffBuilder&&) = default;
+    GffBuilder& operator=(const GffBuilder&) = delete;
+    GffBuilder& operator=(GffBuilder&&) = default;
 
     size_t add_label(StringView name);
     // Note, this must be called before `write_to` or `to_byte_array`
     void build();
+    /// Size in bytes of the built file
+    size_t byte_size() const noexcept;
     ByteArray to_byte_array() const;
     bool write_to(const std::filesystem::path& path) const;
+    /// Writes the built file to a stream
+    bool write_to(std::ostream& out) const;
 
     GffBuilderStruct top;
 
@@ -72,67 +74,90 @@ struct GffBuilder {
     Vector<uint32_t> list_indices;
     Vector<GffFieldEntry> field_entries;
     Vector<GffStructEntry> struct_entries;
+
+private:
+    friend struct GffBuilderList;
+    friend struct GffBuilderStruct;
+
+    static constexpr uint32_t no_list = 0xFFFFFFFF;
+
+    uint32_t add_field_entry(uint32_t owner, uint32_t label, SerializationType::type type, uint32_t data_or_offset);
+    uint32_t add_struct_entry(uint32_t id, uint32_t list);
+
+    template <typename T>
+    T* make_handle()
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return new (arena_.allocate(sizeof(T), alignof(T))) T{this};
+    }
+
+    MemoryArena arena_;
+    absl::flat_hash_map<GffLabel::Storage, uint32_t> label_map_;
+    Vector<uint32_t> field_owners_; ///< Struct index of each field entry
+    Vector<uint32_t> struct_lists_; ///< List index of each struct, ``no_list`` if not a list element
+    Vector<uint32_t> list_fields_;  ///< Field index of each list
 };
 
 template <typename T>
 GffBuilderStruct& GffBuilderStruct::add_field(StringView name, const T& value)
 {
-    GffBuilderField f{parent};
-    f.label_index = to_u32(parent->add_label(name));
+    SerializationType::type type = SerializationType::invalid;
+    uint32_t data_or_offset = 0;
+    const uint32_t label_index = to_u32(parent->add_label(name));
 
     if constexpr (std::is_enum_v<T>) {
         return add_field(name, to_underlying(value));
     } else if constexpr (std::is_same_v<T, bool>) {
-        f.type = SerializationType::id<uint8_t>();
+        type = SerializationType::id<uint8_t>();
         uint8_t temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 1);
+        std::memcpy(&data_or_offset, &temp, 1);
     } else if constexpr (std::is_same_v<T, uint8_t>) {
-        f.type = SerializationType::id<uint8_t>();
+        type = SerializationType::id<uint8_t>();
         uint8_t temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 1);
+        std::memcpy(&data_or_offset, &temp, 1);
     } else if constexpr (std::is_same_v<T, int8_t>) {
-        f.type = SerializationType::id<int8_t>();
+        type = SerializationType::id<int8_t>();
         int8_t temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 1);
+        std::memcpy(&data_or_offset, &temp, 1);
     } else if constexpr (std::is_same_v<T, uint16_t>) {
-        f.type = SerializationType::id<uint16_t>();
+        type = SerializationType::id<uint16_t>();
         uint16_t temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 2);
+        std::memcpy(&data_or_offset, &temp, 2);
     } else if constexpr (std::is_same_v<T, int16_t>) {
-        f.type = SerializationType::id<int16_t>();
+        type = SerializationType::id<int16_t>();
         int16_t temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 2);
+        std::memcpy(&data_or_offset, &temp, 2);
     } else if constexpr (std::is_same_v<T, uint32_t>) {
-        f.type = SerializationType::id<uint32_t>();
+        type = SerializationType::id<uint32_t>();
         uint32_t temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 4);
+        std::memcpy(&data_or_offset, &temp, 4);
     } else if constexpr (std::is_same_v<T, int32_t>) {
-        f.type = SerializationType::id<int32_t>();
+        type = SerializationType::id<int32_t>();
         int32_t temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 4);
+        std::memcpy(&data_or_offset, &temp, 4);
     } else if constexpr (std::is_same_v<T, uint64_t>) {
-        f.data_or_offset = to_u32(parent->data.size());
-        f.type = SerializationType::id<uint64_t>();
+        data_or_offset = to_u32(parent->data.size());
+        type = SerializationType::id<uint64_t>();
         uint64_t temp = value;
         parent->data.append(&temp, 8);
     } else if constexpr (std::is_same_v<T, int64_t>) {
-        f.data_or_offset = to_u32(parent->data.size());
-        f.type = SerializationType::id<int64_t>();
+        data_or_offset = to_u32(parent->data.size());
+        type = SerializationType::id<int64_t>();
         int64_t temp = value;
         parent->data.append(&temp, 8);
     } else if constexpr (std::is_same_v<T, float>) {
-        f.type = SerializationType::id<float>();
+        type = SerializationType::id<float>();
         float temp = value;
-        std::memcpy(&f.data_or_offset, &temp, 4);
+        std::memcpy(&data_or_offset, &temp, 4);
     } else if constexpr (std::is_same_v<T, double>) {
-        f.data_or_offset = to_u32(parent->data.size());
-        f.type = SerializationType::id<double>();
+        data_or_offset = to_u32(parent->data.size());
+        type = SerializationType::id<double>();
         double temp = value;
         parent->data.append(&temp, 8);
     } else if constexpr (std::is_same_v<T, String>) {
         const String& temp = value;
-        f.type = SerializationType::id<String>();
-        f.data_or_offset = to_u32(parent->data.size());
+        type = SerializationType::id<String>();
+        data_or_offset = to_u32(parent->data.size());
         String s = string::desanitize_colors(temp);
         s = from_utf8_by_global_lang(s);
         uint32_t size = to_u32(s.size());
@@ -140,8 +165,8 @@ GffBuilderStruct& GffBuilderStruct::add_field(StringView name, const T& value)
         parent->data.append(s.data(), size);
     } else if constexpr (std::is_same_v<T, Resref>) {
         const Resref& temp = value;
-        f.type = SerializationType::id<Resref>();
-        f.data_or_offset = to_u32(parent->data.size());
+        type = SerializationType::id<Resref>();
+        data_or_offset = to_u32(parent->data.size());
         if (temp.length() > nw::kernel::config().max_resref_length()) {
             throw std::runtime_error(fmt::format("[gffbuilder] invalid resref '{}'", temp.view()));
         }
@@ -150,8 +175,8 @@ GffBuilderStruct& GffBuilderStruct::add_field(StringView name, const T& value)
         parent->data.append(temp.view().data(), size);
     } else if constexpr (std::is_same_v<T, LocString>) {
         const LocString& temp = value;
-        f.type = SerializationType::id<LocString>();
-        f.data_or_offset = to_u32(parent->data.size());
+        type = SerializationType::id<LocString>();
+        data_or_offset = to_u32(parent->data.size());
         uint32_t total_size = 8;
         uint32_t strref = temp.strref(), num_strings = to_u32(temp.size());
         size_t placeholder = parent->data.size(); // Won't know total size till the end.
@@ -168,18 +193,18 @@ GffBuilderStruct& GffBuilderStruct::add_field(StringView name, const T& value)
             parent->data.append(&size, 4);
             parent->data.append(s.data(), size);
         }
-        memcpy(parent->data.data() + placeholder, &total_size, 4);
+        memcpy(parent->data.mutable_data() + placeholder, &total_size, 4);
     } else if constexpr (std::is_same_v<T, ByteArray>) {
         const ByteArray& temp = value;
-        f.type = SerializationType::id<ByteArray>();
-        f.data_or_offset = to_u32(parent->data.size());
+        type = SerializationType::id<ByteArray>();
+        data_or_offset = to_u32(parent->data.size());
         uint32_t size = to_u32(temp.size());
         parent->data.append(&size, 4);
         parent->data.append(temp.data(), size);
     } else {
         static_assert(always_false<T>());
     }
-    field_entries.push_back(f);
+    parent->add_field_entry(index, label_index, type, data_or_offset);
 
     return *this;
 }
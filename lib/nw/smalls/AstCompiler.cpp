@@ -3659,6 +3659,10 @@ void AstCompiler::visit(CallExpression* expr)
             return;
         }
         Runtime::GenericInstantiation inst = *inst_opt;
+        if (defining_script != script_) {
+            module_->generic_instantiations.push_back({String(defining_script->name()),
+                generic_def ? generic_def->identifier() : func_name, expr->inferred_type_args});
+        }
 
         const FunctionDefinition* func_def = call_signature_def;
         size_t total_args = func_def ? func_def->params.size() : expr->args.size();
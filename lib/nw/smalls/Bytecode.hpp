@@ -361,6 +361,15 @@ struct BytecodeModule {
     };
     Vector<ExternalGlobalRef> global_refs;
     absl::flat_hash_map<String, uint32_t> global_ref_map; // "module::var" -> index
+
+    // Generic functions of other modules instantiated while compiling this one.  The instantiations
+    // live in the defining module, so they are replayed when this module is read from a bytecode cache.
+    struct GenericInstantiationRef {
+        String module_name;
+        String function_name;
+        Vector<TypeID> type_args;
+    };
+    Vector<GenericInstantiationRef> generic_instantiations;
 };
 
 } // namespace nw::smalls
@@ -0,0 +1,276 @@
+#include "BytecodeCache.hpp"
+
+#include "../kernel/Strings.hpp"
+#include "../util/BinaryStream.hpp"
+#include "runtime.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace nw::smalls {
+
+namespace {
+
+constexpr char cache_magic[4] = {'N', 'W', 'S', 'B'};
+constexpr uint32_t cache_format_version = 1;
+constexpr uint32_t no_offset = std::numeric_limits<uint32_t>::max();
+
+// Adds runtime type names and source locations to the plain binary encoding
+struct Writer : BinaryWriter {
+    Runtime& runtime;
+    StringView source;
+    bool ok = true;
+
+    Writer(ByteArray& out, Runtime& rt, StringView src)
+        : BinaryWriter(out)
+        , runtime(rt)
+        , source(src)
+    {
+    }
+
+    void type(TypeID id)
+    {
+        if (id == invalid_type_id) {
+            str({});
+            return;
+        }
+        auto name = runtime.type_name(id);
+        if (runtime.type_id(name) != id) { ok = false; }
+        str(name);
+    }
+
+    void location(const SourceLocation& loc)
+    {
+        uint32_t offset = no_offset;
+        uint32_t length = 0;
+        if (loc.start && loc.end && loc.start >= source.data() && loc.end <= source.data() + source.size()) {
+            offset = static_cast<uint32_t>(loc.start - source.data());
+            length = static_cast<uint32_t>(loc.length());
+        }
+        pod(offset);
+        pod(length);
+        pod(static_cast<uint32_t>(loc.range.start.line));
+        pod(static_cast<uint32_t>(loc.range.start.column));
+        pod(static_cast<uint32_t>(loc.range.end.line));
+        pod(static_cast<uint32_t>(loc.range.end.column));
+    }
+};
+
+struct Reader : BinaryReader {
+    Runtime& runtime;
+    StringView source;
+
+    Reader(std::span<const uint8_t> bytes, Runtime& rt, StringView src)
+        : BinaryReader(bytes)
+        , runtime(rt)
+        , source(src)
+    {
+    }
+
+    TypeID type()
+    {
+        auto name = str();
+        if (name.empty()) { return invalid_type_id; }
+        auto id = runtime.type_id(name);
+        if (id == invalid_type_id) { fail(); }
+        return id;
+    }
+
+    SourceLocation location()
+    {
+        SourceLocation loc;
+        const auto offset = pod<uint32_t>();
+        const auto length = pod<uint32_t>();
+        loc.range.start.line = pod<uint32_t>();
+        loc.range.start.column = pod<uint32_t>();
+        loc.range.end.line = pod<uint32_t>();
+        loc.range.end.column = pod<uint32_t>();
+        if (offset != no_offset && uint64_t(offset) + length <= source.size()) {
+            loc.start = source.data() + offset;
+            loc.end = loc.start + length;
+        }
+        return loc;
+    }
+};
+
+} // namespace
+
+StringView bytecode_build_id() noexcept
+{
+#ifdef ROLLNW_BUILD_ID
+    return ROLLNW_BUILD_ID;
+#else
+    return __DATE__ " " __TIME__;
+#endif
+}
+
+bool write_bytecode_module(const BytecodeModule& module, Runtime& runtime, StringView source, uint64_t key,
+    ByteArray& out)
+{
+    out.clear();
+    Writer w{out, runtime, source};
+
+    w.bytes(cache_magic, sizeof(cache_magic));
+    w.pod(cache_format_version);
+    w.pod(bytecode_compiler_version);
+    w.pod(key);
+    w.str(module.module_name);
+
+    w.pod(static_cast<uint32_t>(module.string_pool.size()));
+    for (const auto& str : module.string_pool) {
+        w.str(str);
+    }
+
+    w.pod(static_cast<uint32_t>(module.constants.size()));
+    for (const auto& constant : module.constants) {
+        w.type(constant.type_id);
+        w.pod(constant.data.string_idx);
+    }
+
+    w.pod(static_cast<uint32_t>(module.functions.size()));
+    for (const auto* func : module.functions) {
+        w.str(func->name);
+        w.pod(func->param_count);
+        w.pod(func->register_count);
+        w.pod(func->upvalue_count);
+        w.type(func->return_type);
+        w.type(func->function_type);
+        w.pods(func->instructions);
+        w.pods(func->constant_refs);
+        w.pods(func->upvalue_descriptors);
+        w.pod(static_cast<uint32_t>(func->debug_locations.size()));
+        for (const auto& loc : func->debug_locations) {
+            w.location(loc);
+        }
+    }
+
+    w.pod(static_cast<uint32_t>(module.type_refs.size()));
+    for (auto type : module.type_refs) {
+        w.type(type);
+    }
+    w.pods(module.field_offsets);
+    w.pod(static_cast<uint32_t>(module.field_types.size()));
+    for (auto type : module.field_types) {
+        w.type(type);
+    }
+
+    // Slots are written in order so identical modules produce identical files
+    Vector<std::pair<uint32_t, StringView>> slots;
+    slots.reserve(module.global_slot_map.size());
+    for (const auto& [name, slot] : module.global_slot_map) {
+        slots.emplace_back(slot, name);
+    }
+    std::sort(slots.begin(), slots.end());
+    w.pod(module.global_count);
+    w.pod(static_cast<uint32_t>(slots.size()));
+    for (const auto& [slot, name] : slots) {
+        w.str(name);
+        w.pod(slot);
+    }
+
+    w.pod(static_cast<uint32_t>(module.external_refs.size()));
+    for (const auto& ref : module.external_refs) {
+        w.str(ref.view());
+    }
+    w.pod(static_cast<uint32_t>(module.global_refs.size()));
+    for (const auto& ref : module.global_refs) {
+        w.str(ref.module_name);
+        w.str(ref.var_name);
+    }
+
+    w.pod(static_cast<uint32_t>(module.generic_instantiations.size()));
+    for (const auto& inst : module.generic_instantiations) {
+        w.str(inst.module_name);
+        w.str(inst.function_name);
+        w.pod(static_cast<uint32_t>(inst.type_args.size()));
+        for (auto type : inst.type_args) {
+            w.type(type);
+        }
+    }
+
+    return w.ok;
+}
+
+bool read_bytecode_module(std::span<const uint8_t> bytes, Runtime& runtime, StringView source, uint64_t key,
+    BytecodeModule& module)
+{
+    Reader r{bytes, runtime, source};
+
+    char magic[4];
+    r.bytes(magic, sizeof(magic));
+    if (!r.ok()
+        || std::memcmp(magic, cache_magic, sizeof(magic)) != 0
+        || r.pod<uint32_t>() != cache_format_version
+        || r.pod<uint32_t>() != bytecode_compiler_version
+        || r.pod<uint64_t>() != key
+        || r.str() != module.module_name) {
+        return false;
+    }
+
+    for (uint32_t i = 0, n = r.count(sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        auto str = r.str();
+        module.string_indices.emplace(String(str), static_cast<uint32_t>(module.string_pool.size()));
+        module.string_pool.emplace_back(str);
+    }
+
+    for (uint32_t i = 0, n = r.count(2 * sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        Constant constant;
+        constant.type_id = r.type();
+        constant.data.string_idx = r.pod<uint32_t>();
+        module.constants.push_back(constant);
+    }
+
+    for (uint32_t i = 0, n = r.count(sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        auto* func = module.add_function(new CompiledFunction(String(r.str())));
+        func->param_count = r.pod<uint8_t>();
+        func->register_count = r.pod<uint16_t>();
+        func->upvalue_count = r.pod<uint8_t>();
+        func->return_type = r.type();
+        func->function_type = r.type();
+        r.pods(func->instructions);
+        r.pods(func->constant_refs);
+        r.pods(func->upvalue_descriptors);
+        const auto locations = r.count(6 * sizeof(uint32_t));
+        func->debug_locations.reserve(locations);
+        for (uint32_t j = 0; j < locations && r.ok(); ++j) {
+            func->debug_locations.push_back(r.location());
+        }
+    }
+
+    for (uint32_t i = 0, n = r.count(sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        module.type_refs.push_back(r.type());
+    }
+    r.pods(module.field_offsets);
+    for (uint32_t i = 0, n = r.count(sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        module.field_types.push_back(r.type());
+    }
+
+    module.global_count = r.pod<uint32_t>();
+    for (uint32_t i = 0, n = r.count(2 * sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        auto name = r.str();
+        module.global_slot_map[String(name)] = r.pod<uint32_t>();
+    }
+
+    for (uint32_t i = 0, n = r.count(sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        module.add_external_ref(nw::kernel::strings().intern(r.str()));
+    }
+    for (uint32_t i = 0, n = r.count(2 * sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        auto module_name = r.str();
+        module.add_global_ref(module_name, r.str());
+    }
+
+    for (uint32_t i = 0, n = r.count(3 * sizeof(uint32_t)); i < n && r.ok(); ++i) {
+        BytecodeModule::GenericInstantiationRef inst;
+        inst.module_name = String(r.str());
+        inst.function_name = String(r.str());
+        for (uint32_t j = 0, types = r.count(sizeof(uint32_t)); j < types && r.ok(); ++j) {
+            inst.type_args.push_back(r.type());
+        }
+        module.generic_instantiations.push_back(std::move(inst));
+    }
+
+    return r.ok() && r.remaining() == 0;
+}
+
+} // namespace nw::smalls
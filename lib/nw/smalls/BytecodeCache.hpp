@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../util/ByteArray.hpp"
+#include "Bytecode.hpp"
+
+#include <cstdint>
+#include <span>
+
+namespace nw::smalls {
+
+struct Runtime;
+
+/// Version of the bytecode ``AstCompiler`` emits, part of every bytecode cache key
+/// @note Bump when code generation or the layout of ``BytecodeModule`` changes.
+inline constexpr uint32_t bytecode_compiler_version = 1;
+
+/// Identifies the build of the library, part of every bytecode cache key
+StringView bytecode_build_id() noexcept;
+
+/// Serializes a compiled module for ``read_bytecode_module``
+///
+/// Type ids are assigned at runtime so types are written by name, source locations are written as
+/// offsets into ``source``.
+/// @param key Identifies the inputs the module was compiled from, see ``Runtime::set_bytecode_cache_path``
+/// @return false if the module refers to a type that cannot be found again by name
+bool write_bytecode_module(const BytecodeModule& module, Runtime& runtime, StringView source, uint64_t key,
+    ByteArray& out);
+
+/// Reads a module written by ``write_bytecode_module`` into an empty ``module``
+/// @return false if the bytes are corrupt, were written with a different key or format, or refer to a
+/// type that does not exist in ``runtime``
+bool read_bytecode_module(std::span<const uint8_t> bytes, Runtime& runtime, StringView source, uint64_t key,
+    BytecodeModule& module);
+
+} // namespace nw::smalls
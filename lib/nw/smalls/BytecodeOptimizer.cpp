@@ -0,0 +1,751 @@
+#include "BytecodeOptimizer.hpp"
+
+#include "../log.hpp"
+#include "BytecodeVerifier.hpp"
+#include "runtime.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <limits>
+
+namespace nw::smalls {
+
+BytecodeOptimizerStats& BytecodeOptimizerStats::operator+=(const BytecodeOptimizerStats& other) noexcept
+{
+    functions += other.functions;
+    instructions_before += other.instructions_before;
+    instructions_after += other.instructions_after;
+    copies_propagated += other.copies_propagated;
+    dead_stores_removed += other.dead_stores_removed;
+    jumps_threaded += other.jumps_threaded;
+    branches_fused += other.branches_fused;
+    calls_inlined += other.calls_inlined;
+    return *this;
+}
+
+namespace {
+
+using RegisterSet = std::bitset<256>;
+
+constexpr uint8_t reg_a = 1;
+constexpr uint8_t reg_b = 2;
+constexpr uint8_t reg_c = 4;
+
+constexpr int max_rounds = 4;
+constexpr int max_jump_hops = 8;
+
+// Registers an instruction reads and writes.  Unknown instructions are treated as reading every
+// register and clobbering every copy; they may write registers the table does not describe,
+// e.g. intrinsics with several results.
+struct OpShape {
+    uint8_t uses = 0;
+    uint8_t defs = 0;
+    bool known = false;
+    bool in_place = false; // Reads and writes A, e.g. CAST
+};
+
+OpShape shape_of(Opcode op) noexcept
+{
+    switch (op) {
+    case Opcode::ADD:
+    case Opcode::SUB:
+    case Opcode::MUL:
+    case Opcode::DIV:
+    case Opcode::MOD:
+    case Opcode::AND:
+    case Opcode::OR:
+    case Opcode::EQ:
+    case Opcode::NE:
+    case Opcode::LT:
+    case Opcode::LE:
+    case Opcode::GT:
+    case Opcode::GE:
+    case Opcode::GETARRAY:
+    case Opcode::MAPGET:
+    case Opcode::FIELDGETI_R:
+    case Opcode::FIELDGETF_R:
+    case Opcode::FIELDGETB_R:
+    case Opcode::FIELDGETS_R:
+    case Opcode::FIELDGETO_R:
+    case Opcode::FIELDGETH_R:
+    case Opcode::FIELDGETI_OFF_R:
+    case Opcode::FIELDGETF_OFF_R:
+    case Opcode::FIELDGETB_OFF_R:
+    case Opcode::FIELDGETS_OFF_R:
+    case Opcode::FIELDGETO_OFF_R:
+    case Opcode::FIELDGETH_OFF_R:
+    case Opcode::STACK_FIELDGET_R:
+    case Opcode::STACK_INDEXGET:
+        return {reg_b | reg_c, reg_a, true, false};
+
+    case Opcode::NEG:
+    case Opcode::NOT:
+    case Opcode::MOVE:
+    case Opcode::TYPEOF:
+    case Opcode::GETFIELD:
+    case Opcode::GETTUPLE:
+    case Opcode::FIELDGETI:
+    case Opcode::FIELDGETF:
+    case Opcode::FIELDGETB:
+    case Opcode::FIELDGETS:
+    case Opcode::FIELDGETO:
+    case Opcode::FIELDGETH:
+    case Opcode::STACK_FIELDGET:
+    case Opcode::SUMGETTAG:
+    case Opcode::SUMGETPAYLOAD:
+        return {reg_b, reg_a, true, false};
+
+    case Opcode::LOADK:
+    case Opcode::LOADI:
+    case Opcode::LOADB:
+    case Opcode::LOADNIL:
+    case Opcode::GETUPVAL:
+    case Opcode::GETGLOBAL:
+    case Opcode::GETEXTGLOBAL:
+        return {0, reg_a, true, false};
+
+    case Opcode::CAST:
+    case Opcode::IS:
+    case Opcode::IS_OBJ_SUBTYPE:
+        return {reg_a, reg_a, true, true};
+
+    case Opcode::SETFIELD:
+    case Opcode::FIELDSETI:
+    case Opcode::FIELDSETF:
+    case Opcode::FIELDSETB:
+    case Opcode::FIELDSETS:
+    case Opcode::FIELDSETO:
+    case Opcode::FIELDSETH:
+    case Opcode::STACK_FIELDSET:
+        return {reg_a | reg_c, 0, true, false};
+
+    case Opcode::SETARRAY:
+    case Opcode::MAPSET:
+    case Opcode::FIELDSETI_R:
+    case Opcode::FIELDSETF_R:
+    case Opcode::FIELDSETB_R:
+    case Opcode::FIELDSETS_R:
+    case Opcode::FIELDSETO_R:
+    case Opcode::FIELDSETH_R:
+    case Opcode::FIELDSETI_OFF_R:
+    case Opcode::FIELDSETF_OFF_R:
+    case Opcode::FIELDSETB_OFF_R:
+    case Opcode::FIELDSETS_OFF_R:
+    case Opcode::FIELDSETO_OFF_R:
+    case Opcode::FIELDSETH_OFF_R:
+    case Opcode::STACK_FIELDSET_R:
+    case Opcode::STACK_INDEXSET:
+        return {reg_a | reg_b | reg_c, 0, true, false};
+
+    case Opcode::JMPT:
+    case Opcode::JMPF:
+    case Opcode::RET:
+    case Opcode::SETGLOBAL:
+    case Opcode::SETUPVAL:
+        return {reg_a, 0, true, false};
+
+    case Opcode::ISEQ:
+    case Opcode::ISNE:
+    case Opcode::ISLT:
+    case Opcode::ISLE:
+    case Opcode::ISGT:
+    case Opcode::ISGE:
+        return {reg_a | reg_b, 0, true, false};
+
+    case Opcode::JMP:
+    case Opcode::RETVOID:
+        return {0, 0, true, false};
+
+    default:
+        return {};
+    }
+}
+
+// Instructions a function may contain to be inlined, none can write memory or call
+bool is_inlinable(Opcode op) noexcept
+{
+    switch (op) {
+    case Opcode::ADD:
+    case Opcode::SUB:
+    case Opcode::MUL:
+    case Opcode::DIV:
+    case Opcode::MOD:
+    case Opcode::NEG:
+    case Opcode::AND:
+    case Opcode::OR:
+    case Opcode::NOT:
+    case Opcode::EQ:
+    case Opcode::NE:
+    case Opcode::LT:
+    case Opcode::LE:
+    case Opcode::GT:
+    case Opcode::GE:
+    case Opcode::LOADK:
+    case Opcode::LOADI:
+    case Opcode::LOADB:
+    case Opcode::MOVE:
+    case Opcode::LOADNIL:
+    case Opcode::GETFIELD:
+    case Opcode::GETTUPLE:
+    case Opcode::FIELDGETI:
+    case Opcode::FIELDGETF:
+    case Opcode::FIELDGETB:
+    case Opcode::FIELDGETS:
+    case Opcode::FIELDGETO:
+    case Opcode::FIELDGETH:
+    case Opcode::CAST:
+    case Opcode::IS:
+    case Opcode::IS_OBJ_SUBTYPE:
+    case Opcode::GETGLOBAL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions with no effect beyond writing A
+bool is_removable_store(Opcode op) noexcept
+{
+    switch (op) {
+    case Opcode::MOVE:
+    case Opcode::LOADK:
+    case Opcode::LOADI:
+    case Opcode::LOADB:
+    case Opcode::LOADNIL:
+    case Opcode::GETGLOBAL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool is_compare(Opcode op) noexcept { return op >= Opcode::EQ && op <= Opcode::GE; }
+bool is_test(Opcode op) noexcept { return op >= Opcode::ISEQ && op <= Opcode::ISGE; }
+
+bool is_branch(Opcode op) noexcept
+{
+    return op == Opcode::JMP || op == Opcode::JMPT || op == Opcode::JMPF;
+}
+
+bool is_return(Opcode op) noexcept { return op == Opcode::RET || op == Opcode::RETVOID; }
+
+uint8_t get_field(Instruction instr, uint8_t field) noexcept
+{
+    if (field == reg_a) { return instr.arg_a(); }
+    if (field == reg_b) { return instr.arg_b(); }
+    return instr.arg_c();
+}
+
+void set_field(Instruction& instr, uint8_t field, uint8_t value) noexcept
+{
+    const uint32_t shift = field == reg_a ? 16 : (field == reg_b ? 8 : 0);
+    instr.raw = (instr.raw & ~(0xFFu << shift)) | (static_cast<uint32_t>(value) << shift);
+}
+
+// == Function Representation =================================================
+
+// Jumps are kept as absolute node indices so instructions can be removed and inserted freely,
+// offsets are recomputed by ``encode``.
+struct Node {
+    Instruction instr;
+    SourceLocation loc;
+    int32_t target = -1;
+    bool removed = false;
+};
+
+constexpr uint8_t flag_targeted = 1;  // Some jump lands here
+constexpr uint8_t flag_protected = 2; // Follows a test-and-skip, must stay one instruction
+constexpr uint8_t flag_leader = 4;    // Starts a basic block
+
+bool decode(const CompiledFunction& func, Vector<Node>& nodes)
+{
+    const auto& instrs = func.instructions;
+    if (instrs.empty() || func.debug_locations.size() != instrs.size()) { return false; }
+
+    const auto n = static_cast<int32_t>(instrs.size());
+    nodes.resize(instrs.size());
+    for (int32_t i = 0; i < n; ++i) {
+        const Instruction instr = instrs[i];
+        const Opcode op = instr.opcode();
+        // Upvalue descriptor words follow CLOSURE and the closure may capture any register
+        if (op == Opcode::CLOSURE) { return false; }
+
+        nodes[i].instr = instr;
+        nodes[i].loc = func.debug_locations[i];
+        if (is_branch(op)) {
+            const int32_t offset = op == Opcode::JMP ? instr.arg_jump() : instr.arg_sbx();
+            const int32_t target = i + 1 + offset;
+            if (target < 0 || target >= n) { return false; }
+            nodes[i].target = target;
+        }
+    }
+    return true;
+}
+
+bool encode(const Vector<Node>& nodes, Vector<Instruction>& instrs, Vector<SourceLocation>& locs)
+{
+    if (nodes.empty() || !is_return(nodes.back().instr.opcode())) { return false; }
+
+    instrs.clear();
+    locs.clear();
+    instrs.reserve(nodes.size());
+    locs.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Instruction instr = nodes[i].instr;
+        if (nodes[i].target >= 0) {
+            const int32_t offset = nodes[i].target - static_cast<int32_t>(i + 1);
+            if (instr.opcode() == Opcode::JMP) {
+                if (offset < -(1 << 23) || offset >= (1 << 23)) { return false; }
+                instr = Instruction::make_jump(Opcode::JMP, offset);
+            } else {
+                if (offset < std::numeric_limits<int16_t>::min() || offset > std::numeric_limits<int16_t>::max()) {
+                    return false;
+                }
+                instr = Instruction::make_asbx(instr.opcode(), instr.arg_a(), static_cast<int16_t>(offset));
+            }
+        }
+        instrs.push_back(instr);
+        locs.push_back(nodes[i].loc);
+    }
+    return true;
+}
+
+// Drops removed nodes, jumps to a removed node land on the next one kept
+void compact(Vector<Node>& nodes)
+{
+    Vector<int32_t> remap(nodes.size() + 1);
+    int32_t next = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        remap[i] = next;
+        if (!nodes[i].removed) { ++next; }
+    }
+    remap[nodes.size()] = next;
+
+    Vector<Node> result;
+    result.reserve(static_cast<size_t>(next));
+    for (auto& node : nodes) {
+        if (node.removed) { continue; }
+        if (node.target >= 0) { node.target = remap[node.target]; }
+        result.push_back(node);
+    }
+    nodes = std::move(result);
+}
+
+Vector<uint8_t> flow_flags(const Vector<Node>& nodes)
+{
+    Vector<uint8_t> flags(nodes.size(), 0);
+    if (!nodes.empty()) { flags[0] |= flag_leader; }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Opcode op = nodes[i].instr.opcode();
+        if (nodes[i].target >= 0) { flags[nodes[i].target] |= flag_targeted | flag_leader; }
+        if ((op == Opcode::JMP || is_return(op)) && i + 1 < nodes.size()) { flags[i + 1] |= flag_leader; }
+        if (is_test(op)) {
+            if (i + 1 < nodes.size()) { flags[i + 1] |= flag_protected; }
+            if (i + 2 < nodes.size()) { flags[i + 2] |= flag_leader; }
+        }
+    }
+    return flags;
+}
+
+void use_def(Instruction instr, RegisterSet& use, RegisterSet& def)
+{
+    use.reset();
+    def.reset();
+
+    const Opcode op = instr.opcode();
+    if (op == Opcode::CALL) {
+        for (uint32_t i = 1; i <= instr.arg_c(); ++i) {
+            const uint32_t r = instr.arg_a() + i;
+            if (r < 256) { use.set(r); }
+        }
+        def.set(instr.arg_a());
+        return;
+    }
+
+    const OpShape shape = shape_of(op);
+    if (!shape.known) {
+        use.set();
+        return;
+    }
+    for (uint8_t field : {reg_a, reg_b, reg_c}) {
+        if (shape.uses & field) { use.set(get_field(instr, field)); }
+        if (shape.defs & field) { def.set(get_field(instr, field)); }
+    }
+}
+
+// Registers live after each node
+Vector<RegisterSet> liveness(const Vector<Node>& nodes)
+{
+    const size_t n = nodes.size();
+    Vector<RegisterSet> use(n), def(n), live_in(n), live_out(n);
+    for (size_t i = 0; i < n; ++i) {
+        use_def(nodes[i].instr, use[i], def[i]);
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = n; i-- > 0;) {
+            const Opcode op = nodes[i].instr.opcode();
+            RegisterSet out;
+            if (nodes[i].target >= 0) { out |= live_in[nodes[i].target]; }
+            if (op != Opcode::JMP && !is_return(op) && i + 1 < n) { out |= live_in[i + 1]; }
+            if (is_test(op) && i + 2 < n) { out |= live_in[i + 2]; }
+
+            RegisterSet in = use[i] | (out & ~def[i]);
+            if (in != live_in[i] || out != live_out[i]) {
+                live_in[i] = in;
+                live_out[i] = out;
+                changed = true;
+            }
+        }
+    }
+    return live_out;
+}
+
+// == Passes ==================================================================
+
+uint32_t propagate_copies(Vector<Node>& nodes)
+{
+    const auto flags = flow_flags(nodes);
+    std::array<int16_t, 256> copy_of;
+    copy_of.fill(-1);
+
+    auto invalidate = [&](uint8_t r) {
+        copy_of[r] = -1;
+        for (auto& src : copy_of) {
+            if (src == r) { src = -1; }
+        }
+    };
+
+    uint32_t count = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (flags[i] & flag_leader) { copy_of.fill(-1); }
+
+        Instruction& instr = nodes[i].instr;
+        const Opcode op = instr.opcode();
+        const OpShape shape = shape_of(op);
+        if (!shape.known) {
+            copy_of.fill(-1);
+            continue;
+        }
+
+        if (!shape.in_place) {
+            for (uint8_t field : {reg_a, reg_b, reg_c}) {
+                if (!(shape.uses & field)) { continue; }
+                const int16_t src = copy_of[get_field(instr, field)];
+                if (src >= 0) {
+                    set_field(instr, field, static_cast<uint8_t>(src));
+                    ++count;
+                }
+            }
+        }
+
+        for (uint8_t field : {reg_a, reg_b, reg_c}) {
+            if (shape.defs & field) { invalidate(get_field(instr, field)); }
+        }
+        if (op == Opcode::MOVE && instr.arg_a() != instr.arg_b()) {
+            copy_of[instr.arg_a()] = instr.arg_b();
+        }
+    }
+    return count;
+}
+
+uint32_t eliminate_dead_stores(Vector<Node>& nodes)
+{
+    const auto flags = flow_flags(nodes);
+    const auto live = liveness(nodes);
+
+    uint32_t count = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Instruction instr = nodes[i].instr;
+        if ((flags[i] & flag_protected) || !is_removable_store(instr.opcode())) { continue; }
+
+        const bool self_move = instr.opcode() == Opcode::MOVE && instr.arg_a() == instr.arg_b();
+        if (self_move || !live[i].test(instr.arg_a())) {
+            nodes[i].removed = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
+uint32_t thread_jumps(Vector<Node>& nodes)
+{
+    uint32_t count = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto& node = nodes[i];
+        if (node.target < 0) { continue; }
+
+        int32_t target = node.target;
+        for (int hops = 0; hops < max_jump_hops; ++hops) {
+            const auto& next = nodes[target];
+            if (next.instr.opcode() != Opcode::JMP || next.target == target
+                || next.target == static_cast<int32_t>(i)) {
+                break;
+            }
+            target = next.target;
+        }
+        if (target != node.target) {
+            node.target = target;
+            ++count;
+        }
+
+        if (node.instr.opcode() == Opcode::JMP && is_return(nodes[target].instr.opcode())) {
+            node.instr = nodes[target].instr;
+            node.target = -1;
+            ++count;
+        }
+    }
+
+    const auto flags = flow_flags(nodes);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto& node = nodes[i];
+        if (node.instr.opcode() == Opcode::JMP && node.target == static_cast<int32_t>(i + 1)
+            && !(flags[i] & flag_protected)) {
+            node.removed = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
+// ``CMP t, x, y; JMPF t, L`` becomes ``IScmp x, y; JMP L`` when ``t`` is not read afterwards
+uint32_t fuse_branches(Vector<Node>& nodes)
+{
+    const auto flags = flow_flags(nodes);
+    const auto live = liveness(nodes);
+
+    uint32_t count = 0;
+    for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+        auto& cmp = nodes[i];
+        auto& branch = nodes[i + 1];
+        const Opcode op = cmp.instr.opcode();
+        const Opcode branch_op = branch.instr.opcode();
+        if (!is_compare(op) || (branch_op != Opcode::JMPF && branch_op != Opcode::JMPT)) { continue; }
+        if ((flags[i] & flag_protected) || (flags[i + 1] & flag_targeted)) { continue; }
+
+        const uint8_t result = cmp.instr.arg_a();
+        if (branch.instr.arg_a() != result || live[i + 1].test(result)) { continue; }
+
+        // The test skips the jump when the comparison holds.  Jumping on true needs the negated
+        // comparison, which is only exact for equality.
+        Opcode test;
+        if (branch_op == Opcode::JMPF) {
+            test = static_cast<Opcode>(static_cast<uint8_t>(Opcode::ISEQ)
+                + (static_cast<uint8_t>(op) - static_cast<uint8_t>(Opcode::EQ)));
+        } else if (op == Opcode::EQ) {
+            test = Opcode::ISNE;
+        } else if (op == Opcode::NE) {
+            test = Opcode::ISEQ;
+        } else {
+            continue;
+        }
+
+        cmp.instr = Instruction::make_abc(test, cmp.instr.arg_b(), cmp.instr.arg_c(), 0);
+        branch.instr = Instruction::make_jump(Opcode::JMP, 0);
+        ++count;
+        ++i;
+    }
+    return count;
+}
+
+bool returns_scalar(const Runtime* runtime, TypeID type) noexcept
+{
+    return type == runtime->int_type()
+        || type == runtime->float_type()
+        || type == runtime->bool_type()
+        || type == runtime->string_type()
+        || runtime->is_object_like_type(type);
+}
+
+// Straight-line functions of a few pure instructions that read only parameters or registers they
+// wrote, ending in a single RET of a scalar
+bool can_inline(const CompiledFunction* callee, const Runtime* runtime, uint32_t max_instructions)
+{
+    if (!callee || callee->upvalue_count > 0 || callee->instructions.empty()) { return false; }
+    if (callee->instructions.size() - 1 > max_instructions) { return false; }
+    if (callee->register_count > 256 || callee->param_count > callee->register_count) { return false; }
+
+    const Instruction last = callee->instructions.back();
+    if (last.opcode() != Opcode::RET || !returns_scalar(runtime, callee->return_type)) { return false; }
+
+    RegisterSet defined;
+    for (uint32_t p = 0; p < callee->param_count; ++p) {
+        defined.set(p);
+    }
+    for (size_t i = 0; i + 1 < callee->instructions.size(); ++i) {
+        const Instruction instr = callee->instructions[i];
+        if (!is_inlinable(instr.opcode())) { return false; }
+
+        const OpShape shape = shape_of(instr.opcode());
+        for (uint8_t field : {reg_a, reg_b, reg_c}) {
+            if ((shape.uses & field) && !defined.test(get_field(instr, field))) { return false; }
+        }
+        for (uint8_t field : {reg_a, reg_b, reg_c}) {
+            if (shape.defs & field) { defined.set(get_field(instr, field)); }
+        }
+    }
+    return defined.test(last.arg_a());
+}
+
+// Inlined bodies share the registers past the caller's own
+uint32_t inline_calls(Vector<Node>& nodes, const CompiledFunction& func, const BytecodeModule& module,
+    const Runtime* runtime, uint32_t max_instructions, uint16_t& register_count)
+{
+    const auto flags = flow_flags(nodes);
+    const uint32_t base = func.register_count;
+
+    Vector<Node> result;
+    result.reserve(nodes.size());
+    Vector<int32_t> remap(nodes.size());
+    uint32_t count = 0;
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        remap[i] = static_cast<int32_t>(result.size());
+        const Node& node = nodes[i];
+        const Instruction call = node.instr;
+
+        const CompiledFunction* callee = nullptr;
+        if (call.opcode() == Opcode::CALL && !(flags[i] & flag_protected) && call.arg_b() < module.functions.size()) {
+            callee = module.functions[call.arg_b()];
+        }
+        if (!callee || callee == &func || call.arg_c() != callee->param_count
+            || base + callee->register_count > 256
+            || !can_inline(callee, runtime, max_instructions)) {
+            result.push_back(node);
+            continue;
+        }
+
+        auto emit = [&](Instruction instr) {
+            result.push_back(Node{instr, node.loc, -1, false});
+        };
+
+        for (uint32_t p = 0; p < callee->param_count; ++p) {
+            emit(Instruction::make_abc(Opcode::MOVE, static_cast<uint8_t>(base + p),
+                static_cast<uint8_t>(call.arg_a() + 1 + p), 0));
+        }
+        for (size_t j = 0; j + 1 < callee->instructions.size(); ++j) {
+            Instruction instr = callee->instructions[j];
+            const OpShape shape = shape_of(instr.opcode());
+            for (uint8_t field : {reg_a, reg_b, reg_c}) {
+                if ((shape.uses | shape.defs) & field) {
+                    set_field(instr, field, static_cast<uint8_t>(base + get_field(instr, field)));
+                }
+            }
+            emit(instr);
+        }
+        emit(Instruction::make_abc(Opcode::MOVE, call.arg_a(),
+            static_cast<uint8_t>(base + callee->instructions.back().arg_a()), 0));
+
+        register_count = std::max<uint16_t>(register_count, static_cast<uint16_t>(base + callee->register_count));
+        ++count;
+    }
+
+    if (count == 0) { return 0; }
+    for (auto& node : result) {
+        if (node.target >= 0) { node.target = remap[node.target]; }
+    }
+    nodes = std::move(result);
+    return count;
+}
+
+void optimize_function(CompiledFunction& func, const BytecodeModule& module, const Runtime* runtime,
+    const BytecodeOptimizerOptions& options, BytecodeOptimizerStats& stats)
+{
+    Vector<Node> nodes;
+    if (!decode(func, nodes)) { return; }
+
+    BytecodeOptimizerStats local;
+    local.instructions_before = static_cast<uint32_t>(nodes.size());
+    uint16_t register_count = func.register_count;
+
+    if (options.inline_small_functions && runtime) {
+        local.calls_inlined = inline_calls(nodes, func, module, runtime, options.max_inline_instructions,
+            register_count);
+    }
+
+    for (int round = 0; round < max_rounds; ++round) {
+        uint32_t changes = 0;
+        if (options.copy_propagation) {
+            const uint32_t n = propagate_copies(nodes);
+            local.copies_propagated += n;
+            changes += n;
+        }
+        if (options.dead_store_elimination) {
+            const uint32_t n = eliminate_dead_stores(nodes);
+            compact(nodes);
+            local.dead_stores_removed += n;
+            changes += n;
+        }
+        if (options.jump_threading) {
+            const uint32_t n = thread_jumps(nodes);
+            compact(nodes);
+            local.jumps_threaded += n;
+            changes += n;
+        }
+        if (options.superinstructions) {
+            const uint32_t n = fuse_branches(nodes);
+            local.branches_fused += n;
+            changes += n;
+        }
+        if (changes == 0) { break; }
+    }
+
+    Vector<Instruction> instructions;
+    Vector<SourceLocation> locations;
+    if (!encode(nodes, instructions, locations)) { return; }
+
+    local.functions = 1;
+    local.instructions_after = static_cast<uint32_t>(instructions.size());
+    func.instructions = std::move(instructions);
+    func.debug_locations = std::move(locations);
+    func.register_count = register_count;
+    stats += local;
+}
+
+} // namespace
+
+BytecodeOptimizerStats optimize_bytecode(BytecodeModule* module, const Runtime* runtime,
+    const BytecodeOptimizerOptions& options)
+{
+    BytecodeOptimizerStats stats;
+    if (!module || !options.any()) { return stats; }
+
+    struct Original {
+        Vector<Instruction> instructions;
+        Vector<SourceLocation> debug_locations;
+        uint16_t register_count = 0;
+    };
+    Vector<Original> originals;
+    originals.reserve(module->functions.size());
+    for (const auto* func : module->functions) {
+        if (func) {
+            originals.push_back({func->instructions, func->debug_locations, func->register_count});
+        } else {
+            originals.push_back({});
+        }
+    }
+
+    for (auto* func : module->functions) {
+        if (func) { optimize_function(*func, *module, runtime, options, stats); }
+    }
+
+    String error;
+    if (!verify_bytecode_module(module, &error)) {
+        LOG_F(ERROR, "[smalls] optimized bytecode of '{}' failed verification, keeping it unoptimized: {}",
+            module->module_name, error);
+        for (size_t i = 0; i < module->functions.size(); ++i) {
+            if (auto* func = module->functions[i]) {
+                func->instructions = std::move(originals[i].instructions);
+                func->debug_locations = std::move(originals[i].debug_locations);
+                func->register_count = originals[i].register_count;
+            }
+        }
+        return {};
+    }
+    return stats;
+}
+
+} // namespace nw::smalls
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Bytecode.hpp"
+
+#include <cstdint>
+
+namespace nw::smalls {
+
+struct Runtime;
+
+/// Passes run by ``optimize_bytecode``
+struct BytecodeOptimizerOptions {
+    bool copy_propagation = true;       ///< Reads of ``MOVE`` destinations use the source register
+    bool dead_store_elimination = true; ///< Removes moves and loads whose result is never read
+    bool jump_threading = true;         ///< Retargets jumps to jumps, drops jumps to the next instruction
+    bool superinstructions = true;      ///< Fuses compare and branch pairs into test-and-skip
+    bool inline_small_functions = true; ///< Inlines calls to short straight-line functions in the same module
+    uint32_t max_inline_instructions = 8;
+
+    /// Gets options with every pass disabled
+    static constexpr BytecodeOptimizerOptions none() noexcept
+    {
+        return {false, false, false, false, false};
+    }
+
+    /// Determines if any pass is enabled
+    constexpr bool any() const noexcept
+    {
+        return copy_propagation || dead_store_elimination || jump_threading || superinstructions
+            || inline_small_functions;
+    }
+};
+
+/// Counts of changes made by ``optimize_bytecode``
+struct BytecodeOptimizerStats {
+    uint32_t functions = 0; ///< Functions rewritten
+    uint32_t instructions_before = 0;
+    uint32_t instructions_after = 0;
+    uint32_t copies_propagated = 0;
+    uint32_t dead_stores_removed = 0;
+    uint32_t jumps_threaded = 0;
+    uint32_t branches_fused = 0;
+    uint32_t calls_inlined = 0;
+
+    BytecodeOptimizerStats& operator+=(const BytecodeOptimizerStats& other) noexcept;
+};
+
+/// Optimizes the compiled functions of a module in place
+///
+/// Functions that create closures are left as compiled, since their registers may be captured.
+/// ``debug_locations`` is kept in step with ``instructions``, inlined code reports the location of
+/// its call.  If the result does not pass ``verify_bytecode_module`` the module is restored.
+///
+/// @param runtime Used to check inlined return types, inlining is skipped if null
+BytecodeOptimizerStats optimize_bytecode(BytecodeModule* module, const Runtime* runtime,
+    const BytecodeOptimizerOptions& options = {});
+
+} // namespace nw::smalls
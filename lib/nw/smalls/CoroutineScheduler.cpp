@@ -0,0 +1,202 @@
+#include "CoroutineScheduler.hpp"
+
+#include "../log.hpp"
+#include "Smalls.hpp"
+#include "VirtualMachine.hpp"
+
+#include <algorithm>
+
+namespace nw::smalls {
+
+namespace {
+
+struct CoroutineWakeEvent {
+    uint64_t tick = 0;
+};
+
+void coroutine_wake_payload_delete(void* data)
+{
+    delete static_cast<CoroutineWakeEvent*>(data);
+}
+
+void coroutine_wake_callback(const kernel::EventHandle& ev)
+{
+    auto* payload = static_cast<CoroutineWakeEvent*>(ev.data);
+    auto* runtime = kernel::services().get_mut<Runtime>();
+    if (!payload || !runtime) {
+        return;
+    }
+
+    runtime->coroutines().resume_due(payload->tick);
+}
+
+} // namespace
+
+CoroutineScheduler::CoroutineScheduler(Runtime* runtime, VirtualMachine* vm)
+    : runtime_{runtime}
+    , vm_{vm}
+    , slice_gas_{Runtime::default_gas_limit}
+{
+}
+
+// Pending wake events outlive the scheduler harmlessly, they find no bucket for their tick.
+CoroutineScheduler::~CoroutineScheduler() = default;
+
+CoroutineId CoroutineScheduler::spawn(BytecodeModule* module, const CompiledFunction* function,
+    std::span<const Value> args)
+{
+    if (!vm_->idle()) {
+        LOG_F(ERROR, "[runtime] unable to spawn coroutine while a script is running");
+        return 0;
+    }
+
+    auto co = std::make_unique<Coroutine>();
+    CoroutineId id = next_id_++;
+    switch (vm_->start_coroutine(*co, module, function, args, slice_gas_)) {
+    case CoroutineStatus::finished:
+        return 0;
+    case CoroutineStatus::failed:
+        report_failure(id);
+        return 0;
+    case CoroutineStatus::parked:
+        break;
+    }
+
+    uint64_t tick = wake_tick(*co);
+    parked_.emplace(id, Parked{std::move(co), runtime_->module_generation()});
+    schedule(id, tick);
+    return id;
+}
+
+CoroutineId CoroutineScheduler::spawn(Script* script, StringView function_name, std::span<const Value> args)
+{
+    BytecodeModule* module = script ? runtime_->get_or_compile_module(script) : nullptr;
+    if (!module) {
+        LOG_F(ERROR, "[runtime] Failed to get bytecode for coroutine script '{}'", script ? script->name() : StringView{});
+        return 0;
+    }
+
+    const CompiledFunction* function = module->get_function(function_name);
+    if (!function) {
+        LOG_F(ERROR, "[runtime] Coroutine function not found: {}", function_name);
+        return 0;
+    }
+    return spawn(module, function, args);
+}
+
+size_t CoroutineScheduler::resume_due(uint64_t tick)
+{
+    auto bucket = wake_.find(tick);
+    if (bucket == wake_.end()) {
+        return 0;
+    }
+    Vector<CoroutineId> due = std::move(bucket->second.coroutines);
+    wake_.erase(bucket);
+
+    auto& events = kernel::events();
+    const uint64_t next_tick = events.current_tick() + 1;
+
+    size_t resumed = 0;
+    uint64_t budget = tick_budget_;
+    for (size_t i = 0; i < due.size(); ++i) {
+        // Out of budget or reentered from a running script, the rest waits for the next tick
+        if ((tick_budget_ && budget == 0) || !vm_->idle()) {
+            auto& deferred = wake_bucket(next_tick).coroutines;
+            deferred.insert(deferred.begin(), due.begin() + static_cast<ptrdiff_t>(i), due.end());
+            break;
+        }
+
+        auto it = parked_.find(due[i]);
+        if (it == parked_.end()) { continue; } // Cancelled
+
+        if (it->second.module_generation != runtime_->module_generation()) {
+            LOG_F(WARNING, "[runtime] dropping coroutine {}, its modules were evicted while it was parked", due[i]);
+            parked_.erase(it);
+            continue;
+        }
+
+        uint64_t slice = slice_gas_;
+        if (tick_budget_ && (slice == 0 || slice > budget)) { slice = budget; }
+
+        Coroutine& co = *it->second.coroutine;
+        CoroutineStatus status = vm_->resume_coroutine(co, slice);
+        ++resumed;
+        if (tick_budget_) {
+            budget -= std::min(budget, slice - vm_->remaining_gas());
+        }
+
+        switch (status) {
+        case CoroutineStatus::finished:
+            parked_.erase(it);
+            break;
+        case CoroutineStatus::failed:
+            report_failure(due[i]);
+            parked_.erase(it);
+            break;
+        case CoroutineStatus::parked:
+            schedule(due[i], wake_tick(co));
+            break;
+        }
+    }
+
+    return resumed;
+}
+
+bool CoroutineScheduler::cancel(CoroutineId id)
+{
+    // Its id stays in the wake bucket and is skipped when the bucket is resumed
+    return parked_.erase(id) > 0;
+}
+
+void CoroutineScheduler::clear()
+{
+    if (auto* events = kernel::services().get_mut<kernel::EventSystem>()) {
+        for (const auto& [_, bucket] : wake_) {
+            events->cancel(bucket.event);
+        }
+    }
+    wake_.clear();
+    parked_.clear();
+}
+
+bool CoroutineScheduler::is_parked(CoroutineId id) const
+{
+    return parked_.contains(id);
+}
+
+void CoroutineScheduler::enumerate_roots(GCRootVisitor& visitor)
+{
+    for (auto& [_, parked] : parked_) {
+        parked.coroutine->enumerate_roots(visitor, runtime_);
+    }
+}
+
+CoroutineScheduler::WakeBucket& CoroutineScheduler::wake_bucket(uint64_t tick)
+{
+    auto& bucket = wake_[tick];
+    if (!bucket.event.is_valid()) {
+        auto& events = kernel::events();
+        const uint64_t now = events.current_tick();
+        bucket.event = events.add_custom(ObjectHandle{}, &coroutine_wake_callback, tick > now ? tick - now : 0,
+            new CoroutineWakeEvent{tick}, &coroutine_wake_payload_delete);
+    }
+    return bucket;
+}
+
+void CoroutineScheduler::schedule(CoroutineId id, uint64_t tick)
+{
+    wake_bucket(tick).coroutines.push_back(id);
+}
+
+uint64_t CoroutineScheduler::wake_tick(const Coroutine& co) const
+{
+    return kernel::events().current_tick() + std::max<uint64_t>(co.sleep_ticks, 1);
+}
+
+void CoroutineScheduler::report_failure(CoroutineId id)
+{
+    LOG_F(ERROR, "[runtime] coroutine {} failed: {}", id, vm_->error_message());
+    vm_->reset();
+}
+
+} // namespace nw::smalls
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "runtime.hpp"
+
+#include "../kernel/EventSystem.hpp"
+
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace nw::smalls {
+
+struct Coroutine;
+struct VirtualMachine;
+
+/// Identifies a parked coroutine, 0 is never a valid id
+using CoroutineId = uint64_t;
+
+/// Parks smalls coroutines and resumes them on later ``EventSystem`` ticks
+///
+/// A coroutine parks when it calls ``core.coroutine.yield`` or ``core.coroutine.sleep``, or when it runs out
+/// of its slice gas.  Coroutines due on the same tick share one custom event and resume in the order they
+/// parked.  The tick budget bounds the gas spent by all resumes of one tick, once it is spent the remaining
+/// coroutines move to the front of the next tick, so script time per tick is bounded without failing
+/// long running scripts.  Coroutines are dropped if modules are evicted while they are parked.
+struct CoroutineScheduler {
+    CoroutineScheduler(Runtime* runtime, VirtualMachine* vm);
+    ~CoroutineScheduler();
+
+    CoroutineScheduler(const CoroutineScheduler&) = delete;
+    CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+    /// Runs a function as a coroutine until it returns, fails or parks
+    /// @return Id of the parked coroutine, or 0 if it finished, failed or the VM was busy
+    CoroutineId spawn(BytecodeModule* module, const CompiledFunction* function, std::span<const Value> args = {});
+    CoroutineId spawn(Script* script, StringView function_name, std::span<const Value> args = {});
+
+    /// Resumes the coroutines due on ``tick``, called by their wake event
+    /// @return Number of coroutines resumed
+    size_t resume_due(uint64_t tick);
+
+    /// Drops a parked coroutine without resuming it
+    bool cancel(CoroutineId id);
+
+    /// Drops every parked coroutine
+    void clear();
+
+    /// Determines if a coroutine is parked
+    bool is_parked(CoroutineId id) const;
+
+    /// Gets the number of parked coroutines
+    size_t parked() const noexcept { return parked_.size(); }
+
+    /// Gas of one resume, 0 for unlimited
+    uint64_t slice_gas() const noexcept { return slice_gas_; }
+    void set_slice_gas(uint64_t gas) noexcept { slice_gas_ = gas; }
+
+    /// Gas shared by every resume of one tick, 0 for unlimited
+    uint64_t tick_budget() const noexcept { return tick_budget_; }
+    void set_tick_budget(uint64_t gas) noexcept { tick_budget_ = gas; }
+
+    /// Enumerate parked roots for GC
+    void enumerate_roots(GCRootVisitor& visitor);
+
+private:
+    struct Parked {
+        std::unique_ptr<Coroutine> coroutine;
+        uint64_t module_generation = 0;
+    };
+
+    struct WakeBucket {
+        Vector<CoroutineId> coroutines;
+        kernel::EventId event;
+    };
+
+    // Gets the coroutines waking on ``tick``, scheduling their event on first use
+    WakeBucket& wake_bucket(uint64_t tick);
+    void schedule(CoroutineId id, uint64_t tick);
+    uint64_t wake_tick(const Coroutine& co) const;
+    void report_failure(CoroutineId id);
+
+    Runtime* runtime_ = nullptr;
+    VirtualMachine* vm_ = nullptr;
+    absl::flat_hash_map<CoroutineId, Parked> parked_;
+    absl::btree_map<uint64_t, WakeBucket> wake_;
+    CoroutineId next_id_ = 1;
+    uint64_t slice_gas_ = 100000;
+    uint64_t tick_budget_ = 0;
+};
+
+} // namespace nw::smalls
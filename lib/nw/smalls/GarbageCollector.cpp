@@ -1,6 +1,7 @@
 #include "GarbageCollector.hpp"
 
 #include "../kernel/Kernel.hpp"
+#include "Map.hpp"
 #include "VirtualMachine.hpp"
 #include "runtime.hpp"
 
@@ -515,6 +516,10 @@ void GarbageCollector::mark_roots(bool young_only)
     runtime_->enumerate_handle_roots(visitor, young_only);
     handle_roots_us = to_us(handle_roots_start, std::chrono::high_resolution_clock::now());
 
+    // Call stacks parked by coroutines
+    source = RootSource::none;
+    runtime_->enumerate_coroutine_roots(visitor);
+
     stats_.minor_roots_frame_slots_us += frame_slots_us;
     stats_.minor_roots_registers_us += registers_us;
     stats_.minor_roots_runtime_stack_us += runtime_stack_us;
@@ -1062,34 +1067,9 @@ bool GarbageCollector::trace_object(HeapPtr ptr, bool young_only)
         MapInstance* map = static_cast<MapInstance*>(heap_->get_ptr(ptr));
         if (!map) { return false; }
 
-        bool key_is_heap = runtime_->type_table_.is_heap_type(map->key_type);
-        bool val_is_heap = runtime_->type_table_.is_heap_type(map->value_type);
-
-        auto it = map->data.begin();
-        auto end = map->data.end();
-        while (it != end) {
-            auto& [key, val] = *it;
-
-            // Prefetch next entry's values
-            auto next_it = it;
-            ++next_it;
-            if (next_it != end) {
-                if (key_is_heap && next_it->first.storage == ValueStorage::heap) {
-                    rollnw_prefetch(heap_->get_ptr(next_it->first.data.hptr), 1, 1);
-                }
-                if (val_is_heap && next_it->second.storage == ValueStorage::heap) {
-                    rollnw_prefetch(heap_->get_ptr(next_it->second.data.hptr), 1, 1);
-                }
-            }
-
-            if (key_is_heap && key.storage == ValueStorage::heap) {
-                try_mark_child(key.data.hptr);
-            }
-            if (val_is_heap && val.storage == ValueStorage::heap) {
-                try_mark_child(val.data.hptr);
-            }
-            ++it;
-        }
+        // Prefetch the next entry's heap refs while marking the current one
+        map->for_each_heap_ref([&](HeapPtr child) { try_mark_child(child); },
+            [&](HeapPtr next) { rollnw_prefetch(heap_->get_ptr(next), 1, 1); });
         break;
     }
 
@@ -0,0 +1,37 @@
+#include "Map.hpp"
+
+namespace nw::smalls {
+
+// == MapInstance =============================================================
+
+namespace {
+
+MapTable make_map_table(MapKeyKind kind, bool unboxed, const Runtime* rt)
+{
+    switch (kind) {
+    case MapKeyKind::int_key:
+        if (unboxed) { return IntMapTable<MapScalar>{}; }
+        return IntMapTable<Value>{};
+    case MapKeyKind::string_key:
+        if (unboxed) { return StringMapTable<MapScalar>{0, StringKeyHash{}, StringKeyEq{rt}}; }
+        return StringMapTable<Value>{0, StringKeyHash{}, StringKeyEq{rt}};
+    case MapKeyKind::generic:
+        break;
+    }
+    if (unboxed) { return GenericMapTable<MapScalar>{}; }
+    return GenericMapTable<Value>{};
+}
+
+} // namespace
+
+MapInstance::MapInstance(TypeID k, TypeID v, MapKeyKind kind, bool unboxed, const Runtime* runtime)
+    : key_type(k)
+    , value_type(v)
+    , key_kind(kind)
+    , unboxed_values(unboxed)
+    , rt(runtime)
+    , data(make_map_table(kind, unboxed, runtime))
+{
+}
+
+} // namespace nw::smalls
@@ -0,0 +1,314 @@
+#pragma once
+
+#include "runtime.hpp"
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <variant>
+
+namespace nw::smalls {
+
+// == Map Storage =============================================================
+
+/// Key storage of a map, chosen from its key type when the map is allocated
+enum struct MapKeyKind : uint8_t {
+    generic,    ///< ``Value`` keys hashed through ``ValueHash``/``ValueEq``, i.e. native value types
+    int_key,    ///< ``int`` and newtypes over ``int``, stored unboxed
+    string_key, ///< ``string`` and newtypes over ``string``, keyed by the ``HeapPtr`` of the inserted string
+};
+
+/// Unboxed map value, the raw bits of an int, float or bool of the map's value type
+using MapScalar = uint32_t;
+
+namespace detail {
+
+inline StringView map_string_key_view(const Runtime* rt, HeapPtr str)
+{
+    return str.value != 0 ? rt->get_string_view(str) : StringView{};
+}
+
+} // namespace detail
+
+/// Key of a string keyed map, the script string an entry was inserted with and the hash of its contents
+/// @note The hash is kept so that growing the table never reads the strings again.
+struct StringMapKey {
+    HeapPtr str;
+    size_t hash = 0;
+};
+
+/// Hashes string keys by contents, lookups pass the ``StringView`` of the script string searched for
+struct StringKeyHash {
+    using is_transparent = void;
+
+    size_t operator()(StringView key) const noexcept { return absl::HashOf(key); }
+    size_t operator()(const StringMapKey& key) const noexcept { return key.hash; }
+};
+
+struct StringKeyEq {
+    using is_transparent = void;
+
+    const Runtime* rt = nullptr;
+
+    bool operator()(const StringMapKey& a, const StringMapKey& b) const noexcept
+    {
+        return a.str == b.str
+            || (a.hash == b.hash && detail::map_string_key_view(rt, a.str) == detail::map_string_key_view(rt, b.str));
+    }
+    bool operator()(const StringMapKey& a, StringView b) const noexcept
+    {
+        return detail::map_string_key_view(rt, a.str) == b;
+    }
+    bool operator()(StringView a, const StringMapKey& b) const noexcept
+    {
+        return a == detail::map_string_key_view(rt, b.str);
+    }
+};
+
+template <typename V>
+using GenericMapTable = absl::flat_hash_map<Value, V, ValueHash, ValueEq>;
+
+template <typename V>
+using IntMapTable = absl::flat_hash_map<int32_t, V>;
+
+/// String keyed table, the key is the script string an entry was inserted with and is kept alive by the map
+template <typename V>
+using StringMapTable = absl::flat_hash_map<StringMapKey, V, StringKeyHash, StringKeyEq>;
+
+using MapTable = std::variant<
+    GenericMapTable<Value>, GenericMapTable<MapScalar>,
+    IntMapTable<Value>, IntMapTable<MapScalar>,
+    StringMapTable<Value>, StringMapTable<MapScalar>>;
+
+namespace detail {
+
+// Converts keys and values between ``Value`` and their storage in a ``MapTable``
+
+inline const Value& map_find_key(const Runtime*, const Value& key, std::type_identity<Value>) { return key; }
+inline int32_t map_find_key(const Runtime*, const Value& key, std::type_identity<int32_t>) { return key.data.ival; }
+
+inline StringView map_find_key(const Runtime* rt, const Value& key, std::type_identity<StringMapKey>)
+{
+    return map_string_key_view(rt, key.data.hptr);
+}
+
+inline const Value& map_insert_key(const Runtime*, const Value& key, std::type_identity<Value>) { return key; }
+inline int32_t map_insert_key(const Runtime*, const Value& key, std::type_identity<int32_t>) { return key.data.ival; }
+
+inline StringMapKey map_insert_key(const Runtime* rt, const Value& key, std::type_identity<StringMapKey>)
+{
+    return {key.data.hptr, StringKeyHash{}(map_string_key_view(rt, key.data.hptr))};
+}
+
+inline Value map_load_key(const std::pair<const Value, Value>& entry, TypeID) { return entry.first; }
+inline Value map_load_key(const std::pair<const Value, MapScalar>& entry, TypeID) { return entry.first; }
+
+template <typename V>
+Value map_load_key(const std::pair<const int32_t, V>& entry, TypeID type)
+{
+    Value result(type);
+    result.data.ival = entry.first;
+    return result;
+}
+
+template <typename V>
+Value map_load_key(const std::pair<const StringMapKey, V>& entry, TypeID type)
+{
+    return Value::make_heap(entry.first.str, type);
+}
+
+inline const Value& map_store_value(const Value& value, std::type_identity<Value>) { return value; }
+
+inline MapScalar map_store_value(const Value& value, std::type_identity<MapScalar>)
+{
+    MapScalar bits;
+    std::memcpy(&bits, &value.data.ival, sizeof(bits)); // bval and fval share these bytes
+    return bits;
+}
+
+inline Value map_load_value(const Value& value, TypeID) { return value; }
+
+inline Value map_load_value(MapScalar bits, TypeID type)
+{
+    Value result(type);
+    std::memcpy(&result.data.ival, &bits, sizeof(bits));
+    return result;
+}
+
+template <typename Table>
+using map_key_t = std::type_identity<typename Table::key_type>;
+
+template <typename Table>
+using map_value_t = std::type_identity<typename Table::mapped_type>;
+
+} // namespace detail
+
+// == MapInstance =============================================================
+
+/// Script map, storage is specialized per key type like ``TypedArray`` is per element type
+///
+/// Int and string keyed maps skip the per entry type dispatch of ``ValueHash``/``ValueEq``, and maps of
+/// int, float or bool values store them unboxed.  String keyed maps hash and compare keys by contents
+/// in the map's own table, a lookup is one probe and nothing outlives the map.  Keys and values of
+/// specialized storage must have exactly the map's key and value type, the type resolver already
+/// guarantees this for compiled scripts.
+struct MapInstance {
+    TypeID key_type;
+    TypeID value_type;
+    MapKeyKind key_kind = MapKeyKind::generic;
+    bool unboxed_values = false; ///< Values are stored as ``MapScalar``
+    bool key_is_heap = false;
+    bool value_is_heap = false;
+    uint32_t iteration_count = 0;
+    const Runtime* rt = nullptr;
+    MapTable data;
+
+    MapInstance(TypeID k, TypeID v, MapKeyKind kind, bool unboxed, const Runtime* runtime);
+    ~MapInstance() = default;
+
+    /// Determines if a key and value match the map's storage
+    bool accepts(const Value& key, const Value& value) const noexcept
+    {
+        return (key_kind == MapKeyKind::generic || key.type_id == key_type)
+            && (!unboxed_values || value.type_id == value_type);
+    }
+
+    bool find(const Value& key, Value& out) const
+    {
+        if (key_kind != MapKeyKind::generic && key.type_id != key_type) { return false; }
+        return std::visit([&](const auto& table) {
+            using Table = std::decay_t<decltype(table)>;
+            auto it = table.find(detail::map_find_key(rt, key, detail::map_key_t<Table>{}));
+            if (it == table.end()) { return false; }
+            out = detail::map_load_value(it->second, value_type);
+            return true;
+        },
+            data);
+    }
+
+    bool contains(const Value& key) const
+    {
+        if (key_kind != MapKeyKind::generic && key.type_id != key_type) { return false; }
+        return std::visit([&](const auto& table) {
+            using Table = std::decay_t<decltype(table)>;
+            return table.contains(detail::map_find_key(rt, key, detail::map_key_t<Table>{}));
+        },
+            data);
+    }
+
+    /// Inserts or assigns an entry, the key and value must be ``accepts``ed
+    /// @return true if the key was inserted, false if it was assigned
+    bool insert_or_assign(const Value& key, const Value& value)
+    {
+        return std::visit([&](auto& table) {
+            using Table = std::decay_t<decltype(table)>;
+            return table.insert_or_assign(detail::map_insert_key(rt, key, detail::map_key_t<Table>{}),
+                            detail::map_store_value(value, detail::map_value_t<Table>{}))
+                .second;
+        },
+            data);
+    }
+
+    bool erase(const Value& key)
+    {
+        if (key_kind != MapKeyKind::generic && key.type_id != key_type) { return false; }
+        return std::visit([&](auto& table) {
+            using Table = std::decay_t<decltype(table)>;
+            return table.erase(detail::map_find_key(rt, key, detail::map_key_t<Table>{})) > 0;
+        },
+            data);
+    }
+
+    size_t size() const noexcept
+    {
+        return std::visit([](const auto& table) { return table.size(); }, data);
+    }
+
+    void clear()
+    {
+        std::visit([](auto& table) { table.clear(); }, data);
+    }
+
+    /// Calls ``mark(HeapPtr)`` for every heap reference held by keys and values, ``prefetch(HeapPtr)`` is
+    /// called for the references of the next entry before the current one is marked
+    template <typename Mark, typename Prefetch>
+    void for_each_heap_ref(Mark&& mark, Prefetch&& prefetch) const
+    {
+        std::visit([&](const auto& table) {
+            using Table = std::decay_t<decltype(table)>;
+            using Key = typename Table::key_type;
+            using Mapped = typename Table::mapped_type;
+            auto refs = [this](const auto& entry, auto&& f) {
+                const auto& [key, value] = entry;
+                if constexpr (std::is_same_v<Key, StringMapKey>) {
+                    if (key.str.value != 0) { f(key.str); }
+                } else if constexpr (std::is_same_v<Key, Value>) {
+                    if (key_is_heap && key.storage == ValueStorage::heap) { f(key.data.hptr); }
+                }
+                if constexpr (std::is_same_v<Mapped, Value>) {
+                    if (value_is_heap && value.storage == ValueStorage::heap) { f(value.data.hptr); }
+                }
+            };
+
+            auto it = table.begin();
+            const auto end = table.end();
+            while (it != end) {
+                auto next = it;
+                ++next;
+                if (next != end) { refs(*next, prefetch); }
+                refs(*it, mark);
+                it = next;
+            }
+        },
+            data);
+    }
+};
+
+/// Iteration state of one ``MapTable`` alternative
+template <typename Table>
+struct MapCursor {
+    typename Table::const_iterator current;
+    typename Table::const_iterator end;
+};
+
+using MapCursors = std::variant<
+    MapCursor<GenericMapTable<Value>>, MapCursor<GenericMapTable<MapScalar>>,
+    MapCursor<IntMapTable<Value>>, MapCursor<IntMapTable<MapScalar>>,
+    MapCursor<StringMapTable<Value>>, MapCursor<StringMapTable<MapScalar>>>;
+
+struct MapIterator {
+    HeapPtr map_ptr;
+    TypeID key_type;
+    TypeID value_type;
+    MapCursors cursor;
+
+    explicit MapIterator(HeapPtr ptr, const MapInstance& map)
+        : map_ptr{ptr}
+        , key_type{map.key_type}
+        , value_type{map.value_type}
+        , cursor{std::visit([](const auto& table) -> MapCursors {
+            using Table = std::decay_t<decltype(table)>;
+            return MapCursor<Table>{table.begin(), table.end()};
+        },
+              map.data)}
+    {
+    }
+
+    /// Gets the next entry
+    /// @return false once every entry was visited
+    bool next(Value& key, Value& value)
+    {
+        return std::visit([&](auto& c) {
+            if (c.current == c.end) { return false; }
+            key = detail::map_load_key(*c.current, key_type);
+            value = detail::map_load_value(c.current->second, value_type);
+            ++c.current;
+            return true;
+        },
+            cursor);
+    }
+};
+
+} // namespace nw::smalls
@@ -0,0 +1,98 @@
+#include "ScriptFunction.hpp"
+
+#include "../log.hpp"
+#include "Bytecode.hpp"
+
+namespace nw::smalls {
+
+ResolvedScriptFunction::ResolvedScriptFunction(String module, String function, uint64_t gas_limit)
+    : module_{std::move(module)}
+    , function_{std::move(function)}
+    , gas_limit_{gas_limit}
+{
+}
+
+bool ResolvedScriptFunction::resolve(Runtime& rt)
+{
+    if (compiled_ && generation_ == rt.module_generation()) {
+        return true;
+    }
+
+    bytecode_ = nullptr;
+    compiled_ = nullptr;
+    generation_ = rt.module_generation();
+
+    auto* script = rt.get_module(module_);
+    if (!script) {
+        LOG_F(ERROR, "[smalls] {}.{}: module not found", module_, function_);
+        return false;
+    }
+    bytecode_ = rt.get_or_compile_module(script);
+    if (!bytecode_) {
+        LOG_F(ERROR, "[smalls] {}.{}: module failed to compile", module_, function_);
+        return false;
+    }
+    compiled_ = bytecode_->get_function(function_);
+    if (!compiled_) {
+        LOG_F(ERROR, "[smalls] {}.{}: function not found", module_, function_);
+        return false;
+    }
+    return true;
+}
+
+ExecutionResult ResolvedScriptFunction::call(Runtime& rt, std::span<const Value> args)
+{
+    if (!resolve(rt)) {
+        return ExecutionResult{
+            .value = Value{},
+            .failed = true,
+            .error_message = fmt::format("Failed to resolve script function '{}.{}'", module_, function_),
+            .stack_trace = {},
+            .error_module = {},
+            .error_location = {},
+            .error_snippet = {}};
+    }
+
+    auto result = rt.execute_compiled(bytecode_, compiled_, args, gas_limit_);
+    if (!result.ok()) {
+        LOG_F(WARNING, "[smalls] {}.{} failed: {}", module_, function_, result.error_message);
+    }
+    return result;
+}
+
+namespace detail {
+
+bool is_int_compatible_type(const Runtime& rt, TypeID type_id) noexcept
+{
+    while (type_id != rt.int_type()) {
+        const auto* type = rt.get_type(type_id);
+        if (!type) {
+            return false;
+        }
+
+        if (type->type_kind != TK_alias && type->type_kind != TK_newtype) {
+            return type->primitive_kind == PK_int;
+        }
+
+        if (type->type_params.empty()) {
+            return false;
+        }
+
+        const auto alias_target = type->type_params[0];
+        if (!alias_target.is<TypeID>()) {
+            return false;
+        }
+
+        type_id = alias_target.as<TypeID>();
+    }
+    return true;
+}
+
+void log_script_function_result_mismatch(const ResolvedScriptFunction& ref)
+{
+    LOG_F(WARNING, "[smalls] {}.{} returned a value of an unexpected type", ref.module(), ref.function());
+}
+
+} // namespace detail
+
+} // namespace nw::smalls
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "runtime.hpp"
+
+#include <array>
+#include <optional>
+#include <type_traits>
+
+namespace nw::smalls {
+
+/// Script function resolved once by module and name
+///
+/// The function's ``BytecodeModule`` and ``CompiledFunction`` are looked up on first use and again
+/// only when ``Runtime::module_generation`` changes, i.e. after module eviction or a runtime restart.
+/// See ``ScriptFunction`` for the typed form.
+struct ResolvedScriptFunction {
+    ResolvedScriptFunction() = default;
+    ResolvedScriptFunction(String module, String function, uint64_t gas_limit = Runtime::default_gas_limit);
+
+    /// Resolves the function if needed, false if its module or the function does not exist
+    bool resolve(Runtime& rt);
+
+    /// Calls the function with marshalled arguments, failures are logged
+    ExecutionResult call(Runtime& rt, std::span<const Value> args);
+
+    const String& module() const noexcept { return module_; }
+    const String& function() const noexcept { return function_; }
+
+private:
+    String module_;
+    String function_;
+    uint64_t gas_limit_ = Runtime::default_gas_limit;
+    uint64_t generation_ = 0;
+    BytecodeModule* bytecode_ = nullptr;
+    const CompiledFunction* compiled_ = nullptr;
+};
+
+namespace detail {
+
+/// Determines if a type is ``int`` or an alias or newtype of it
+bool is_int_compatible_type(const Runtime& rt, TypeID type_id) noexcept;
+
+/// Converts a script result to ``R``, ``std::nullopt`` if the value's type is not convertible
+template <typename R>
+std::optional<R> convert_result(Runtime& rt, const Value& value)
+{
+    if constexpr (std::is_same_v<R, Value>) {
+        return value;
+    } else if constexpr (std::is_same_v<R, bool>) {
+        if (value.type_id == rt.bool_type()) { return value.data.bval; }
+        if (is_int_compatible_type(rt, value.type_id)) { return value.data.ival != 0; }
+        return std::nullopt;
+    } else if constexpr (std::is_same_v<R, float>) {
+        if (value.type_id == rt.float_type()) { return value.data.fval; }
+        if (is_int_compatible_type(rt, value.type_id)) { return static_cast<float>(value.data.ival); }
+        return std::nullopt;
+    } else if constexpr (std::is_integral_v<R> || std::is_enum_v<R>) {
+        if (!is_int_compatible_type(rt, value.type_id)) { return std::nullopt; }
+        return static_cast<R>(value.data.ival);
+    } else if constexpr (std::is_same_v<R, ObjectHandle>) {
+        if (!rt.is_object_like_type(value.type_id)) { return std::nullopt; }
+        return value.data.oval;
+    } else {
+        return value_cast<R>(&rt, value);
+    }
+}
+
+} // namespace detail
+
+template <typename Signature>
+struct ScriptFunction;
+
+/// Typed handle to a script function
+///
+/// Arguments are converted with ``detail::make_value`` into an array on the stack and handed to the VM
+/// as is.  Calls return ``std::nullopt``, or false for ``void`` functions, if the function cannot be
+/// resolved, fails, or returns a value that does not convert to ``R``.
+///
+/// @code{.cpp}
+/// thread_local ScriptFunction<int32_t(ObjectHandle, int32_t)> cooldown{"nwn1.combat", "resolve_attack_cooldown_ticks"};
+/// auto ticks = cooldown(attacker->handle(), 60);
+/// @endcode
+template <typename R, typename... Args>
+struct ScriptFunction<R(Args...)> {
+    using result_type = std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+
+    ScriptFunction(String module, String function, uint64_t gas_limit = Runtime::default_gas_limit)
+        : resolved_{std::move(module), std::move(function), gas_limit}
+    {
+    }
+
+    /// Calls the function on the kernel runtime
+    result_type operator()(const Args&... args) { return call(nw::kernel::runtime(), args...); }
+
+    /// Calls the function
+    result_type call(Runtime& rt, const Args&... args)
+    {
+        const std::array<Value, sizeof...(Args)> values{detail::make_value(&rt, args)...};
+        auto result = resolved_.call(rt, values);
+        if constexpr (std::is_void_v<R>) {
+            return result.ok();
+        } else {
+            if (!result.ok()) { return std::nullopt; }
+            auto converted = detail::convert_result<R>(rt, result.value);
+            if (!converted) { log_mismatch(); }
+            return converted;
+        }
+    }
+
+    /// Resolves the function ahead of the first call
+    bool resolve(Runtime& rt) { return resolved_.resolve(rt); }
+
+    const ResolvedScriptFunction& resolved() const noexcept { return resolved_; }
+
+private:
+    ResolvedScriptFunction resolved_;
+
+    void log_mismatch() const;
+};
+
+namespace detail {
+void log_script_function_result_mismatch(const ResolvedScriptFunction& ref);
+} // namespace detail
+
+template <typename R, typename... Args>
+void ScriptFunction<R(Args...)>::log_mismatch() const
+{
+    detail::log_script_function_result_mismatch(resolved_);
+}
+
+} // namespace nw::smalls
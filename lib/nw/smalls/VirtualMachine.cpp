@@ -1,16 +1,19 @@
 #include "VirtualMachine.hpp"
 
 #include "BytecodeVerifier.hpp"
+#include "Map.hpp"
 #include "PropsetPool.hpp"
 
 #include "../kernel/Kernel.hpp"
 #include "../log.hpp"
 
 #include <absl/strings/str_cat.h>
+#include <algorithm>
 #include <cctype>
 #include <chrono>
 #include <cstring>
 #include <limits>
+#include <utility>
 
 namespace nw::smalls {
 
@@ -63,6 +66,47 @@ bool type_may_hold_heap_refs(Runtime* rt, TypeID type_id)
     return rt->type_table_.is_heap_type(type_id) || type->contains_heap_refs;
 }
 
+// Roots of a call stack, live on the VM or parked in a coroutine
+void enumerate_call_stack_roots(Vector<CallFrame>& frames, Value* registers, size_t register_count,
+    GCRootVisitor& visitor, Runtime* runtime)
+{
+    for (auto& frame : frames) {
+        frame.enumerate_stack_roots(visitor, runtime);
+
+        for (Upvalue* uv = frame.open_upvalues; uv; uv = uv->next) {
+            if (uv->heap_ptr.value != 0) {
+                visitor.visit_root(&uv->heap_ptr);
+            }
+            if (!uv->is_open() && uv->closed.storage == ValueStorage::heap && uv->closed.data.hptr.value != 0) {
+                visitor.visit_root(&uv->closed.data.hptr);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < register_count; ++i) {
+        Value& value = registers[i];
+        if (value.storage == ValueStorage::heap && value.data.hptr.value != 0) {
+            visitor.visit_root(&value.data.hptr);
+
+            const Type* type = runtime->get_type(value.type_id);
+            if (type && type->type_kind == TK_function) {
+                Closure* closure = runtime->get_closure(value.data.hptr);
+                if (closure) {
+                    for (Upvalue* uv : closure->upvalues) {
+                        if (!uv) { continue; }
+                        if (uv->heap_ptr.value != 0) {
+                            visitor.visit_root(&uv->heap_ptr);
+                        }
+                        if (!uv->is_open() && uv->closed.storage == ValueStorage::heap && uv->closed.data.hptr.value != 0) {
+                            visitor.visit_root(&uv->closed.data.hptr);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 } // namespace
 
 VirtualMachine::VirtualMachine()
@@ -84,6 +128,7 @@ void VirtualMachine::reset()
     gas_enabled_ = false;
     remaining_gas_ = 0;
     current_base_ = 0;
+    suspend_requested_ = false;
 }
 
 bool VirtualMachine::consume_gas(uint64_t amount)
@@ -98,6 +143,11 @@ bool VirtualMachine::consume_gas(uint64_t amount)
 
     if (remaining_gas_ < amount) {
         remaining_gas_ = 0;
+        if (coroutine_ && !frames_.empty()) {
+            // End of a time slice: park, the instruction asking for gas runs again on resume
+            park_coroutine(true);
+            return false;
+        }
         fail("Script exceeded execution limit");
         return false;
     }
@@ -138,41 +188,34 @@ void VirtualMachine::enumerate_roots(GCRootVisitor& visitor, Runtime* runtime)
         return;
     }
 
-    for (auto& frame : frames_) {
-        frame.enumerate_stack_roots(visitor, runtime);
+    enumerate_call_stack_roots(frames_, registers_.get(), stack_top_, visitor, runtime);
+}
 
-        for (Upvalue* uv = frame.open_upvalues; uv; uv = uv->next) {
-            if (uv->heap_ptr.value != 0) {
-                visitor.visit_root(&uv->heap_ptr);
-            }
-            if (!uv->is_open() && uv->closed.storage == ValueStorage::heap && uv->closed.data.hptr.value != 0) {
-                visitor.visit_root(&uv->closed.data.hptr);
-            }
+Coroutine::~Coroutine()
+{
+    close_upvalues();
+}
+
+void Coroutine::close_upvalues()
+{
+    for (auto& frame : frames) {
+        for (Upvalue* uv = frame.open_upvalues; uv;) {
+            Upvalue* next = uv->next;
+            uv->closed = *uv->location;
+            uv->location = &uv->closed;
+            uv = next;
         }
+        frame.open_upvalues = nullptr;
     }
+}
 
-    for (size_t i = 0; i < stack_top_; ++i) {
-        Value& value = registers_[i];
-        if (value.storage == ValueStorage::heap && value.data.hptr.value != 0) {
-            visitor.visit_root(&value.data.hptr);
-
-            const Type* type = runtime->get_type(value.type_id);
-            if (type && type->type_kind == TK_function) {
-                Closure* closure = runtime->get_closure(value.data.hptr);
-                if (closure) {
-                    for (Upvalue* uv : closure->upvalues) {
-                        if (!uv) { continue; }
-                        if (uv->heap_ptr.value != 0) {
-                            visitor.visit_root(&uv->heap_ptr);
-                        }
-                        if (!uv->is_open() && uv->closed.storage == ValueStorage::heap && uv->closed.data.hptr.value != 0) {
-                            visitor.visit_root(&uv->closed.data.hptr);
-                        }
-                    }
-                }
-            }
-        }
+void Coroutine::enumerate_roots(GCRootVisitor& visitor, Runtime* runtime)
+{
+    if (!runtime) {
+        return;
     }
+
+    enumerate_call_stack_roots(frames, registers.data(), registers.size(), visitor, runtime);
 }
 
 uint8_t* VirtualMachine::current_frame_stack_data()
@@ -455,6 +498,7 @@ void VirtualMachine::call_native_wrapper(const NativeFunctionWrapper& wrapper, R
     if (profile) {
         rt.record_vm_native_call(func_name, profile_timing ? (vm_profile_now_ns() - t0) : 0);
     }
+    if (ABSL_PREDICT_FALSE(suspend_requested_)) { park_coroutine(false); }
 }
 
 void VirtualMachine::call_native_pointer(NativeFunctionPointer fn, Runtime& rt,
@@ -473,6 +517,7 @@ void VirtualMachine::call_native_pointer(NativeFunctionPointer fn, Runtime& rt,
     if (profile) {
         rt.record_vm_native_call(func_name, profile_timing ? (vm_profile_now_ns() - t0) : 0);
     }
+    if (ABSL_PREDICT_FALSE(suspend_requested_)) { park_coroutine(false); }
 }
 
 void VirtualMachine::setup_script_call(uint8_t dest_reg, uint8_t argc,
@@ -512,7 +557,7 @@ void VirtualMachine::setup_script_call(uint8_t dest_reg, uint8_t argc,
     }
 
     push_frame(target_module, callee, dest_reg, closure);
-    if (failed_) { return; }
+    if (failed_ || suspended_) { return; }
 
     copy_args_to_callee(caller_base, dest_reg, argc, caller_frame_index, opcode_name);
 }
@@ -694,7 +739,7 @@ Value VirtualMachine::execute(BytecodeModule* module, StringView function_name,
     return execute(module, func, args, gas_limit);
 }
 
-Value VirtualMachine::execute(BytecodeModule* module, const CompiledFunction* func, const Vector<Value>& args,
+Value VirtualMachine::execute(BytecodeModule* module, const CompiledFunction* func, std::span<const Value> args,
     uint64_t gas_limit)
 {
     // Track entry frame depth for reentrant execution
@@ -710,25 +755,7 @@ Value VirtualMachine::execute(BytecodeModule* module, const CompiledFunction* fu
         saved_reg0_valid = true;
     }
 
-    if (!module->external_refs_resolved) {
-        if (!const_cast<BytecodeModule*>(module)->resolve_external_refs(&nw::kernel::runtime())) {
-            fail("Failed to resolve external references");
-            return {};
-        }
-    }
-
-    if (!const_cast<BytecodeModule*>(module)->verification_attempted) {
-        String verify_error;
-        const bool verified = verify_bytecode_module(module, rt_, &verify_error);
-        auto* mutable_module = const_cast<BytecodeModule*>(module);
-        mutable_module->verification_attempted = true;
-        mutable_module->verification_passed = verified;
-        mutable_module->verification_error = std::move(verify_error);
-    }
-    if (!module->verification_passed) {
-        fail(module->verification_error);
-        return {};
-    }
+    if (!prepare_module(module)) { return {}; }
 
     if (args.size() != func->param_count) {
         fail(fmt::format("Argument count mismatch: expected {}, got {}",
@@ -736,14 +763,20 @@ Value VirtualMachine::execute(BytecodeModule* module, const CompiledFunction* fu
         return {};
     }
 
+    // A coroutine can't park from inside a nested execution, its frames would be split around the native
+    Coroutine* coroutine = std::exchange(coroutine_, nullptr);
     push_frame(module, func, 0, nullptr);
-    if (failed_) { return {}; }
+    if (failed_) {
+        coroutine_ = coroutine;
+        return {};
+    }
 
     for (size_t i = 0; i < args.size(); ++i) {
         reg(static_cast<uint8_t>(i)) = args[i];
     }
 
     bool success = step_limit_enabled_ ? run_limited(module, entry_depth) : run(module, entry_depth);
+    coroutine_ = coroutine;
 
     if (success) {
         // For reentrant calls, the return value was written to register 0 of the entry frame
@@ -803,14 +836,19 @@ Value VirtualMachine::execute_closure(Closure* closure, const Vector<Value>& arg
         return {};
     }
 
+    Coroutine* coroutine = std::exchange(coroutine_, nullptr);
     push_frame(module, func, 0, closure);
-    if (failed_) return {};
+    if (failed_) {
+        coroutine_ = coroutine;
+        return {};
+    }
 
     for (size_t i = 0; i < args.size(); ++i) {
         reg(static_cast<uint8_t>(i)) = args[i];
     }
 
     bool success = step_limit_enabled_ ? run_limited(module, entry_depth) : run(module, entry_depth);
+    coroutine_ = coroutine;
 
     if (success) {
         if (entry_depth > 0 && !frames_.empty()) {
@@ -847,6 +885,159 @@ void VirtualMachine::execute_module_init(BytecodeModule* module, uint64_t gas_li
     }
 }
 
+bool VirtualMachine::prepare_module(BytecodeModule* module)
+{
+    if (!module->external_refs_resolved) {
+        if (!module->resolve_external_refs(&nw::kernel::runtime())) {
+            fail("Failed to resolve external references");
+            return false;
+        }
+    }
+
+    if (!module->verification_attempted) {
+        String verify_error;
+        const bool verified = verify_bytecode_module(module, rt_, &verify_error);
+        module->verification_attempted = true;
+        module->verification_passed = verified;
+        module->verification_error = std::move(verify_error);
+    }
+    if (!module->verification_passed) {
+        fail(module->verification_error);
+        return false;
+    }
+    return true;
+}
+
+CoroutineStatus VirtualMachine::start_coroutine(Coroutine& co, BytecodeModule* module, const CompiledFunction* func,
+    std::span<const Value> args, uint64_t slice_gas)
+{
+    assert(idle());
+    reset();
+
+    if (!module || !func) {
+        fail("start_coroutine: invalid function");
+        return CoroutineStatus::failed;
+    }
+    if (!prepare_module(module)) { return CoroutineStatus::failed; }
+
+    if (args.size() != func->param_count) {
+        fail(fmt::format("Argument count mismatch: expected {}, got {}",
+            func->param_count, args.size()));
+        return CoroutineStatus::failed;
+    }
+
+    init_gas(slice_gas);
+    push_frame(module, func, 0, nullptr);
+    if (failed_) { return CoroutineStatus::failed; }
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        reg(static_cast<uint8_t>(i)) = args[i];
+    }
+
+    return run_coroutine(co);
+}
+
+CoroutineStatus VirtualMachine::resume_coroutine(Coroutine& co, uint64_t slice_gas)
+{
+    assert(idle());
+    reset();
+
+    if (!co.parked()) {
+        fail("resume_coroutine: coroutine is not parked");
+        return CoroutineStatus::failed;
+    }
+
+    init_gas(slice_gas);
+
+    // Parked frames are based at register 0 and came from a VM with the same register file size
+    Value* base = registers_.get();
+    std::copy(co.registers.begin(), co.registers.end(), base);
+    stack_top_ = co.registers.size();
+    for (auto& parked : co.frames) {
+        for (Upvalue* uv = parked.open_upvalues; uv; uv = uv->next) {
+            uv->location = base + (uv->location - co.registers.data());
+        }
+        frames_.push_back(std::move(parked));
+    }
+    co.frames.clear();
+    co.registers.clear();
+
+    frame_ptr_ = &frames_.back();
+    current_base_ = frame_ptr_->base_register;
+    ip_ = frame_ptr_->function->instructions.data() + frame_ptr_->pc;
+    ip_end_ = frame_ptr_->function->instructions.data() + frame_ptr_->function->instructions.size();
+
+    return run_coroutine(co);
+}
+
+bool VirtualMachine::suspend_coroutine(uint64_t sleep_ticks)
+{
+    if (!coroutine_ || failed_) { return false; }
+
+    coroutine_->sleep_ticks = sleep_ticks;
+    suspend_requested_ = true;
+    return true;
+}
+
+CoroutineStatus VirtualMachine::run_coroutine(Coroutine& co)
+{
+    co.sleep_ticks = 0;
+    co.preempted = false;
+    coroutine_ = &co;
+    suspended_ = false;
+
+    BytecodeModule* module = frames_.front().module;
+    bool success = step_limit_enabled_ ? run_limited(module, 0) : run(module, 0);
+    coroutine_ = nullptr;
+
+    if (!success) { return CoroutineStatus::failed; }
+    if (suspended_) {
+        suspended_ = false;
+        return CoroutineStatus::parked;
+    }
+    co.result = last_result_;
+    return CoroutineStatus::finished;
+}
+
+void VirtualMachine::park_coroutine(bool rewind)
+{
+    suspend_requested_ = false;
+    if (failed_ || !coroutine_ || frames_.empty()) { return; }
+
+    // Threaded dispatch keeps ip_ current, the switch loop advances frame.pc instead
+#if defined(__GNUC__) || defined(__clang__)
+    if (rewind) { --ip_; }
+    sync_pc_for_debug();
+#else
+    if (rewind) { --frames_.back().pc; }
+#endif
+
+    // The coroutine owns every frame: it started on an idle VM and nested executions never park
+    Coroutine& co = *coroutine_;
+    Value* base = registers_.get();
+    co.registers.assign(base, base + stack_top_);
+    co.frames.clear();
+    co.frames.reserve(frames_.size());
+    for (auto& live : frames_) {
+        for (Upvalue* uv = live.open_upvalues; uv; uv = uv->next) {
+            uv->location = co.registers.data() + (uv->location - base);
+        }
+        co.frames.push_back(std::move(live));
+    }
+    if (rewind) {
+        co.sleep_ticks = 0;
+        co.preempted = true;
+    }
+
+    frames_.clear();
+    stack_top_ = 0;
+    current_base_ = 0;
+    frame_ptr_ = nullptr;
+    ip_ = nullptr;
+    ip_end_ = nullptr;
+    suspended_ = true;
+}
+
 template <bool StepLimited>
 bool VirtualMachine::run_impl(BytecodeModule* /*module*/, size_t entry_depth)
 {
@@ -1612,14 +1803,18 @@ lbl_MAPGET: {
     uint8_t key_reg = c;
 
     Value map_val = reg(map_reg);
-    Value key_val = reg(key_reg);
+    if (map_val.data.hptr.value == 0) {
+        fail("Map access on null map");
+        DISPATCH();
+    }
 
+    // Typed registers guarantee a map, so go straight to its storage
+    const auto* map = static_cast<const MapInstance*>(rt_->heap_.get_ptr(map_val.data.hptr));
     Value result;
-    if (rt_->map_get(map_val.data.hptr, key_val, result)) {
-        reg(dest_reg) = result;
-    } else {
-        reg(dest_reg) = Value{};
+    if (!map->find(reg(key_reg), result)) {
+        result = Value{};
     }
+    reg(dest_reg) = result;
     DISPATCH();
 }
 
@@ -1629,10 +1824,25 @@ lbl_MAPSET: {
     uint8_t val_reg = c;
 
     Value map_val = reg(map_reg);
-    Value key_val = reg(key_reg);
-    Value val = reg(val_reg);
+    if (map_val.data.hptr.value == 0) {
+        fail("Map access on null map");
+        DISPATCH();
+    }
 
-    (void)rt_->map_set(map_val.data.hptr, key_val, val);
+    auto* map = static_cast<MapInstance*>(rt_->heap_.get_ptr(map_val.data.hptr));
+    if (map->iteration_count != 0) {
+        fail("Cannot modify map while iterating");
+        DISPATCH();
+    }
+    const Value& key = reg(key_reg);
+    const Value& value = reg(val_reg);
+    if (!map->accepts(key, value)) {
+        fail(fmt::format("Map entry of type ({}, {}) does not match map[{}, {}]",
+            rt_->type_name(key.type_id), rt_->type_name(value.type_id),
+            rt_->type_name(map->key_type), rt_->type_name(map->value_type)));
+        DISPATCH();
+    }
+    rt_->map_set(map_val.data.hptr, *map, key, value);
     DISPATCH();
 }
 
@@ -2913,14 +3123,17 @@ vm_exit:
             uint8_t key_reg = c;
 
             Value map_val = reg(map_reg);
-            Value key_val = reg(key_reg);
+            if (map_val.data.hptr.value == 0) {
+                fail("Map access on null map");
+                break;
+            }
 
+            const auto* map = static_cast<const MapInstance*>(rt_->heap_.get_ptr(map_val.data.hptr));
             Value result;
-            if (rt_->map_get(map_val.data.hptr, key_val, result)) {
-                reg(dest_reg) = result;
-            } else {
-                reg(dest_reg) = Value{};
+            if (!map->find(reg(key_reg), result)) {
+                result = Value{};
             }
+            reg(dest_reg) = result;
             break;
         }
 
@@ -2930,10 +3143,25 @@ vm_exit:
             uint8_t val_reg = c;
 
             Value map_val = reg(map_reg);
-            Value key_val = reg(key_reg);
-            Value val = reg(val_reg);
+            if (map_val.data.hptr.value == 0) {
+                fail("Map access on null map");
+                break;
+            }
 
-            (void)rt_->map_set(map_val.data.hptr, key_val, val);
+            auto* map = static_cast<MapInstance*>(rt_->heap_.get_ptr(map_val.data.hptr));
+            if (map->iteration_count != 0) {
+                fail("Cannot modify map while iterating");
+                break;
+            }
+            const Value& key = reg(key_reg);
+            const Value& value = reg(val_reg);
+            if (!map->accepts(key, value)) {
+                fail(fmt::format("Map entry of type ({}, {}) does not match map[{}, {}]",
+                    rt_->type_name(key.type_id), rt_->type_name(value.type_id),
+                    rt_->type_name(map->key_type), rt_->type_name(map->value_type)));
+                break;
+            }
+            rt_->map_set(map_val.data.hptr, *map, key, value);
             break;
         }
 
@@ -4082,6 +4310,34 @@ void VirtualMachine::op_test_and_skip(Opcode op, uint8_t a, uint8_t b)
         return;
     }
 
+    // Fast path: bool cmp bool
+    if (lv.type_id == rt_->bool_type() && rv.type_id == rt_->bool_type()) {
+        switch (op) {
+        case Opcode::ISEQ:
+            skip = lv.data.bval == rv.data.bval;
+            break;
+        case Opcode::ISNE:
+            skip = lv.data.bval != rv.data.bval;
+            break;
+        case Opcode::ISLT:
+            skip = lv.data.bval < rv.data.bval;
+            break;
+        case Opcode::ISLE:
+            skip = lv.data.bval <= rv.data.bval;
+            break;
+        case Opcode::ISGT:
+            skip = lv.data.bval > rv.data.bval;
+            break;
+        case Opcode::ISGE:
+            skip = lv.data.bval >= rv.data.bval;
+            break;
+        default:
+            break;
+        }
+        if (skip) { skip_next_instruction(); }
+        return;
+    }
+
     // Fast path: string cmp string
     if (lv.type_id == rt_->string_type() && rv.type_id == rt_->string_type()) {
         StringView ls = (lv.data.hptr.value != 0) ? rt_->get_string_view(lv.data.hptr) : StringView{};
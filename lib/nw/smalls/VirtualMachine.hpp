@@ -6,6 +6,7 @@
 
 #include <cassert>
 #include <memory>
+#include <span>
 
 namespace nw::smalls {
 
@@ -56,6 +57,38 @@ struct CallFrame {
     friend struct GarbageCollector; // Allow GC to access private members for optimized root scanning
 };
 
+/// Outcome of running a coroutine until it stops
+enum struct CoroutineStatus : uint8_t {
+    finished, ///< Returned, ``Coroutine::result`` holds its value
+    parked,   ///< Suspended by a native or by the end of its time slice
+    failed,   ///< Aborted, the VM holds the error until it is reset
+};
+
+/// Call frames and registers of a suspended script
+///
+/// Frames keep their base registers, relative to ``registers[0]``, and their open upvalues point into
+/// ``registers``, so closures see the parked values while other scripts run on the VM.
+struct Coroutine {
+    Coroutine() = default;
+    Coroutine(const Coroutine&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+    ~Coroutine();
+
+    Vector<CallFrame> frames; // Bottom first
+    Vector<Value> registers;
+    uint64_t sleep_ticks = 0; // Ticks requested by the suspending native, 0 for the next tick
+    bool preempted = false;   // Parked by the end of its time slice rather than by the script
+    Value result;
+
+    bool parked() const noexcept { return !frames.empty(); }
+
+    /// Closes open upvalues, so closures outlive a coroutine that is never resumed
+    void close_upvalues();
+
+    /// Enumerate parked roots for GC
+    void enumerate_roots(GCRootVisitor& visitor, Runtime* runtime);
+};
+
 /// Register-based virtual machine for Smalls bytecode
 struct VirtualMachine {
     VirtualMachine();
@@ -75,7 +108,7 @@ struct VirtualMachine {
     /// @param args Arguments to pass to the function
     /// @return Result value, or Value with invalid_type_id on error
     /// @param gas_limit Gas budget for this execution (0 means unlimited). Only applied for top-level entry.
-    Value execute(BytecodeModule* module, const CompiledFunction* function, const Vector<Value>& args,
+    Value execute(BytecodeModule* module, const CompiledFunction* function, std::span<const Value> args,
         uint64_t gas_limit = 0);
 
     /// Executes a closure directly
@@ -126,6 +159,27 @@ struct VirtualMachine {
     /// Get current frame's stack data (for value-type access)
     uint8_t* current_frame_stack_data();
 
+    /// Starts a function as a coroutine and runs it until it returns, fails or parks
+    /// @param slice_gas Gas budget for this run (0 means unlimited), running out parks the coroutine
+    /// instead of failing it and the instruction that ran out is retried on resume.
+    /// @pre The VM is idle, the coroutine owns the whole call stack until it stops
+    CoroutineStatus start_coroutine(Coroutine& co, BytecodeModule* module, const CompiledFunction* function,
+        std::span<const Value> args, uint64_t slice_gas = 0);
+
+    /// Resumes a parked coroutine where it stopped
+    /// @pre The VM is idle
+    CoroutineStatus resume_coroutine(Coroutine& co, uint64_t slice_gas = 0);
+
+    /// Parks the running coroutine once the current native call returns
+    /// @return false if no coroutine is running, or the native was reached through a nested execution
+    bool suspend_coroutine(uint64_t sleep_ticks);
+
+    /// Determines if nothing is executing
+    bool idle() const noexcept { return frames_.empty(); }
+
+    /// Gas left of the current budget
+    uint64_t remaining_gas() const noexcept { return remaining_gas_; }
+
     /// Runs a module's __init function with an isolated gas budget.
     /// If the VM is already executing (reentrant call), the current gas state is saved and
     /// restored afterward so module initialization never drains the parent's budget.
@@ -149,6 +203,11 @@ private:
     bool gas_enabled_ = false;
     uint64_t remaining_gas_ = 0;
 
+    // Coroutine being run, null while none is or while a native reenters the VM
+    Coroutine* coroutine_ = nullptr;
+    bool suspend_requested_ = false; // Honored once the requesting native returns
+    bool suspended_ = false;         // The running coroutine parked
+
     // Cached base register offset of the current frame.
     // Updated by push_frame() and pop_frame() so reg() never touches frames_.
     uint32_t current_base_ = 0;
@@ -175,6 +234,10 @@ private:
 
     bool consume_gas(uint64_t amount = 1);
     void init_gas(uint64_t gas_limit);
+    bool prepare_module(BytecodeModule* module);
+
+    CoroutineStatus run_coroutine(Coroutine& co);
+    void park_coroutine(bool rewind);
 
     void store_native_result(Value result, uint8_t dest_reg, StringView func_name, TypeID return_type);
     void push_frame(BytecodeModule* module, const CompiledFunction* func, uint32_t ret_reg, Closure* closure);
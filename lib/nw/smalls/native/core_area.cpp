@@ -1,9 +1,47 @@
 #include "../stdlib.hpp"
 
+#include "../../objects/Area.hpp"
+#include "../../objects/AreaSpatialIndex.hpp"
+#include "../../objects/ObjectComponentSystem.hpp"
 #include "../../objects/ObjectManager.hpp"
+#include "../Array.hpp"
 
 namespace nw::smalls {
 
+namespace {
+
+const nw::AreaSpatialIndex* spatial_index(nw::ObjectHandle area)
+{
+    if (area.type != nw::ObjectType::area) { return nullptr; }
+    return nw::kernel::objects().components().area_spatial_index(area.id);
+}
+
+// Scripts pass -1 for any type or any faction, which is all bits set either way.
+nw::SpatialFilter make_filter(int32_t types, int32_t faction)
+{
+    nw::SpatialFilter result;
+    result.types = static_cast<uint32_t>(types);
+    result.faction = static_cast<uint32_t>(faction);
+    return result;
+}
+
+Value make_object_array(Runtime& rt, const Vector<nw::ObjectHandle>& objects)
+{
+    const HeapPtr array_ptr = rt.create_array_typed(rt.object_type(), objects.size());
+    auto* array = rt.get_array_typed(array_ptr);
+    if (!array) {
+        return {};
+    }
+
+    for (nw::ObjectHandle obj : objects) {
+        array->append_value(detail::make_value(&rt, obj), rt);
+    }
+
+    return Value::make_heap(array_ptr, rt.heap_.get_header(array_ptr)->type_id);
+}
+
+} // namespace
+
 void register_core_area(Runtime& rt)
 {
     if (rt.get_native_module("core.area")) { return; }
@@ -21,6 +59,32 @@ void register_core_area(Runtime& rt)
             auto* base = nw::kernel::objects().get_object_base(obj);
             auto* area = base ? base->as_area() : nullptr;
             return area ? static_cast<int32_t>(area->tiles.size()) : 0; })
+        .function("get_objects_in_radius", +[](nw::ObjectHandle area, glm::vec3 center, float radius, int32_t types, int32_t faction) -> Value {
+            Vector<nw::ObjectHandle> result;
+            if (const auto* index = spatial_index(area)) {
+                index->query_radius(center, radius, make_filter(types, faction), result);
+            }
+            return make_object_array(nw::kernel::runtime(), result); })
+        .function("get_objects_in_box", +[](nw::ObjectHandle area, glm::vec3 min, glm::vec3 max, int32_t types, int32_t faction) -> Value {
+            Vector<nw::ObjectHandle> result;
+            if (const auto* index = spatial_index(area)) {
+                index->query_box(min, max, make_filter(types, faction), result);
+            }
+            return make_object_array(nw::kernel::runtime(), result); })
+        .function("get_objects_in_cone", +[](nw::ObjectHandle area, glm::vec3 apex, glm::vec3 direction, float half_angle, float range, int32_t types, int32_t faction) -> Value {
+            Vector<nw::ObjectHandle> result;
+            if (const auto* index = spatial_index(area)) {
+                index->query_cone(apex, direction, half_angle, range, make_filter(types, faction), result);
+            }
+            return make_object_array(nw::kernel::runtime(), result); })
+        .function("get_nearest_objects", +[](nw::ObjectHandle area, glm::vec3 center, int32_t count, int32_t types, int32_t faction) -> Value {
+            Vector<nw::ObjectHandle> result;
+            if (const auto* index = spatial_index(area); index && count > 0) {
+                index->query_nearest(center, static_cast<size_t>(count), make_filter(types, faction), result);
+            }
+            return make_object_array(nw::kernel::runtime(), result); })
+        .function("set_spatial_faction", +[](nw::ObjectHandle obj, int32_t faction) -> bool {
+            return nw::kernel::objects().components().set_faction(obj, static_cast<uint32_t>(faction)); })
         .finalize();
 }
 
@@ -4,6 +4,7 @@
 #include "../../objects/Creature.hpp"
 #include "../../objects/ObjectManager.hpp"
 #include "../../profiles/nwn1/constants.hpp"
+#include "../../rules/combat_scheduler.hpp"
 
 #include <algorithm>
 
@@ -368,6 +369,7 @@ void register_core_combat(Runtime& rt)
         .function("roll_dice", +[](int32_t dice, int32_t sides, int32_t bonus, int32_t multiplier) -> int32_t { return roll_dice_amount(dice, sides, bonus, multiplier); })
         .function("creature_effect_version", +[](nw::ObjectHandle obj) -> int32_t { return creature_effect_version(obj); })
         .function("creature_equip_version", +[](nw::ObjectHandle obj) -> int32_t { return creature_equip_version(obj); })
+        .function("target_is_dead", +[](nw::ObjectHandle obj) -> bool { return nw::combat::target_is_dead(nw::kernel::objects().get_object_base(obj)); })
         .finalize();
 }
 
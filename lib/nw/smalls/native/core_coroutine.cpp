@@ -0,0 +1,39 @@
+#include "../stdlib.hpp"
+
+namespace nw::smalls {
+
+namespace {
+
+void coroutine_yield()
+{
+    auto& rt = nw::kernel::runtime();
+    if (!rt.suspend_coroutine(0)) {
+        rt.fail("yield: not called from a coroutine");
+    }
+}
+
+void coroutine_sleep(int32_t ticks)
+{
+    auto& rt = nw::kernel::runtime();
+    if (ticks < 0) {
+        rt.fail("sleep: ticks must not be negative");
+    } else if (!rt.suspend_coroutine(static_cast<uint64_t>(ticks))) {
+        rt.fail("sleep: not called from a coroutine");
+    }
+}
+
+} // namespace
+
+void register_core_coroutine(Runtime& rt)
+{
+    if (rt.get_native_module("core.coroutine")) {
+        return;
+    }
+
+    rt.module("core.coroutine")
+        .function("yield", &coroutine_yield)
+        .function("sleep", &coroutine_sleep)
+        .finalize();
+}
+
+} // namespace nw::smalls
@@ -1,10 +1,12 @@
 #include "../stdlib.hpp"
 
+#include "../../kernel/FactionSystem.hpp"
 #include "../../kernel/Kernel.hpp"
 #include "../../kernel/Strings.hpp"
 #include "../../objects/ObjectBase.hpp"
 #include "../../objects/ObjectManager.hpp"
 #include "../../rules/effects.hpp"
+#include "../Array.hpp"
 
 namespace nw::smalls {
 
@@ -38,6 +40,31 @@ ScriptString get_comment(nw::ObjectHandle obj)
     return ScriptString{rt.alloc_string(base ? nw::StringView{base->comment} : nw::StringView{})};
 }
 
+Value classify_hostility(nw::ObjectHandle observer, IArray* targets)
+{
+    auto& rt = nw::kernel::runtime();
+    if (!targets) { return {}; }
+
+    Vector<nw::ObjectHandle> handles;
+    handles.reserve(targets->size());
+    for (size_t i = 0; i < targets->size(); ++i) {
+        Value element;
+        if (!targets->get_value(i, element, rt) || !rt.is_object_like_type(element.type_id)) {
+            return {};
+        }
+        handles.push_back(element.data.oval);
+    }
+
+    const auto mask = nw::kernel::factions().classify_hostility(observer, handles);
+    const HeapPtr array_ptr = rt.create_array_typed(rt.bool_type(), handles.size());
+    auto* array = rt.get_array_typed(array_ptr);
+    if (!array) { return {}; }
+    for (size_t i = 0; i < mask.size; ++i) {
+        array->append_value(Value::make_bool(mask.test(i)), rt);
+    }
+    return Value::make_heap(array_ptr, rt.heap_.get_header(array_ptr)->type_id);
+}
+
 } // namespace
 
 void register_core_object(Runtime& rt)
@@ -113,6 +140,15 @@ void register_core_object(Runtime& rt)
             auto* row = nw::kernel::objects().components().get_or_create_spatial(obj);
             return row ? row->angular_velocity : glm::vec3{0.0f}; })
         .function("set_angular_velocity", +[](nw::ObjectHandle obj, glm::vec3 velocity) -> bool { return nw::kernel::objects().components().set_angular_velocity(obj, velocity); })
+        .function("get_reputation", +[](nw::ObjectHandle observer, nw::ObjectHandle target) -> int32_t {
+            return nw::kernel::factions().reputation(observer, target); })
+        .function("adjust_reputation", +[](nw::ObjectHandle observer, nw::ObjectHandle target, int32_t amount) {
+            nw::kernel::factions().adjust_personal_reputation(observer, target, amount); })
+        .function("set_temporary_reputation", +[](nw::ObjectHandle observer, nw::ObjectHandle target, int32_t amount, int32_t ticks) {
+            nw::kernel::factions().set_temporary_reputation(observer, target, amount, static_cast<uint64_t>(std::max(ticks, 0))); })
+        .function("clear_personal_reputation", +[](nw::ObjectHandle observer, nw::ObjectHandle target) {
+            nw::kernel::factions().clear_personal_reputation(observer, target); })
+        .function("classify_hostility", &classify_hostility)
         .finalize();
 }
 
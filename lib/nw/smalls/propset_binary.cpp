@@ -0,0 +1,375 @@
+#include "propset_binary.hpp"
+
+#include "Array.hpp"
+#include "runtime.hpp"
+
+#include "../kernel/Strings.hpp"
+#include "../resources/assets.hpp"
+#include "../util/HandlePool.hpp"
+
+#include "xxhash/xxh3.h"
+
+
+namespace nw::smalls {
+
+namespace {
+
+const Type* storage_type(Runtime* rt, TypeID type_id)
+{
+    const Type* type = rt->get_type(type_id);
+    while (type
+        && (type->type_kind == TK_newtype || type->type_kind == TK_alias)
+        && type->type_params[0].is<TypeID>()) {
+        type_id = type->type_params[0].as<TypeID>();
+        type = rt->get_type(type_id);
+    }
+    return type;
+}
+
+bool is_resref_type(Runtime* rt, TypeID type_id)
+{
+    return type_id == rt->type_id("core.types.ResRef", false);
+}
+
+bool is_text_ref_type(Runtime* rt, TypeID type_id)
+{
+    return type_id == rt->type_id("core.types.TextRef", false);
+}
+
+const Type* fixed_array_type(Runtime* rt, TypeID type_id)
+{
+    const Type* type = storage_type(rt, type_id);
+    if (!type || type->type_kind != TK_fixed_array
+        || !type->type_params[0].is<TypeID>()
+        || !type->type_params[1].is<int32_t>()) {
+        return nullptr;
+    }
+    return type;
+}
+
+struct Writer {
+    Runtime* rt;
+    BinaryWriter& out;
+
+    void value(const Value& value, TypeID declared_type);
+    void array(const IArray* arr);
+    void fields(const Value& ref, const StructDef* def);
+};
+
+struct Reader {
+    Runtime* rt;
+    BinaryReader& in;
+
+    bool value(TypeID declared_type, Value& out);
+    bool array_elements(IArray* arr, uint32_t n);
+    bool fields(const Value& ref, const StructDef* def);
+    bool new_struct(TypeID type_id, const Type* type, Value& out);
+};
+
+// == Writer ==================================================================
+
+void Writer::value(const Value& value, TypeID declared_type)
+{
+    const Type* type = storage_type(rt, declared_type);
+    if (!type) { return; }
+
+    if (type->type_kind == TK_primitive) {
+        switch (type->primitive_kind) {
+        default:
+            return;
+        case PK_int:
+            out.pod(value.data.ival);
+            return;
+        case PK_float:
+            out.pod(value.data.fval);
+            return;
+        case PK_bool:
+            out.pod(static_cast<uint8_t>(value.data.bval));
+            return;
+        case PK_string:
+            out.str(ScriptString{value.data.hptr}.view(*rt));
+            return;
+        }
+    }
+
+    if (rt->is_native_value_type(declared_type)) {
+        if (is_resref_type(rt, declared_type)) {
+            auto* ptr = static_cast<nw::Resref*>(rt->get_value_data_ptr(value));
+            out.str(ptr ? ptr->view() : StringView{});
+        } else if (is_text_ref_type(rt, declared_type)) {
+            auto* ptr = static_cast<nw::TextRef*>(rt->get_value_data_ptr(value));
+            auto loc = ptr ? nw::kernel::strings().to_locstring(*ptr) : nw::LocString{};
+            out.pod(loc.strref());
+            out.pod(static_cast<uint32_t>(loc.size()));
+            for (const auto& [lang, string] : loc) {
+                out.pod(lang);
+                out.str(string);
+            }
+        }
+        return;
+    }
+
+    if (rt->is_object_like_type(declared_type)) {
+        out.pod(value.data.oval.to_ull());
+        return;
+    }
+
+    if (type->type_kind == TK_array) {
+        if (value.storage != ValueStorage::heap || value.data.hptr.value == 0) {
+            out.pod(uint32_t(0));
+            return;
+        }
+        array(rt->get_array_typed(value.data.hptr));
+        return;
+    }
+
+    if (type->type_kind == TK_struct) {
+        fields(value, rt->get_struct_def(declared_type));
+    }
+}
+
+void Writer::array(const IArray* arr)
+{
+    if (!arr) {
+        out.pod(uint32_t(0));
+        return;
+    }
+
+    // The count is patched once elements that cannot be read are skipped
+    const size_t count_pos = out.reserve<uint32_t>();
+    uint32_t count = 0;
+    const TypeID element_type = arr->element_type();
+    for (size_t i = 0; i < arr->size(); ++i) {
+        Value element;
+        if (!arr->get_value(i, element, *rt)) { continue; }
+        value(element, element_type);
+        ++count;
+    }
+    out.patch(count_pos, count);
+}
+
+void Writer::fields(const Value& ref, const StructDef* def)
+{
+    if (!def) { return; }
+
+    for (uint32_t i = 0; i < def->field_count; ++i) {
+        const FieldDef& fd = def->fields[i];
+        if (fd.is_unmanaged_array) {
+            Value arr_val = rt->read_value_field_at_offset(ref, fd.offset, fd.type_id);
+            array(rt->object_pool().get_unmanaged_array(TypedHandle::from_ull(arr_val.data.handle)));
+            continue;
+        }
+
+        if (const Type* array_type = fixed_array_type(rt, fd.type_id)) {
+            TypeID element_type = array_type->type_params[0].as<TypeID>();
+            int32_t count = array_type->type_params[1].as<int32_t>();
+            const Type* element_storage_type = storage_type(rt, element_type);
+            if (!element_storage_type) { continue; }
+            for (int32_t k = 0; k < count; ++k) {
+                value(rt->read_value_field_at_offset(ref,
+                          fd.offset + static_cast<uint32_t>(k) * element_storage_type->size, element_type),
+                    element_type);
+            }
+            continue;
+        }
+
+        value(rt->read_value_field_at_offset(ref, fd.offset, fd.type_id), fd.type_id);
+    }
+}
+
+// == Reader ==================================================================
+
+// Types ``Writer::value`` writes nothing for are skipped, ``out`` is left invalid
+bool Reader::value(TypeID declared_type, Value& out)
+{
+    const Type* type = storage_type(rt, declared_type);
+    if (!type) { return true; }
+
+    if (type->type_kind == TK_primitive) {
+        switch (type->primitive_kind) {
+        default:
+            return true;
+        case PK_int:
+            out = Value::make_int(in.pod<int32_t>());
+            break;
+        case PK_float:
+            out = Value::make_float(in.pod<float>());
+            break;
+        case PK_bool:
+            out = Value::make_bool(in.pod<uint8_t>() != 0);
+            break;
+        case PK_string: {
+            auto string = in.str();
+            if (!in.ok()) { return false; }
+            out = Value::make_string(rt->alloc_string(string));
+            break;
+        }
+        }
+        out.type_id = declared_type;
+        return in.ok();
+    }
+
+    if (rt->is_native_value_type(declared_type)) {
+        if (is_resref_type(rt, declared_type)) {
+            auto resref = in.str();
+            if (!in.ok()) { return false; }
+            out = detail::make_value(rt, nw::Resref{resref});
+            return out.type_id != invalid_type_id;
+        }
+        if (is_text_ref_type(rt, declared_type)) {
+            nw::LocString loc{in.pod<uint32_t>()};
+            const auto n = in.count();
+            for (uint32_t i = 0; i < n && in.ok(); ++i) {
+                const auto lang = in.pod<uint32_t>();
+                auto string = in.str();
+                auto base_lang = Language::to_base_id(lang);
+                loc.add(base_lang.first, string, base_lang.second);
+            }
+            if (!in.ok()) { return false; }
+            out = detail::make_value(rt, nw::kernel::strings().make_text_ref(loc));
+            return out.type_id != invalid_type_id;
+        }
+        return true;
+    }
+
+    if (rt->is_object_like_type(declared_type)) {
+        out = Value::make_object(ObjectHandle::from_ull(in.pod<uint64_t>()));
+        out.type_id = declared_type;
+        return in.ok();
+    }
+
+    if (type->type_kind == TK_array) {
+        if (!type->type_params[0].is<TypeID>()) { return false; }
+        const auto n = in.count();
+        HeapPtr ptr = rt->create_array_typed(type->type_params[0].as<TypeID>(), n);
+        IArray* arr = ptr.value ? rt->get_array_typed(ptr) : nullptr;
+        if (!arr || !array_elements(arr, n)) { return false; }
+        out = Value::make_heap(ptr, rt->heap_.get_header(ptr)->type_id);
+        return true;
+    }
+
+    if (type->type_kind == TK_struct) {
+        return new_struct(declared_type, type, out);
+    }
+
+    return true;
+}
+
+bool Reader::new_struct(TypeID type_id, const Type* type, Value& out)
+{
+    HeapPtr ptr = rt->heap_.allocate(type->size, type->alignment, type_id);
+    auto* data = static_cast<uint8_t*>(rt->heap_.get_ptr(ptr));
+    if (!data) { return false; }
+
+    rt->initialize_zero_defaults(type_id, data);
+    out = Value::make_heap(ptr, type_id);
+    return fields(out, rt->get_struct_def(type_id));
+}
+
+bool Reader::array_elements(IArray* arr, uint32_t n)
+{
+    const TypeID element_type = arr->element_type();
+    arr->clear();
+    arr->reserve(n);
+    for (uint32_t i = 0; i < n && in.ok(); ++i) {
+        Value element;
+        if (!value(element_type, element)) { return false; }
+        if (element.type_id != invalid_type_id) { arr->append_value(element, *rt); }
+    }
+    return in.ok();
+}
+
+bool Reader::fields(const Value& ref, const StructDef* def)
+{
+    if (!def) { return false; }
+
+    for (uint32_t i = 0; i < def->field_count && in.ok(); ++i) {
+        const FieldDef& fd = def->fields[i];
+        if (fd.is_unmanaged_array) {
+            Value arr_val = rt->read_value_field_at_offset(ref, fd.offset, fd.type_id);
+            IArray* arr = rt->object_pool().get_unmanaged_array(TypedHandle::from_ull(arr_val.data.handle));
+            if (!arr || !array_elements(arr, in.count())) { return false; }
+            continue;
+        }
+
+        if (const Type* array_type = fixed_array_type(rt, fd.type_id)) {
+            TypeID element_type = array_type->type_params[0].as<TypeID>();
+            int32_t count = array_type->type_params[1].as<int32_t>();
+            const Type* element_storage_type = storage_type(rt, element_type);
+            if (!element_storage_type) { continue; }
+            for (int32_t k = 0; k < count; ++k) {
+                Value element;
+                if (!value(element_type, element)) { return false; }
+                if (element.type_id == invalid_type_id) { continue; }
+                if (!rt->write_value_field_at_offset(ref,
+                        fd.offset + static_cast<uint32_t>(k) * element_storage_type->size, element_type, element)) {
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        Value field_value;
+        if (!value(fd.type_id, field_value)) { return false; }
+        if (field_value.type_id == invalid_type_id) { continue; }
+        if (!rt->write_value_field_at_offset(ref, fd.offset, fd.type_id, field_value)) { return false; }
+    }
+    return in.ok();
+}
+
+void append_layout(Runtime* rt, const StructDef* def, String& out, int depth)
+{
+    // Recursive value types are impossible, the bound only guards against malformed definitions
+    if (!def || depth > 16) { return; }
+
+    out += '{';
+    for (uint32_t i = 0; i < def->field_count; ++i) {
+        const FieldDef& fd = def->fields[i];
+        out += fd.name.view();
+        out += ':';
+        out += rt->type_name(fd.type_id);
+        if (fd.is_unmanaged_array) { out += "[]"; }
+        out += ';';
+
+        // Structs nested as values or array elements are part of the layout
+        TypeID nested = fd.type_id;
+        const Type* type = storage_type(rt, nested);
+        if (type && (type->type_kind == TK_array || type->type_kind == TK_fixed_array)
+            && type->type_params[0].is<TypeID>()) {
+            nested = type->type_params[0].as<TypeID>();
+        }
+        if (!rt->is_native_value_type(nested)) {
+            const Type* nested_type = storage_type(rt, nested);
+            if (nested_type && nested_type->type_kind == TK_struct) {
+                append_layout(rt, rt->get_struct_def(nested), out, depth + 1);
+            }
+        }
+    }
+    out += '}';
+}
+
+} // namespace
+
+BinarySerializer::BinarySerializer(Runtime* rt)
+    : rt_(rt)
+{
+}
+
+uint64_t BinarySerializer::layout_hash(const StructDef* def) const
+{
+    String layout;
+    append_layout(rt_, def, layout, 0);
+    return XXH3_64bits(layout.data(), layout.size());
+}
+
+void BinarySerializer::serialize(const Value& ref, const StructDef* def, BinaryWriter& out) const
+{
+    Writer{rt_, out}.fields(ref, def);
+}
+
+bool BinarySerializer::deserialize(BinaryReader& in, const Value& ref, const StructDef* def) const
+{
+    return Reader{rt_, in}.fields(ref, def) && in.ok();
+}
+
+} // namespace nw::smalls
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "types.hpp"
+
+#include "../util/BinaryStream.hpp"
+
+#include <cstdint>
+
+namespace nw::smalls {
+
+struct Runtime;
+struct StructDef;
+struct Value;
+
+/// Generic smalls struct ↔ binary serializer, the compact counterpart of ``JsonSerializer``.
+///
+/// Fields are written in declaration order without names, so binary data is only readable by a runtime
+/// whose struct has the same ``layout_hash``.  Handles the same field types as ``JsonSerializer``:
+///   - TK_primitive int, float, bool, string
+///   - ResRef and TextRef native values
+///   - Fixed arrays, managed arrays, unmanaged propset arrays and nested structs
+///   - ObjectHandle (immediate) as uint64
+/// Other fields are skipped, as they are serialized to ``null`` in JSON.
+class BinarySerializer {
+public:
+    explicit BinarySerializer(Runtime* rt);
+
+    /// Gets a hash of the field names, types and nesting of a struct
+    uint64_t layout_hash(const StructDef* def) const;
+
+    /// Appends a struct-like field block to ``out``
+    void serialize(const Value& ref, const StructDef* def, BinaryWriter& out) const;
+
+    /// Reads a struct-like field block written by ``serialize`` into an existing block
+    /// @note Returns false if any field could not be read or written.
+    bool deserialize(BinaryReader& in, const Value& ref, const StructDef* def) const;
+
+private:
+    Runtime* rt_;
+};
+
+using PropsetBinarySerializer = BinarySerializer;
+
+} // namespace nw::smalls
@@ -10,8 +10,11 @@
 #include "../util/profile.hpp"
 #include "AstCompiler.hpp"
 #include "AstResolver.hpp"
+#include "BytecodeCache.hpp"
 #include "BytecodeVerifier.hpp"
 #include "Context.hpp"
+#include "CoroutineScheduler.hpp"
+#include "Map.hpp"
 #include "NullVisitor.hpp"
 #include "PropsetPool.hpp"
 #include "Smalls.hpp"
@@ -29,6 +32,7 @@
 #include <nlohmann/json.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <filesystem>
 #include <fstream>
@@ -36,6 +40,16 @@
 
 namespace nw::smalls {
 
+namespace {
+
+uint64_t next_module_generation() noexcept
+{
+    static std::atomic<uint64_t> generation{0};
+    return ++generation;
+}
+
+} // namespace
+
 // == Value ===================================================================
 // ============================================================================
 
@@ -193,6 +207,7 @@ bool ValueEq::operator()(const Value& a, const Value& b) const noexcept
 // ============================================================================
 
 const std::type_index Runtime::type_index{typeid(Runtime)};
+size_t Runtime::service_slot = kernel::Services::no_slot;
 
 Runtime::ScopedRoots::ScopedRoots(Runtime& runtime, size_t expected_roots)
     : runtime_{&runtime}
@@ -225,6 +240,7 @@ Runtime::Runtime(MemoryResource* scope)
     , type_table_(scope)
     , gc_{std::make_unique<GarbageCollector>(&heap_, this)}
     , vm_{std::make_unique<VirtualMachine>()}
+    , coroutines_{std::make_unique<CoroutineScheduler>(this, vm_.get())}
     , arena_(MB(256))
     , scope_(&arena_)
     , resman_{nw::kernel::global_allocator(), &kernel::resman()}
@@ -235,6 +251,7 @@ Runtime::Runtime(MemoryResource* scope)
     diagnostic_context_->scope = &scope_;
     diagnostic_context_->config = diagnostic_config_;
     gc_->set_vm(vm_.get());
+    module_generation_ = next_module_generation();
 }
 
 Runtime::~Runtime()
@@ -243,6 +260,7 @@ Runtime::~Runtime()
 
     // Destroy VM and GC first to release any references before cleaning up
     // objects they might point to.
+    coroutines_.reset();
     vm_.reset();
     gc_.reset();
     propsets_.reset();
@@ -270,6 +288,7 @@ void Runtime::initialize(nw::kernel::ServiceInitTime time)
 {
     if (time == nw::kernel::ServiceInitTime::kernel_start || time == kernel::ServiceInitTime::module_pre_load) {
         const bool language_only = kernel::services().mode() == kernel::ServiceMode::language;
+        coroutines_->set_tick_budget(kernel::config().options().smalls_coroutine_tick_budget);
 
         // Language tooling supplies explicit package paths. Game runtimes
         // bootstrap the shipped core and exactly one selected profile.
@@ -297,6 +316,7 @@ void Runtime::initialize(nw::kernel::ServiceInitTime time)
         register_core_player(*this);
         register_core_combat(*this);
         register_core_visual(*this);
+        register_core_coroutine(*this);
 
         if (language_only) {
             return;
@@ -485,6 +505,8 @@ nlohmann::json Runtime::stats() const
         {"module_count", modules_.size()},
         {"ast_discarded_module_count", ast_discarded_count},
         {"compiled_module_count", bytecode_cache_.size()},
+        {"bytecode_cache_hits", bytecode_cache_hits_},
+        {"bytecode_cache_writes", bytecode_cache_writes_},
         {"compiled_function_count", module_functions},
         {"global_slot_count", module_globals},
         {"export_count", export_count},
@@ -494,6 +516,7 @@ nlohmann::json Runtime::stats() const
         {"instantiated_generic_function_count", instantiation_cache_.size()},
         {"instantiated_generic_type_count", type_instantiation_cache_.size()},
         {"source_map_cache_entries", line_offsets_.size()},
+        {"parked_coroutine_count", coroutines_->parked()},
         {"compiler_arena_used_bytes", arena_.used()},
         {"compiler_arena_capacity_bytes", arena_.capacity()},
     };
@@ -1840,7 +1863,7 @@ ExecutionResult Runtime::execute_script(Script* script, StringView function_name
 }
 
 ExecutionResult Runtime::execute_compiled(BytecodeModule* module, const CompiledFunction* function,
-    const Vector<Value>& args, uint64_t gas_limit)
+    std::span<const Value> args, uint64_t gas_limit)
 {
     if (!module || !function) {
         return ExecutionResult{
@@ -2081,6 +2104,11 @@ void Runtime::fail(StringView msg)
     vm_->fail(msg);
 }
 
+bool Runtime::suspend_coroutine(uint64_t sleep_ticks)
+{
+    return vm_->suspend_coroutine(sleep_ticks);
+}
+
 bool Runtime::evict_module(StringView module_name)
 {
     absl::flat_hash_set<String> selected;
@@ -2107,6 +2135,7 @@ size_t Runtime::evict_cached_modules(const absl::flat_hash_set<String>& module_n
         }
 
         line_offsets_.erase(module_name);
+        bytecode_keys_.erase(module_name);
         script_it->second->~Script();
         // Script storage is arena-backed and remains high-water memory until runtime shutdown.
         modules_.erase(script_it);
@@ -2116,6 +2145,7 @@ size_t Runtime::evict_cached_modules(const absl::flat_hash_set<String>& module_n
     if (evicted_paths.empty()) {
         return 0;
     }
+    module_generation_ = next_module_generation();
 
     absl::flat_hash_set<uint32_t> evicted_external_indices;
     for (uint32_t i = 0; i < external_functions_.size(); ++i) {
@@ -2452,12 +2482,20 @@ BytecodeModule* Runtime::get_or_compile_module(Script* script)
     BytecodeModule* module = module_uptr.get();
     bytecode_cache_[script] = std::move(module_uptr);
 
-    AstCompiler compiler(script, module, this, diagnostic_context_);
+    const uint64_t cache_key = bytecode_cache_key(script);
+    const bool cached = cache_key != 0 && read_cached_bytecode(script, module, cache_key);
+    if (!cached) {
+        AstCompiler compiler(script, module, this, diagnostic_context_);
 
-    if (!compiler.compile()) {
-        LOG_F(ERROR, "[runtime] Compilation failed for '{}': {}", script->name(), compiler.error_message_);
-        bytecode_cache_[script] = nullptr; // downgrade to failed entry; do not retry
-        return nullptr;
+        if (!compiler.compile()) {
+            LOG_F(ERROR, "[runtime] Compilation failed for '{}': {}", script->name(), compiler.error_message_);
+            bytecode_cache_[script] = nullptr; // downgrade to failed entry; do not retry
+            return nullptr;
+        }
+
+        if (bytecode_optimizer_.any()) {
+            bytecode_optimizer_stats_ += optimize_bytecode(module, this, bytecode_optimizer_);
+        }
     }
 
     if (script_tests_enabled_) {
@@ -2511,6 +2549,11 @@ BytecodeModule* Runtime::get_or_compile_module(Script* script)
         return nullptr;
     }
 
+    if (cache_key != 0) {
+        bytecode_keys_[String(script->name())] = cache_key;
+        if (!cached) { write_cached_bytecode(script, module, cache_key); }
+    }
+
     // Auto-run __init if present.
     // Uses execute_module_init so that lazily-loaded modules (triggered during another
     // script's execution) get their own isolated gas budget rather than draining the
@@ -2526,6 +2569,161 @@ BytecodeModule* Runtime::get_or_compile_module(Script* script)
     return module;
 }
 
+uint64_t Runtime::bytecode_cache_key(Script* script) const
+{
+    if (kernel::config().options().smalls_bytecode_cache.empty()) { return 0; }
+
+    const auto source = script->text();
+    if (source.empty()) { return 0; }
+
+    const auto& opt = bytecode_optimizer_;
+    const uint64_t optimizer = uint64_t(opt.copy_propagation)
+        | uint64_t(opt.dead_store_elimination) << 1
+        | uint64_t(opt.jump_threading) << 2
+        | uint64_t(opt.superinstructions) << 3
+        | uint64_t(opt.inline_small_functions) << 4
+        | uint64_t(opt.max_inline_instructions) << 8;
+
+    const auto build_id = bytecode_build_id();
+    Vector<uint64_t> parts{
+        bytecode_compiler_version,
+        XXH3_64bits(build_id.data(), build_id.size()),
+        native_layout_signature(),
+        optimizer,
+        XXH3_64bits(script->name().data(), script->name().size()),
+        XXH3_64bits(source.data(), source.size()),
+    };
+
+    // A dependency without a key was not compiled or not cacheable, so neither is this module.
+    for (const auto& dep : script->dependencies()) {
+        if (dep.empty()) { continue; }
+        auto it = bytecode_keys_.find(dep);
+        if (it == bytecode_keys_.end()) { return 0; }
+        parts.push_back(it->second);
+    }
+
+    // Preludes are visible to every module without an import
+    for (const Script* prelude : {core_prelude_, user_prelude_}) {
+        if (!prelude || prelude == script) { continue; }
+        auto it = bytecode_keys_.find(prelude->name());
+        if (it != bytecode_keys_.end()) {
+            parts.push_back(it->second);
+        } else if (!prelude->text().empty()) {
+            parts.push_back(XXH3_64bits(prelude->text().data(), prelude->text().size()));
+        } else {
+            return 0;
+        }
+    }
+
+    return XXH3_64bits(parts.data(), parts.size() * sizeof(uint64_t));
+}
+
+uint64_t Runtime::native_layout_signature() const
+{
+    // Cached modules hold raw field offsets, so any change to a native layout must miss the cache.
+    // Layouts are hashed in name order, registration order may differ from run to run.
+    auto hash = [](StringView str) { return XXH3_64bits(str.data(), str.size()); };
+    Vector<uint64_t> parts;
+
+    Vector<StringView> names;
+    for (const auto& [name, layout] : native_struct_layouts_) {
+        names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    for (auto name : names) {
+        const auto& layout = native_struct_layouts_.find(name)->second;
+        parts.insert(parts.end(), {hash(name), layout.size, layout.alignment, layout.fields.size()});
+        for (const auto& field : layout.fields) {
+            parts.insert(parts.end(), {hash(field.name), field.offset, hash(type_name(field.type_id))});
+        }
+    }
+
+    names.clear();
+    for (const auto& [name, layout] : native_value_type_layouts_) {
+        names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    for (auto name : names) {
+        const auto& layout = native_value_type_layouts_.find(name)->second;
+        parts.insert(parts.end(), {hash(name), layout.size, layout.alignment});
+    }
+
+    return XXH3_64bits(parts.data(), parts.size() * sizeof(uint64_t));
+}
+
+bool Runtime::read_cached_bytecode(Script* script, BytecodeModule* module, uint64_t key)
+{
+    NW_PROFILE_SCOPE_N("smalls.read_cached_bytecode");
+
+    const auto path = std::filesystem::path{kernel::config().options().smalls_bytecode_cache}
+        / fmt::format("{}.nwsb", script->name());
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) { return false; }
+
+    BytecodeModule loaded{String(script->name())};
+    const auto bytes = ByteArray::from_file(path);
+    if (!read_bytecode_module(bytes.span(), *this, script->text(), key, loaded)) {
+        return false;
+    }
+
+    String error;
+    if (!verify_bytecode_module(&loaded, &error)) {
+        LOG_F(WARNING, "[runtime] Cached bytecode for '{}' failed verification, recompiling: {}", script->name(), error);
+        return false;
+    }
+
+    for (const auto& inst : loaded.generic_instantiations) {
+        Script* provider = get_module(inst.module_name);
+        if (!provider
+            || !ensure_generic_instantiation_by_name(provider, nullptr, inst.function_name, inst.type_args, &error)) {
+            LOG_F(WARNING, "[runtime] Cached bytecode for '{}' needs '{}.{}', recompiling: {}",
+                script->name(), inst.module_name, inst.function_name, error);
+            return false;
+        }
+    }
+
+    // The compiler consults definitions when later instantiating generics into this module
+    for (auto* decl : script->ast().decls) {
+        auto* func = dynamic_cast<FunctionDefinition*>(decl);
+        if (!func || func->is_generic()) { continue; }
+        auto idx = loaded.get_function_index(func->identifier());
+        if (idx != UINT32_MAX) { loaded.functions[idx]->source_ast = func; }
+    }
+
+    *module = std::move(loaded);
+    ++bytecode_cache_hits_;
+    return true;
+}
+
+void Runtime::write_cached_bytecode(Script* script, const BytecodeModule* module, uint64_t key)
+{
+    ByteArray bytes;
+    if (!write_bytecode_module(*module, *this, script->text(), key, bytes)) {
+        LOG_F(INFO, "[runtime] '{}' refers to types that cannot be cached, skipping bytecode cache", script->name());
+        return;
+    }
+
+    const std::filesystem::path dir{kernel::config().options().smalls_bytecode_cache};
+    const auto path = dir / fmt::format("{}.nwsb", script->name());
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    // Renamed into place so a concurrent reader never sees a partial file, each writer gets its own
+    // temporary so concurrent writers never interleave.
+    const auto tmp = unique_sibling_path(path);
+    if (!bytes.write_to(tmp)) {
+        LOG_F(ERROR, "[runtime] unable to write bytecode cache '{}'", tmp);
+        return;
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        LOG_F(ERROR, "[runtime] unable to replace bytecode cache '{}': {}", path, ec.message());
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+    ++bytecode_cache_writes_;
+}
+
 void Runtime::enumerate_module_globals(GCRootVisitor& visitor)
 {
     for (auto& [script, module] : bytecode_cache_) {
@@ -2544,6 +2742,11 @@ void Runtime::enumerate_module_globals(GCRootVisitor& visitor)
     }
 }
 
+void Runtime::enumerate_coroutine_roots(GCRootVisitor& visitor)
+{
+    coroutines_->enumerate_roots(visitor);
+}
+
 void Runtime::register_primitive_operators()
 {
 // Helper macros for common patterns
@@ -2979,6 +3182,11 @@ void Runtime::set_script_tests_enabled(bool enabled) noexcept
     script_tests_enabled_ = enabled;
 }
 
+void Runtime::set_bytecode_optimizer(const BytecodeOptimizerOptions& options) noexcept
+{
+    bytecode_optimizer_ = options;
+}
+
 std::span<const ScriptTest> Runtime::module_tests(Script* script)
 {
     if (!script_tests_enabled_ || !script) {
@@ -4359,10 +4567,29 @@ HeapPtr Runtime::alloc_map(TypeID key_type_id, TypeID value_type_id)
     };
     TypeID map_type_id = type_table_.add(map_type);
 
+    // Int and string keys, directly or through newtypes, get specialized storage.  Aliases and native
+    // value types stay generic since their values may not carry the map's exact key type.
+    MapKeyKind key_kind = MapKeyKind::generic;
+    TypeID underlying_key = key_type_id;
+    const Type* underlying = key_type_ptr;
+    while (underlying && underlying->type_kind == TK_newtype && underlying->type_params[0].is<TypeID>()) {
+        underlying_key = underlying->type_params[0].as<TypeID>();
+        underlying = get_type(underlying_key);
+    }
+    if (underlying_key == int_type()) {
+        key_kind = MapKeyKind::int_key;
+    } else if (underlying_key == string_type()) {
+        key_kind = MapKeyKind::string_key;
+    }
+    const bool unboxed_values = value_type_id == int_type() || value_type_id == float_type()
+        || value_type_id == bool_type();
+
     HeapPtr ptr = heap_.allocate(sizeof(MapInstance), alignof(MapInstance), map_type_id);
     void* data = heap_.get_ptr(ptr);
 
-    new (data) MapInstance(key_type_id, value_type_id);
+    auto* map = new (data) MapInstance(key_type_id, value_type_id, key_kind, unboxed_values, this);
+    map->key_is_heap = type_table_.is_heap_type(key_type_id);
+    map->value_is_heap = type_table_.is_heap_type(value_type_id);
 
     return ptr;
 }
@@ -4376,13 +4603,8 @@ bool Runtime::map_get(HeapPtr map_ptr, const Value& key, Value& out_value) const
     CHECK_F(type && type->type_kind == TK_map,
         "HeapPtr is not a map (type: {})", type ? type_name(header->type_id) : "<unknown>");
 
-    MapInstance* map = static_cast<MapInstance*>(heap_.get_ptr(map_ptr));
-    auto it = map->data.find(key);
-    if (it != map->data.end()) {
-        out_value = it->second;
-        return true;
-    }
-    return false;
+    const MapInstance* map = static_cast<const MapInstance*>(heap_.get_ptr(map_ptr));
+    return map->find(key, out_value);
 }
 
 bool Runtime::map_set(HeapPtr map_ptr, const Value& key, const Value& value)
@@ -4396,21 +4618,25 @@ bool Runtime::map_set(HeapPtr map_ptr, const Value& key, const Value& value)
 
     MapInstance* map = static_cast<MapInstance*>(heap_.get_ptr(map_ptr));
     CHECK_F(map->iteration_count == 0, "Cannot modify map while iterating");
-    auto result = map->data.insert({key, value});
-    if (!result.second) {
-        result.first->second = value;
-    }
+    return map_set(map_ptr, *map, key, value);
+}
+
+bool Runtime::map_set(HeapPtr map_ptr, MapInstance& map, const Value& key, const Value& value)
+{
+    ENSURE_OR_RETURN_FALSE(map.accepts(key, value), "Map entry type mismatch: expected ({}, {}), got ({}, {})",
+        map.key_type.value, map.value_type.value, key.type_id.value, value.type_id.value);
+    const bool inserted = map.insert_or_assign(key, value);
 
     if (gc_) {
-        if (type_table_.is_heap_type(map->key_type) && key.storage == ValueStorage::heap) {
+        if (map.key_is_heap && key.storage == ValueStorage::heap) {
             gc_->write_barrier(map_ptr, key.data.hptr);
         }
-        if (type_table_.is_heap_type(map->value_type) && value.storage == ValueStorage::heap) {
+        if (map.value_is_heap && value.storage == ValueStorage::heap) {
             gc_->write_barrier(map_ptr, value.data.hptr);
         }
     }
 
-    return result.second;
+    return inserted;
 }
 
 bool Runtime::map_contains(HeapPtr map_ptr, const Value& key) const
@@ -4422,8 +4648,8 @@ bool Runtime::map_contains(HeapPtr map_ptr, const Value& key) const
     CHECK_F(type && type->type_kind == TK_map,
         "HeapPtr is not a map (type: {})", type ? type_name(header->type_id) : "<unknown>");
 
-    MapInstance* map = static_cast<MapInstance*>(heap_.get_ptr(map_ptr));
-    return map->data.contains(key);
+    const MapInstance* map = static_cast<const MapInstance*>(heap_.get_ptr(map_ptr));
+    return map->contains(key);
 }
 
 size_t Runtime::map_size(HeapPtr map_ptr) const
@@ -4435,8 +4661,8 @@ size_t Runtime::map_size(HeapPtr map_ptr) const
     CHECK_F(type && type->type_kind == TK_map,
         "HeapPtr is not a map (type: {})", type ? type_name(header->type_id) : "<unknown>");
 
-    MapInstance* map = static_cast<MapInstance*>(heap_.get_ptr(map_ptr));
-    return map->data.size();
+    const MapInstance* map = static_cast<const MapInstance*>(heap_.get_ptr(map_ptr));
+    return map->size();
 }
 
 bool Runtime::map_remove(HeapPtr map_ptr, const Value& key)
@@ -4450,7 +4676,7 @@ bool Runtime::map_remove(HeapPtr map_ptr, const Value& key)
 
     MapInstance* map = static_cast<MapInstance*>(heap_.get_ptr(map_ptr));
     CHECK_F(map->iteration_count == 0, "Cannot modify map while iterating");
-    return map->data.erase(key) > 0;
+    return map->erase(key);
 }
 
 void Runtime::map_clear(HeapPtr map_ptr)
@@ -4464,7 +4690,7 @@ void Runtime::map_clear(HeapPtr map_ptr)
 
     MapInstance* map = static_cast<MapInstance*>(heap_.get_ptr(map_ptr));
     CHECK_F(map->iteration_count == 0, "Cannot modify map while iterating");
-    map->data.clear();
+    map->clear();
 }
 
 HeapPtr Runtime::map_iter_begin(HeapPtr map_ptr)
@@ -4481,7 +4707,7 @@ HeapPtr Runtime::map_iter_begin(HeapPtr map_ptr)
 
     HeapPtr iter_ptr = heap_.allocate(sizeof(MapIterator), alignof(MapIterator), invalid_type_id);
     void* iter_data = heap_.get_ptr(iter_ptr);
-    new (iter_data) MapIterator{map_ptr, map->data.begin(), map->data.end()};
+    new (iter_data) MapIterator(map_ptr, *map);
     return iter_ptr;
 }
 
@@ -4490,14 +4716,7 @@ bool Runtime::map_iter_next(HeapPtr iter_ptr, Value& key, Value& value)
     CHECK_F(iter_ptr.value != 0, "Null iterator pointer");
     MapIterator* iter = static_cast<MapIterator*>(heap_.get_ptr(iter_ptr));
 
-    if (iter->current == iter->end) {
-        return false;
-    }
-
-    key = iter->current->first;
-    value = iter->current->second;
-    ++iter->current;
-    return true;
+    return iter->next(key, value);
 }
 
 void Runtime::map_iter_end(HeapPtr map_ptr, HeapPtr iter_ptr)
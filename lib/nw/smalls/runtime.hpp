@@ -7,6 +7,7 @@
 #include "../rules/RuntimeObject.hpp"
 #include "../util/HandlePool.hpp"
 #include "Array.hpp"
+#include "BytecodeOptimizer.hpp"
 #include "Context.hpp"
 #include "GarbageCollector.hpp"
 #include "ScriptHeap.hpp"
@@ -38,12 +39,14 @@ struct CompiledFunction;
 struct FunctionDefinition;
 struct GCRootVisitor;
 struct IArray;
+struct MapInstance;
 struct ModuleBuilder;
 struct NativeValueTypeLayout;
 struct NativeStructLayout;
 struct Script;
 struct ScriptTest;
 struct Token;
+struct CoroutineScheduler;
 struct VirtualMachine;
 class PropsetPoolManager;
 struct Runtime;
@@ -207,29 +210,6 @@ struct HandleEntry {
     OwnershipMode mode; // Ownership mode for this handle
 };
 
-// == MapInstance =============================================================
-
-struct MapInstance {
-    TypeID key_type;
-    TypeID value_type;
-    uint32_t iteration_count = 0;
-    absl::flat_hash_map<Value, Value, ValueHash, ValueEq> data;
-
-    MapInstance(TypeID k, TypeID v)
-        : key_type(k)
-        , value_type(v)
-    {
-    }
-
-    ~MapInstance() = default;
-};
-
-struct MapIterator {
-    HeapPtr map_ptr;
-    absl::flat_hash_map<Value, Value, ValueHash, ValueEq>::iterator current;
-    absl::flat_hash_map<Value, Value, ValueHash, ValueEq>::iterator end;
-};
-
 // == Module Interface Metadata ===============================================
 // ============================================================================
 
@@ -343,6 +323,7 @@ struct VmProfileSnapshot {
 
 struct Runtime : public nw::kernel::Service {
     const static std::type_index type_index;
+    static size_t service_slot; ///< Assigned by the kernel when the service is first added
 
     /// Roots a contiguous batch of temporary Values on Runtime::stack_.
     ///
@@ -385,7 +366,7 @@ struct Runtime : public nw::kernel::Service {
 
     /// Executes a pre-resolved compiled function.
     ExecutionResult execute_compiled(BytecodeModule* module, const CompiledFunction* function,
-        const Vector<Value>& args = {}, uint64_t gas_limit = default_gas_limit);
+        std::span<const Value> args = {}, uint64_t gas_limit = default_gas_limit);
 
     /// Executes a script function by script path
     ExecutionResult execute_script(StringView path, StringView function_name, const Vector<Value>& args = {},
@@ -410,8 +391,26 @@ struct Runtime : public nw::kernel::Service {
     void clear_user_cache();
 
     /// Gets or compiles bytecode for a script
+    ///
+    /// If ``ConfigOptions::smalls_bytecode_cache`` is set, a module whose source, dependencies, compiler
+    /// version and optimizer settings are unchanged is read from the cache and verified instead of compiled.
+    /// The script is still parsed and resolved, since types and exports are registered from its AST.
     BytecodeModule* get_or_compile_module(Script* script);
 
+    /// Gets the module generation, it changes whenever modules are evicted and so cached
+    /// ``BytecodeModule`` and ``CompiledFunction`` pointers may dangle.  Generations are unique
+    /// across runtime instances.
+    uint64_t module_generation() const noexcept { return module_generation_; }
+
+    // -- Coroutines ----------------------------------------------------------
+
+    /// Gets the scheduler of parked coroutines
+    CoroutineScheduler& coroutines() { return *coroutines_; }
+
+    /// Parks the running coroutine once the current native call returns
+    /// @return false if no coroutine is running
+    bool suspend_coroutine(uint64_t sleep_ticks);
+
     // -- Type System ---------------------------------------------------------
 
     /// Accessors for cached primitive type IDs
@@ -759,6 +758,15 @@ struct Runtime : public nw::kernel::Service {
     ExecutionResult execute_test(Script* script, StringView name, uint64_t gas_limit = default_gas_limit);
     Vector<ExecutionResult> execute_tests(Script* script, uint64_t gas_limit = default_gas_limit);
 
+    // -- Bytecode Optimizer ---------------------------------------------------
+
+    /// Sets the passes run over modules compiled after this call, every pass is off by default
+    void set_bytecode_optimizer(const BytecodeOptimizerOptions& options) noexcept;
+    const BytecodeOptimizerOptions& bytecode_optimizer() const noexcept { return bytecode_optimizer_; }
+
+    /// Gets totals over every module optimized
+    const BytecodeOptimizerStats& bytecode_optimizer_stats() const noexcept { return bytecode_optimizer_stats_; }
+
     // -- Handle System -------------------------------------------------------
 
     /// Registers a handle type with the runtime
@@ -1192,6 +1200,10 @@ public:
     /// @return true if inserted, false if overwritten
     bool map_set(HeapPtr map_ptr, const Value& key, const Value& value);
 
+    /// Set a key-value pair in a map already resolved from ``map_ptr``, used by the VM's ``MAPSET``
+    /// @return true if inserted, false if overwritten or rejected
+    bool map_set(HeapPtr map_ptr, MapInstance& map, const Value& key, const Value& value);
+
     /// Check if a map contains a key
     /// @param map_ptr Heap pointer to the map
     /// @param key The key to check
@@ -1269,6 +1281,7 @@ public:
     void destruct_object(HeapPtr ptr);
     void* get_value_data_ptr(const Value& v) noexcept;
     void enumerate_module_globals(GCRootVisitor& visitor);
+    void enumerate_coroutine_roots(GCRootVisitor& visitor);
 
     template <typename Callback>
     void scan_fixed_array_heap_refs(const Type* arr_type, uint8_t* base, Callback&& callback);
@@ -1313,6 +1326,7 @@ private:
     // Bytecode cache: Script -> BytecodeModule
     // BytecodeModules are owned by Runtime
     absl::flat_hash_map<Script*, std::unique_ptr<BytecodeModule>> bytecode_cache_;
+    uint64_t module_generation_ = 0;
 
     // Generic function instantiation cache
     struct InstantiationKey {
@@ -1384,6 +1398,7 @@ private:
 
     // VM instance
     std::unique_ptr<VirtualMachine> vm_;
+    std::unique_ptr<CoroutineScheduler> coroutines_;
 
     // Stack of modules currently being loaded (for circular dependency detection)
     Vector<String> loading_stack_;
@@ -1473,6 +1488,18 @@ private:
     uint32_t test_count_ = 0;
     uint32_t test_failures_ = 0;
     bool script_tests_enabled_ = false;
+    BytecodeOptimizerOptions bytecode_optimizer_ = BytecodeOptimizerOptions::none();
+    BytecodeOptimizerStats bytecode_optimizer_stats_;
+
+    // On-disk bytecode cache, see ``ConfigOptions::smalls_bytecode_cache``
+    absl::flat_hash_map<String, uint64_t> bytecode_keys_; ///< Module name to cache key
+    size_t bytecode_cache_hits_ = 0;
+    size_t bytecode_cache_writes_ = 0;
+
+    uint64_t bytecode_cache_key(Script* script) const;
+    uint64_t native_layout_signature() const;
+    bool read_cached_bytecode(Script* script, BytecodeModule* module, uint64_t key);
+    void write_cached_bytecode(Script* script, const BytecodeModule* module, uint64_t key);
 
     bool vm_profile_enabled_ = false;
     bool vm_profile_timing_enabled_ = false;
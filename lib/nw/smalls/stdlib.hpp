@@ -21,5 +21,6 @@ void register_core_module(Runtime& rt);
 void register_core_player(Runtime& rt);
 void register_core_combat(Runtime& rt);
 void register_core_visual(Runtime& rt);
+void register_core_coroutine(Runtime& rt);
 
 } // namespace nw::smalls
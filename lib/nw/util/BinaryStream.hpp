@@ -0,0 +1,171 @@
+#pragma once
+
+#include "../config.hpp"
+#include "ByteArray.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace nw {
+
+/// Appends fixed width values and length prefixed strings to a ``ByteArray``
+/// @note Values are written in host byte order, output is meant for caches and snapshots read back by
+/// the same build.
+struct BinaryWriter {
+    explicit BinaryWriter(ByteArray& out)
+        : out_(out)
+    {
+    }
+
+    /// Appends a trivially copyable value
+    template <typename T>
+    void pod(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.append(&value, sizeof(T));
+    }
+
+    /// Appends a ``uint32_t`` count followed by the values
+    template <typename T>
+    void pods(std::span<const T> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        pod(static_cast<uint32_t>(values.size()));
+        bytes(values.data(), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void pods(const Vector<T>& values)
+    {
+        pods(std::span<const T>{values});
+    }
+
+    /// Appends raw bytes
+    void bytes(const void* data, size_t size)
+    {
+        if (size) { out_.append(data, size); }
+    }
+
+    /// Appends a ``uint32_t`` length followed by the characters
+    void str(StringView value)
+    {
+        pod(static_cast<uint32_t>(value.size()));
+        bytes(value.data(), value.size());
+    }
+
+    /// Appends a value to be overwritten by ``patch`` once known, returns its position
+    template <typename T>
+    size_t reserve(const T& value = T{})
+    {
+        const size_t result = out_.size();
+        pod(value);
+        return result;
+    }
+
+    /// Overwrites a value appended by ``reserve``
+    template <typename T>
+    void patch(size_t pos, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::memcpy(out_.mutable_data() + pos, &value, sizeof(T));
+    }
+
+    /// Gets the output buffer
+    ByteArray& buffer() noexcept { return out_; }
+
+    /// Gets the size of the output buffer
+    size_t size() const noexcept { return out_.size(); }
+
+private:
+    ByteArray& out_;
+};
+
+/// Bounds checked reader of what ``BinaryWriter`` writes
+/// @note A read past the end fails the reader, it and every later read return default values.
+struct BinaryReader {
+    explicit BinaryReader(std::span<const uint8_t> bytes, size_t pos = 0)
+        : bytes_(bytes)
+        , pos_(pos)
+        , ok_(pos <= bytes.size())
+    {
+    }
+
+    /// Determines if every read so far succeeded
+    bool ok() const noexcept { return ok_; }
+
+    /// Marks the read as failed, e.g. when a value read is invalid
+    void fail() noexcept { ok_ = false; }
+
+    /// Gets the read position
+    size_t pos() const noexcept { return pos_; }
+
+    /// Gets the number of bytes left to read
+    size_t remaining() const noexcept { return ok_ ? bytes_.size() - pos_ : 0; }
+
+    /// Gets all bytes being read
+    std::span<const uint8_t> data() const noexcept { return bytes_; }
+
+    /// Reads ``size`` raw bytes into ``out``
+    void bytes(void* out, size_t size)
+    {
+        if (!take(size)) { return; }
+        if (size) { std::memcpy(out, bytes_.data() + pos_, size); }
+        pos_ += size;
+    }
+
+    /// Reads a trivially copyable value
+    template <typename T>
+    T pod()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        bytes(&value, sizeof(T));
+        return value;
+    }
+
+    /// Reads a ``uint32_t`` count, failing if the bytes left cannot hold that many elements
+    uint32_t count(size_t min_element_size = 1)
+    {
+        const auto n = pod<uint32_t>();
+        if (ok_ && uint64_t(n) * min_element_size > bytes_.size() - pos_) { ok_ = false; }
+        return ok_ ? n : 0;
+    }
+
+    /// Reads values written by ``BinaryWriter::pods``
+    template <typename T>
+    void pods(Vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto n = count(sizeof(T));
+        values.resize(n);
+        bytes(values.data(), n * sizeof(T));
+    }
+
+    /// Reads a string written by ``BinaryWriter::str``, the result views the bytes being read
+    StringView str()
+    {
+        const auto n = pod<uint32_t>();
+        if (!take(n)) { return {}; }
+        StringView result{reinterpret_cast<const char*>(bytes_.data() + pos_), n};
+        pos_ += n;
+        return result;
+    }
+
+private:
+    bool take(size_t size) noexcept
+    {
+        if (!ok_ || bytes_.size() - pos_ < size) {
+            ok_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    std::span<const uint8_t> bytes_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace nw
@@ -20,6 +20,11 @@ ByteArray::ByteArray(const uint8_t* buffer, size_t len)
     append(buffer, len);
 }
 
+bool ByteArray::operator==(const ByteArray& other) const
+{
+    return size() == other.size() && (size() == 0 || memcmp(data(), other.data(), size()) == 0);
+}
+
 void ByteArray::append(const void* buffer, size_t len)
 {
     auto b = reinterpret_cast<const uint8_t*>(buffer);
@@ -29,6 +34,32 @@ void ByteArray::append(const void* buffer, size_t len)
     }
 }
 
+ByteArray ByteArray::borrow(std::shared_ptr<const void> owner, const uint8_t* buffer, size_t len)
+{
+    ByteArray result;
+    if (!owner || len == 0) { return result; }
+    result.owner_ = std::move(owner);
+    result.borrowed_ = buffer;
+    result.borrowed_size_ = len;
+    return result;
+}
+
+void ByteArray::clear()
+{
+    owner_.reset();
+    borrowed_ = nullptr;
+    borrowed_size_ = 0;
+    array_.clear();
+}
+
+void ByteArray::detach_slow()
+{
+    array_.assign(borrowed_, borrowed_ + borrowed_size_);
+    owner_.reset();
+    borrowed_ = nullptr;
+    borrowed_size_ = 0;
+}
+
 bool ByteArray::read_at(size_t offset, void* buffer, size_t sz) const
 {
     if (offset > size() || sz > size() - offset) {
@@ -63,7 +94,7 @@ ByteArray ByteArray::from_file(const std::filesystem::path& path)
         }
         auto size = fs::file_size(path);
         ba.resize(size);
-        if (!istream_read(f, ba.data(), size)) {
+        if (!istream_read(f, ba.mutable_data(), size)) {
             LOG_F(ERROR, "Failed to read file '{}'", path);
             ba.clear();
         }
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <filesystem>
 #include <ios>
+#include <memory>
 #include <span>
 #include <string>
 
@@ -25,39 +26,63 @@ struct ByteArray {
 
     ByteArray& operator=(ByteArray&&) = default;
     ByteArray& operator=(const ByteArray&) = default;
-    bool operator==(const ByteArray& other) const { return array_ == other.array_; }
-    uint8_t& operator[](size_type pos) { return array_[pos]; }
-    const uint8_t& operator[](size_type pos) const { return array_[pos]; }
+    bool operator==(const ByteArray& other) const;
+    const uint8_t& operator[](size_type pos) const { return data()[pos]; }
 
     /// Appends bytes to the array
     void append(const void* buffer, size_t len);
 
+    /// Constructs an array that borrows ``len`` bytes at ``buffer``, ``owner`` keeps the memory alive.
+    /// @note The first mutable access copies the borrowed bytes into owned storage.
+    static ByteArray borrow(std::shared_ptr<const void> owner, const uint8_t* buffer, size_t len);
+
+    /// Determines if the array borrows its bytes
+    bool borrowed() const noexcept { return !!owner_; }
+
     /// @brief Clears the data in the array
-    void clear() { array_.clear(); }
+    void clear();
 
     /// Returns pointer to the underlying array
-    uint8_t* data() noexcept { return array_.data(); }
+    const uint8_t* data() const noexcept { return owner_ ? borrowed_ : array_.data(); }
 
-    /// Returns pointer to the underlying array
-    const uint8_t* data() const noexcept { return array_.data(); }
+    /// Returns writable pointer to the underlying array
+    /// @note If borrowed, the bytes are copied first
+    uint8_t* mutable_data()
+    {
+        detach();
+        return array_.data();
+    }
+
+    /// Constructs writable std::span
+    /// @note If borrowed, the bytes are copied first
+    std::span<uint8_t> mutable_span() { return {mutable_data(), size()}; }
 
     /// Appends one element to the array
-    void push_back(uint8_t byte) { array_.push_back(byte); }
+    void push_back(uint8_t byte)
+    {
+        detach();
+        array_.push_back(byte);
+    }
 
     /// Reads ``size`` bytes at ``offset`` into an arbitrary ``buffer``
     bool read_at(size_t offset, void* buffer, size_t size) const;
 
     /// Increases the capacity of the array by ``count`` elements
-    void reserve(size_type count) { array_.reserve(count); }
+    void reserve(size_type count)
+    {
+        detach();
+        array_.reserve(count);
+    }
 
     /// Resizes array to contain ``count`` elements.  If greater, than current size, null padded.
-    void resize(size_type count) { array_.resize(count); }
+    void resize(size_type count)
+    {
+        detach();
+        array_.resize(count);
+    }
 
     /// Returns the number of bytes
-    size_type size() const noexcept { return array_.size(); }
-
-    /// Construct std::span
-    std::span<uint8_t> span() { return {data(), size()}; }
+    size_type size() const noexcept { return owner_ ? borrowed_size_ : array_.size(); }
 
     /// Construct std::span
     std::span<const uint8_t> span() const { return {data(), size()}; }
@@ -73,6 +98,15 @@ struct ByteArray {
 
 private:
     Vector<uint8_t> array_;
+    std::shared_ptr<const void> owner_;
+    const uint8_t* borrowed_ = nullptr;
+    size_t borrowed_size_ = 0;
+
+    void detach()
+    {
+        if (owner_) { detach_slow(); }
+    }
+    void detach_slow();
 };
 
 void from_json(const nlohmann::json& json, ByteArray& ba);
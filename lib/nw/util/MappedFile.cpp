@@ -0,0 +1,145 @@
+#include "MappedFile.hpp"
+
+#include "../log.hpp"
+
+#include <utility>
+
+#ifdef ROLLNW_OS_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nw {
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_{std::exchange(other.data_, nullptr)}
+    , size_{std::exchange(other.size_, 0)}
+    , valid_{std::exchange(other.valid_, false)}
+#ifdef ROLLNW_OS_WINDOWS
+    , file_handle_{std::exchange(other.file_handle_, nullptr)}
+    , mapping_handle_{std::exchange(other.mapping_handle_, nullptr)}
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    reset();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        valid_ = std::exchange(other.valid_, false);
+#ifdef ROLLNW_OS_WINDOWS
+        file_handle_ = std::exchange(other.file_handle_, nullptr);
+        mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+std::span<const uint8_t> MappedFile::slice(size_t offset, size_t size) const noexcept
+{
+    if (offset > size_ || size > size_ - offset) { return {}; }
+    return {data_ + offset, size};
+}
+
+void MappedFile::reset() noexcept
+{
+#ifdef ROLLNW_OS_WINDOWS
+    if (data_) { UnmapViewOfFile(data_); }
+    if (mapping_handle_) { CloseHandle(mapping_handle_); }
+    if (file_handle_) { CloseHandle(file_handle_); }
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+#else
+    if (data_) { munmap(const_cast<uint8_t*>(data_), size_); }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    valid_ = false;
+}
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::filesystem::path& path)
+{
+    auto result = std::make_shared<MappedFile>();
+
+#ifdef ROLLNW_OS_WINDOWS
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_F(ERROR, "[mmap] unable to open '{}'", path);
+        return nullptr;
+    }
+    result->file_handle_ = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        LOG_F(ERROR, "[mmap] unable to read file size for '{}'", path);
+        return nullptr;
+    }
+    result->size_ = static_cast<size_t>(size.QuadPart);
+    result->valid_ = true;
+    if (result->size_ == 0) { return result; }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        LOG_F(ERROR, "[mmap] unable to create file mapping for '{}'", path);
+        result->valid_ = false;
+        return nullptr;
+    }
+    result->mapping_handle_ = mapping;
+
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        LOG_F(ERROR, "[mmap] unable to map view of '{}'", path);
+        result->valid_ = false;
+        return nullptr;
+    }
+    result->data_ = static_cast<const uint8_t*>(view);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_F(ERROR, "[mmap] unable to open '{}'", path);
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        LOG_F(ERROR, "[mmap] unable to read file size for '{}'", path);
+        ::close(fd);
+        return nullptr;
+    }
+    result->size_ = static_cast<size_t>(st.st_size);
+    result->valid_ = true;
+
+    if (result->size_ > 0) {
+        void* view = mmap(nullptr, result->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            LOG_F(ERROR, "[mmap] unable to map '{}'", path);
+            ::close(fd);
+            result->size_ = 0;
+            result->valid_ = false;
+            return nullptr;
+        }
+        result->data_ = static_cast<const uint8_t*>(view);
+    }
+
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+#endif
+
+    return result;
+}
+
+} // namespace nw
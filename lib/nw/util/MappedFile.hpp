@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace nw {
+
+/// Read-only memory mapping of an entire file
+struct MappedFile {
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// Pointer to the start of the mapping, nullptr if not mapped or file is empty
+    const uint8_t* data() const noexcept { return data_; }
+
+    /// Size of the mapping in bytes
+    size_t size() const noexcept { return size_; }
+
+    /// Constructs a span of ``size`` bytes at ``offset``, empty if out of range
+    std::span<const uint8_t> slice(size_t offset, size_t size) const noexcept;
+
+    /// Unmaps the file
+    void reset() noexcept;
+
+    /// Determines if the file was mapped
+    bool valid() const noexcept { return valid_; }
+
+    /// Maps the file at ``path``, returns nullptr on failure.
+    static std::shared_ptr<MappedFile> open(const std::filesystem::path& path);
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool valid_ = false;
+#ifdef ROLLNW_OS_WINDOWS
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+} // namespace nw
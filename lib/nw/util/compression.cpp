@@ -59,7 +59,7 @@ inline ByteArray zstd_decompress(std::span<const uint8_t> span, uint32_t uncompr
     case 1: {
         result.resize(uncompressed_size);
 
-        auto res_size = ZSTD_decompressDCtx(dctx.get(), result.data(), uncompressed_size,
+        auto res_size = ZSTD_decompressDCtx(dctx.get(), result.mutable_data(), uncompressed_size,
             span.data() + hdr_sz, span.size() - hdr_sz);
         if (res_size != uncompressed_size) {
             LOG_F(ERROR, "zstd failed to decompress");
@@ -82,6 +82,16 @@ fs::path create_unique_tmp_path()
     return path;
 }
 
+fs::path unique_sibling_path(const fs::path& path)
+{
+    std::uniform_int_distribution<uint64_t> rand(0);
+    std::stringstream ss;
+    ss << '.' << std::hex << rand(prng) << ".tmp";
+    auto result = path;
+    result += ss.str();
+    return result;
+}
+
 std::filesystem::path expand_path(const std::filesystem::path& path)
 {
     std::filesystem::path result;
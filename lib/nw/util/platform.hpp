@@ -20,6 +20,10 @@ std::filesystem::path home_path();
 /// Creates randomly named folder in tmp.  Analguous to POSIX ``mkdtemp``.
 std::filesystem::path create_unique_tmp_path();
 
+/// Gets a randomly named path next to ``path``, e.g. to write a file and rename it into place
+/// @note Each call gets its own name, so concurrent writers never share a temporary file.
+std::filesystem::path unique_sibling_path(const std::filesystem::path& path);
+
 /// Expands path with ~ and environment variables
 std::filesystem::path expand_path(const std::filesystem::path& path);
 
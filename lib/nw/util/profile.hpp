@@ -33,6 +33,7 @@ inline void plot(const char* name, T value)
 #define NW_PROFILE_VALUE(value) ZoneValue(value)
 #define NW_PROFILE_TEXT(text, size) ZoneText(text, size)
 #define NW_PROFILE_PLOT(name, value) ::nw::profile::plot(name, value)
+#define NW_PROFILE_THREAD_NAME(name) ::tracy::SetThreadName(name)
 
 #define NW_PROFILE_TEXT_CSTR(cstr)                     \
     do {                                               \
@@ -69,6 +70,11 @@ inline void plot(const char* name, T value)
         (void)(value);          \
     } while (0)
 
+#define NW_PROFILE_THREAD_NAME(name) \
+    do {                             \
+        (void)(name);                \
+    } while (0)
+
 #define NW_PROFILE_TEXT(text, size) \
     do {                            \
         (void)(text);               \
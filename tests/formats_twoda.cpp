@@ -23,6 +23,48 @@ TEST(StaticTwoDA, Parse)
     EXPECT_EQ(*feat.get<int32_t>(12, "FEAT"), *row.get<int32_t>("FEAT"));
 }
 
+TEST(StaticTwoDA, Compiled)
+{
+    nw::StaticTwoDA text(fs::path("test_data/user/development/feat.2da"));
+    nw::StaticTwoDA feat(fs::path("test_data/user/development/feat.2da"));
+    ASSERT_TRUE(feat.is_valid());
+    EXPECT_FALSE(feat.compiled());
+    feat.compile();
+    EXPECT_TRUE(feat.compiled());
+
+    const auto matches = [&text](const nw::StaticTwoDA& tda) {
+        for (size_t row = 0; row < text.rows(); ++row) {
+            for (size_t col = 0; col < text.columns(); ++col) {
+                if (text.get<int32_t>(row, col) != tda.get<int32_t>(row, col)
+                    || text.get<uint32_t>(row, col) != tda.get<uint32_t>(row, col)
+                    || text.get<int16_t>(row, col) != tda.get<int16_t>(row, col)
+                    || text.get<float>(row, col) != tda.get<float>(row, col)
+                    || text.get<nw::StringView>(row, col) != tda.get<nw::StringView>(row, col)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    EXPECT_TRUE(matches(feat));
+
+    auto data = nw::ResourceData::from_file("test_data/user/development/feat.2da");
+    const auto hash = nw::StaticTwoDA::source_hash(data);
+    fs::create_directories("tmp");
+    ASSERT_TRUE(feat.write_sidecar("tmp/feat.2dac", hash));
+
+    auto mapped = nw::StaticTwoDA::from_sidecar("tmp/feat.2dac", data.name, hash);
+    ASSERT_TRUE(mapped.is_valid());
+    EXPECT_TRUE(mapped.compiled());
+    EXPECT_EQ(mapped.rows(), text.rows());
+    EXPECT_EQ(mapped.columns(), text.columns());
+    EXPECT_EQ(mapped.column_index("FEAT"), text.column_index("FEAT"));
+    EXPECT_TRUE(matches(mapped));
+
+    // A sidecar built from other source bytes is never used
+    EXPECT_FALSE(nw::StaticTwoDA::from_sidecar("tmp/feat.2dac", data.name, hash + 1).is_valid());
+}
+
 TEST(TwoDA, Parse)
 {
     nw::TwoDA feat(fs::path("test_data/user/development/feat.2da"));
@@ -81,3 +81,113 @@ TEST(KernelEvents, CustomEventsPreserveInsertionOrderAtSameTick)
     EXPECT_EQ(observed[1], 2);
     EXPECT_EQ(observed[2], 3);
 }
+
+TEST(KernelEvents, CancelledEventsDoNotFire)
+{
+    auto& events = nwk::events();
+    events.process_until(std::numeric_limits<uint64_t>::max());
+    events.set_current_tick(0);
+
+    static int deleted = 0;
+    deleted = 0;
+    int fired = 0;
+    auto keep = events.add_custom(nw::ObjectHandle{}, &event_counter_callback, 3, &fired);
+    auto drop = events.add_custom(nw::ObjectHandle{}, &event_counter_callback, 3, &fired,
+        [](void*) { ++deleted; });
+    EXPECT_EQ(events.pending(), 2);
+    EXPECT_TRUE(events.is_pending(drop));
+
+    EXPECT_TRUE(events.cancel(drop));
+    EXPECT_FALSE(events.cancel(drop));
+    EXPECT_FALSE(events.is_pending(drop));
+    EXPECT_EQ(deleted, 1);
+    EXPECT_EQ(events.pending(), 1);
+
+    EXPECT_EQ(events.process_until(3), 1);
+    EXPECT_EQ(fired, 1);
+    EXPECT_FALSE(events.is_pending(keep));
+    EXPECT_FALSE(events.cancel(keep));
+
+    // A handle whose node was reused by a later event stays dead
+    auto reused = events.add_custom(nw::ObjectHandle{}, &event_counter_callback, 1, &fired);
+    EXPECT_EQ(reused.index, keep.index);
+    EXPECT_FALSE(events.cancel(keep));
+    EXPECT_TRUE(events.is_pending(reused));
+    EXPECT_EQ(events.process_until(4), 1);
+    EXPECT_EQ(fired, 2);
+}
+
+TEST(KernelEvents, FarEventsCascadeInOrder)
+{
+    auto& events = nwk::events();
+    events.process_until(std::numeric_limits<uint64_t>::max());
+    events.set_current_tick(0);
+
+    // Spread over several wheel levels, added out of order.
+    std::array<int, 3> observed = {0, 0, 0};
+    std::pair<std::array<int, 3>*, int> p1{&observed, 1};
+    std::pair<std::array<int, 3>*, int> p2{&observed, 2};
+    std::pair<std::array<int, 3>*, int> p3{&observed, 3};
+    events.add_custom(nw::ObjectHandle{}, &event_order_callback, uint64_t(1) << 40, &p3);
+    events.add_custom(nw::ObjectHandle{}, &event_order_callback, 70000, &p2);
+    events.add_custom(nw::ObjectHandle{}, &event_order_callback, 300, &p1);
+    EXPECT_EQ(events.pending(0), 0);
+    EXPECT_EQ(events.pending(1), 1);
+    EXPECT_EQ(events.pending(2), 1);
+    EXPECT_EQ(events.pending(5), 1);
+    EXPECT_EQ(events.occupied_slots(), 3);
+
+    EXPECT_EQ(events.process_until(299), 0);
+    EXPECT_EQ(events.process_until(300), 1);
+    EXPECT_EQ(events.process_until(69999), 0);
+    EXPECT_EQ(events.process_until(70000), 1);
+    EXPECT_EQ(events.process_until((uint64_t(1) << 40) - 1), 0);
+    EXPECT_EQ(events.process_until(uint64_t(1) << 40), 1);
+    EXPECT_EQ(observed[0], 1);
+    EXPECT_EQ(observed[1], 2);
+    EXPECT_EQ(observed[2], 3);
+    EXPECT_EQ(events.pending(), 0);
+    EXPECT_EQ(events.occupied_slots(), 0);
+}
+
+TEST(KernelEvents, SameTickOrderSurvivesCascade)
+{
+    auto& events = nwk::events();
+    events.process_until(std::numeric_limits<uint64_t>::max());
+    events.set_current_tick(0);
+
+    // The first event is added from far away and cascades, the second lands on level 0 directly.
+    std::array<int, 3> observed = {0, 0, 0};
+    std::pair<std::array<int, 3>*, int> p1{&observed, 1};
+    std::pair<std::array<int, 3>*, int> p2{&observed, 2};
+    std::pair<std::array<int, 3>*, int> p3{&observed, 3};
+    events.add_custom(nw::ObjectHandle{}, &event_order_callback, 1000, &p1);
+    events.process_until(900);
+    events.add_custom(nw::ObjectHandle{}, &event_order_callback, 100, &p2);
+    events.add_at(nwk::EventType::custom, nw::ObjectHandle{}, 1000, &p3);
+
+    EXPECT_EQ(events.process_until(1000), 3);
+    EXPECT_EQ(observed[0], 1);
+    EXPECT_EQ(observed[1], 2);
+    EXPECT_EQ(observed[2], 0); // custom events without a callback do nothing
+}
+
+TEST(KernelEvents, EventsBehindTheWheelRunFirst)
+{
+    auto& events = nwk::events();
+    events.process_until(std::numeric_limits<uint64_t>::max());
+    events.set_current_tick(0);
+
+    int fired = 0;
+    events.add_custom(nw::ObjectHandle{}, &event_counter_callback, 500, &fired);
+    EXPECT_EQ(events.process_until(100), 0);
+
+    // Moving the clock back with events pending leaves the wheel where it is.
+    events.set_current_tick(10);
+    events.add_custom(nw::ObjectHandle{}, &event_counter_callback, 5, &fired);
+    EXPECT_EQ(events.process(), 0);
+    EXPECT_EQ(events.process_until(15), 1);
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(events.process_until(500), 1);
+    EXPECT_EQ(fired, 2);
+}
@@ -1,9 +1,19 @@
 #include <gtest/gtest.h>
 
+#include "nw/kernel/EventSystem.hpp"
 #include "nw/kernel/FactionSystem.hpp"
+#include "nw/objects/Creature.hpp"
+#include "nw/objects/ObjectComponentSystem.hpp"
+#include "nw/objects/ObjectManager.hpp"
+#include "nw/serialization/Gff.hpp"
 
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
 #include <limits>
 
+using namespace std::literals;
 namespace nwk = nw::kernel;
 
 TEST(Kernel, FactionSystem)
@@ -49,3 +59,100 @@ TEST(Kernel, FactionSystem)
     EXPECT_EQ(all.size(), 5);
     EXPECT_EQ(all[id4], "Defender");
 }
+
+TEST(Kernel, FactionHostility)
+{
+    auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    ASSERT_TRUE(mod);
+
+    auto& factions = nwk::factions();
+    const uint32_t hostile = factions.faction_id("Hostile");
+    const uint32_t commoner = factions.faction_id("Commoner");
+    const uint32_t defender = factions.faction_id("Defender");
+
+    auto* observer = nwk::objects().load<nw::Creature>("nw_chicken"sv);
+    auto* bandit = nwk::objects().load<nw::Creature>("nw_chicken"sv);
+    auto* villager = nwk::objects().load<nw::Creature>("nw_chicken"sv);
+    ASSERT_TRUE(observer && bandit && villager);
+    auto& components = nwk::objects().components();
+    components.set_faction(observer->handle(), defender);
+    components.set_faction(bandit->handle(), hostile);
+    components.set_faction(villager->handle(), commoner);
+
+    const nw::ObjectHandle invalid;
+    const nw::ObjectHandle targets[] = {bandit->handle(), villager->handle(), observer->handle(), invalid};
+    auto mask = factions.classify_hostility(observer->handle(), targets);
+    EXPECT_EQ(mask.size, 4);
+    EXPECT_TRUE(mask.test(0));
+    EXPECT_FALSE(mask.test(1));
+    EXPECT_FALSE(mask.test(2));
+    EXPECT_FALSE(mask.test(3));
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(mask.test(i), factions.reputation(observer->handle(), targets[i]) <= nwk::FactionSystem::hostile_threshold);
+    }
+
+    // Personal reputation overlays the faction matrix, temporary adjustments decay
+    factions.adjust_personal_reputation(observer->handle(), villager->handle(), -100);
+    factions.set_temporary_reputation(observer->handle(), bandit->handle(), 100, 10);
+    mask = factions.classify_hostility(observer->handle(), targets);
+    EXPECT_TRUE(mask.test(1));
+    EXPECT_FALSE(mask.test(0));
+    EXPECT_EQ(factions.reputation(observer->handle(), bandit->handle()), 100);
+
+    nwk::events().advance(10);
+    mask = factions.classify_hostility(observer->handle(), targets);
+    EXPECT_TRUE(mask.test(0));
+    EXPECT_EQ(factions.prune_personal_reputation(), 1);
+
+    factions.clear_personal_reputation(observer->handle());
+    mask = factions.classify_hostility(observer->handle(), targets);
+    EXPECT_FALSE(mask.test(1));
+    EXPECT_EQ(mask.count(), 1);
+
+    nwk::unload_module();
+}
+
+TEST(Kernel, FactionOfLoadedCreatures)
+{
+    auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    ASSERT_TRUE(mod);
+
+    auto& factions = nwk::factions();
+    const uint32_t hostile = factions.faction_id("Hostile");
+
+    // Loaded creatures are tagged with the FactionID of their blueprint
+    nw::Gff gff("test_data/user/development/pl_agent_001.utc");
+    ASSERT_TRUE(gff.valid());
+    uint16_t faction_id = 0;
+    ASSERT_TRUE(gff.toplevel().get_to("FactionID", faction_id));
+    ASSERT_NE(faction_id, hostile);
+
+    auto* agent = nwk::objects().load_file<nw::Creature>("test_data/user/development/pl_agent_001.utc");
+    auto* ally = nwk::objects().load_file<nw::Creature>("test_data/user/development/pl_agent_001.utc");
+    ASSERT_TRUE(agent && ally);
+    EXPECT_EQ(factions.faction_of(agent->handle()), faction_id);
+
+    // The same creature saved into the Hostile faction loads into it
+    std::filesystem::create_directories("tmp");
+    ASSERT_TRUE(agent->save("tmp/faction_agent.utc.json", "json"));
+    nlohmann::json j;
+    std::ifstream{"tmp/faction_agent.utc.json"} >> j;
+    ASSERT_TRUE(j.contains("nwn1.propsets.CreatureHealth"));
+    j["nwn1.propsets.CreatureHealth"]["faction_id"] = hostile;
+    std::ofstream{"tmp/faction_hostile.utc.json"} << j;
+
+    auto* bandit = nwk::objects().load_file<nw::Creature>("tmp/faction_hostile.utc.json");
+    ASSERT_TRUE(bandit);
+    EXPECT_EQ(factions.faction_of(bandit->handle()), hostile);
+
+    // The Hostile faction dislikes everyone, members of one faction are not hostile to each other
+    const nw::ObjectHandle targets[] = {agent->handle(), ally->handle()};
+    auto mask = factions.classify_hostility(bandit->handle(), targets);
+    EXPECT_TRUE(mask.test(0));
+    EXPECT_TRUE(mask.test(1));
+
+    mask = factions.classify_hostility(agent->handle(), std::span(targets + 1, 1));
+    EXPECT_FALSE(mask.test(0));
+
+    nwk::unload_module();
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <nw/kernel/JobSystem.hpp>
+#include <nw/kernel/Memory.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace nwk = nw::kernel;
+
+TEST(KernelJobs, InlineWithoutWorkers)
+{
+    auto& jobs = nwk::jobs();
+    EXPECT_EQ(jobs.worker_count(), 0);
+
+    nw::Vector<int> order;
+    nwk::JobGroup group;
+    for (int i = 0; i < 4; ++i) {
+        jobs.run(group, [&order, i]() { order.push_back(i); });
+    }
+    EXPECT_TRUE(group.done());
+
+    nwk::JobGroup next;
+    jobs.then(group, next, [&order]() { order.push_back(4); });
+    jobs.run(next, [&order]() { order.push_back(5); }, nwk::JobAffinity::main_thread);
+    jobs.wait(next);
+    EXPECT_EQ(order, (nw::Vector<int>{0, 1, 2, 3, 4, 5}));
+
+    order.clear();
+    jobs.parallel_for(3, [&order](size_t i) { order.push_back(int(i)); });
+    EXPECT_EQ(order, (nw::Vector<int>{0, 1, 2}));
+    EXPECT_EQ(nwk::JobSystem::scratch(), nwk::tls_scratch());
+}
+
+TEST(KernelJobs, Workers)
+{
+    nwk::JobSystem jobs{nwk::global_allocator(), 4};
+    EXPECT_EQ(jobs.worker_count(), 4);
+
+    nw::Vector<uint64_t> values(10000);
+    std::iota(values.begin(), values.end(), 1);
+    jobs.parallel_for(std::span<uint64_t>{values}, [](uint64_t& value) { value *= 2; }, 64);
+    EXPECT_EQ(std::accumulate(values.begin(), values.end(), uint64_t(0)), uint64_t(10000) * 10001);
+
+    std::atomic<int> counter{0};
+    nwk::JobGroup group;
+    for (int i = 0; i < 100; ++i) {
+        jobs.run(group, [&jobs, &counter]() {
+            auto scratch = nwk::JobSystem::scratch();
+            EXPECT_TRUE(scratch);
+            EXPECT_NE(scratch, nwk::tls_scratch());
+            scratch->alloc_pod<int>();
+
+            // Nested groups are waited on by the worker, which runs jobs in the meantime
+            nwk::JobGroup nested;
+            jobs.run(nested, [&counter]() { ++counter; });
+            jobs.wait(nested);
+            ++counter;
+        });
+    }
+
+    // Continuations only run once the whole group is done, main thread jobs only on the main thread
+    nwk::JobGroup next;
+    int seen = 0;
+    std::thread::id thread;
+    jobs.then(group, next, [&]() {
+        seen = counter;
+        thread = std::this_thread::get_id();
+    },
+        nwk::JobAffinity::main_thread);
+    jobs.wait(next);
+    EXPECT_EQ(seen, 200);
+    EXPECT_EQ(thread, std::this_thread::get_id());
+    EXPECT_TRUE(group.done());
+
+    nwk::JobGroup failing;
+    jobs.run(failing, []() { throw std::runtime_error("job failed"); });
+    EXPECT_THROW(jobs.wait(failing), std::runtime_error);
+
+    auto stats = jobs.stats();
+    EXPECT_EQ(stats["job system service"]["workers"], 4);
+}
@@ -64,6 +64,38 @@ TEST(Kernel, LoadModuleZip)
     EXPECT_TRUE(cre);
 }
 
+TEST(Kernel, LoadModuleParallelAreas)
+{
+    nw::kernel::config().set_area_load_mode(nw::AreaLoadMode::parallel);
+    auto mod = nw::kernel::load_module("test_data/user/modules/module_as_dir/");
+    nw::kernel::config().set_area_load_mode(nw::AreaLoadMode::serial);
+    ASSERT_TRUE(mod);
+    EXPECT_EQ(mod->area_count(), 1);
+    auto area = mod->get_area(0);
+    ASSERT_TRUE(area);
+    EXPECT_EQ(area->resref, "test_area");
+    EXPECT_TRUE(area->creatures.size() > 0);
+    expect_creature_hp_max(area->creatures[0], 110);
+}
+
+TEST(Kernel, LoadModuleLazyAreas)
+{
+    nw::kernel::config().set_area_load_mode(nw::AreaLoadMode::lazy);
+    auto mod = nw::kernel::load_module("test_data/user/modules/module_as_dir/");
+    nw::kernel::config().set_area_load_mode(nw::AreaLoadMode::serial);
+    ASSERT_TRUE(mod);
+    EXPECT_EQ(mod->area_count(), 1);
+    EXPECT_EQ(mod->get_area_resref(0), "test_area");
+    EXPECT_EQ(static_cast<const nw::Module*>(mod)->get_area(0), nullptr);
+
+    auto area = mod->get_area(0);
+    ASSERT_TRUE(area);
+    EXPECT_EQ(area->resref, "test_area");
+    EXPECT_EQ(mod->get_area(0), area);
+    EXPECT_TRUE(area->creatures.size() > 0);
+    expect_creature_hp_max(area->creatures[0], 110);
+}
+
 TEST(Kernel, LoadMissingModule)
 {
     auto mod = nw::kernel::load_module("test_data/user/modules/does_not_exist.mod");
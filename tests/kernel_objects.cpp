@@ -17,6 +17,7 @@
 #include <nw/profiles/nwn1/Profile.hpp>
 #include <nw/profiles/nwn1/constants.hpp>
 #include <nw/profiles/nwn1/scriptbridge.hpp>
+#include <nw/resources/ResourceManager.hpp>
 #include <nw/serialization/GffBuilder.hpp>
 #include <nw/smalls/runtime.hpp>
 
@@ -107,6 +108,18 @@ void inventory_destroy_probe(nw::ObjectBase* obj)
 
 } // namespace
 
+TEST(ObjectSystem, ServiceLookupBySlot)
+{
+    auto* objects = nwk::services().get_mut<nw::ObjectManager>();
+    ASSERT_NE(objects, nullptr);
+    EXPECT_EQ(objects, nwk::services().find(nw::ObjectManager::type_index));
+    EXPECT_EQ(objects, &nwk::objects());
+    EXPECT_EQ(nwk::services().get<nw::ObjectManager>(), objects);
+    EXPECT_NE(nwk::services().slot<nw::ObjectManager>(), nwk::services().slot<nw::ResourceManager>());
+    EXPECT_LT(nwk::services().slot<nw::ObjectManager>(), nw::kernel::Services::max_services);
+    EXPECT_EQ(nwk::services().get_mut<nw::ResourceManager>(), &nwk::resman());
+}
+
 TEST(ObjectSystem, LoadCreature)
 {
     auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
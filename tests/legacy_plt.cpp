@@ -16,11 +16,11 @@ nw::ResourceData make_plt(uint32_t width, uint32_t height, std::initializer_list
 {
     nw::ResourceData data;
     data.bytes.resize(24 + pixels.size() * sizeof(nw::PltPixel));
-    std::memcpy(data.bytes.data(), "PLT V1  ", 8);
-    std::memcpy(data.bytes.data() + 16, &width, sizeof(width));
-    std::memcpy(data.bytes.data() + 20, &height, sizeof(height));
+    std::memcpy(data.bytes.mutable_data(), "PLT V1  ", 8);
+    std::memcpy(data.bytes.mutable_data() + 16, &width, sizeof(width));
+    std::memcpy(data.bytes.mutable_data() + 20, &height, sizeof(height));
     if (pixels.size() != 0) {
-        std::memcpy(data.bytes.data() + 24, pixels.begin(), pixels.size() * sizeof(nw::PltPixel));
+        std::memcpy(data.bytes.mutable_data() + 24, pixels.begin(), pixels.size() * sizeof(nw::PltPixel));
     }
     return data;
 }
@@ -20,7 +20,7 @@ constexpr size_t mdl_pointer_base = 12;
 template <typename T>
 void write_at(nw::ResourceData& data, size_t offset, const T& value)
 {
-    std::memcpy(data.bytes.data() + offset, &value, sizeof(T));
+    std::memcpy(data.bytes.mutable_data() + offset, &value, sizeof(T));
 }
 
 template <typename T>
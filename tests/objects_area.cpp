@@ -1,18 +1,25 @@
 #include <gtest/gtest.h>
 
+#include "nwn1_test_builders.hpp"
+
 #include <nw/objects/Area.hpp>
+#include <nw/objects/AreaSpatialIndex.hpp>
 #include <nw/objects/Creature.hpp>
 #include <nw/objects/Location.hpp>
 #include <nw/objects/ObjectManager.hpp>
+#include <nw/objects/ObjectSnapshot.hpp>
 #include <nw/profiles/nwn1/constants.hpp>
 #include <nw/profiles/nwn1/scriptbridge.hpp>
+#include <nw/rules/effects.hpp>
 #include <nw/serialization/Gff.hpp>
 #include <nw/serialization/GffBuilder.hpp>
 #include <nw/serialization/gff_conversion.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 
@@ -181,6 +188,229 @@ TEST(Area, JsonSerializesSubobjectsAsPropsetsComponents)
     EXPECT_EQ(count_json_comments(roundtrip_json), count_json_comments(j));
 }
 
+TEST(Area, SnapshotRoundTripMatchesJson)
+{
+    auto ent = nw::kernel::objects().make<nw::Area>();
+    nw::Gff are{"test_data/user/development/test_area.are"};
+    nw::Gff git{"test_data/user/development/test_area.git"};
+    nw::Gff gic{"test_data/user/development/test_area.gic"};
+    ASSERT_TRUE(are.valid() && git.valid() && gic.valid());
+    deserialize(ent, are.toplevel(), git.toplevel(), gic.toplevel());
+    ASSERT_FALSE(ent->creatures.empty());
+
+    auto& components = nw::kernel::objects().components();
+    const auto creature = ent->creatures[0]->handle();
+    ASSERT_TRUE(components.set_velocity(creature, glm::vec3{1.0f, 2.0f, 3.0f}));
+    ASSERT_TRUE(components.set_vitals(creature, 7, 12));
+    ASSERT_TRUE(nw::kernel::effects().apply_to(ent->creatures[0],
+        nwn1::effect_ability_modifier(nwn1::ability_strength, 5)));
+
+    const auto object_lists = [](const nw::Area* area) {
+        nlohmann::json j;
+        nw::serialize(area, j);
+        nlohmann::json result;
+        for (const char* list : {
+                 "creatures",
+                 "doors",
+                 "encounters",
+                 "items",
+                 "placeables",
+                 "sounds",
+                 "stores",
+                 "triggers",
+                 "waypoints",
+             }) {
+            result[list] = j.at(list);
+        }
+        return result;
+    };
+    const auto expected = object_lists(ent);
+
+    auto bytes = nw::AreaSnapshot::write(ent);
+    ASSERT_GT(bytes.size(), 0);
+
+    // Restoring into the snapshotted area reproduces every object exactly
+    ASSERT_TRUE(nw::AreaSnapshot::restore(ent, std::span<const uint8_t>{bytes.data(), bytes.size()}));
+    EXPECT_EQ(object_lists(ent), expected);
+
+    fs::create_directories("tmp");
+    ASSERT_TRUE(nw::AreaSnapshot::write(ent, "tmp/test_area.snapshot"));
+    ASSERT_TRUE(nw::AreaSnapshot::restore(ent, "tmp/test_area.snapshot"));
+    EXPECT_EQ(object_lists(ent), expected);
+
+    // Restoring into another area moves locations there
+    auto restored = nw::kernel::objects().make<nw::Area>();
+    ASSERT_TRUE(nw::AreaSnapshot::restore(restored, std::span<const uint8_t>{bytes.data(), bytes.size()}));
+    ASSERT_EQ(restored->creatures.size(), ent->creatures.size());
+
+    const auto restored_creature = restored->creatures[0]->handle();
+    ASSERT_NE(components.find_spatial(restored_creature), nullptr);
+    EXPECT_EQ(components.find_spatial(restored_creature)->area, restored->handle().id);
+    EXPECT_EQ(components.find_spatial(restored_creature)->velocity, glm::vec3(1.0f, 2.0f, 3.0f));
+    ASSERT_NE(components.find_vitals(restored_creature), nullptr);
+    EXPECT_EQ(components.find_vitals(restored_creature)->hp_current, 7);
+    EXPECT_EQ(components.find_vitals(restored_creature)->hp_max, 12);
+
+    const auto restored_effect = std::find_if(restored->creatures[0]->effects().begin(),
+        restored->creatures[0]->effects().end(), [](const nw::EffectHandle& it) {
+            return it.type == nwn1::effect_type_ability_increase && it.subtype == *nwn1::ability_strength;
+        });
+    ASSERT_NE(restored_effect, restored->creatures[0]->effects().end());
+    EXPECT_EQ(restored_effect->effect->get_int(0), 5);
+
+    // Object IDs held by locals and effect creators follow the objects they refer to
+    auto* locals = components.get_or_create_locals(ent->creatures[0]->handle());
+    ASSERT_NE(locals, nullptr);
+    locals->set_object("self", ent->creatures[0]->handle().id);
+    auto* effect = nwn1::effect_ability_modifier(nwn1::ability_dexterity, 2);
+    ASSERT_NE(effect, nullptr);
+    effect->handle().creator = ent->creatures[0]->handle();
+    ASSERT_TRUE(nw::kernel::effects().apply_to(ent->creatures[0], effect));
+
+    bytes = nw::AreaSnapshot::write(ent);
+    ASSERT_TRUE(nw::AreaSnapshot::restore(restored, std::span<const uint8_t>{bytes.data(), bytes.size()}));
+    const auto remapped = restored->creatures[0]->handle();
+    EXPECT_NE(remapped, ent->creatures[0]->handle());
+    ASSERT_NE(components.find_locals(remapped), nullptr);
+    EXPECT_EQ(components.find_locals(remapped)->get_object("self"), remapped.id);
+    const auto remapped_effect = std::find_if(restored->creatures[0]->effects().begin(),
+        restored->creatures[0]->effects().end(), [](const nw::EffectHandle& it) {
+            return it.type == nwn1::effect_type_ability_increase && it.subtype == *nwn1::ability_dexterity;
+        });
+    ASSERT_NE(remapped_effect, restored->creatures[0]->effects().end());
+    EXPECT_EQ(remapped_effect->effect->handle().creator, remapped);
+
+    // Snapshots from an incompatible build are rejected without touching the area
+    bytes.mutable_data()[4] = 0xFF;
+    EXPECT_FALSE(nw::AreaSnapshot::restore(restored, std::span<const uint8_t>{bytes.data(), bytes.size()}));
+    ASSERT_EQ(restored->creatures.size(), ent->creatures.size());
+    EXPECT_EQ(restored->creatures[0]->handle(), remapped);
+
+    // A snapshot that fails partway leaves the area as it was, here the last record is cut to one byte
+    bytes = nw::AreaSnapshot::write(ent);
+    uint32_t record_count = 0;
+    std::memcpy(&record_count, bytes.data() + 16, sizeof(record_count));
+    ASSERT_GT(record_count, 1);
+    const uint64_t truncated = 1;
+    std::memcpy(bytes.mutable_data() + 40 + (record_count - 1) * 24 + 16, &truncated, sizeof(truncated));
+    EXPECT_FALSE(nw::AreaSnapshot::restore(restored, std::span<const uint8_t>{bytes.data(), bytes.size()}));
+    ASSERT_EQ(restored->creatures.size(), ent->creatures.size());
+    EXPECT_EQ(restored->creatures[0]->handle(), remapped);
+}
+
+TEST(Area, SpatialIndexQueries)
+{
+    nw::AreaSpatialIndex index;
+    const auto handle = [](uint32_t id, nw::ObjectType type) {
+        return nw::ObjectHandle{static_cast<nw::ObjectID>(id), type};
+    };
+
+    // A 20 x 20 grid of creatures one meter apart, every fourth one a placeable in faction 1.
+    for (uint32_t i = 0; i < 400; ++i) {
+        const auto type = i % 4 == 0 ? nw::ObjectType::placeable : nw::ObjectType::creature;
+        index.update(handle(i, type), glm::vec3{float(i % 20), float(i / 20), 0.0f}, i % 4 == 0 ? 1 : 0);
+    }
+    EXPECT_EQ(index.size(), 400);
+
+    nw::Vector<nw::ObjectHandle> out;
+    index.query_radius({0.0f, 0.0f, 0.0f}, 1.5f, {}, out);
+    EXPECT_EQ(out.size(), 4); // (0,0) (1,0) (0,1) (1,1)
+
+    out.clear();
+    nw::SpatialFilter placeables;
+    placeables.types = nw::SpatialFilter::type_bit(nw::ObjectType::placeable);
+    index.query_box({0.0f, 0.0f, -1.0f}, {19.0f, 19.0f, 1.0f}, placeables, out);
+    EXPECT_EQ(out.size(), 100);
+
+    out.clear();
+    nw::SpatialFilter faction;
+    faction.faction = 1;
+    index.query_radius({10.0f, 10.0f, 0.0f}, 100.0f, faction, out);
+    EXPECT_EQ(out.size(), 100);
+
+    // Looking down +x from the origin with a narrow cone only sees the first row.
+    out.clear();
+    index.query_cone({0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, 0.01f, 5.5f, {}, out);
+    EXPECT_EQ(out.size(), 6);
+
+    out.clear();
+    nw::SpatialFilter exclude;
+    exclude.exclude = handle(21, nw::ObjectType::creature);
+    index.query_nearest({1.0f, 1.0f, 0.0f}, 3, exclude, out);
+    ASSERT_EQ(out.size(), 3);
+    for (auto obj : out) {
+        EXPECT_TRUE(obj.id == nw::ObjectID(1) || obj.id == nw::ObjectID(20)
+            || obj.id == nw::ObjectID(22) || obj.id == nw::ObjectID(41));
+    }
+
+    out.clear();
+    index.query_nearest({100.0f, 100.0f, 0.0f}, 1, {}, out);
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].id, nw::ObjectID(399));
+
+    out.clear();
+    index.query_nearest({100.0f, 100.0f, 0.0f}, 1, {}, out, 10.0f);
+    EXPECT_TRUE(out.empty());
+
+    // Moving and removing keeps cells coherent
+    index.update(handle(0, nw::ObjectType::placeable), {50.0f, 50.0f, 0.0f}, 1);
+    EXPECT_TRUE(index.remove(handle(399, nw::ObjectType::creature)));
+    EXPECT_FALSE(index.remove(handle(399, nw::ObjectType::creature)));
+    out.clear();
+    index.query_radius({50.0f, 50.0f, 0.0f}, 1.0f, {}, out);
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].id, nw::ObjectID(0));
+    out.clear();
+    index.query_radius({0.0f, 0.0f, 0.0f}, 0.5f, {}, out);
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(index.size(), 399);
+}
+
+TEST(Area, SpatialIndexTracksObjects)
+{
+    auto ent = nw::kernel::objects().make<nw::Area>();
+    nw::Gff are{"test_data/user/development/test_area.are"};
+    nw::Gff git{"test_data/user/development/test_area.git"};
+    nw::Gff gic{"test_data/user/development/test_area.gic"};
+    ASSERT_TRUE(are.valid() && git.valid() && gic.valid());
+    deserialize(ent, are.toplevel(), git.toplevel(), gic.toplevel());
+    ASSERT_FALSE(ent->creatures.empty());
+
+    auto& components = nw::kernel::objects().components();
+    const auto* index = components.area_spatial_index(ent->handle().id);
+    ASSERT_NE(index, nullptr);
+    const size_t count = ent->creatures.size() + ent->doors.size() + ent->encounters.size() + ent->items.size()
+        + ent->placeables.size() + ent->sounds.size() + ent->stores.size() + ent->triggers.size()
+        + ent->waypoints.size();
+    EXPECT_EQ(index->size(), count);
+
+    const auto creature = ent->creatures[0]->handle();
+    ASSERT_TRUE(components.set_position(creature, glm::vec3{-500.0f, -500.0f, 0.0f}));
+    nw::Vector<nw::ObjectHandle> out;
+    index->query_nearest({-500.0f, -500.0f, 0.0f}, 1, {}, out);
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0], creature);
+
+    ASSERT_TRUE(components.set_faction(creature, 7));
+    nw::SpatialFilter faction;
+    faction.faction = 7;
+    out.clear();
+    index->query_radius({0.0f, 0.0f, 0.0f}, 10000.0f, faction, out);
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0], creature);
+
+    ASSERT_TRUE(components.set_area(creature, nw::object_invalid));
+    EXPECT_EQ(index->size(), count - 1);
+    EXPECT_FALSE(index->contains(creature));
+
+    ent->clear();
+    EXPECT_EQ(index->size(), 0);
+
+    const auto area_id = ent->handle().id;
+    nw::kernel::objects().destroy(ent->handle());
+    EXPECT_EQ(components.area_spatial_index(area_id), nullptr);
+}
+
 TEST(Location, DeserializeGitBareCoordinates)
 {
     fs::create_directories("tmp");
@@ -17,6 +17,7 @@
 #include <nw/rules/combat_scheduler.hpp>
 #include <nw/rules/effects.hpp>
 #include <nw/rules/feats.hpp>
+#include <nw/serialization/Gff.hpp>
 #include <nw/serialization/GffBuilder.hpp>
 #include <nw/smalls/Array.hpp>
 #include <nw/smalls/Smalls.hpp>
@@ -56,6 +57,18 @@ void capture_effect_batch(nw::ObjectBase*, const nw::Vector<nw::Effect*>& effect
     g_effect_batch_is_apply = is_apply;
 }
 
+bool g_refuse_effect_removal = true;
+
+bool apply_refusable_effect(nw::ObjectBase*, const nw::Effect*)
+{
+    return true;
+}
+
+bool remove_refusable_effect(nw::ObjectBase*, const nw::Effect*)
+{
+    return !g_refuse_effect_removal;
+}
+
 bool test_has_effect_applied(const nw::ObjectBase* obj, nw::EffectType type, int subtype = -1)
 {
     if (!obj || type == nw::EffectType::invalid()) { return false; }
@@ -1312,6 +1325,130 @@ TEST(Creature, AutoAttackCanRetargetAndStop)
     EXPECT_FALSE(nw::combat::stop_auto_attack(attacker));
 }
 
+TEST(Creature, AutoAttacksDueOnATickResolveAsOneRound)
+{
+    auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    EXPECT_TRUE(mod);
+
+    auto attacker1 = nwk::objects().load_file<nw::Creature>("test_data/user/development/pl_agent_001.utc");
+    auto attacker2 = nwk::objects().load_file<nw::Creature>("test_data/user/development/drorry.utc");
+    auto target = nwk::objects().load_file<nw::Creature>("test_data/user/development/nw_chicken.utc");
+    ASSERT_TRUE(attacker1);
+    ASSERT_TRUE(attacker2);
+    ASSERT_TRUE(target);
+
+    auto& events = nwk::events();
+    events.process_until(std::numeric_limits<uint64_t>::max());
+    events.set_current_tick(0);
+    auto active = nw::combat::auto_attack_count();
+
+    EXPECT_TRUE(nw::combat::start_auto_attack(attacker1, target, 1, 60));
+    EXPECT_TRUE(nw::combat::start_auto_attack(attacker2, target, 1, 60));
+    EXPECT_EQ(nw::combat::auto_attack_count(), active + 2);
+    EXPECT_EQ(events.pending(), 1u);
+
+    events.advance(1);
+    EXPECT_EQ(events.process(), 1);
+    EXPECT_EQ(nw::combat::auto_attack_count(), active + 2);
+    EXPECT_GE(events.pending(), 1u);
+
+    // Stopping reclaims the entry, stopping everyone drops the pending rounds.
+    EXPECT_TRUE(nw::combat::stop_auto_attack(attacker1));
+    EXPECT_EQ(nw::combat::auto_attack_count(), active + 1);
+    EXPECT_TRUE(nw::combat::stop_auto_attack(attacker2));
+    EXPECT_EQ(nw::combat::auto_attack_count(), active);
+    EXPECT_EQ(events.pending(), 0u);
+}
+
+TEST(Creature, CombatSchedulerResolveRound)
+{
+    auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    EXPECT_TRUE(mod);
+
+    auto attacker1 = nwk::objects().load_file<nw::Creature>("test_data/user/development/pl_agent_001.utc");
+    auto attacker2 = nwk::objects().load_file<nw::Creature>("test_data/user/development/drorry.utc");
+    auto target = nwk::objects().load_file<nw::Creature>("test_data/user/development/nw_chicken.utc");
+    ASSERT_TRUE(attacker1);
+    ASSERT_TRUE(attacker2);
+    ASSERT_TRUE(target);
+
+    nw::Creature* attackers[] = {attacker1, nullptr, attacker2};
+    nw::ObjectBase* targets[] = {target, target, target};
+    nw::Vector<nw::AttackData> results;
+    EXPECT_EQ(nw::combat::resolve_round(attackers, targets, &results), 2u);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].attacker, attacker1);
+    EXPECT_EQ(results[1].attacker, attacker2);
+    EXPECT_EQ(results[1].target, target);
+    EXPECT_LE(static_cast<int>(results[0].result), static_cast<int>(nw::AttackResult::miss_by_roll));
+
+    EXPECT_EQ(nw::combat::resolve_round(std::span(attackers, 2), targets), 0u);
+}
+
+TEST(Creature, CombatSchedulerResolveRoundSkipsKilledTarget)
+{
+    auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    EXPECT_TRUE(mod);
+
+    auto attacker1 = nwk::objects().load_file<nw::Creature>("test_data/user/development/pl_agent_001.utc");
+    auto attacker2 = nwk::objects().load_file<nw::Creature>("test_data/user/development/drorry.utc");
+    auto target = nwk::objects().load_file<nw::Creature>("test_data/user/development/nw_chicken.utc");
+    ASSERT_TRUE(attacker1);
+    ASSERT_TRUE(attacker2);
+    ASSERT_TRUE(target);
+
+    auto& rt = nw::kernel::runtime();
+    auto* script = rt.load_module_from_source("test.custom_combat_policy_killing_blow", R"(
+        from nwn1.combat_primitives import { AttackData };
+        import core.creature as NativeCreature;
+        import nwn1.combat as Combat;
+
+        fn resolve_attack(attacker: Creature, target: object): AttackData {
+            var data = Combat.resolve_attack(attacker, target);
+            var cre = target as Creature;
+            NativeCreature.set_vitals(cre, 0, NativeCreature.get_vitals_hp_max(cre));
+            return data;
+        }
+    )");
+    ASSERT_NE(script, nullptr);
+    ASSERT_EQ(script->errors(), 0);
+
+    auto& components = nwk::objects().components();
+    const auto* vitals = components.find_vitals(target->handle());
+    ASSERT_TRUE(vitals);
+    const int hp_max = vitals->hp_max;
+    ASSERT_TRUE(components.set_vitals(target->handle(), hp_max, hp_max));
+    EXPECT_FALSE(nw::combat::target_is_dead(target));
+
+    // The first attacker kills the target, the second must not swing at the corpse.
+    nwk::config().set_combat_policy_module("test.custom_combat_policy_killing_blow");
+    nw::Creature* attackers[] = {attacker1, attacker2};
+    nw::ObjectBase* targets[] = {target, target};
+    nw::Vector<nw::AttackData> results;
+    EXPECT_EQ(nw::combat::resolve_round(attackers, targets, &results), 1u);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].attacker, attacker1);
+    EXPECT_TRUE(nw::combat::target_is_dead(target));
+
+    // Auto attacks at a target killed during the round are reclaimed rather than rescheduled.
+    ASSERT_TRUE(components.set_vitals(target->handle(), hp_max, hp_max));
+    auto& events = nwk::events();
+    events.process_until(std::numeric_limits<uint64_t>::max());
+    events.set_current_tick(0);
+    auto active = nw::combat::auto_attack_count();
+    EXPECT_TRUE(nw::combat::start_auto_attack(attacker1, target, 1, 60));
+    EXPECT_TRUE(nw::combat::start_auto_attack(attacker2, target, 1, 60));
+    events.advance(1);
+    EXPECT_EQ(events.process(), 1);
+    EXPECT_EQ(nw::combat::auto_attack_count(), active);
+    EXPECT_EQ(events.pending(), 0u);
+    nwk::config().set_combat_policy_module("nwn1.combat");
+
+    // The batched policy entry point re-checks the target before every swing too.
+    EXPECT_EQ(nw::combat::resolve_round(attackers, targets, &results), 0u);
+    EXPECT_TRUE(results.empty());
+}
+
 TEST(Creature, BaseAttackBonus)
 {
     auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
@@ -1913,6 +2050,130 @@ TEST(Creature, EffectsBatchCallback)
     effects.set_event_batch_callback({});
 }
 
+TEST(Creature, EffectsExpire)
+{
+    auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    EXPECT_TRUE(mod);
+
+    auto obj = nwk::objects().load_file<nw::Creature>("test_data/user/development/test_creature.utc");
+    ASSERT_TRUE(obj);
+    auto chicken = nwk::objects().load_file<nw::Creature>("test_data/user/development/nw_chicken.utc");
+    ASSERT_TRUE(chicken);
+
+    auto& effects = nwk::effects();
+    g_effect_batch_types.clear();
+    effects.set_event_batch_callback(capture_effect_batch);
+
+    auto* haste = nwn1::effect_haste();
+    auto* temp_hp = nwn1::effect_hitpoints_temporary(5);
+    auto* permanent = nwn1::effect_hitpoints_temporary(3);
+    ASSERT_TRUE(haste && temp_hp && permanent);
+    haste->expire_tick = 10;
+    temp_hp->expire_tick = 20;
+    EXPECT_EQ(effects.apply_to(obj, nw::Vector<nw::Effect*>{haste, temp_hp, permanent}), 3);
+    EXPECT_EQ(effects.expiring(), 2);
+    EXPECT_EQ(effects.next_expiry(), 10);
+
+    // Early removal cancels expiry
+    auto* early = nwn1::effect_haste();
+    ASSERT_TRUE(early);
+    early->expire_tick = 10;
+    EXPECT_TRUE(effects.apply_to(chicken, early));
+    EXPECT_EQ(effects.expiring(), 3);
+    EXPECT_TRUE(effects.remove_from(chicken, early));
+    effects.destroy(early);
+    EXPECT_EQ(effects.expiring(), 2);
+
+    EXPECT_EQ(effects.expire(9), 0);
+    EXPECT_EQ(obj->effects().size(), 3);
+
+    g_effect_batch_types.clear();
+    EXPECT_EQ(effects.expire(15), 1);
+    ASSERT_EQ(g_effect_batch_types.size(), 1);
+    EXPECT_EQ(g_effect_batch_types[0], nwn1::effect_type_haste);
+    EXPECT_FALSE(g_effect_batch_is_apply);
+    EXPECT_EQ(obj->effects().size(), 2);
+    EXPECT_EQ(effects.next_expiry(), 20);
+
+    EXPECT_EQ(effects.expire(100), 1);
+    EXPECT_EQ(obj->effects().size(), 1);
+    EXPECT_EQ(effects.expiring(), 0);
+    EXPECT_EQ(effects.next_expiry(), std::numeric_limits<uint64_t>::max());
+
+    EXPECT_TRUE(effects.remove_from(obj, permanent));
+    effects.destroy(permanent);
+    effects.set_event_batch_callback({});
+
+    // A refused removal keeps the effect applied and due again on the next tick
+    const auto refusable = nw::EffectType::make(1000);
+    effects.add(refusable, apply_refusable_effect, remove_refusable_effect);
+    for (bool destroy : {true, false}) {
+        g_refuse_effect_removal = true;
+        auto* refused = effects.create(refusable);
+        ASSERT_TRUE(refused);
+        refused->expire_tick = 200;
+        ASSERT_TRUE(effects.apply_to(obj, refused));
+        EXPECT_EQ(effects.expire(200, destroy), 0);
+        EXPECT_EQ(obj->effects().size(), 1);
+        EXPECT_EQ(effects.next_expiry(), 201);
+
+        g_refuse_effect_removal = false;
+        EXPECT_EQ(effects.expire(201, destroy), 1);
+        EXPECT_EQ(obj->effects().size(), 0);
+        EXPECT_EQ(effects.expiring(), 0);
+        if (!destroy) { effects.destroy(refused); }
+    }
+}
+
+TEST(Creature, EffectsExpireFromDuration)
+{
+    auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
+    EXPECT_TRUE(mod);
+
+    auto obj = nwk::objects().load_file<nw::Creature>("test_data/user/development/test_creature.utc");
+    ASSERT_TRUE(obj);
+    auto copy = nwk::objects().load_file<nw::Creature>("test_data/user/development/test_creature.utc");
+    ASSERT_TRUE(copy);
+
+    auto& events = nwk::events();
+    events.process_until(std::numeric_limits<uint64_t>::max());
+    events.set_current_tick(0);
+
+    auto& effects = nwk::effects();
+    const size_t base_effects = obj->effects().size();
+    auto* haste = nwn1::effect_haste();
+    ASSERT_TRUE(haste);
+    haste->duration = 2.0f;
+    ASSERT_TRUE(effects.apply_to(obj, haste));
+    const uint64_t ticks = 2 * nwk::config().options().ticks_per_second;
+    EXPECT_EQ(haste->expire_tick, ticks);
+    EXPECT_EQ(effects.next_expiry(), ticks);
+
+    // Persisted with the ticks it has left
+    events.advance(ticks / 2);
+    fs::create_directories("tmp");
+    nw::GffBuilder out{"UTC"};
+    ASSERT_TRUE(effects.serialize_effects(obj, out.top));
+    out.build();
+    ASSERT_TRUE(out.write_to("tmp/effects_expire_from_duration.gff"));
+    nw::Gff in{"tmp/effects_expire_from_duration.gff"};
+    ASSERT_TRUE(in.valid());
+    const size_t copy_effects = copy->effects().size();
+    EXPECT_EQ(effects.deserialize_effects(copy, in.toplevel()), 1u);
+    ASSERT_EQ(copy->effects().size(), copy_effects + 1);
+    EXPECT_EQ(effects.expiring(), 2u);
+
+    // The event system drives expiry, nothing calls expire directly
+    events.advance(ticks / 2 - 1);
+    events.process();
+    EXPECT_EQ(obj->effects().size(), base_effects + 1);
+    events.advance(1);
+    events.process();
+    EXPECT_EQ(obj->effects().size(), base_effects);
+    EXPECT_EQ(copy->effects().size(), copy_effects);
+    EXPECT_EQ(effects.expiring(), 0u);
+}
+
 TEST(Creature, Casting)
 {
     auto mod = nwk::load_module("test_data/user/modules/DockerDemo.mod");
@@ -815,6 +815,45 @@ TEST(Item, LocalVariables)
     EXPECT_EQ(locals->size(), 0);
 }
 
+TEST(Item, LocalVariablesByKey)
+{
+    const nw::LocalKey count{"lv_key_count"};
+    EXPECT_TRUE(count.valid());
+    EXPECT_EQ(count.name(), "lv_key_count");
+    EXPECT_EQ(nw::LocalKey::find("lv_key_count"), count);
+    EXPECT_FALSE(nw::LocalKey::find("lv_key_never_set").valid());
+
+    nw::LocalData locals;
+    locals.set_int(count, 3);
+    locals.set_string(count, "a string long enough to need its own allocation");
+    EXPECT_EQ(locals.get_int("lv_key_count"), 3);
+    EXPECT_EQ(locals.get_string(count), "a string long enough to need its own allocation");
+    EXPECT_EQ(locals.size(), 2);
+    EXPECT_TRUE(locals.contains(count, nw::LocalVarType::integer));
+    EXPECT_FALSE(locals.contains(count, nw::LocalVarType::float_));
+    EXPECT_EQ(locals.get_float(nw::LocalKey{}), 0.0f);
+    EXPECT_GT(locals.memory_usage(), 0);
+
+    locals.set_float("lv_key_a", 2.5f);
+    auto entries = locals.entries();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].first, "lv_key_a");
+    EXPECT_EQ(entries[1].first, "lv_key_count");
+    EXPECT_TRUE(entries[1].second.flags.test(nw::LocalVarType::integer));
+    EXPECT_TRUE(entries[1].second.flags.test(nw::LocalVarType::string));
+    EXPECT_EQ(entries[1].second.integer, 3);
+
+    nw::LocalData parsed;
+    EXPECT_TRUE(parsed.from_json(locals.to_json(nw::SerializationProfile::any)));
+    EXPECT_EQ(parsed.size(), 3);
+    EXPECT_EQ(parsed.get_int(count), 3);
+    EXPECT_EQ(parsed.get_float("lv_key_a"), 2.5f);
+
+    locals.delete_int(count);
+    EXPECT_EQ(locals.get_int(count), 0);
+    EXPECT_EQ(locals.size(), 2);
+}
+
 TEST(Item, GffDeserializeLayered)
 {
     auto ent = nw::kernel::objects().load_file<nw::Item>("test_data/user/development/wduersc004.uti");
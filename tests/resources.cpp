@@ -2,6 +2,7 @@
 
 #include <nw/kernel/Memory.hpp>
 #include <nw/resources/Erf.hpp>
+#include <nw/resources/RegistrySnapshot.hpp>
 #include <nw/resources/ResourceManager.hpp>
 #include <nw/resources/StaticDirectory.hpp>
 #include <nw/resources/StaticErf.hpp>
@@ -11,10 +12,13 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <limits>
+#include <thread>
 
 using namespace nw;
 using namespace std::literals;
@@ -492,6 +496,40 @@ TEST(StaticErf, DemandRejectsWrappedResourceRange)
     EXPECT_TRUE(data.bytes.size() == 0);
 }
 
+TEST(StaticErf, MemoryMappedDemandBorrowsAndCopiesOnWrite)
+{
+    StaticErf streamed("test_data/user/modules/DockerDemo.mod");
+    StaticErf mapped("test_data/user/modules/DockerDemo.mod");
+    ASSERT_TRUE(mapped.memory_map());
+    EXPECT_TRUE(mapped.memory_mapped());
+    EXPECT_FALSE(streamed.memory_mapped());
+
+    const auto module = Resource{"module"sv, ResourceType::ifo};
+    const ContainerKey* streamed_key = nullptr;
+    const ContainerKey* mapped_key = nullptr;
+    streamed.visit([&](Resource res, const ContainerKey* key) {
+        if (res == module) { streamed_key = key; }
+    });
+    mapped.visit([&](Resource res, const ContainerKey* key) {
+        if (res == module) { mapped_key = key; }
+    });
+    ASSERT_NE(streamed_key, nullptr);
+    ASSERT_NE(mapped_key, nullptr);
+
+    auto expected = streamed.demand(streamed_key);
+    auto data = mapped.demand(mapped_key);
+    EXPECT_FALSE(expected.bytes.borrowed());
+    EXPECT_TRUE(data.bytes.borrowed());
+    EXPECT_EQ(data.name, module);
+    EXPECT_EQ(data.bytes, expected.bytes);
+
+    auto other = mapped.demand(mapped_key);
+    other.bytes.mutable_data()[0] = static_cast<uint8_t>(other.bytes[0] ^ 0xFF);
+    EXPECT_FALSE(other.bytes.borrowed());
+    EXPECT_EQ(data.bytes, expected.bytes);
+    EXPECT_EQ(mapped.demand(mapped_key).bytes, expected.bytes);
+}
+
 // == StaticKey ===============================================================
 // ============================================================================
 
@@ -591,6 +629,41 @@ TEST(StaticZip, visit)
     EXPECT_EQ(z.size(), count);
 }
 
+TEST(StaticZip, DemandReusesArchiveHandles)
+{
+    nw::StaticZip z{"test_data/user/modules/module_as_zip.zip"};
+    ASSERT_TRUE(z.valid());
+    EXPECT_EQ(z.pooled_archives(), 1u);
+
+    std::vector<const nw::ContainerKey*> keys;
+    z.visit([&keys](nw::Resource, const nw::ContainerKey* key) { keys.push_back(key); });
+    ASSERT_FALSE(keys.empty());
+
+    std::vector<nw::ByteArray> expected;
+    for (auto key : keys) {
+        expected.push_back(z.demand(key).bytes);
+        EXPECT_EQ(z.pooled_archives(), 1u);
+    }
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t> mismatches{0};
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                size_t idx = (i + t) % keys.size();
+                if (!(z.demand(keys[idx]).bytes == expected[idx])) { ++mismatches; }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(mismatches.load(), 0u);
+    EXPECT_GE(z.pooled_archives(), 1u);
+    EXPECT_LE(z.pooled_archives(), nw::kernel::config().options().zip_pooled_archives);
+}
+
 // == Resref ==================================================================
 // ============================================================================
 
@@ -755,6 +828,263 @@ TEST(KernelResources, AddContainer)
     delete rm;
 }
 
+TEST(KernelResources, BuildRegistryTopContainerWins)
+{
+    nw::ResourceManager resources{nwk::global_allocator()};
+    nw::StaticZip zip{"test_data/user/modules/module_as_zip.zip"};
+    nw::StaticErf erf{"test_data/user/modules/DockerDemo.mod"};
+    nw::StaticDirectory dir{"test_data/user/modules/module_as_dir"};
+    ASSERT_TRUE(resources.add_custom_container(&zip, false));
+    ASSERT_TRUE(resources.add_custom_container(&erf, false));
+    ASSERT_TRUE(resources.add_custom_container(&dir, false));
+    resources.build_registry();
+
+    const auto& stats = resources.build_stats();
+    EXPECT_EQ(stats.containers, 3u);
+    EXPECT_GE(stats.workers, 1u);
+    EXPECT_EQ(resources.stats()["build_registry"]["containers"].get<size_t>(), 3u);
+
+    size_t visited = 0;
+    resources.visit([&](nw::Resource uri) {
+        ++visited;
+        const Container* owner = nullptr;
+        for (const Container* c : {static_cast<const Container*>(&zip),
+                 static_cast<const Container*>(&erf), static_cast<const Container*>(&dir)}) {
+            c->visit([&](nw::Resource res, const ContainerKey* key) {
+                if (!owner && res == uri) {
+                    owner = c;
+                    EXPECT_EQ(resources.demand(uri).bytes, c->demand(key).bytes);
+                }
+            });
+            if (owner) { break; }
+        }
+        EXPECT_NE(owner, nullptr);
+    });
+    EXPECT_EQ(visited, resources.size());
+}
+
+TEST(KernelResources, DemandManyMatchesDemand)
+{
+    nw::ResourceManager resources{nwk::global_allocator()};
+    nw::StaticZip zip{"test_data/user/modules/module_as_zip.zip"};
+    nw::StaticErf erf{"test_data/user/modules/DockerDemo.mod"};
+    ASSERT_TRUE(resources.add_custom_container(&zip, false));
+    ASSERT_TRUE(resources.add_custom_container(&erf, false));
+    resources.build_registry();
+
+    Vector<nw::Resource> uris;
+    resources.visit([&uris](nw::Resource uri) { uris.push_back(uri); });
+    ASSERT_GT(uris.size(), 0u);
+    std::reverse(uris.begin(), uris.end());
+    uris.push_back({"doesnotexist"sv, nw::ResourceType::utc});
+
+    auto batch = resources.demand_many(uris);
+    ASSERT_EQ(batch.size(), uris.size());
+    for (size_t i = 0; i < uris.size(); ++i) {
+        EXPECT_EQ(batch[i].bytes, resources.demand(uris[i]).bytes);
+    }
+    EXPECT_EQ(batch.back().bytes.size(), 0u);
+
+    std::atomic<size_t> calls{0};
+    resources.demand_many(uris, [&](size_t index, nw::ResourceData data) {
+        ++calls;
+        EXPECT_EQ(data.bytes, batch[index].bytes);
+    });
+    EXPECT_EQ(calls.load(), uris.size());
+
+    auto future = resources.demand_many_async(uris);
+    auto async = future.get();
+    ASSERT_EQ(async.size(), uris.size());
+    for (size_t i = 0; i < uris.size(); ++i) {
+        EXPECT_EQ(async[i].bytes, batch[i].bytes);
+    }
+}
+
+TEST(KernelResources, DemandManyFallsBackToParent)
+{
+    nw::ResourceManager parent{nwk::global_allocator()};
+    nw::StaticZip zip{"test_data/user/modules/module_as_zip.zip"};
+    ASSERT_TRUE(parent.add_custom_container(&zip, false));
+    parent.build_registry();
+
+    nw::Resource uri;
+    zip.visit([&uri](nw::Resource r, const nw::ContainerKey*) { uri = r; });
+    ASSERT_TRUE(uri.valid());
+
+    // An empty file in the child shadows the parent's resource, like ``demand`` the parent wins
+    auto dir = fs::temp_directory_path() / "rollnw_demand_many_parent";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    { std::ofstream{dir / uri.filename()}; }
+
+    nw::ResourceManager child{nwk::global_allocator(), &parent};
+    nw::StaticDirectory sd{dir};
+    ASSERT_TRUE(child.add_custom_container(&sd, false));
+    child.build_registry();
+    ASSERT_TRUE(child.contains(uri));
+
+    auto batch = child.demand_many(std::span<const nw::Resource>{&uri, 1});
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_GT(batch[0].bytes.size(), 0u);
+    EXPECT_EQ(batch[0].bytes, child.demand(uri).bytes);
+
+    fs::remove_all(dir);
+}
+
+TEST(KernelResources, MemoryMapContainersOption)
+{
+    auto options = nwk::config().options();
+    const bool previous = options.memory_map_containers;
+    options.memory_map_containers = true;
+    nwk::config().initialize(options);
+
+    nw::ResourceManager resources{nwk::global_allocator()};
+    nw::StaticErf e("test_data/user/modules/DockerDemo.mod");
+    ASSERT_TRUE(resources.add_custom_container(&e, false));
+    resources.build_registry();
+
+    EXPECT_TRUE(e.memory_mapped());
+    EXPECT_EQ(resources.stats()["memory_mapped_containers"].get<size_t>(), 1u);
+    auto data = resources.demand({"module"sv, nw::ResourceType::ifo});
+    EXPECT_TRUE(data.bytes.borrowed());
+    EXPECT_GT(data.bytes.size(), 0u);
+
+    options.memory_map_containers = previous;
+    nwk::config().initialize(options);
+}
+
+TEST(RegistrySnapshot, WriteAndOpen)
+{
+    nw::StaticErf erf{"test_data/user/modules/DockerDemo.mod"};
+    auto stamp = nw::ContainerStamp::from_container(&erf);
+    ASSERT_TRUE(stamp);
+
+    Vector<nw::RegistrySnapshot::Entry> entries;
+    erf.visit([&](nw::Resource uri, const ContainerKey*) {
+        entries.push_back({uri, static_cast<uint32_t>(entries.size())});
+    });
+
+    const fs::path path = "tmp/registry_snapshot_write.bin";
+    ASSERT_TRUE(nw::RegistrySnapshot::write(path, {*stamp}, {entries}));
+    auto snapshot = nw::RegistrySnapshot::open(path);
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ(snapshot->container_count(), 1u);
+    EXPECT_EQ(snapshot->container(0), *stamp);
+    EXPECT_EQ(snapshot->entry_count(), entries.size());
+
+    for (const auto& e : entries) {
+        size_t found = 0;
+        snapshot->find(e.resource, [&](uint32_t container, uint32_t ordinal) {
+            ++found;
+            EXPECT_EQ(container, 0u);
+            EXPECT_EQ(ordinal, e.ordinal);
+        });
+        EXPECT_EQ(found, 1u);
+    }
+
+    size_t missing = 0;
+    snapshot->find({"doesnotexist"sv, nw::ResourceType::utc}, [&](uint32_t, uint32_t) { ++missing; });
+    EXPECT_EQ(missing, 0u);
+
+    snapshot.reset();
+    std::ofstream{path, std::ios::binary | std::ios::trunc} << "NWRS";
+    EXPECT_FALSE(nw::RegistrySnapshot::open(path));
+}
+
+TEST(KernelResources, RegistrySnapshotWarmBuildMatchesColdBuild)
+{
+    const fs::path path = "tmp/registry_snapshot_warm.bin";
+    std::error_code ec;
+    fs::remove(path, ec);
+
+    nw::StaticZip zip{"test_data/user/modules/module_as_zip.zip"};
+    nw::StaticErf erf{"test_data/user/modules/DockerDemo.mod"};
+    nw::StaticDirectory dir{"test_data/user/modules/module_as_dir"};
+
+    auto build = [&](nw::ResourceManager& resources) {
+        ASSERT_TRUE(resources.add_custom_container(&zip, false));
+        ASSERT_TRUE(resources.add_custom_container(&erf, false));
+        ASSERT_TRUE(resources.add_custom_container(&dir, false));
+        resources.build_registry();
+    };
+
+    nw::ResourceManager cold{nwk::global_allocator()};
+    build(cold);
+
+    auto options = nwk::config().options();
+    const auto previous = options.registry_snapshot;
+    options.registry_snapshot = path.string();
+    nwk::config().initialize(options);
+
+    nw::ResourceManager first{nwk::global_allocator()};
+    build(first);
+    EXPECT_TRUE(first.snapshot_stats().written);
+    EXPECT_EQ(first.snapshot_stats().rescanned, 2u);
+
+    nw::ResourceManager warm{nwk::global_allocator()};
+    build(warm);
+    EXPECT_FALSE(warm.snapshot_stats().written);
+    EXPECT_EQ(warm.snapshot_stats().reused, 2u);
+    EXPECT_EQ(warm.snapshot_stats().rescanned, 0u);
+    EXPECT_EQ(warm.stats()["registry_snapshot"]["reused_containers"].get<size_t>(), 2u);
+
+    EXPECT_EQ(warm.size(), cold.size());
+    size_t visited = 0;
+    cold.visit([&](nw::Resource uri) {
+        ++visited;
+        EXPECT_TRUE(warm.contains(uri));
+        EXPECT_EQ(warm.demand(uri).bytes, cold.demand(uri).bytes);
+    });
+    warm.visit([&](nw::Resource uri) {
+        --visited;
+        EXPECT_TRUE(cold.contains(uri));
+    });
+    EXPECT_EQ(visited, 0u);
+    EXPECT_FALSE(warm.contains({"doesnotexist"sv, nw::ResourceType::utc}));
+
+    options.registry_snapshot = previous;
+    nwk::config().initialize(options);
+}
+
+TEST(KernelResources, RegistrySnapshotRescansChangedContainer)
+{
+    const fs::path path = "tmp/registry_snapshot_changed.bin";
+    const fs::path mod = "tmp/registry_snapshot_changed.mod";
+    std::error_code ec;
+    fs::remove(path, ec);
+    fs::create_directories("tmp", ec);
+    fs::copy_file("test_data/user/modules/DockerDemo.mod", mod, fs::copy_options::overwrite_existing);
+
+    auto options = nwk::config().options();
+    const auto previous = options.registry_snapshot;
+    options.registry_snapshot = path.string();
+    nwk::config().initialize(options);
+
+    {
+        nw::ResourceManager resources{nwk::global_allocator()};
+        nw::StaticErf erf{mod};
+        ASSERT_TRUE(resources.add_custom_container(&erf, false));
+        resources.build_registry();
+        EXPECT_TRUE(resources.snapshot_stats().written);
+    }
+
+    fs::last_write_time(mod, fs::last_write_time(mod) + std::chrono::seconds(10));
+
+    {
+        nw::ResourceManager resources{nwk::global_allocator()};
+        nw::StaticErf erf{mod};
+        ASSERT_TRUE(resources.add_custom_container(&erf, false));
+        resources.build_registry();
+        EXPECT_EQ(resources.snapshot_stats().reused, 0u);
+        EXPECT_EQ(resources.snapshot_stats().rescanned, 1u);
+        EXPECT_TRUE(resources.snapshot_stats().written);
+        EXPECT_TRUE(resources.contains({"module"sv, nw::ResourceType::ifo}));
+    }
+
+    options.registry_snapshot = previous;
+    nwk::config().initialize(options);
+}
+
 TEST(KernelResources, RegistryGenerationAdvancesWhenVisibleResourcesChange)
 {
     nw::ResourceManager resources{nwk::global_allocator()};
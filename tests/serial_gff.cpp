@@ -7,7 +7,9 @@
 
 #include <nlohmann/json.hpp>
 
+#include <cstring>
 #include <fstream>
+#include <memory>
 #include <utility>
 
 using namespace std::literals;
@@ -90,6 +92,68 @@ TEST(Gff, IntegerPromotion)
     EXPECT_TRUE(top["ClassList"][0]["Class"].get<int64_t>());
 }
 
+TEST(Gff, InPlaceTables)
+{
+    auto data = std::make_shared<nw::ResourceData>(
+        nw::ResourceData::from_file("test_data/user/development/nw_chicken.utc"));
+    ASSERT_GT(data->bytes.size(), 0u);
+    auto view = [&data]() {
+        nw::ResourceData result;
+        result.name = data->name;
+        result.bytes = nw::ByteArray::borrow(data, data->bytes.data(), data->bytes.size());
+        return result;
+    };
+
+    nw::Gff copied{view(), nw::LanguageID::english, false};
+    ASSERT_TRUE(copied.valid());
+    EXPECT_FALSE(copied.in_place());
+
+    nw::Gff in_place{view()};
+    ASSERT_TRUE(in_place.valid());
+    EXPECT_TRUE(in_place.in_place());
+    EXPECT_EQ(nw::gff_to_gffjson(in_place), nw::gff_to_gffjson(copied));
+
+    // Misaligned input falls back to copying the tables.
+    auto storage = std::make_shared<std::vector<uint8_t>>(data->bytes.size() + 1);
+    std::memcpy(storage->data() + 1, data->bytes.data(), data->bytes.size());
+    nw::ResourceData misaligned;
+    misaligned.name = data->name;
+    misaligned.bytes = nw::ByteArray::borrow(storage, storage->data() + 1, data->bytes.size());
+
+    nw::Gff fallback{std::move(misaligned)};
+    ASSERT_TRUE(fallback.valid());
+    EXPECT_FALSE(fallback.in_place());
+    EXPECT_EQ(nw::gff_to_gffjson(fallback), nw::gff_to_gffjson(copied));
+}
+
+TEST(Gff, LabelIndex)
+{
+    nw::Gff g("test_data/user/development/nw_chicken.utc");
+    ASSERT_TRUE(g.valid());
+    auto top = g.toplevel();
+
+    EXPECT_TRUE(top["TemplateResRef"].valid());
+    EXPECT_TRUE(top["templateresref"].valid());
+    EXPECT_EQ(top["TEMPLATERESREF"].name(), "TemplateResRef");
+    EXPECT_FALSE(top["NotAField"].valid());
+    EXPECT_FALSE(top["AVeryLongLabelThatCannotExist"].valid());
+
+    // The slot layout of a struct type is taken from its first struct, which for the toplevel is
+    // itself, so every lookup of a present label is a slot hit.
+    auto before = g.lookup_stats();
+    for (size_t i = 0; i < top.size(); ++i) {
+        EXPECT_EQ(top[top[i].name()].name(), top[i].name());
+    }
+    auto after = g.lookup_stats();
+#if defined(ROLLNW_ENABLE_GFF_STATS)
+    EXPECT_EQ(after.lookups - before.lookups, top.size());
+    EXPECT_EQ(after.slot_hits - before.slot_hits, top.size());
+#else
+    EXPECT_EQ(after.lookups, 0u);
+    EXPECT_EQ(after.slot_hits, 0u);
+#endif
+}
+
 TEST(Gff, GffJsonConversion)
 {
     nw::Gff g("test_data/user/development/nw_chicken.utc");
@@ -157,6 +221,18 @@ TEST(Gff, ListsNested)
     out.build();
     EXPECT_EQ(out.struct_entries[0].field_count, 2u);
     EXPECT_EQ(out.struct_entries.size(), 4u);
+    EXPECT_EQ(out.field_entries.size(), 8u);
+
+    // Fields and structs in depth first order, each multi-field struct's field indices and each
+    // list's struct indices laid out in the order the structs and lists were opened.
+    EXPECT_EQ(out.field_indices, (std::vector<uint32_t>{0, 6, 1, 2, 3, 4}));
+    EXPECT_EQ(out.list_indices, (std::vector<uint32_t>{1, 1, 1, 2, 1, 3}));
+    EXPECT_EQ(out.struct_entries[1].field_index, 8u);
+    EXPECT_EQ(out.struct_entries[2].field_index, 5u);
+    EXPECT_EQ(out.struct_entries[3].field_index, 7u);
+    EXPECT_EQ(out.field_entries[4].data_or_offset, 8u);
+    EXPECT_EQ(out.field_entries[6].data_or_offset, 16u);
+    EXPECT_EQ(out.to_byte_array().size(), out.byte_size());
 
     out.write_to("tmp/test.gff");
 
@@ -29,6 +29,7 @@
 #include <nw/objects/Waypoint.hpp>
 #include <nw/profiles/nwn1/propset_gff_exporter.hpp>
 #include <nw/profiles/nwn1/propset_gff_importer.hpp>
+#include <nw/profiles/nwn1/propset_gff_plan.hpp>
 #include <nw/profiles/nwn1/propset_gff_policy.hpp>
 #include <nw/resources/assets.hpp>
 #include <nw/rules/items.hpp>
@@ -343,6 +344,52 @@ TEST_F(SmallsPropsetParity, RegistryKnownPropsets)
     EXPECT_NE(registry_->find("nwn1.propsets.PlaceableState"), nullptr);
 }
 
+TEST_F(SmallsPropsetParity, CompiledPlans)
+{
+    auto& rt = nw::kernel::runtime();
+    ASSERT_NE(rt.load_module("nwn1.propsets"), nullptr);
+
+    const auto blueprint = nwn1::propset_gff_plan(&rt, registry_.get(), "nwn1.propsets.SoundState",
+        nw::SerializationProfile::blueprint);
+    const auto instance = nwn1::propset_gff_plan(&rt, registry_.get(), "nwn1.propsets.SoundState",
+        nw::SerializationProfile::instance);
+    ASSERT_NE(blueprint, nullptr);
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(blueprint->type_id, rt.type_id("nwn1.propsets.SoundState", false));
+
+    // Instance only fields are dropped at compile time
+    EXPECT_EQ(blueprint->steps.size() + 1, instance->steps.size());
+    ASSERT_FALSE(blueprint->steps.empty());
+    EXPECT_EQ(blueprint->steps[0].op, nwn1::PropsetGffOp::list_scalar);
+    EXPECT_EQ(blueprint->steps[0].gff_label, "Sounds");
+    EXPECT_EQ(blueprint->labels[blueprint->steps[0].first], "Sound");
+
+    // Plans are compiled once, propsets without a policy have none
+    EXPECT_EQ(blueprint, nwn1::propset_gff_plan(&rt, registry_.get(), "nwn1.propsets.SoundState",
+                             nw::SerializationProfile::blueprint));
+    EXPECT_EQ(nwn1::propset_gff_plan(&rt, registry_.get(), "core.object.ObjectCommon",
+                  nw::SerializationProfile::blueprint),
+        nullptr);
+
+    const auto levels = nwn1::propset_gff_plan(&rt, registry_.get(), "nwn1.propsets.CreatureLevels",
+        nw::SerializationProfile::blueprint);
+    ASSERT_NE(levels, nullptr);
+    auto paired = std::find_if(levels->steps.begin(), levels->steps.end(), [](const auto& step) {
+        return step.op == nwn1::PropsetGffOp::list_paired;
+    });
+    ASSERT_NE(paired, levels->steps.end());
+    EXPECT_EQ(paired->slots, 8u);
+
+    // Handles outlive the cache, a lookup after clearing compiles a new plan
+    nwn1::clear_propset_gff_plans();
+    EXPECT_EQ(blueprint->steps[0].gff_label, "Sounds");
+    auto recompiled = nwn1::propset_gff_plan(&rt, registry_.get(), "nwn1.propsets.SoundState",
+        nw::SerializationProfile::blueprint);
+    ASSERT_NE(recompiled, nullptr);
+    EXPECT_NE(recompiled, blueprint);
+    EXPECT_EQ(recompiled->steps.size(), blueprint->steps.size());
+}
+
 TEST_F(SmallsPropsetParity, GffDeserializeInitializesSimpleObjectPropsets)
 {
     auto& rt = nw::kernel::runtime();
@@ -2,6 +2,7 @@
 
 #include <nw/log.hpp>
 #include <nw/smalls/Bytecode.hpp>
+#include <nw/smalls/ScriptFunction.hpp>
 #include <nw/smalls/Smalls.hpp>
 #include <nw/smalls/propset_json.hpp>
 #include <nw/smalls/runtime.hpp>
@@ -1305,3 +1306,68 @@ TEST_F(SmallsRuntime, EvictModuleLeavesUnrelatedModulesLoaded)
     EXPECT_TRUE(consumer_module->external_refs_resolved);
     EXPECT_EQ(result.value.data.ival, 12);
 }
+
+TEST_F(SmallsRuntime, ScriptFunctionTypedCalls)
+{
+    auto& rt = nw::kernel::runtime();
+    auto* script = rt.load_module_from_source("test.script_function", R"(
+        fn add(a: int, b: int): int {
+            return a + b;
+        }
+
+        fn half(a: float): float {
+            return a / 2.0;
+        }
+
+        fn is_positive(a: int): bool {
+            return a > 0;
+        }
+
+        fn noop() { }
+    )");
+    ASSERT_NE(script, nullptr);
+    ASSERT_EQ(script->errors(), 0);
+
+    nw::smalls::ScriptFunction<int32_t(int32_t, int32_t)> add{"test.script_function", "add"};
+    nw::smalls::ScriptFunction<float(float)> half{"test.script_function", "half"};
+    nw::smalls::ScriptFunction<bool(int32_t)> is_positive{"test.script_function", "is_positive"};
+    nw::smalls::ScriptFunction<void()> noop{"test.script_function", "noop"};
+
+    EXPECT_EQ(add(2, 3), 5);
+    EXPECT_EQ(half(3.0f), 1.5f);
+    EXPECT_EQ(is_positive(-1), false);
+    EXPECT_TRUE(noop());
+
+    // Results that do not convert are rejected rather than misread.
+    nw::smalls::ScriptFunction<nw::ObjectHandle(int32_t, int32_t)> wrong{"test.script_function", "add"};
+    EXPECT_FALSE(wrong(1, 2).has_value());
+
+    nw::smalls::ScriptFunction<int32_t()> missing{"test.script_function", "missing"};
+    EXPECT_FALSE(missing().has_value());
+}
+
+TEST_F(SmallsRuntime, ScriptFunctionResolvesAgainAfterEviction)
+{
+    auto& rt = nw::kernel::runtime();
+    ASSERT_NE(rt.load_module_from_source("test.script_function_reload", R"(
+        fn value(): int {
+            return 1;
+        }
+    )"),
+        nullptr);
+
+    nw::smalls::ScriptFunction<int32_t()> value{"test.script_function_reload", "value"};
+    EXPECT_EQ(value(), 1);
+
+    auto generation = rt.module_generation();
+    EXPECT_TRUE(rt.evict_module("test.script_function_reload"));
+    EXPECT_NE(rt.module_generation(), generation);
+
+    ASSERT_NE(rt.load_module_from_source("test.script_function_reload", R"(
+        fn value(): int {
+            return 2;
+        }
+    )"),
+        nullptr);
+    EXPECT_EQ(value(), 2);
+}
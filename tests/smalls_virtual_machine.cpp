@@ -1,9 +1,16 @@
 #include "smalls_fixtures.hpp"
 
+#include <nw/kernel/EventSystem.hpp>
+#include <nw/kernel/Strings.hpp>
 #include <nw/log.hpp>
 #include <nw/smalls/AstCompiler.hpp>
 #include <nw/smalls/Bytecode.hpp>
+#include <nw/smalls/BytecodeCache.hpp>
+#include <nw/smalls/BytecodeOptimizer.hpp>
+#include <nw/smalls/BytecodeVerifier.hpp>
 #include <nw/smalls/Context.hpp>
+#include <nw/smalls/CoroutineScheduler.hpp>
+#include <nw/smalls/Map.hpp>
 #include <nw/smalls/Smalls.hpp>
 #include <nw/smalls/VirtualMachine.hpp>
 #include <nw/smalls/runtime.hpp>
@@ -11,8 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
 #include <limits>
 #include <string_view>
+#include <vector>
 
 using namespace std::literals;
 
@@ -1019,6 +1028,96 @@ TEST_F(SmallsVirtualMachine, MapGetSet)
     EXPECT_EQ(res.data.ival, 120);
 }
 
+TEST_F(SmallsVirtualMachine, MapSpecializedStorage)
+{
+    using namespace nw::smalls;
+
+    auto& rt = nw::kernel::runtime();
+
+    HeapPtr ints = rt.alloc_map(rt.int_type(), rt.int_type());
+    auto* int_map = static_cast<MapInstance*>(rt.heap_.get_ptr(ints));
+    EXPECT_EQ(int_map->key_kind, MapKeyKind::int_key);
+    EXPECT_TRUE(int_map->unboxed_values);
+    EXPECT_TRUE(rt.map_set(ints, Value::make_int(7), Value::make_int(-3)));
+    EXPECT_FALSE(rt.map_set(ints, Value::make_float(7.0f), Value::make_int(1)));
+    EXPECT_FALSE(rt.map_set(ints, Value::make_int(8), Value::make_float(1.0f)));
+    EXPECT_EQ(rt.map_size(ints), 1u);
+
+    HeapPtr strings = rt.alloc_map(rt.string_type(), rt.string_type());
+    auto* string_map = static_cast<MapInstance*>(rt.heap_.get_ptr(strings));
+    EXPECT_EQ(string_map->key_kind, MapKeyKind::string_key);
+    EXPECT_FALSE(string_map->unboxed_values);
+
+    // String keys compare by contents, not by allocation
+    EXPECT_TRUE(rt.map_set(strings, Value::make_string(rt.alloc_string("a")), Value::make_string(rt.alloc_string("x"))));
+    EXPECT_FALSE(rt.map_set(strings, Value::make_string(rt.alloc_string("a")), Value::make_string(rt.alloc_string("y"))));
+    Value val;
+    ASSERT_TRUE(rt.map_get(strings, Value::make_string(rt.alloc_string("a")), val));
+    EXPECT_EQ(rt.get_string_view(val.data.hptr), "y");
+    EXPECT_FALSE(rt.map_get(strings, Value::make_string(rt.alloc_string("map key never inserted")), val));
+
+    // Keys live in the map, nothing is interned by the kernel
+    EXPECT_TRUE(rt.map_set(strings, Value::make_string(rt.alloc_string("map key only in a map")),
+        Value::make_string(rt.alloc_string("w"))));
+    EXPECT_FALSE(nw::kernel::strings().get_interned("map key only in a map"));
+
+    // Empty strings are valid keys
+    EXPECT_TRUE(rt.map_set(strings, Value::make_string(rt.alloc_string("")), Value::make_string(rt.alloc_string("z"))));
+    ASSERT_TRUE(rt.map_get(strings, Value::make_string(rt.alloc_string("")), val));
+    EXPECT_EQ(rt.get_string_view(val.data.hptr), "z");
+
+    std::string_view source = R"(
+        type FeatId(int);
+
+        var names: map!(string, float) = {};
+        var feats: map!(FeatId, bool) = {};
+
+        fn fill(n: int) {
+            for (var i = 0; i < n; i = i + 1) {
+                names[f"name{i}"] = (i as float) * 0.5;
+                feats[FeatId(i)] = i % 2 == 0;
+            }
+        }
+
+        fn matches(n: int): int {
+            var hits = 0;
+            for (var i = 0; i < n; i = i + 1) {
+                if (names[f"name{i}"] == (i as float) * 0.5 && feats[FeatId(i)] == (i % 2 == 0)) {
+                    hits = hits + 1;
+                }
+            }
+            return hits;
+        }
+
+        fn even_sum(): int {
+            var sum = 0;
+            for (var feat, even in feats) {
+                if (even) {
+                    sum = sum + (feat as int);
+                }
+            }
+            return sum;
+        }
+    )";
+
+    auto* script = rt.load_module_from_source("test.vm.map_specialized", source);
+    ASSERT_NE(script, nullptr);
+    ASSERT_EQ(script->errors(), 0);
+
+    ASSERT_TRUE(rt.execute_script(script, "fill", {Value::make_int(100)}).ok());
+
+    // String keys are only reachable through the map
+    rt.gc()->collect_full();
+
+    auto hits = rt.execute_script(script, "matches", {Value::make_int(100)});
+    ASSERT_TRUE(hits.ok()) << hits.error_message;
+    EXPECT_EQ(hits.value.data.ival, 100);
+
+    auto sum = rt.execute_script(script, "even_sum", {});
+    ASSERT_TRUE(sum.ok()) << sum.error_message;
+    EXPECT_EQ(sum.value.data.ival, 2450);
+}
+
 TEST_F(SmallsVirtualMachine, ArrayLiteral)
 {
     using namespace nw::smalls;
@@ -1858,3 +1957,270 @@ TEST_F(SmallsVirtualMachine, StructClosureFieldCall)
     EXPECT_EQ(result.type_id, nw::kernel::runtime().type_id("int"));
     EXPECT_EQ(result.data.ival, 12);
 }
+
+TEST_F(SmallsVirtualMachine, BytecodeOptimizerPreservesResults)
+{
+    using namespace nw::smalls;
+    auto& rt = nw::kernel::runtime();
+
+    constexpr auto source = R"(
+        fn clamp_add(x: int, y: int): int {
+            return x + y;
+        }
+
+        fn is_even(x: int): bool {
+            return x % 2 == 0;
+        }
+
+        fn test(n: int): int {
+            var total = 0;
+            var flips = false;
+            for (var i = 0; i < n; i = i + 1) {
+                var v = i;
+                if (is_even(v)) {
+                    total = clamp_add(total, v);
+                } else if (v > 7) {
+                    total = total - 1;
+                } else {
+                    total += 2;
+                }
+                if (flips == false) {
+                    flips = true;
+                } else {
+                    flips = false;
+                }
+                if (total >= 100) { break; }
+            }
+            if (flips) { total = total * 10; }
+            return total;
+        }
+    )"sv;
+
+    auto plain_script = make_script(source);
+    auto optimized_script = make_script(source);
+    for (auto* script : {&plain_script, &optimized_script}) {
+        EXPECT_NO_THROW(script->parse());
+        ASSERT_NO_THROW(script->resolve());
+        ASSERT_EQ(script->errors(), 0);
+    }
+
+    BytecodeModule plain("plain");
+    AstCompiler plain_compiler(&plain_script, &plain, &rt, rt.diagnostic_context());
+    ASSERT_TRUE(plain_compiler.compile());
+
+    BytecodeModule optimized("optimized");
+    AstCompiler optimized_compiler(&optimized_script, &optimized, &rt, rt.diagnostic_context());
+    ASSERT_TRUE(optimized_compiler.compile());
+
+    EXPECT_EQ(optimize_bytecode(&optimized, &rt, BytecodeOptimizerOptions::none()).functions, 0u);
+
+    auto stats = optimize_bytecode(&optimized, &rt);
+    EXPECT_GT(stats.functions, 0u);
+    EXPECT_GT(stats.calls_inlined, 0u);
+    EXPECT_GT(stats.branches_fused, 0u);
+    EXPECT_LT(stats.instructions_after, stats.instructions_before);
+
+    nw::String error;
+    EXPECT_TRUE(verify_bytecode_module(&optimized, &rt, &error)) << error;
+    for (const auto* func : optimized.functions) {
+        EXPECT_EQ(func->debug_locations.size(), func->instructions.size());
+    }
+
+    for (int32_t n : {0, 1, 5, 12, 40}) {
+        VirtualMachine vm{};
+        nw::Vector<Value> args{Value::make_int(n)};
+        auto expected = vm.execute(&plain, "test", args);
+        auto actual = vm.execute(&optimized, "test", args);
+        EXPECT_EQ(actual.type_id, rt.int_type());
+        EXPECT_EQ(actual.data.ival, expected.data.ival) << "n = " << n;
+    }
+}
+
+TEST_F(SmallsVirtualMachine, BytecodeCacheRoundTrip)
+{
+    using namespace nw::smalls;
+    auto& rt = nw::kernel::runtime();
+
+    auto script = make_script(R"(
+        type Pair { x: int; y: float; };
+
+        fn label(n: int): string {
+            if (n > 2) { return "many"; }
+            return "few";
+        }
+
+        fn test(n: int): int {
+            var p: Pair = { n, 1.5 };
+            var total = p.x;
+            for (var i = 0; i < n; i = i + 1) {
+                if (label(i) == "many") {
+                    total = total + 10;
+                }
+            }
+            return total;
+        }
+    )"sv);
+    EXPECT_NO_THROW(script.parse());
+    ASSERT_NO_THROW(script.resolve());
+    ASSERT_EQ(script.errors(), 0);
+
+    BytecodeModule compiled("test");
+    AstCompiler compiler(&script, &compiled, &rt, rt.diagnostic_context());
+    ASSERT_TRUE(compiler.compile());
+
+    nw::ByteArray bytes;
+    ASSERT_TRUE(write_bytecode_module(compiled, rt, script.text(), 42, bytes));
+
+    BytecodeModule stale("test");
+    EXPECT_FALSE(read_bytecode_module(bytes.span(), rt, script.text(), 43, stale));
+    BytecodeModule truncated("test");
+    EXPECT_FALSE(read_bytecode_module(bytes.span().first(bytes.size() / 2), rt, script.text(), 42, truncated));
+
+    BytecodeModule loaded("test");
+    ASSERT_TRUE(read_bytecode_module(bytes.span(), rt, script.text(), 42, loaded));
+    nw::String error;
+    EXPECT_TRUE(verify_bytecode_module(&loaded, &rt, &error)) << error;
+
+    ASSERT_EQ(loaded.functions.size(), compiled.functions.size());
+    EXPECT_EQ(loaded.string_pool, compiled.string_pool);
+    EXPECT_EQ(loaded.constants.size(), compiled.constants.size());
+    EXPECT_EQ(loaded.type_refs, compiled.type_refs);
+    EXPECT_EQ(loaded.field_offsets, compiled.field_offsets);
+    for (size_t i = 0; i < compiled.functions.size(); ++i) {
+        const auto* expected = compiled.functions[i];
+        const auto* actual = loaded.functions[i];
+        EXPECT_EQ(actual->name, expected->name);
+        EXPECT_EQ(actual->register_count, expected->register_count);
+        EXPECT_EQ(actual->return_type, expected->return_type);
+        ASSERT_EQ(actual->instructions.size(), expected->instructions.size());
+        for (size_t j = 0; j < expected->instructions.size(); ++j) {
+            EXPECT_EQ(actual->instructions[j].raw, expected->instructions[j].raw);
+        }
+        ASSERT_EQ(actual->debug_locations.size(), expected->debug_locations.size());
+        for (size_t j = 0; j < expected->debug_locations.size(); ++j) {
+            EXPECT_EQ(actual->debug_locations[j].range.start, expected->debug_locations[j].range.start);
+            EXPECT_EQ(actual->debug_locations[j].view(), expected->debug_locations[j].view());
+        }
+    }
+
+    for (int32_t n : {0, 3, 6}) {
+        VirtualMachine vm{};
+        nw::Vector<Value> args{Value::make_int(n)};
+        auto expected = vm.execute(&compiled, "test", args);
+        auto actual = vm.execute(&loaded, "test", args);
+        EXPECT_EQ(actual.data.ival, expected.data.ival) << "n = " << n;
+    }
+}
+
+TEST_F(SmallsVirtualMachine, CoroutineSleepResumesOnLaterTicks)
+{
+    using namespace nw::smalls;
+
+    auto& rt = nw::kernel::runtime();
+    auto& events = nw::kernel::events();
+    std::string_view source = R"(
+        import core.coroutine as co;
+
+        var progress = 0;
+
+        fn run(n: int) {
+            var total = 0;
+            var add = fn(x: int) { total = total + x; };
+            for (var i = 1; i <= n; i = i + 1) {
+                add(i);
+                co.sleep(2);
+                progress = total;
+            }
+        }
+
+        fn get_progress(): int {
+            return progress;
+        }
+
+        fn bad() {
+            co.yield();
+        }
+    )";
+
+    auto* script = rt.load_module_from_source("test.vm.coroutine_sleep", source);
+    ASSERT_NE(script, nullptr);
+    ASSERT_EQ(script->errors(), 0);
+
+    auto progress = [&]() {
+        auto result = rt.execute_script(script, "get_progress", {});
+        EXPECT_TRUE(result.ok()) << result.error_message;
+        return result.value.data.ival;
+    };
+
+    auto id = rt.coroutines().spawn(script, "run", std::array{Value::make_int(3)});
+    ASSERT_NE(id, 0u);
+    EXPECT_TRUE(rt.coroutines().is_parked(id));
+    EXPECT_EQ(progress(), 0);
+
+    // The closure and its open upvalue live only in parked registers
+    std::vector<int32_t> seen;
+    for (int tick = 0; tick < 8 && rt.coroutines().is_parked(id); ++tick) {
+        rt.gc()->collect_full();
+        events.advance(1);
+        events.process();
+        seen.push_back(progress());
+    }
+    EXPECT_FALSE(rt.coroutines().is_parked(id));
+    EXPECT_EQ(seen, (std::vector<int32_t>{0, 1, 1, 3, 3, 6}));
+    EXPECT_EQ(rt.coroutines().parked(), 0u);
+
+    auto result = rt.execute_script(script, "bad", {});
+    EXPECT_FALSE(result.ok());
+}
+
+TEST_F(SmallsVirtualMachine, CoroutineTimeSlicing)
+{
+    using namespace nw::smalls;
+
+    auto& rt = nw::kernel::runtime();
+    auto& events = nw::kernel::events();
+    std::string_view source = R"(
+        var done = 0;
+
+        fn spin(n: int) {
+            var i = 0;
+            for (i < n) {
+                i = i + 1;
+            }
+            done = done + i;
+        }
+
+        fn get_done(): int {
+            return done;
+        }
+    )";
+
+    auto* script = rt.load_module_from_source("test.vm.coroutine_slice", source);
+    ASSERT_NE(script, nullptr);
+    ASSERT_EQ(script->errors(), 0);
+
+    // Far over the slice, the script is parked instead of failing
+    auto& scheduler = rt.coroutines();
+    scheduler.set_slice_gas(1000);
+    auto a = scheduler.spawn(script, "spin", std::array{Value::make_int(5000)});
+    auto b = scheduler.spawn(script, "spin", std::array{Value::make_int(5000)});
+    ASSERT_NE(a, 0u);
+    ASSERT_NE(b, 0u);
+
+    // A tick budget of one slice resumes one coroutine per tick, the other is deferred
+    scheduler.set_tick_budget(1000);
+    std::vector<size_t> resumed;
+    while (scheduler.parked() > 0 && resumed.size() < 64) {
+        events.advance(1);
+        resumed.push_back(scheduler.resume_due(events.current_tick()));
+        events.process();
+    }
+    EXPECT_EQ(scheduler.parked(), 0u);
+    ASSERT_GE(resumed.size(), 8u);
+    EXPECT_EQ(resumed[0], 1u);
+    EXPECT_EQ(resumed[1], 1u);
+
+    auto result = rt.execute_script(script, "get_done", {});
+    ASSERT_TRUE(result.ok()) << result.error_message;
+    EXPECT_EQ(result.value.data.ival, 10000);
+}
@@ -363,12 +363,7 @@ bool valid_variable_record(const ObjectVariableRecord& record) noexcept
 bool local_record_exists(
     const LocalData& locals, std::string_view name, ObjectVariableType type)
 {
-    for (const auto& [candidate, value] : locals) {
-        if (candidate == name && value.flags.test(local_variable_type(type))) {
-            return true;
-        }
-    }
-    return false;
+    return locals.contains(name, local_variable_type(type));
 }
 
 ObjectVariableWarning numeric_string_warning(std::string_view value) noexcept
@@ -431,12 +426,12 @@ using ObjectVariableKeySet = std::unordered_set<
 void append_local_variable_keys(
     const LocalData& locals, ObjectVariableKeySet& output)
 {
-    for (const auto& [name, value] : locals) {
+    for (const auto& [name, value] : locals.entries()) {
         for (const auto type : {ObjectVariableType::integer,
                  ObjectVariableType::floating,
                  ObjectVariableType::string}) {
             if (value.flags.test(local_variable_type(type))) {
-                output.insert({name, type});
+                output.insert({std::string{name}, type});
             }
         }
     }
@@ -499,19 +494,16 @@ bool canonicalize_object_variable_targets(
 
 bool local_record_matches(const LocalData& locals, const ObjectVariableRecord& record)
 {
-    for (const auto& [name, value] : locals) {
-        if (name != record.name
-            || !value.flags.test(local_variable_type(record.type))) {
-            continue;
-        }
-        switch (record.type) {
-        case ObjectVariableType::integer:
-            return value.integer == record.integer;
-        case ObjectVariableType::floating:
-            return value.float_ == record.floating;
-        case ObjectVariableType::string:
-            return value.string == record.string;
-        }
+    if (!locals.contains(record.name, local_variable_type(record.type))) {
+        return false;
+    }
+    switch (record.type) {
+    case ObjectVariableType::integer:
+        return locals.get_int(record.name) == record.integer;
+    case ObjectVariableType::floating:
+        return locals.get_float(record.name) == record.floating;
+    case ObjectVariableType::string:
+        return locals.get_string(record.name) == record.string;
     }
     return false;
 }
@@ -2666,11 +2658,11 @@ void snapshot_object_variables(ObjectHandle object, ObjectVariableSnapshot& outp
     }
 
     output.rows.reserve(locals->size());
-    for (const auto& [name, value] : *locals) {
+    for (const auto& [name, value] : locals->entries()) {
         if (value.flags.test(LocalVarType::integer)) {
             output.rows.push_back({
                 .variable = {
-                    .name = name,
+                    .name = std::string{name},
                     .type = ObjectVariableType::integer,
                     .integer = value.integer,
                 },
@@ -2686,7 +2678,7 @@ void snapshot_object_variables(ObjectHandle object, ObjectVariableSnapshot& outp
             }
             output.rows.push_back({
                 .variable = {
-                    .name = name,
+                    .name = std::string{name},
                     .type = ObjectVariableType::floating,
                     .floating = value.float_,
                 },
@@ -2695,7 +2687,7 @@ void snapshot_object_variables(ObjectHandle object, ObjectVariableSnapshot& outp
         if (value.flags.test(LocalVarType::string)) {
             output.rows.push_back({
                 .variable = {
-                    .name = name,
+                    .name = std::string{name},
                     .type = ObjectVariableType::string,
                     .string = value.string,
                 },